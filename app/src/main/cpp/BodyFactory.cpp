@@ -1,13 +1,70 @@
 #include "BodyFactory.h"
 #include "PhysicsWorld.h"
+#include "GeometryCache.h"
 #include <box2d/box2d.h>
+#include <functional>
 
 // Static storage for all created body IDs
 std::vector<b2BodyId> BodyFactory::bodies_;
 
+// Body pool storage
+bool BodyFactory::poolingEnabled_ = true;
+std::vector<BodyFactory::ShapeTemplate> BodyFactory::templates_;
+std::unordered_map<BodyFactory::ShapeTemplate, int, BodyFactory::ShapeTemplateHash> BodyFactory::templateIds_;
+std::vector<std::vector<b2BodyId>> BodyFactory::pool_;
+std::vector<uint64_t> BodyFactory::templateLastUse_;
+uint64_t BodyFactory::useClock_ = 0;
+size_t BodyFactory::parkedCount_ = 0;
+std::unordered_map<int, int> BodyFactory::bodyTemplate_;
+
+// Static baking storage
+b2BodyId BodyFactory::bakedBody_ = b2_nullBodyId;
+std::unordered_map<int, BodyFactory::BakedEntry> BodyFactory::baked_;
+std::unordered_map<int32_t, int> BodyFactory::bakedShapeIndex_;
+
+// Upper bound of parked bodies per template; extra ones are really destroyed
+static constexpr size_t kMaxPooledPerTemplate = 256;
+// Upper bound of parked bodies over all templates; varied debris would otherwise keep
+// one template per outline/size alive in the world forever
+static constexpr size_t kMaxPooledTotal = 1024;
+
 // Clears all stored bodies without destroying them in the world
 void BodyFactory::clearBodies() {
     bodies_.clear();
+    clearPool();
+    // Templates only live as long as the world; a snapshot can't outlive it either
+    templates_.clear();
+    templateIds_.clear();
+    templateLastUse_.clear();
+    pool_.clear();
+    useClock_ = 0;
+    bakedBody_ = b2_nullBodyId;
+    baked_.clear();
+    bakedShapeIndex_.clear();
+}
+
+// Copies the index tables; the bodies they name are saved with the world
+void BodyFactory::saveSnapshot(Snapshot& out) {
+    out.bodies          = bodies_;
+    out.pool            = pool_;
+    out.bodyTemplate    = bodyTemplate_;
+    out.bakedBody       = bakedBody_;
+    out.baked           = baked_;
+    out.bakedShapeIndex = bakedShapeIndex_;
+}
+
+void BodyFactory::restoreSnapshot(const Snapshot& snap) {
+    bodies_          = snap.bodies;
+    pool_            = snap.pool;
+    bodyTemplate_    = snap.bodyTemplate;
+    bakedBody_       = snap.bakedBody;
+    baked_           = snap.baked;
+    bakedShapeIndex_ = snap.bakedShapeIndex;
+
+    // Templates interned after the snapshot keep their ids, with nothing parked
+    pool_.resize(templates_.size());
+    parkedCount_ = 0;
+    for (const auto& parked : pool_) parkedCount_ += parked.size();
 }
 
 // Retrieves the Box2D body ID at the given index, or b2_nullBodyId if out of range
@@ -101,6 +158,10 @@ int BodyFactory::createDynamicBodyRound(float x, float y, float radius,
         x < world.getLeftX()   || x > world.getRightX()) {
         return -1;
     }
+    int tpl = internTemplate({ 0, radius, 0.0f, {} });
+    int revived = reviveFromPool(tpl, x, y, density, friction, restitution);
+    if (revived >= 0) return revived;
+
     b2BodyDef bd = b2DefaultBodyDef();
     bd.type = b2_dynamicBody;
     bd.position = (b2Vec2){ x, y };
@@ -115,8 +176,7 @@ int BodyFactory::createDynamicBodyRound(float x, float y, float radius,
     sd.material.restitution = restitution;
 
     b2CreateCircleShape(body, &sd, &circle);
-    bodies_.push_back(body);
-    return (int)bodies_.size() - 1;
+    return storePooledBody(body, tpl);
 }
 
 int BodyFactory::createStaticBodyRound(float x, float y, float radius,
@@ -152,6 +212,10 @@ int BodyFactory::createDynamicBodySquare(float x, float y, float halfWidth, floa
         x < world.getLeftX()   || x > world.getRightX()) {
         return -1;
     }
+    int tpl = internTemplate({ 1, halfWidth, halfHeight, {} });
+    int revived = reviveFromPool(tpl, x, y, density, friction, restitution);
+    if (revived >= 0) return revived;
+
     b2BodyDef bd = b2DefaultBodyDef();
     bd.type = b2_dynamicBody;
     bd.position = (b2Vec2){ x, y };
@@ -165,8 +229,7 @@ int BodyFactory::createDynamicBodySquare(float x, float y, float halfWidth, floa
     sd.material.restitution = restitution;
 
     b2CreatePolygonShape(body, &sd, &poly);
-    bodies_.push_back(body);
-    return (int)bodies_.size() - 1;
+    return storePooledBody(body, tpl);
 }
 
 int BodyFactory::createStaticBodySquare(float x, float y, float halfWidth, float halfHeight,
@@ -202,30 +265,32 @@ int BodyFactory::createDynamicBodyPolygon(
     auto& world = PhysicsWorld::instance();
     // bounds check...
 
-    // 1) Make a dynamic body
+    // 0) Convex hull + polygon for the point list (cached per outline)
+    b2Polygon poly;
+    if (!GeometryCache::getPolygon(points, poly)) return -1;
+
+    // 1) Reuse a parked body with the same outline if there is one
+    int tpl = internTemplate({ 2, 0.0f, 0.0f, points });
+    int revived = reviveFromPool(tpl, x, y, density, friction, restitution);
+    if (revived >= 0) return revived;
+
+    // 2) Make a dynamic body
     b2BodyDef bd = b2DefaultBodyDef();
     bd.type = b2_dynamicBody;
     bd.position = { x, y };
     b2BodyId body = b2CreateBody(world.getWorldId(), &bd);
 
-    // 2) Compute convex hull from input points
-    b2Hull hull = b2ComputeHull(points.data(), int(points.size()));
-
-    // 3) Build the polygon shape (no rounding)
-    b2Polygon poly = b2MakePolygon(&hull, /*radius=*/0.0f);
-
-    // 4) Define material properties
+    // 3) Define material properties
     b2ShapeDef sd = b2DefaultShapeDef();
     sd.density = density;
     sd.material.friction = friction;
     sd.material.restitution = restitution;
 
-    // 5) Attach shape to body
+    // 4) Attach shape to body
     b2CreatePolygonShape(body, &sd, &poly);
 
-    // 6) Store and return
-    bodies_.push_back(body);
-    return int(bodies_.size() - 1);
+    // 5) Store and return
+    return storePooledBody(body, tpl);
 }
 
 int BodyFactory::createStaticBodyPolygon(    float x, float y,
@@ -238,28 +303,26 @@ int BodyFactory::createStaticBodyPolygon(    float x, float y,
         return -1;
     }
 
-    // 1) Make a dynamic body
+    // 1) Convex hull + polygon for the point list (cached per outline)
+    b2Polygon poly;
+    if (!GeometryCache::getPolygon(points, poly)) return -1;
+
+    // 2) Make a dynamic body
     b2BodyDef bd = b2DefaultBodyDef();
     bd.type = b2_dynamicBody;
     bd.position = { x, y };
     b2BodyId body = b2CreateBody(world.getWorldId(), &bd);
 
-    // 2) Compute convex hull from input points
-    b2Hull hull = b2ComputeHull(points.data(), int(points.size()));
-
-    // 3) Build the polygon shape (no rounding)
-    b2Polygon poly = b2MakePolygon(&hull, /*radius=*/0.0f);
-
-    // 4) Define material properties
+    // 3) Define material properties
     b2ShapeDef sd = b2DefaultShapeDef();
     sd.density = density;
     sd.material.friction = friction;
     sd.material.restitution = restitution;
 
-    // 5) Attach shape to body
+    // 4) Attach shape to body
     b2CreatePolygonShape(body, &sd, &poly);
 
-    // 6) Store and return
+    // 5) Store and return
     bodies_.push_back(body);
     return int(bodies_.size() - 1);
 }
@@ -267,16 +330,296 @@ int BodyFactory::createStaticBodyPolygon(    float x, float y,
 
 // Destroys the body at index idx and removes it from storage
 void BodyFactory::destroyBody(int idx) {
+    // 0) Baked statics: only remove their sub-shapes from the compound body
+    auto bakedIt = baked_.find(idx);
+    if (bakedIt != baked_.end()) {
+        for (b2ShapeId shape : bakedIt->second.shapes) {
+            bakedShapeIndex_.erase(shape.index1);
+            if (b2Shape_IsValid(shape)) b2DestroyShape(shape, false);
+        }
+        baked_.erase(bakedIt);
+        return;
+    }
+
     b2BodyId body = getBodyId(idx);
     if (B2_IS_NULL(body)) return;   // nothing to do
 
-    // 1) Remove the body (and all its shapes) from the Box2D world
+    // 1) Park pooled bodies instead of destroying them
+    auto it = bodyTemplate_.find(idx);
+    if (it != bodyTemplate_.end()) {
+        int tpl = it->second;
+        bodyTemplate_.erase(it);
+        bool park = poolingEnabled_ && pool_[tpl].size() < kMaxPooledPerTemplate &&
+                    (parkedCount_ < kMaxPooledTotal || evictLeastRecentlyUsed(tpl));
+        if (park) {
+            b2Body_Disable(body);       // drops contacts and leaves the broadphase
+            pool_[tpl].push_back(body);
+            ++parkedCount_;
+            bodies_[idx] = b2_nullBodyId;
+            return;
+        }
+    }
+
+    // 2) Remove the body (and all its shapes) from the Box2D world
     b2DestroyBody(body);
 
-    // 2) Mark the slot dead so our indices stay valid
+    // 3) Mark the slot dead so our indices stay valid
     bodies_[idx] = b2_nullBodyId;
 }
 
+// -- STATIC BAKING ------------------------------------------------------------
+
+b2Vec2 BodyFactory::getBodyPosition(int idx) {
+    auto it = baked_.find(idx);
+    if (it != baked_.end()) return it->second.position;
+    b2BodyId body = getBodyId(idx);
+    return B2_IS_NULL(body) ? b2Vec2_zero : b2Body_GetPosition(body);
+}
+
+bool BodyFactory::isBaked(int idx) {
+    return baked_.find(idx) != baked_.end();
+}
+
+int BodyFactory::lookupShapeIndex(b2ShapeId shape) {
+    auto it = bakedShapeIndex_.find(shape.index1);
+    if (it != bakedShapeIndex_.end()) return it->second;
+    return lookupIndex(b2Shape_GetBody(shape));
+}
+
+// The compound static body sits at the origin, so sub-shapes are stored in world space
+b2BodyId BodyFactory::getBakedBody() {
+    if (B2_IS_NULL(bakedBody_) || !b2Body_IsValid(bakedBody_)) {
+        b2BodyDef bd = b2DefaultBodyDef();
+        bd.type = b2_staticBody;
+        bd.position = b2Vec2_zero;
+        bakedBody_ = b2CreateBody(PhysicsWorld::instance().getWorldId(), &bd);
+    }
+    return bakedBody_;
+}
+
+// Re-creates every shape of a static body on the baked body (world-space geometry,
+// same material/filter/event flags), then destroys the original body.
+// Chain shapes are left alone and make the whole body non-bakeable.
+bool BodyFactory::moveShapesToBakedBody(b2BodyId body, std::vector<b2ShapeId>& moved) {
+    if (B2_IS_NULL(body) || b2Body_GetType(body) != b2_staticBody) return false;
+
+    int shapeCount = b2Body_GetShapeCount(body);
+    std::vector<b2ShapeId> shapes(shapeCount);
+    b2Body_GetShapes(body, shapes.data(), shapeCount);
+    for (b2ShapeId shape : shapes) {
+        if (b2Shape_GetType(shape) == b2_chainSegmentShape) return false;
+    }
+
+    b2BodyId target = getBakedBody();
+    b2Transform xf = b2Body_GetTransform(body);
+    for (b2ShapeId shape : shapes) {
+        b2ShapeDef sd = b2DefaultShapeDef();
+        sd.userData = b2Shape_GetUserData(shape);
+        sd.material = b2Shape_GetSurfaceMaterial(shape);
+        sd.density = b2Shape_GetDensity(shape);
+        sd.filter = b2Shape_GetFilter(shape);
+        sd.isSensor = b2Shape_IsSensor(shape);
+        sd.enableSensorEvents = b2Shape_AreSensorEventsEnabled(shape);
+        sd.enableContactEvents = b2Shape_AreContactEventsEnabled(shape);
+        sd.enableHitEvents = b2Shape_AreHitEventsEnabled(shape);
+        sd.enablePreSolveEvents = b2Shape_ArePreSolveEventsEnabled(shape);
+        sd.invokeContactCreation = true;   // bodies resting on the old shape must find the new one
+        sd.updateBodyMass = false;         // static, no mass
+
+        b2ShapeId copy = b2_nullShapeId;
+        switch (b2Shape_GetType(shape)) {
+            case b2_circleShape: {
+                b2Circle circle = b2Shape_GetCircle(shape);
+                circle.center = b2TransformPoint(xf, circle.center);
+                copy = b2CreateCircleShape(target, &sd, &circle);
+                break;
+            }
+            case b2_capsuleShape: {
+                b2Capsule capsule = b2Shape_GetCapsule(shape);
+                capsule.center1 = b2TransformPoint(xf, capsule.center1);
+                capsule.center2 = b2TransformPoint(xf, capsule.center2);
+                copy = b2CreateCapsuleShape(target, &sd, &capsule);
+                break;
+            }
+            case b2_segmentShape: {
+                b2Segment seg = b2Shape_GetSegment(shape);
+                seg.point1 = b2TransformPoint(xf, seg.point1);
+                seg.point2 = b2TransformPoint(xf, seg.point2);
+                copy = b2CreateSegmentShape(target, &sd, &seg);
+                break;
+            }
+            case b2_polygonShape: {
+                b2Polygon poly = b2Shape_GetPolygon(shape);
+                poly = b2TransformPolygon(xf, &poly);
+                copy = b2CreatePolygonShape(target, &sd, &poly);
+                break;
+            }
+            default:
+                break;
+        }
+        if (B2_IS_NON_NULL(copy)) moved.push_back(copy);
+    }
+
+    b2DestroyBody(body);
+    return true;
+}
+
+int BodyFactory::bakeStaticBodies(const std::vector<int>& indices) {
+    int count = 0;
+    for (int idx : indices) {
+        b2BodyId body = getBodyId(idx);
+        if (B2_IS_NULL(body) || isBaked(idx)) continue;
+
+        BakedEntry entry;
+        entry.position = b2Body_GetPosition(body);
+        if (!moveShapesToBakedBody(body, entry.shapes)) continue;
+
+        // side table so collisions on the compound body still resolve to idx
+        for (b2ShapeId shape : entry.shapes) {
+            bakedShapeIndex_[shape.index1] = idx;
+        }
+        baked_[idx] = std::move(entry);
+        bodies_[idx] = b2_nullBodyId;   // the original body is gone
+        bodyTemplate_.erase(idx);
+        ++count;
+    }
+    return count;
+}
+
+bool BodyFactory::bakeUntrackedBody(b2BodyId body) {
+    std::vector<b2ShapeId> moved;
+    return moveShapesToBakedBody(body, moved);
+}
+
+// -- BODY POOL ---------------------------------------------------------------
+
+bool BodyFactory::ShapeTemplate::operator==(const ShapeTemplate& other) const {
+    if (kind != other.kind || a != other.a || b != other.b) return false;
+    if (points.size() != other.points.size()) return false;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (points[i].x != other.points[i].x || points[i].y != other.points[i].y) return false;
+    }
+    return true;
+}
+
+size_t BodyFactory::ShapeTemplateHash::operator()(const ShapeTemplate& t) const {
+    std::hash<float> hf;
+    size_t h = std::hash<int>()(t.kind);
+    auto mix = [&h](size_t v) { h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2); };
+    mix(hf(t.a));
+    mix(hf(t.b));
+    for (const b2Vec2& p : t.points) {
+        mix(hf(p.x));
+        mix(hf(p.y));
+    }
+    return h;
+}
+
+void BodyFactory::setPoolingEnabled(bool enable) {
+    poolingEnabled_ = enable;
+    if (!enable) {
+        // Really destroy whatever is parked right now
+        for (auto& parked : pool_) {
+            for (b2BodyId body : parked) {
+                if (b2Body_IsValid(body)) b2DestroyBody(body);
+            }
+            parked.clear();
+        }
+        parkedCount_ = 0;
+    }
+}
+
+// Forget all parked bodies; called when the world (and with it the bodies) is gone
+void BodyFactory::clearPool() {
+    for (auto& parked : pool_) parked.clear();
+    bodyTemplate_.clear();
+    parkedCount_ = 0;
+}
+
+size_t BodyFactory::getPooledCount() {
+    return parkedCount_;
+}
+
+// Returns a stable id for the template, registering it on first use
+int BodyFactory::internTemplate(const ShapeTemplate& tpl) {
+    auto it = templateIds_.find(tpl);
+    if (it != templateIds_.end()) {
+        templateLastUse_[it->second] = ++useClock_;
+        return it->second;
+    }
+    int id = (int)templates_.size();
+    templates_.push_back(tpl);
+    templateIds_.emplace(tpl, id);
+    pool_.emplace_back();
+    templateLastUse_.push_back(++useClock_);
+    return id;
+}
+
+// Really destroys the parked bodies of the least recently used template to make room
+// under kMaxPooledTotal. Returns false when keepTemplateId is itself the oldest one,
+// in which case the caller should destroy its body instead of parking it.
+bool BodyFactory::evictLeastRecentlyUsed(int keepTemplateId) {
+    int oldest = -1;
+    for (int id = 0; id < (int)pool_.size(); ++id) {
+        if (pool_[id].empty() && id != keepTemplateId) continue;
+        if (oldest < 0 || templateLastUse_[id] < templateLastUse_[oldest]) oldest = id;
+    }
+    if (oldest < 0 || oldest == keepTemplateId) return false;
+
+    for (b2BodyId body : pool_[oldest]) {
+        if (b2Body_IsValid(body)) b2DestroyBody(body);
+    }
+    parkedCount_ -= pool_[oldest].size();
+    pool_[oldest].clear();
+    pool_[oldest].shrink_to_fit();
+    return true;
+}
+
+// Stores a freshly created body and remembers its template so it can be parked later
+int BodyFactory::storePooledBody(b2BodyId body, int templateId) {
+    bodies_.push_back(body);
+    int idx = (int)bodies_.size() - 1;
+    bodyTemplate_[idx] = templateId;
+    return idx;
+}
+
+// Pops a parked body for this template, resets it to spawn state and re-enables it.
+// Returns the new index, or -1 when the pool is empty.
+int BodyFactory::reviveFromPool(int templateId, float x, float y,
+                                float density, float friction, float restitution) {
+    if (!poolingEnabled_) return -1;
+    auto& parked = pool_[templateId];
+    while (!parked.empty()) {
+        b2BodyId body = parked.back();
+        parked.pop_back();
+        --parkedCount_;
+        if (!b2Body_IsValid(body)) continue;    // world was reset under us
+
+        // 1) Same state a fresh b2DefaultBodyDef would give
+        b2Body_SetTransform(body, (b2Vec2){ x, y }, b2Rot_identity);
+        b2Body_SetLinearVelocity(body, b2Vec2_zero);
+        b2Body_SetAngularVelocity(body, 0.0f);
+        b2Body_SetGravityScale(body, 1.0f);
+        b2Body_SetBullet(body, false);
+
+        // 2) New material on every shape, then recompute mass once
+        int shapeCount = b2Body_GetShapeCount(body);
+        std::vector<b2ShapeId> shapes(shapeCount);
+        b2Body_GetShapes(body, shapes.data(), shapeCount);
+        for (int i = 0; i < shapeCount; ++i) {
+            b2Shape_SetDensity(shapes[i], density, false);
+            b2Shape_SetFriction(shapes[i], friction);
+            b2Shape_SetRestitution(shapes[i], restitution);
+        }
+        b2Body_ApplyMassFromShapes(body);
+
+        // 3) Back into the simulation
+        b2Body_Enable(body);
+        return storePooledBody(body, templateId);
+    }
+    return -1;
+}
+
 // Teleports an existing body to a new (x, y) while preserving its rotation
 void BodyFactory::replaceBody(int idx, float x, float y) {
     b2BodyId body = getBodyId(idx);
@@ -336,6 +679,8 @@ void BodyFactory::applyLaunchImpulse(int idx, float lastX, float lastY, float ne
     b2Body_SetLinearVelocity(body, { vx, vy });
 }
 bool BodyFactory::isBodyAlive(int idx) {
+    if (isBaked(idx)) return true;  // part of the static compound body
+
     b2BodyId body = getBodyId(idx);
     if (B2_IS_NULL(body)) {
         return false;  // index invalid or already destroyed
@@ -372,8 +717,8 @@ bool BodyFactory::isBodyAlive(int idx) {
     auto& world = PhysicsWorld::instance();
     for (size_t idx = 0; idx < bodies_.size(); ++idx) {
         b2BodyId body = bodies_[idx];
-        if (B2_IS_NULL(body)) continue;          // skip destroyed slots
-        b2Vec2 pos = b2Body_GetPosition(body);
+        if (B2_IS_NULL(body) && !isBaked((int)idx)) continue;   // skip destroyed slots
+        b2Vec2 pos = getBodyPosition((int)idx);
         out.push_back(static_cast<float>(idx)); // index in bodies_
         out.push_back(pos.x);
         out.push_back(pos.y);
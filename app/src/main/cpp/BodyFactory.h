@@ -1,7 +1,9 @@
 #ifndef BODYFACTORY_H
 #define BODYFACTORY_H
 
+#include <cstdint>
 #include <vector>
+#include <unordered_map>
 #include <box2d/box2d.h>
 
 class BodyFactory {
@@ -61,8 +63,82 @@ public:
 
     static std::vector<float> getAllBodyPositions();
 
+    /// Position of a body, or of the original body for baked entries
+    static b2Vec2 getBodyPosition(int idx);
+
+    /// Static baking: move the shapes of the given static bodies onto one compound
+    /// static body. Indices stay valid and keep reporting their original position.
+    /// Returns the number of bodies baked.
+    static int bakeStaticBodies(const std::vector<int>& indices);
+    /// Same for a static body that has no index (e.g. a world boundary)
+    static bool bakeUntrackedBody(b2BodyId body);
+    /// Index owning a shape, including shapes moved onto the baked body (-1 if none)
+    static int lookupShapeIndex(b2ShapeId shape);
+    static bool isBaked(int idx);
+
+    /// Body pool: destroyed dynamic bodies are parked (disabled) and revived by the
+    /// next create call with the same shape template instead of being reallocated.
+    /// The total number of parked bodies is capped; past the cap the parked bodies of
+    /// the least recently used template are really destroyed.
+    static void setPoolingEnabled(bool enable);
+    static void clearPool();
+    static size_t getPooledCount();
+
+    /// Shape key used by the body pool (kind + dimensions, or polygon points)
+    struct ShapeTemplate {
+        int kind;                       // 0 = circle, 1 = box, 2 = polygon
+        float a;                        // radius or half width
+        float b;                        // half height
+        std::vector<b2Vec2> points;     // polygon only
+        bool operator==(const ShapeTemplate& other) const;
+    };
+    struct ShapeTemplateHash {
+        size_t operator()(const ShapeTemplate& t) const;
+    };
+
+    /// Shapes that now live on the baked body, per original body index
+    struct BakedEntry {
+        std::vector<b2ShapeId> shapes;
+        b2Vec2 position;
+    };
+
+    /// Index tables matching a world snapshot. Templates are append-only until the
+    /// world is destroyed, so their ids stay valid and they are not part of it.
+    struct Snapshot {
+        std::vector<b2BodyId> bodies;
+        std::vector<std::vector<b2BodyId>> pool;
+        std::unordered_map<int, int> bodyTemplate;
+        b2BodyId bakedBody{ b2_nullBodyId };
+        std::unordered_map<int, BakedEntry> baked;
+        std::unordered_map<int32_t, int> bakedShapeIndex;
+    };
+    static void saveSnapshot(Snapshot& out);
+    static void restoreSnapshot(const Snapshot& snap);
 
     static std::vector<b2BodyId> bodies_;
+
+private:
+    static b2BodyId getBakedBody();
+    static bool moveShapesToBakedBody(b2BodyId body, std::vector<b2ShapeId>& moved);
+
+    static b2BodyId bakedBody_;
+    static std::unordered_map<int, BakedEntry> baked_;                      // body idx -> entry
+    static std::unordered_map<int32_t, int> bakedShapeIndex_;               // shape index1 -> idx
+
+    static int internTemplate(const ShapeTemplate& tpl);
+    static int reviveFromPool(int templateId, float x, float y,
+                              float density, float friction, float restitution);
+    static int storePooledBody(b2BodyId body, int templateId);
+    static bool evictLeastRecentlyUsed(int keepTemplateId);
+
+    static bool poolingEnabled_;
+    static std::vector<ShapeTemplate> templates_;                           // id -> template
+    static std::unordered_map<ShapeTemplate, int, ShapeTemplateHash> templateIds_;
+    static std::vector<std::vector<b2BodyId>> pool_;                        // id -> parked bodies
+    static std::vector<uint64_t> templateLastUse_;                          // id -> use stamp
+    static uint64_t useClock_;
+    static size_t parkedCount_;                                             // sum over pool_
+    static std::unordered_map<int, int> bodyTemplate_;                      // body idx -> id
 };
 
 #endif // BODYFACTORY_H
\ No newline at end of file
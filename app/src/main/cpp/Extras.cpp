@@ -262,8 +262,8 @@ void Extras_ProcessCollisions() {
 
     for (int i = 0; i < ev.beginCount; ++i) {
         auto* e = &ev.beginEvents[i];
-        int idxA = BodyFactory::lookupIndex(b2Shape_GetBody(e->shapeIdA));
-        int idxB = BodyFactory::lookupIndex(b2Shape_GetBody(e->shapeIdB));
+        int idxA = BodyFactory::lookupShapeIndex(e->shapeIdA);
+        int idxB = BodyFactory::lookupShapeIndex(e->shapeIdB);
         if (idxA < 0 || idxB < 0) continue;
 
         EntityType typeA = g_types[idxA];
@@ -303,6 +303,78 @@ void Extras_ProcessCollisions() {
     }
 }
 
+// -- STATIC BAKING -----------------------------------------------------------
+
+int Extras_BakeStaticGeometry() {
+    auto& world = PhysicsWorld::instance();
+    if (B2_IS_NULL(world.getWorldId())) return 0;
+
+    // Only STATIC_OBSTACLE entities are never destroyed by gameplay; static
+    // targets and sources keep their own bodies.
+    std::vector<int> indices;
+    int count = (int)BodyFactory::getBodyCount();
+    for (int idx = 0; idx < count && idx < g_capacity; ++idx) {
+        if (g_types[idx] != STATIC_OBSTACLE) continue;
+        b2BodyId body = BodyFactory::getBodyId(idx);
+        if (B2_IS_NULL(body) || b2Body_GetType(body) != b2_staticBody) continue;
+        indices.push_back(idx);
+    }
+
+    int baked = BodyFactory::bakeStaticBodies(indices);
+    world.bakeBoundaries();
+    b2World_RebuildStaticTree(world.getWorldId());
+    return baked;
+}
+
+// -- SNAPSHOT ----------------------------------------------------------------
+
+struct ExtrasSnapshot {
+    bool valid = false;
+    PhysicsWorld::Snapshot world;
+    BodyFactory::Snapshot factory;
+    std::vector<EntityType> types;
+    std::vector<bool> hadContact;
+    std::vector<int> scoreValues;
+    int score = 0;
+};
+static ExtrasSnapshot g_snapshot;
+
+int Extras_SaveSnapshot() {
+    g_snapshot.valid = PhysicsWorld::instance().saveSnapshot(g_snapshot.world);
+    if (!g_snapshot.valid) return 0;
+
+    BodyFactory::saveSnapshot(g_snapshot.factory);
+    g_snapshot.types.assign(g_types, g_types + g_capacity);
+    g_snapshot.hadContact  = g_hadContact;
+    g_snapshot.scoreValues = g_scoreValues;
+    g_snapshot.score       = g_score;
+    return (int)g_snapshot.world.world.size();
+}
+
+bool Extras_RestoreSnapshot() {
+    if (!g_snapshot.valid) return false;
+    if (!PhysicsWorld::instance().restoreSnapshot(g_snapshot.world)) return false;
+
+    BodyFactory::restoreSnapshot(g_snapshot.factory);
+
+    // Entity tables never shrink, so the saved ones always fit
+    int count = (int)g_snapshot.types.size();
+    if (count > 0) ensureCapacity(count - 1);
+    std::copy(g_snapshot.types.begin(), g_snapshot.types.end(), g_types);
+    std::fill(g_types + count, g_types + g_capacity, OBSTACLE);
+    std::copy(g_snapshot.hadContact.begin(), g_snapshot.hadContact.end(), g_hadContact.begin());
+    std::fill(g_hadContact.begin() + count, g_hadContact.end(), false);
+    std::copy(g_snapshot.scoreValues.begin(), g_snapshot.scoreValues.end(), g_scoreValues.begin());
+    std::fill(g_scoreValues.begin() + count, g_scoreValues.end(), 1);
+    g_score = g_snapshot.score;
+    g_toDestroy.clear();
+    return true;
+}
+
+void Extras_ClearSnapshot() {
+    g_snapshot = ExtrasSnapshot();
+}
+
 bool Extras_HadContact(int idx) {
     if (idx < 0 || idx >= g_capacity) return false;
     return g_hadContact[idx];
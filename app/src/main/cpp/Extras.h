@@ -102,6 +102,17 @@ int Extras_CreateStaticObstaclePolygon(const std::vector<b2Vec2>& pts,
 // Process collisions and destroy targets/static obstacles
 void Extras_ProcessCollisions();
 
+// Merge all static obstacles and the world boundaries into one static body and
+// rebuild the static tree. Call once the level is built; returns bodies merged.
+int Extras_BakeStaticGeometry();
+
+// Level restart: keep a copy of the whole world plus the factory and entity tables
+// in native memory, and roll back to it in one call. Returns the world blob size.
+int Extras_SaveSnapshot();
+// False if there is no snapshot or the world was re-created since it was taken
+bool Extras_RestoreSnapshot();
+void Extras_ClearSnapshot();
+
 int Extras_GetScore();
 void Extras_ResetScore();
 bool Extras_HadContact(int idx);
@@ -0,0 +1,80 @@
+#include "GeometryCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Static storage
+bool GeometryCache::enabled_ = true;
+size_t GeometryCache::hits_ = 0;
+size_t GeometryCache::misses_ = 0;
+std::unordered_map<GeometryCache::Key, b2Polygon, GeometryCache::KeyHash> GeometryCache::polygons_;
+
+bool GeometryCache::Key::operator==(const Key& other) const {
+    if (points.size() != other.points.size()) return false;
+    return std::memcmp(points.data(), other.points.data(),
+                       points.size() * sizeof(b2Vec2)) == 0;
+}
+
+// FNV-1a over the raw float bits of the sorted points
+size_t GeometryCache::KeyHash::operator()(const Key& k) const {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(k.points.data());
+    size_t count = k.points.size() * sizeof(b2Vec2);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < count; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return (size_t)h;
+}
+
+GeometryCache::Key GeometryCache::normalize(const std::vector<b2Vec2>& points) {
+    Key key{ points };
+    for (b2Vec2& p : key.points) {
+        // -0.0f and 0.0f must hash the same
+        if (p.x == 0.0f) p.x = 0.0f;
+        if (p.y == 0.0f) p.y = 0.0f;
+    }
+    std::sort(key.points.begin(), key.points.end(), [](const b2Vec2& l, const b2Vec2& r) {
+        return l.x < r.x || (l.x == r.x && l.y < r.y);
+    });
+    return key;
+}
+
+// Uncached path: hull + polygon, exactly what BodyFactory used to do inline
+bool GeometryCache::computePolygon(const std::vector<b2Vec2>& points, b2Polygon& out) {
+    if (points.size() < 3 || points.size() > B2_MAX_POLYGON_VERTICES) return false;
+    b2Hull hull = b2ComputeHull(points.data(), int(points.size()));
+    if (hull.count == 0) return false;
+    out = b2MakePolygon(&hull, /*radius=*/0.0f);
+    return true;
+}
+
+bool GeometryCache::getPolygon(const std::vector<b2Vec2>& points, b2Polygon& out) {
+    if (!enabled_) return computePolygon(points, out);
+
+    Key key = normalize(points);
+    auto it = polygons_.find(key);
+    if (it != polygons_.end()) {
+        ++hits_;
+        out = it->second;
+        return true;
+    }
+
+    ++misses_;
+    // Hull from the sorted points so every permutation yields the same polygon
+    if (!computePolygon(key.points, out)) return false;
+    polygons_.emplace(std::move(key), out);
+    return true;
+}
+
+void GeometryCache::clear() {
+    polygons_.clear();
+    hits_ = 0;
+    misses_ = 0;
+}
+
+void GeometryCache::setEnabled(bool enable) { enabled_ = enable; }
+bool GeometryCache::isEnabled() { return enabled_; }
+size_t GeometryCache::size() { return polygons_.size(); }
+size_t GeometryCache::getHitCount() { return hits_; }
+size_t GeometryCache::getMissCount() { return misses_; }
@@ -0,0 +1,47 @@
+#ifndef GEOMETRYCACHE_H
+#define GEOMETRYCACHE_H
+
+#include <vector>
+#include <unordered_map>
+#include <box2d/box2d.h>
+
+class GeometryCache {
+public:
+    /// Look up (or compute and store) the polygon for a point list.
+    /// Returns false when the points do not form a valid convex hull.
+    static bool getPolygon(const std::vector<b2Vec2>& points, b2Polygon& out);
+
+    /// Drop every cached shape
+    static void clear();
+
+    /// Turn caching on/off (off = always run b2ComputeHull, used for benchmarks)
+    static void setEnabled(bool enable);
+    static bool isEnabled();
+
+    /// Number of distinct point sets cached
+    static size_t size();
+
+    /// Lookup statistics since the last clear()
+    static size_t getHitCount();
+    static size_t getMissCount();
+
+private:
+    /// Point set sorted lexicographically so permutations share one entry
+    struct Key {
+        std::vector<b2Vec2> points;
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const;
+    };
+
+    static Key normalize(const std::vector<b2Vec2>& points);
+    static bool computePolygon(const std::vector<b2Vec2>& points, b2Polygon& out);
+
+    static bool enabled_;
+    static size_t hits_;
+    static size_t misses_;
+    static std::unordered_map<Key, b2Polygon, KeyHash> polygons_;
+};
+
+#endif // GEOMETRYCACHE_H
@@ -0,0 +1,185 @@
+#include "InputRecorder.h"
+#include "PhysicsWorld.h"
+#include "BodyFactory.h"
+#include "Extras.h"
+#include <box2d/box2d.h>
+#include <cstdio>
+#include <cstring>
+
+bool InputRecorder::recording_ = false;
+uint32_t InputRecorder::stepIndex_ = 0;
+uint64_t InputRecorder::finalHash_ = 0;
+std::vector<InputEvent> InputRecorder::events_;
+
+// Trace header; bump the version when InputEvent or the op list changes
+static constexpr uint32_t kTraceMagic   = 0x54524947;   // "GIRT"
+static constexpr uint32_t kTraceVersion = 1;
+
+struct TraceHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t eventCount;
+    uint32_t eventSize;
+    uint64_t finalHash;
+};
+
+void InputRecorder::start() {
+    events_.clear();
+    stepIndex_ = 0;
+    finalHash_ = 0;
+    recording_ = true;
+}
+
+void InputRecorder::stop() {
+    if (!recording_) return;
+    recording_ = false;
+    finalHash_ = hashWorld();
+}
+
+bool InputRecorder::isRecording() {
+    return recording_;
+}
+
+void InputRecorder::record(InputOp op, int32_t i0, int32_t i1,
+                           float f0, float f1, float f2, float f3,
+                           float f4, float f5, float f6, float f7) {
+    if (!recording_) return;
+
+    InputEvent e{};
+    e.step = stepIndex_;
+    e.op   = op;
+    e.i[0] = i0;
+    e.i[1] = i1;
+    const float f[8] = { f0, f1, f2, f3, f4, f5, f6, f7 };
+    std::memcpy(e.f, f, sizeof(f));
+    events_.push_back(e);
+
+    if (op == INPUT_STEP || op == INPUT_STEP_COLLISIONS) ++stepIndex_;
+}
+
+const std::vector<InputEvent>& InputRecorder::getEvents() {
+    return events_;
+}
+
+uint64_t InputRecorder::getFinalHash() {
+    return finalHash_;
+}
+
+bool InputRecorder::save(const char* path) {
+    FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+
+    TraceHeader header{ kTraceMagic, kTraceVersion, (uint32_t)events_.size(),
+                        (uint32_t)sizeof(InputEvent), finalHash_ };
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !events_.empty()) {
+        ok = std::fwrite(events_.data(), sizeof(InputEvent), events_.size(), file) == events_.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool InputRecorder::load(const char* path, std::vector<InputEvent>& events, uint64_t& finalHash) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+
+    TraceHeader header{};
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == kTraceMagic &&
+              header.version == kTraceVersion &&
+              header.eventSize == sizeof(InputEvent);
+    if (ok) {
+        events.resize(header.eventCount);
+        ok = header.eventCount == 0 ||
+             std::fread(events.data(), sizeof(InputEvent), header.eventCount, file) == header.eventCount;
+        finalHash = header.finalHash;
+    }
+    std::fclose(file);
+    return ok;
+}
+
+// Mirrors what the JNI entry points do for each op
+void InputRecorder::apply(const InputEvent& e) {
+    auto& world = PhysicsWorld::instance();
+    const float* f = e.f;
+    int idx = e.i[0];
+
+    switch (e.op) {
+        case INPUT_INIT_WORLD:
+            world.init(f[0], f[1]);
+            world.addGround(0.0f, 200.0f, 0.0f, 0.5f);
+            break;
+        case INPUT_DESTROY_WORLD:
+            world.destroy();
+            BodyFactory::clearBodies();
+            Extras_ClearSnapshot();
+            break;
+        case INPUT_STEP:              world.step(f[0]); break;
+        case INPUT_STEP_COLLISIONS:   world.stepPlusCollisons(f[0]); break;
+        case INPUT_SET_GRAVITY:       b2World_SetGravity(world.getWorldId(), { f[0], f[1] }); break;
+        case INPUT_ADD_GROUND:        world.addGround(f[0], f[1], f[2], f[3]); break;
+        case INPUT_ADD_ROOF:          world.addRoof(f[0], f[1], f[2], f[3]); break;
+        case INPUT_ADD_LEFT_WALL:     world.addLeftWall(f[0], f[1], f[2], f[3]); break;
+        case INPUT_ADD_RIGHT_WALL:    world.addRightWall(f[0], f[1], f[2], f[3]); break;
+        case INPUT_CREATE_ENTITY: {
+            auto shape = static_cast<ShapeType>(e.i[1]);
+            int score = (int)f[7];
+            switch (e.i[0]) {
+                case INPUT_DYNAMIC_SOURCE:   Extras_CreateDynamicSource(shape, f[0], f[1], f[2], f[3], f[4], f[5], f[6]); break;
+                case INPUT_STATIC_SOURCE:    Extras_CreateStaticSource(shape, f[0], f[1], f[2], f[3], f[4], f[5], f[6]); break;
+                case INPUT_DYNAMIC_TARGET:   Extras_CreateDynamicTarget(shape, f[0], f[1], f[2], f[3], f[4], f[5], f[6], score); break;
+                case INPUT_STATIC_TARGET:    Extras_CreateStaticTarget(shape, f[0], f[1], f[2], f[3], f[4], f[5], f[6], score); break;
+                case INPUT_DYNAMIC_OBSTACLE: Extras_CreateDynamicObstacle(shape, f[0], f[1], f[2], f[3], f[4], f[5], f[6]); break;
+                case INPUT_STATIC_OBSTACLE:  Extras_CreateStaticObstacle(shape, f[0], f[1], f[2], f[3], f[4], f[5], f[6]); break;
+                default: break;
+            }
+            break;
+        }
+        case INPUT_DESTROY_BODY:      BodyFactory::destroyBody(idx); break;
+        case INPUT_REPLACE_BODY:      BodyFactory::replaceBody(idx, f[0], f[1]); break;
+        case INPUT_SET_BOUNCING:      BodyFactory::setBouncing(idx, e.i[1] != 0); break;
+        case INPUT_SET_VELOCITY:      BodyFactory::setVelocity(idx, f[0], f[1]); break;
+        case INPUT_SET_ACCELERATION:  BodyFactory::setAcceleration(idx, f[0], f[1]); break;
+        case INPUT_TELEPORT_AND_STOP:
+            BodyFactory::setVelocity(idx, 0.0f, 0.0f);
+            BodyFactory::replaceBody(idx, f[0], f[1]);
+            break;
+        case INPUT_SET_GRAVITY_SCALE: BodyFactory::setGravityScale(idx, f[0]); break;
+        case INPUT_PROCESS_COLLISIONS: Extras_ProcessCollisions(); break;
+        case INPUT_RESET_SCORE:       Extras_ResetScore(); break;
+        case INPUT_CLEAR_CONTACTS:    Extras_ClearContacts(); break;
+        case INPUT_SET_POOLING:       BodyFactory::setPoolingEnabled(idx != 0); break;
+        case INPUT_BAKE_STATIC:       Extras_BakeStaticGeometry(); break;
+        case INPUT_SAVE_SNAPSHOT:     Extras_SaveSnapshot(); break;
+        case INPUT_RESTORE_SNAPSHOT:  Extras_RestoreSnapshot(); break;
+        default: break;
+    }
+}
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t k = 0; k < size; ++k) {
+        hash ^= bytes[k];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t InputRecorder::hashWorld() {
+    uint64_t hash = 14695981039346656037ull;
+    size_t count = BodyFactory::getBodyCount();
+    for (size_t idx = 0; idx < count; ++idx) {
+        b2BodyId body = BodyFactory::getBodyId((int)idx);
+        if (B2_IS_NULL(body) || !b2Body_IsValid(body)) continue;
+
+        b2Transform xf = b2Body_GetTransform(body);
+        b2Vec2 v = b2Body_GetLinearVelocity(body);
+        float w = b2Body_GetAngularVelocity(body);
+        uint32_t index = (uint32_t)idx;
+        hash = fnv1a(hash, &index, sizeof(index));
+        hash = fnv1a(hash, &xf, sizeof(xf));
+        hash = fnv1a(hash, &v, sizeof(v));
+        hash = fnv1a(hash, &w, sizeof(w));
+    }
+    int score = Extras_GetScore();
+    return fnv1a(hash, &score, sizeof(score));
+}
@@ -0,0 +1,85 @@
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+#include <cstdint>
+#include <vector>
+
+/// Every state-changing call that reaches the native layer from Kotlin
+enum InputOp : uint16_t {
+    INPUT_INIT_WORLD,           // f: gx, gy
+    INPUT_DESTROY_WORLD,
+    INPUT_STEP,                 // f: dt
+    INPUT_STEP_COLLISIONS,      // f: dt (stepWorldPlusCollisions / stepAndGetRemoved)
+    INPUT_SET_GRAVITY,          // f: gx, gy
+    INPUT_ADD_GROUND,           // f: y, length, restitution, friction
+    INPUT_ADD_ROOF,             // f: y, length, restitution, friction
+    INPUT_ADD_LEFT_WALL,        // f: x, height, restitution, friction
+    INPUT_ADD_RIGHT_WALL,       // f: x, height, restitution, friction
+    INPUT_CREATE_ENTITY,        // i: entity kind, shape; f: x, y, a, b, density, friction, restitution, score
+    INPUT_DESTROY_BODY,         // i: idx
+    INPUT_REPLACE_BODY,         // i: idx; f: x, y
+    INPUT_SET_BOUNCING,         // i: idx, enable
+    INPUT_SET_VELOCITY,         // i: idx; f: vx, vy
+    INPUT_SET_ACCELERATION,     // i: idx; f: ax, ay
+    INPUT_TELEPORT_AND_STOP,    // i: idx; f: x, y
+    INPUT_SET_GRAVITY_SCALE,    // i: idx; f: scale
+    INPUT_PROCESS_COLLISIONS,
+    INPUT_RESET_SCORE,
+    INPUT_CLEAR_CONTACTS,
+    INPUT_SET_POOLING,          // i: enable
+    INPUT_BAKE_STATIC,
+    INPUT_SAVE_SNAPSHOT,
+    INPUT_RESTORE_SNAPSHOT,
+    INPUT_OP_COUNT
+};
+
+/// Entity kinds for INPUT_CREATE_ENTITY, matching the Extras_Create* functions
+enum InputEntityKind : int32_t {
+    INPUT_DYNAMIC_SOURCE, INPUT_STATIC_SOURCE,
+    INPUT_DYNAMIC_TARGET, INPUT_STATIC_TARGET,
+    INPUT_DYNAMIC_OBSTACLE, INPUT_STATIC_OBSTACLE
+};
+
+/// One recorded call, tagged with the number of steps taken before it
+struct InputEvent {
+    uint32_t step;
+    uint16_t op;
+    uint16_t reserved;
+    int32_t  i[2];
+    float    f[8];
+};
+
+class InputRecorder {
+public:
+    /// Start a new recording (drops any previous one)
+    static void start();
+    /// Stop recording and remember the world hash the session ended with
+    static void stop();
+    static bool isRecording();
+
+    /// Append a call; no-op unless recording
+    static void record(InputOp op, int32_t i0 = 0, int32_t i1 = 0,
+                       float f0 = 0, float f1 = 0, float f2 = 0, float f3 = 0,
+                       float f4 = 0, float f5 = 0, float f6 = 0, float f7 = 0);
+
+    static const std::vector<InputEvent>& getEvents();
+    static uint64_t getFinalHash();
+
+    /// Trace file: header + raw events. Same-endianness only.
+    static bool save(const char* path);
+    static bool load(const char* path, std::vector<InputEvent>& events, uint64_t& finalHash);
+
+    /// Re-issue a recorded call against PhysicsWorld/BodyFactory/Extras
+    static void apply(const InputEvent& e);
+
+    /// FNV-1a over transforms and velocities of every tracked body plus the score
+    static uint64_t hashWorld();
+
+private:
+    static bool recording_;
+    static uint32_t stepIndex_;
+    static uint64_t finalHash_;
+    static std::vector<InputEvent> events_;
+};
+
+#endif // INPUTRECORDER_H
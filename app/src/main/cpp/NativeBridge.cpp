@@ -4,12 +4,14 @@
 #include "PhysicsWorld.h"
 #include "BodyFactory.h"
 #include "Extras.h"
+#include "InputRecorder.h"
 #include <box2d/box2d.h>
 
 extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_initWorld(
         JNIEnv*, jobject, jfloat gx, jfloat gy)
 {
+    InputRecorder::record(INPUT_INIT_WORLD, 0, 0, gx, gy);
     PhysicsWorld::instance().init(gx, gy);
     PhysicsWorld::instance().addGround(0.0f, 200.0f, 0.0f, 0.5f);
 }
@@ -18,6 +20,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_stepWorld(
         JNIEnv*, jobject, jfloat dt)
 {
+    InputRecorder::record(INPUT_STEP, 0, 0, dt);
     PhysicsWorld::instance().step(dt);
 }
 
@@ -25,16 +28,14 @@ extern "C" JNIEXPORT jfloat JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_getBodyX(
         JNIEnv*, jobject, jint idx)
 {
-    b2BodyId id = BodyFactory::getBodyId(idx);
-    return B2_IS_NULL(id) ? 0.0f : b2Body_GetPosition(id).x;
+    return BodyFactory::getBodyPosition(idx).x;
 }
 
 extern "C" JNIEXPORT jfloat JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_getBodyY(
         JNIEnv*, jobject, jint idx)
 {
-    b2BodyId id = BodyFactory::getBodyId(idx);
-    return B2_IS_NULL(id) ? 0.0f : b2Body_GetPosition(id).y;
+    return BodyFactory::getBodyPosition(idx).y;
 }
 
 extern "C" JNIEXPORT jfloat JNICALL
@@ -67,6 +68,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_destroyBody(
         JNIEnv*, jobject, jint idx)
 {
+    InputRecorder::record(INPUT_DESTROY_BODY, idx);
     BodyFactory::destroyBody(idx);
 }
 
@@ -74,6 +76,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_replaceBody(
         JNIEnv*, jobject, jint idx, jfloat x, jfloat y)
 {
+    InputRecorder::record(INPUT_REPLACE_BODY, idx, 0, x, y);
     BodyFactory::replaceBody(idx, x, y);
 }
 
@@ -81,6 +84,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setBouncing(
         JNIEnv*, jobject, jint idx, jboolean en)
 {
+    InputRecorder::record(INPUT_SET_BOUNCING, idx, en ? 1 : 0);
     BodyFactory::setBouncing(idx, en);
 }
 
@@ -88,6 +92,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setVelocity(
         JNIEnv*, jobject, jint idx, jfloat vx, jfloat vy)
 {
+    InputRecorder::record(INPUT_SET_VELOCITY, idx, 0, vx, vy);
     BodyFactory::setVelocity(idx, vx, vy);
 }
 
@@ -95,6 +100,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setAcceleration(
         JNIEnv*, jobject, jint idx, jfloat ax, jfloat ay)
 {
+    InputRecorder::record(INPUT_SET_ACCELERATION, idx, 0, ax, ay);
     BodyFactory::setAcceleration(idx, ax, ay);
 }
 
@@ -103,6 +109,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_addGround(
         JNIEnv*, jobject, jfloat y, jfloat length, jfloat re, jfloat f)
 {
+    InputRecorder::record(INPUT_ADD_GROUND, 0, 0, y, length, re, f);
     PhysicsWorld::instance().addGround(y, length, re, f);
 }
 
@@ -110,6 +117,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_addRoof(
         JNIEnv*, jobject, jfloat y, jfloat length, jfloat re, jfloat f)
 {
+    InputRecorder::record(INPUT_ADD_ROOF, 0, 0, y, length, re, f);
     PhysicsWorld::instance().addRoof(y, length, re, f);
 }
 
@@ -117,6 +125,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_addLeftWall(
         JNIEnv*, jobject, jfloat x, jfloat h, jfloat re, jfloat f)
 {
+    InputRecorder::record(INPUT_ADD_LEFT_WALL, 0, 0, x, h, re, f);
     PhysicsWorld::instance().addLeftWall(x, h, re, f);
 }
 
@@ -124,6 +133,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_addRightWall(
         JNIEnv*, jobject, jfloat x, jfloat h, jfloat re, jfloat f)
 {
+    InputRecorder::record(INPUT_ADD_RIGHT_WALL, 0, 0, x, h, re, f);
     PhysicsWorld::instance().addRightWall(x, h, re, f);
 }
 
@@ -132,14 +142,17 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_destroyWorld(
         JNIEnv*, jobject)
 {
+    InputRecorder::record(INPUT_DESTROY_WORLD);
     PhysicsWorld::instance().destroy();
     BodyFactory::clearBodies();
+    Extras_ClearSnapshot();
 }
 
 extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setGravity(
         JNIEnv*, jobject, jfloat gx, jfloat gy)
 {
+    InputRecorder::record(INPUT_SET_GRAVITY, 0, 0, gx, gy);
     b2World_SetGravity(PhysicsWorld::instance().getWorldId(), { gx, gy });
 }
 
@@ -151,6 +164,8 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_createDyn
         jfloat a, jfloat b,
         jfloat density, jfloat friction, jfloat restitution)
 {
+    InputRecorder::record(INPUT_CREATE_ENTITY, INPUT_DYNAMIC_SOURCE, shapeType,
+                          x, y, a, b, density, friction, restitution);
     return Extras_CreateDynamicSource(
             static_cast<ShapeType>(shapeType),
             x, y, a, b,
@@ -164,6 +179,8 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_createSta
         jfloat a, jfloat b,
         jfloat density, jfloat friction, jfloat restitution)
 {
+    InputRecorder::record(INPUT_CREATE_ENTITY, INPUT_STATIC_SOURCE, shapeType,
+                          x, y, a, b, density, friction, restitution);
     return Extras_CreateStaticSource(
             static_cast<ShapeType>(shapeType),
             x, y, a, b,
@@ -177,6 +194,8 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_createDyn
         jfloat a, jfloat b,
         jfloat density, jfloat friction, jfloat restitution,jint scoreValue)
 {
+    InputRecorder::record(INPUT_CREATE_ENTITY, INPUT_DYNAMIC_TARGET, shapeType,
+                          x, y, a, b, density, friction, restitution, (float)scoreValue);
     return Extras_CreateDynamicTarget(
             static_cast<ShapeType>(shapeType),
             x, y, a, b,
@@ -190,6 +209,8 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_createSta
         jfloat a, jfloat b,
         jfloat density, jfloat friction, jfloat restitution,jint scoreValue)
 {
+    InputRecorder::record(INPUT_CREATE_ENTITY, INPUT_STATIC_TARGET, shapeType,
+                          x, y, a, b, density, friction, restitution, (float)scoreValue);
     return Extras_CreateStaticTarget(
             static_cast<ShapeType>(shapeType),
             x, y, a, b,
@@ -203,6 +224,8 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_createDyn
         jfloat a, jfloat b,
         jfloat density, jfloat friction, jfloat restitution)
 {
+    InputRecorder::record(INPUT_CREATE_ENTITY, INPUT_DYNAMIC_OBSTACLE, shapeType,
+                          x, y, a, b, density, friction, restitution);
     return Extras_CreateDynamicObstacle(
             static_cast<ShapeType>(shapeType),
             x, y, a, b,
@@ -216,6 +239,8 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_createSta
         jfloat a, jfloat b,
         jfloat density, jfloat friction, jfloat restitution)
 {
+    InputRecorder::record(INPUT_CREATE_ENTITY, INPUT_STATIC_OBSTACLE, shapeType,
+                          x, y, a, b, density, friction, restitution);
     return Extras_CreateStaticObstacle(
             static_cast<ShapeType>(shapeType),
             x, y, a, b,
@@ -227,6 +252,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_processCollisions(
         JNIEnv*, jobject)
 {
+    InputRecorder::record(INPUT_PROCESS_COLLISIONS);
     Extras_ProcessCollisions();
 }
 
@@ -285,18 +311,21 @@ extern "C"
 JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_resetScore(JNIEnv *env,
                                                                                   jobject ) {
+    InputRecorder::record(INPUT_RESET_SCORE);
     Extras_ResetScore();
 }
 extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_stepWorldPlusCollisions(
         JNIEnv*, jobject, jfloat dt)
 {
+    InputRecorder::record(INPUT_STEP_COLLISIONS, 0, 0, dt);
     PhysicsWorld::instance().stepPlusCollisons(dt);
 }
 extern "C" JNIEXPORT jintArray JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_stepAndGetRemoved(
         JNIEnv* env, jobject, jfloat dt)
 {
+    InputRecorder::record(INPUT_STEP_COLLISIONS, 0, 0, dt);
     // 1) step + process collisions
     PhysicsWorld::instance().stepPlusCollisons(dt);
     // 2) fetch the list we built
@@ -309,10 +338,7 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_stepAndGe
 extern "C" JNIEXPORT jfloatArray JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_getBodyPosition(
         JNIEnv* env, jobject /* self */, jint idx) {
-    b2BodyId id = BodyFactory::getBodyId(idx);
-    b2Vec2 pos = B2_IS_NULL(id)
-                 ? b2Vec2{0,0}
-                 : b2Body_GetPosition(id);
+    b2Vec2 pos = BodyFactory::getBodyPosition(idx);
     jfloat arr[2] = { pos.x, pos.y };
     jfloatArray out = env->NewFloatArray(2);
     env->SetFloatArrayRegion(out, 0, 2, arr);  // Create and fill array  [oai_citation:0‡stackoverflow.com](https://stackoverflow.com/questions/25011597/convert-float-to-jfloatarray-using-jni/25012075?utm_source=chatgpt.com)
@@ -322,6 +348,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_teleportAndStop(
         JNIEnv* env, jobject /* this */,
         jint idx, jfloat x, jfloat y) {
+    InputRecorder::record(INPUT_TELEPORT_AND_STOP, idx, 0, x, y);
     // First, zero velocity
     BodyFactory::setVelocity(idx, 0.0f, 0.0f);
     // Then, teleport body
@@ -332,6 +359,7 @@ Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setGravit
         JNIEnv* /*env*/, jobject /*self*/,
         jint idx, jfloat scale)
 {
+    InputRecorder::record(INPUT_SET_GRAVITY_SCALE, idx, 0, scale);
     // Calls your BodyFactory helper
     BodyFactory::setGravityScale(idx, scale);
 }
@@ -346,5 +374,57 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_extrasClearContacts(
         JNIEnv*, jobject)
 {
+    InputRecorder::record(INPUT_CLEAR_CONTACTS);
     Extras_ClearContacts();
-}
\ No newline at end of file
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setBodyPooling(
+        JNIEnv*, jobject, jboolean enable)
+{
+    InputRecorder::record(INPUT_SET_POOLING, enable ? 1 : 0);
+    BodyFactory::setPoolingEnabled(enable);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_bakeStaticGeometry(
+        JNIEnv*, jobject)
+{
+    InputRecorder::record(INPUT_BAKE_STATIC);
+    return Extras_BakeStaticGeometry();
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_saveSnapshot(
+        JNIEnv*, jobject)
+{
+    InputRecorder::record(INPUT_SAVE_SNAPSHOT);
+    return Extras_SaveSnapshot();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_restoreSnapshot(
+        JNIEnv*, jobject)
+{
+    InputRecorder::record(INPUT_RESTORE_SNAPSHOT);
+    return Extras_RestoreSnapshot() ? JNI_TRUE : JNI_FALSE;
+}
+
+// Input recording for the desktop replay tool (host/input_replay)
+extern "C" JNIEXPORT void JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_startInputRecording(
+        JNIEnv*, jobject)
+{
+    InputRecorder::start();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_stopInputRecording(
+        JNIEnv* env, jobject, jstring path)
+{
+    InputRecorder::stop();
+    const char* cpath = env->GetStringUTFChars(path, nullptr);
+    bool ok = InputRecorder::save(cpath);
+    env->ReleaseStringUTFChars(path, cpath);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
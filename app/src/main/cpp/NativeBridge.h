@@ -170,6 +170,34 @@ JNIEXPORT void JNICALL
 Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_extrasClearContacts(
         JNIEnv*, jobject);
 
+// Body pool toggle (parks destroyed dynamic bodies for reuse)
+JNIEXPORT void JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_setBodyPooling(
+        JNIEnv*, jobject, jboolean enable);
+
+// Merge static obstacles + boundaries into one static body after level load
+JNIEXPORT jint JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_bakeStaticGeometry(
+        JNIEnv*, jobject);
+
+// Level restart snapshot (world + factory/entity tables, kept natively)
+JNIEXPORT jint JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_saveSnapshot(
+        JNIEnv*, jobject);
+
+JNIEXPORT jboolean JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_restoreSnapshot(
+        JNIEnv*, jobject);
+
+// Input recording: log every state-changing call, then write the trace to path
+JNIEXPORT void JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_startInputRecording(
+        JNIEnv*, jobject);
+
+JNIEXPORT jboolean JNICALL
+Java_com_aviadkorakin_demonstrate_12d_1physics_Box2DEngineNativeBridge_stopInputRecording(
+        JNIEnv*, jobject, jstring path);
+
 #ifdef __cplusplus
 }
 #endif
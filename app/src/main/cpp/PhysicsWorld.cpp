@@ -26,6 +26,7 @@ void PhysicsWorld::init(float gx, float gy) {
         b2DestroyWorld(worldId_);       // Destroy existing world
         BodyFactory::clearBodies();     // Remove all created bodies
     }
+    boundaries_.clear();
     b2WorldDef wdef = b2DefaultWorldDef();
     wdef.gravity = (b2Vec2){ gx, gy };  // Set gravity vector in world definition
     worldId_ = b2CreateWorld(&wdef);    // Create new Box2D world and store its ID
@@ -60,6 +61,7 @@ void PhysicsWorld::addGround(float y, float length, float restitution, float fri
     bd.type = b2_staticBody;
     bd.position = {0,0};
     b2BodyId ground = b2CreateBody(worldId_, &bd);
+    boundaries_.push_back(ground);
 
 
     b2Segment seg{};
@@ -81,6 +83,7 @@ void PhysicsWorld::addRoof(float y, float length, float restitution, float frict
     bd.type = b2_staticBody;
     bd.position = {0,0};
     b2BodyId roof = b2CreateBody(worldId_, &bd);
+    boundaries_.push_back(roof);
 
     // register it as an OBSTACLE
     int idx = BodyFactory::lookupIndex(roof);
@@ -105,6 +108,7 @@ void PhysicsWorld::addLeftWall(float x, float height, float restitution, float f
     bd.type = b2_staticBody;
     bd.position = {0,0};
     b2BodyId wall = b2CreateBody(worldId_, &bd);
+    boundaries_.push_back(wall);
 
     // register it as an OBSTACLE
     int idx = BodyFactory::lookupIndex(wall);
@@ -130,6 +134,7 @@ void PhysicsWorld::addRightWall(float x, float height, float restitution, float
     bd.type = b2_staticBody;
     bd.position = {0,0};
     b2BodyId wall = b2CreateBody(worldId_, &bd);
+    boundaries_.push_back(wall);
 
     // register it as an OBSTACLE
     int idx = BodyFactory::lookupIndex(wall);
@@ -154,7 +159,47 @@ void PhysicsWorld::destroy() {
 
         BodyFactory::clearBodies();          // <-- wipe out all stored body IDs
     }
+    boundaries_.clear();
 }
+
+// Hand every boundary body to the static baker; they have no body index of their own
+void PhysicsWorld::bakeBoundaries() {
+    for (b2BodyId body : boundaries_) {
+        if (b2Body_IsValid(body)) BodyFactory::bakeUntrackedBody(body);
+    }
+    boundaries_.clear();
+}
+// Copy the whole b2World into the snapshot; the world keeps running untouched
+bool PhysicsWorld::saveSnapshot(Snapshot& out) const {
+    if (B2_IS_NULL(worldId_)) return false;
+
+    int size = b2World_GetSnapshotSize(worldId_);
+    out.world.resize(size);
+    if (b2World_SaveSnapshot(worldId_, out.world.data(), size) != size) return false;
+
+    out.worldId    = worldId_;
+    out.boundaries = boundaries_;
+    out.groundY    = groundY_;
+    out.roofY      = roofY_;
+    out.leftX      = leftX_;
+    out.rightX     = rightX_;
+    return true;
+}
+
+bool PhysicsWorld::restoreSnapshot(const Snapshot& snap) {
+    // Body ids inside the blob carry this world's generation; a re-created world can't use them
+    if (B2_IS_NULL(worldId_) || snap.worldId.index1 != worldId_.index1 ||
+        snap.worldId.generation != worldId_.generation) return false;
+    if (!b2World_RestoreSnapshot(worldId_, snap.world.data(), (int)snap.world.size())) return false;
+
+    boundaries_ = snap.boundaries;
+    groundY_    = snap.groundY;
+    roofY_      = snap.roofY;
+    leftX_      = snap.leftX;
+    rightX_     = snap.rightX;
+    return true;
+}
+
 float PhysicsWorld::getGroundY() const { return groundY_; }
 float PhysicsWorld::getRoof()    const { return roofY_;   }
 float PhysicsWorld::getLeftX()   const { return leftX_;   }
@@ -1,6 +1,8 @@
 #ifndef PHYSICSWORLD_H
 #define PHYSICSWORLD_H
 
+#include <cstdint>
+#include <vector>
 #include <box2d/box2d.h>
 
 class PhysicsWorld {
@@ -25,6 +27,20 @@ public:
     void addLeftWall(float x, float height, float restitution, float friction);
     void addRightWall(float x, float height, float restitution, float friction);
 
+    /// Move the boundary segments onto the baked static body (see Extras_BakeStaticGeometry)
+    void bakeBoundaries();
+
+    /// Full world state plus the boundary bookkeeping (see b2World_SaveSnapshot)
+    struct Snapshot {
+        b2WorldId worldId{ b2_nullWorldId };
+        std::vector<uint8_t> world;
+        std::vector<b2BodyId> boundaries;
+        float groundY{ 0.0f }, roofY{ 0.0f }, leftX{ 0.0f }, rightX{ 0.0f };
+    };
+    bool saveSnapshot(Snapshot& out) const;
+    /// Only accepted by the same world instance it was taken from
+    bool restoreSnapshot(const Snapshot& snap);
+
     [[nodiscard]] float getGroundY() const;
     [[nodiscard]] float getLeftX() const;
     [[nodiscard]] float getRightX() const;
@@ -40,6 +56,7 @@ private:
     ~PhysicsWorld();
 
     b2WorldId worldId_;
+    std::vector<b2BodyId> boundaries_;  // ground/roof/wall bodies, until baked
 
     float groundY_{ 0.0f };
     float roofY_{ 0.0f };
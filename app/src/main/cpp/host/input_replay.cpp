@@ -0,0 +1,131 @@
+// Replays an input trace recorded on device (startInputRecording/stopInputRecording)
+// step for step and reports per-step timing and the world hash.
+//
+//   input_replay <trace> [--runs N] [--hashes]
+//
+// --runs N    replay the whole session N times and report the fastest run
+// --hashes    print the world hash after every step
+
+#include "InputRecorder.h"
+#include "PhysicsWorld.h"
+#include "BodyFactory.h"
+#include "Extras.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct ReplayResult {
+    std::vector<double> stepMs;     // time spent in each step op
+    double totalMs = 0.0;           // whole session, including creation calls
+    uint64_t finalHash = 0;
+};
+
+// Start every run from a fresh process state. Traces are expected to begin with
+// destroyWorld/initWorld, as PhysicsView.initLevel does.
+static void resetGameLayer() {
+    PhysicsWorld::instance().destroy();
+    BodyFactory::clearBodies();
+    Extras_ClearSnapshot();
+    Extras_ResetScore();
+    Extras_ClearContacts();
+}
+
+static ReplayResult replay(const std::vector<InputEvent>& events, bool printHashes) {
+    resetGameLayer();
+
+    ReplayResult result;
+    result.stepMs.reserve(events.size());
+
+    auto sessionStart = std::chrono::steady_clock::now();
+    for (const InputEvent& e : events) {
+        bool isStep = e.op == INPUT_STEP || e.op == INPUT_STEP_COLLISIONS;
+        if (!isStep) {
+            InputRecorder::apply(e);
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        InputRecorder::apply(e);
+        auto end = std::chrono::steady_clock::now();
+        result.stepMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+        if (printHashes) {
+            std::printf("step %u hash %016" PRIx64 "\n", e.step, InputRecorder::hashWorld());
+        }
+    }
+    result.totalMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - sessionStart).count();
+    result.finalHash = InputRecorder::hashWorld();
+
+    PhysicsWorld::instance().destroy();
+    return result;
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * double(values.size() - 1) + 0.5);
+    return values[index];
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <trace> [--runs N] [--hashes]\n", argv[0]);
+        return 2;
+    }
+
+    int runs = 1;
+    bool printHashes = false;
+    for (int a = 2; a < argc; ++a) {
+        if (std::strcmp(argv[a], "--runs") == 0 && a + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++a]));
+        } else if (std::strcmp(argv[a], "--hashes") == 0) {
+            printHashes = true;
+        }
+    }
+
+    std::vector<InputEvent> events;
+    uint64_t recordedHash = 0;
+    if (!InputRecorder::load(argv[1], events, recordedHash)) {
+        std::fprintf(stderr, "cannot read trace %s\n", argv[1]);
+        return 1;
+    }
+
+    // Every run must land on the same state, otherwise the timings are not comparable
+    ReplayResult best;
+    for (int r = 0; r < runs; ++r) {
+        ReplayResult result = replay(events, printHashes && r == 0);
+        if (r > 0 && result.finalHash != best.finalHash) {
+            std::fprintf(stderr, "run %d diverged: %016" PRIx64 " vs %016" PRIx64 "\n",
+                         r, result.finalHash, best.finalHash);
+            return 1;
+        }
+        if (r == 0 || result.totalMs < best.totalMs) best = result;
+    }
+
+    double stepSum = 0.0;
+    for (double ms : best.stepMs) stepSum += ms;
+    size_t steps = best.stepMs.size();
+
+    std::printf("events        %zu\n", events.size());
+    std::printf("steps         %zu\n", steps);
+    std::printf("session ms    %.3f\n", best.totalMs);
+    std::printf("step total ms %.3f\n", stepSum);
+    std::printf("step mean ms  %.4f\n", steps ? stepSum / double(steps) : 0.0);
+    std::printf("step p50 ms   %.4f\n", percentile(best.stepMs, 0.50));
+    std::printf("step p95 ms   %.4f\n", percentile(best.stepMs, 0.95));
+    std::printf("step p99 ms   %.4f\n", percentile(best.stepMs, 0.99));
+    std::printf("step max ms   %.4f\n", percentile(best.stepMs, 1.0));
+    std::printf("world hash    %016" PRIx64 "\n", best.finalHash);
+
+    // Device and desktop floating point can differ, so a mismatch is reported but not fatal
+    if (recordedHash != 0) {
+        std::printf("recorded hash %016" PRIx64 " (%s)\n", recordedHash,
+                    recordedHash == best.finalHash ? "match" : "differs");
+    }
+    return 0;
+}
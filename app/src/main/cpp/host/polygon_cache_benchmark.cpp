@@ -0,0 +1,70 @@
+// Builds a level of identical polygons with and without GeometryCache and
+// reports the time spent in level construction.
+
+#include "PhysicsWorld.h"
+#include "BodyFactory.h"
+#include "Extras.h"
+#include "GeometryCache.h"
+#include <box2d/box2d.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static constexpr int kPolygonCount = 5000;
+static constexpr int kRuns = 10;
+
+// Build one level: boundaries + a grid of static hexagons. Returns milliseconds.
+static double buildLevel(const std::vector<b2Vec2>& hexagon) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto& world = PhysicsWorld::instance();
+    world.init(0.0f, -9.8f);
+    world.addGround(0.0f, 400.0f, 0.0f, 0.5f);
+    world.addRoof(200.0f, 400.0f, 0.0f, 0.5f);
+    world.addLeftWall(-200.0f, 200.0f, 0.0f, 0.5f);
+    world.addRightWall(200.0f, 200.0f, 0.0f, 0.5f);
+
+    const int columns = 100;
+    for (int i = 0; i < kPolygonCount; ++i) {
+        float x = -150.0f + 3.0f * float(i % columns);
+        float y = 5.0f + 3.0f * float(i / columns);
+        Extras_CreateStaticObstaclePolygon(hexagon, x, y, 1.0f, 0.5f, 0.0f);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static double bestOf(const std::vector<b2Vec2>& hexagon) {
+    double best = 1e30;
+    for (int run = 0; run < kRuns; ++run) {
+        double ms = buildLevel(hexagon);
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+int main() {
+    std::vector<b2Vec2> hexagon;
+    for (int i = 0; i < 6; ++i) {
+        float angle = 2.0f * B2_PI * float(i) / 6.0f;
+        hexagon.push_back({ std::cos(angle), std::sin(angle) });
+    }
+
+    GeometryCache::setEnabled(false);
+    double uncached = bestOf(hexagon);
+
+    GeometryCache::setEnabled(true);
+    GeometryCache::clear();
+    double cached = bestOf(hexagon);
+
+    std::printf("polygons: %d, best of %d runs\n", kPolygonCount, kRuns);
+    std::printf("without cache: %8.3f ms\n", uncached);
+    std::printf("with cache:    %8.3f ms (hits %zu, misses %zu)\n",
+                cached, GeometryCache::getHitCount(), GeometryCache::getMissCount());
+
+    PhysicsWorld::instance().destroy();
+    return EXIT_SUCCESS;
+}
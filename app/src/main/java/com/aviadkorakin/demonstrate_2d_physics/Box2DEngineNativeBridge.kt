@@ -42,6 +42,8 @@ object Box2DEngineNativeBridge {
 
     /** Removal */
     external fun destroyBody(idx: Int)
+    /** Park destroyed dynamic bodies for reuse instead of freeing them (on by default) */
+    external fun setBodyPooling(enable: Boolean)
 
     /** Property setters */
     external fun replaceBody(idx: Int, x: Float, y: Float)
@@ -137,6 +139,21 @@ object Box2DEngineNativeBridge {
     /** Poll contacts and auto-destroy any TARGET hit by a SOURCE */
     external fun processCollisions()
 
+    /** Merge static obstacles and world boundaries into one static body; returns bodies merged */
+    external fun bakeStaticGeometry(): Int
+
+    /** Keep a native copy of the current world for instant restart; returns its size in bytes */
+    external fun saveSnapshot(): Int
+
+    /** Roll the world back to the last saveSnapshot(); false if none or the world was re-created */
+    external fun restoreSnapshot(): Boolean
+
+    /** Log every state-changing call from now on, for replay with host/input_replay */
+    external fun startInputRecording()
+
+    /** Stop logging and write the trace to [path]; false if it could not be written */
+    external fun stopInputRecording(path: String): Boolean
+
     /** World bounds queries */
     external fun getLeftX(): Float
     external fun getRightX(): Float
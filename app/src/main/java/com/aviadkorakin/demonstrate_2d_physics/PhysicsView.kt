@@ -300,6 +300,9 @@ class PhysicsView @JvmOverloads constructor(
         level.objects.source.let { src ->
             addSource(src.x, src.y, src.radius)
         }
+
+        // ── 7) merge all static geometry into one body for a smaller static tree
+        enqueue { Box2DEngineNativeBridge.bakeStaticGeometry() }
     }
 
     override fun surfaceChanged(holder: SurfaceHolder, format: Int, w: Int, h: Int) {}
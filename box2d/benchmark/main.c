@@ -5,6 +5,11 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
+// For clock_gettime with strict C
+#if defined( __linux__ ) && !defined( _POSIX_C_SOURCE )
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "TaskScheduler_c.h"
 #include "benchmarks.h"
 
@@ -20,8 +25,10 @@
 #if defined( _WIN64 )
 #include <windows.h>
 #elif defined( __APPLE__ )
+#include <time.h>
 #include <unistd.h>
 #elif defined( __linux__ )
+#include <time.h>
 #include <unistd.h>
 #endif
 
@@ -70,6 +77,26 @@ int GetNumberOfCores()
 #endif
 }
 
+// CPU time of all threads in the process in milliseconds. This shows the cost of spinning workers.
+double GetProcessCpuTime()
+{
+#if defined( _WIN64 )
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	GetProcessTimes( GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime );
+	ULARGE_INTEGER kernel = { .LowPart = kernelTime.dwLowDateTime, .HighPart = kernelTime.dwHighDateTime };
+	ULARGE_INTEGER user = { .LowPart = userTime.dwLowDateTime, .HighPart = userTime.dwHighDateTime };
+
+	// 100 nanosecond units
+	return 1.0e-4 * (double)( kernel.QuadPart + user.QuadPart );
+#elif defined( __APPLE__ ) || defined( __linux__ )
+	struct timespec ts;
+	clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+	return 1.0e3 * (double)ts.tv_sec + 1.0e-6 * (double)ts.tv_nsec;
+#else
+	return 0.0;
+#endif
+}
+
 void ExecuteRangeTask( uint32_t start, uint32_t end, uint32_t threadIndex, void* context )
 {
 	TaskData* data = context;
@@ -127,6 +154,228 @@ static void MinProfile( b2Profile* p1, const b2Profile* p2 )
 	p1->sleepIslands = b2MinFloat( p1->sleepIslands, p2->sleepIslands );
 }
 
+// Times full rebuilds of a dynamic tree with scattered proxies, serially and with the subtrees built as tasks
+static void RunTreeRebuildBenchmark( int maxThreadCount, int singleWorkerCount, int runCount )
+{
+	int proxyCounts[] = { 1000, 10000, 50000, 100000 };
+	int rebuildCount = 20;
+
+	printf( "benchmark: tree_rebuild, rebuilds = %d\n", rebuildCount );
+
+	FILE* file = fopen( "tree_rebuild.csv", "w" );
+	if ( file != NULL )
+	{
+		fprintf( file, "proxies,threads,serial_ms,task_ms\n" );
+	}
+
+	for ( int countIndex = 0; countIndex < ARRAY_COUNT( proxyCounts ); ++countIndex )
+	{
+		int proxyCount = proxyCounts[countIndex];
+
+		b2DynamicTree tree = b2DynamicTree_Create();
+		float extent = 2.0f * sqrtf( (float)proxyCount );
+		uint32_t seed = 1234;
+		for ( int i = 0; i < proxyCount; ++i )
+		{
+			seed = 1664525u * seed + 1013904223u;
+			float x = extent * (float)( seed >> 8 ) / (float)( 1 << 24 );
+			seed = 1664525u * seed + 1013904223u;
+			float y = extent * (float)( seed >> 8 ) / (float)( 1 << 24 );
+			b2AABB box = { { x - 0.5f, y - 0.5f }, { x + 0.5f, y + 0.5f } };
+			b2DynamicTree_CreateProxy( &tree, box, B2_DEFAULT_CATEGORY_BITS, (uint64_t)i );
+		}
+
+		for ( int threadCount = 1; threadCount <= maxThreadCount; ++threadCount )
+		{
+			if ( singleWorkerCount != -1 && singleWorkerCount != threadCount )
+			{
+				continue;
+			}
+
+			scheduler = enkiNewTaskScheduler();
+			struct enkiTaskSchedulerConfig config = enkiGetTaskSchedulerConfig( scheduler );
+			config.numTaskThreadsToCreate = threadCount - 1;
+			enkiInitTaskSchedulerWithConfig( scheduler, config );
+
+			for ( int taskIndex = 0; taskIndex < MAX_TASKS; ++taskIndex )
+			{
+				tasks[taskIndex] = enkiCreateTaskSet( scheduler, ExecuteRangeTask );
+			}
+
+			float serialTime = FLT_MAX;
+			float taskTime = FLT_MAX;
+			for ( int runIndex = 0; runIndex < runCount; ++runIndex )
+			{
+				uint64_t ticks = b2GetTicks();
+				for ( int i = 0; i < rebuildCount; ++i )
+				{
+					b2DynamicTree_Rebuild( &tree, true );
+				}
+				serialTime = b2MinFloat( serialTime, b2GetMilliseconds( ticks ) / rebuildCount );
+
+				ticks = b2GetTicks();
+				for ( int i = 0; i < rebuildCount; ++i )
+				{
+					b2DynamicTree_RebuildWithTasks( &tree, true, EnqueueTask, FinishTask, NULL );
+					taskCount = 0;
+				}
+				taskTime = b2MinFloat( taskTime, b2GetMilliseconds( ticks ) / rebuildCount );
+			}
+
+			printf( "proxies %d, threads %d : serial %g (ms), tasks %g (ms)\n", proxyCount, threadCount, serialTime,
+					taskTime );
+
+			if ( file != NULL )
+			{
+				fprintf( file, "%d,%d,%g,%g\n", proxyCount, threadCount, serialTime, taskTime );
+			}
+
+			for ( int taskIndex = 0; taskIndex < MAX_TASKS; ++taskIndex )
+			{
+				enkiDeleteTaskSet( scheduler, tasks[taskIndex] );
+				tasks[taskIndex] = NULL;
+				taskData[taskIndex] = ( TaskData ){ 0 };
+			}
+
+			enkiDeleteTaskScheduler( scheduler );
+			scheduler = NULL;
+		}
+
+		b2DynamicTree_Destroy( &tree );
+	}
+
+	if ( file != NULL )
+	{
+		fclose( file );
+	}
+
+	printf( "======================================\n" );
+}
+
+static uint32_t HashManifold( uint32_t hash, const b2Manifold* manifold )
+{
+	hash = b2Hash( hash, (const uint8_t*)&manifold->normal, sizeof( b2Vec2 ) );
+	hash = b2Hash( hash, (const uint8_t*)&manifold->pointCount, sizeof( int ) );
+	for ( int i = 0; i < manifold->pointCount; ++i )
+	{
+		const b2ManifoldPoint* mp = manifold->points + i;
+		hash = b2Hash( hash, (const uint8_t*)&mp->anchorA, sizeof( b2Vec2 ) );
+		hash = b2Hash( hash, (const uint8_t*)&mp->anchorB, sizeof( b2Vec2 ) );
+		hash = b2Hash( hash, (const uint8_t*)&mp->point, sizeof( b2Vec2 ) );
+		hash = b2Hash( hash, (const uint8_t*)&mp->separation, sizeof( float ) );
+		hash = b2Hash( hash, (const uint8_t*)&mp->id, sizeof( uint16_t ) );
+	}
+	return hash;
+}
+
+// Times b2CollidePolygons over random transforms. The manifold hash must match between builds,
+// so it shows when a change to the polygon collider alters the output.
+static void RunManifoldBenchmark( int runCount )
+{
+	enum
+	{
+		e_pairCount = 100000,
+		e_polygonCount = 64,
+	};
+
+	b2Polygon boxes[e_polygonCount];
+	b2Polygon hulls[e_polygonCount];
+	uint32_t seed = 5678;
+	for ( int i = 0; i < e_polygonCount; ++i )
+	{
+		seed = 1664525u * seed + 1013904223u;
+		float hx = 0.1f + 2.0f * (float)( seed >> 8 ) / (float)( 1 << 24 );
+		seed = 1664525u * seed + 1013904223u;
+		float hy = 0.1f + 2.0f * (float)( seed >> 8 ) / (float)( 1 << 24 );
+		boxes[i] = b2MakeBox( hx, hy );
+
+		b2Vec2 points[B2_MAX_POLYGON_VERTICES];
+		int count = 3 + i % ( B2_MAX_POLYGON_VERTICES - 2 );
+		for ( int j = 0; j < count; ++j )
+		{
+			seed = 1664525u * seed + 1013904223u;
+			float radius = 0.5f + 1.5f * (float)( seed >> 8 ) / (float)( 1 << 24 );
+			b2CosSin cs = b2ComputeCosSin( 2.0f * B2_PI * (float)j / (float)count );
+			points[j] = (b2Vec2){ radius * cs.cosine, radius * cs.sine };
+		}
+		b2Hull hull = b2ComputeHull( points, count );
+		hulls[i] = b2MakePolygon( &hull, 0.0f );
+	}
+
+	b2Transform* transforms = malloc( 2 * e_pairCount * sizeof( b2Transform ) );
+	for ( int i = 0; i < e_pairCount; ++i )
+	{
+		seed = 1664525u * seed + 1013904223u;
+		float angleA = B2_PI * ( 2.0f * (float)( seed >> 8 ) / (float)( 1 << 24 ) - 1.0f );
+		seed = 1664525u * seed + 1013904223u;
+		float angleB = B2_PI * ( 2.0f * (float)( seed >> 8 ) / (float)( 1 << 24 ) - 1.0f );
+		seed = 1664525u * seed + 1013904223u;
+		float x = 6.0f * (float)( seed >> 8 ) / (float)( 1 << 24 ) - 3.0f;
+		seed = 1664525u * seed + 1013904223u;
+		float y = 6.0f * (float)( seed >> 8 ) / (float)( 1 << 24 ) - 3.0f;
+		transforms[2 * i] = ( b2Transform ){ { 10.0f, -5.0f }, b2MakeRot( angleA ) };
+		transforms[2 * i + 1] = ( b2Transform ){ { 10.0f + x, -5.0f + y }, b2MakeRot( angleB ) };
+	}
+
+	printf( "benchmark: manifold, pairs = %d\n", e_pairCount );
+
+	FILE* file = fopen( "manifold.csv", "w" );
+	if ( file != NULL )
+	{
+		fprintf( file, "pair,ns_per_pair,hash\n" );
+	}
+
+	const char* names[] = { "box-box", "hull-hull" };
+	const b2Polygon* sets[] = { boxes, hulls };
+	for ( int setIndex = 0; setIndex < 2; ++setIndex )
+	{
+		const b2Polygon* polygons = sets[setIndex];
+		float bestTime = FLT_MAX;
+		int pointCount = 0;
+
+		for ( int runIndex = 0; runIndex < runCount; ++runIndex )
+		{
+			pointCount = 0;
+			uint64_t ticks = b2GetTicks();
+			for ( int i = 0; i < e_pairCount; ++i )
+			{
+				const b2Polygon* polygonA = polygons + ( i % e_polygonCount );
+				const b2Polygon* polygonB = polygons + ( ( i / e_polygonCount + i ) % e_polygonCount );
+				b2Manifold manifold = b2CollidePolygons( polygonA, transforms[2 * i], polygonB, transforms[2 * i + 1] );
+				pointCount += manifold.pointCount;
+			}
+			bestTime = b2MinFloat( bestTime, b2GetMilliseconds( ticks ) );
+		}
+
+		// Hash outside the timed loop
+		uint32_t hash = B2_HASH_INIT;
+		for ( int i = 0; i < e_pairCount; ++i )
+		{
+			const b2Polygon* polygonA = polygons + ( i % e_polygonCount );
+			const b2Polygon* polygonB = polygons + ( ( i / e_polygonCount + i ) % e_polygonCount );
+			b2Manifold manifold = b2CollidePolygons( polygonA, transforms[2 * i], polygonB, transforms[2 * i + 1] );
+			hash = HashManifold( hash, &manifold );
+		}
+
+		float nanoseconds = 1.0e6f * bestTime / e_pairCount;
+		printf( "%s : %g (ns per pair), points %d, hash 0x%08x\n", names[setIndex], nanoseconds, pointCount, hash );
+
+		if ( file != NULL )
+		{
+			fprintf( file, "%s,%g,0x%08x\n", names[setIndex], nanoseconds, hash );
+		}
+	}
+
+	if ( file != NULL )
+	{
+		fclose( file );
+	}
+
+	free( transforms );
+
+	printf( "======================================\n" );
+}
+
 // Box2D benchmark application. On Windows it is important to use affinity avoid cross CCD
 // usage or efficiency cores. Also on Windows create a power plan with Processor power management
 // Min/Max of 99%. This prevents boosting and makes the benchmarks more repeatable.
@@ -144,9 +393,20 @@ static void MinProfile( b2Profile* p1, const b2Profile* p2 )
 // Run benchmark 3 with 4 workers and run once. Disable continuous collision. Record the step times.
 // start /affinity 0x5555 .\build\bin\Release\benchmark.exe -t=4 -w=4 -b=3 -r=1 -nc -s
 
+// Run all benchmarks with 4 workers that sleep after a short spin. Compare the CPU time to the default.
+// start /affinity 0x5555 .\build\bin\Release\benchmark.exe -t=4 -w=4 -hybrid
+
+// Time tree rebuilds for several proxy counts with 1 to 8 threads.
+// start /affinity 0x5555 .\build\bin\Release\benchmark.exe -t=8 -tree
+
+// Time the polygon collider and print a hash of the manifolds it produced.
+// start /affinity 0x5555 .\build\bin\Release\benchmark.exe -manifold
+
 int main( int argc, char** argv )
 {
 	Benchmark benchmarks[] = {
+		{ "cast", CreateCast, StepCast, 200 },
+		{ "confetti", CreateConfetti, NULL, 500 },
 		{ "joint_grid", CreateJointGrid, NULL, 500 },
 		{ "large_pyramid", CreateLargePyramid, NULL, 500 },
 		{ "many_pyramids", CreateManyPyramids, NULL, 200 },
@@ -203,7 +463,13 @@ int main( int argc, char** argv )
 	int singleWorkerCount = -1;
 	b2Counters counters = { 0 };
 	bool enableContinuous = true;
+	b2BroadPhaseType broadPhaseType = b2_treeBroadPhase;
 	bool recordStepTimes = false;
+	bool treeRebuild = false;
+	bool manifoldBenchmark = false;
+	float treeRefitRatio = 0.0f;
+	float manifoldReuseTolerance = 0.0f;
+	b2SolverWaitType solverWaitType = b2_spinSolverWait;
 
 	assert( maxThreadCount <= THREAD_LIMIT );
 
@@ -233,6 +499,39 @@ int main( int argc, char** argv )
 			enableContinuous = false;
 			printf( "Continuous disabled\n" );
 		}
+		else if ( strcmp( arg, "-sap" ) == 0 )
+		{
+			broadPhaseType = b2_sortAndSweepBroadPhase;
+			printf( "Sort and sweep enabled\n" );
+		}
+		else if ( strcmp( arg, "-grid" ) == 0 )
+		{
+			broadPhaseType = b2_gridBroadPhase;
+			printf( "Grid enabled\n" );
+		}
+		else if ( strncmp( arg, "-refit=", 7 ) == 0 )
+		{
+			treeRefitRatio = (float)atof( arg + 7 );
+			printf( "Tree refit enabled, rebuild ratio %g\n", treeRefitRatio );
+		}
+		else if ( strncmp( arg, "-reuse=", 7 ) == 0 )
+		{
+			manifoldReuseTolerance = (float)atof( arg + 7 );
+			printf( "Manifold reuse enabled, tolerance %g\n", manifoldReuseTolerance );
+		}
+		else if ( strcmp( arg, "-hybrid" ) == 0 )
+		{
+			solverWaitType = b2_hybridSolverWait;
+			printf( "Hybrid solver wait enabled\n" );
+		}
+		else if ( strcmp( arg, "-tree" ) == 0 )
+		{
+			treeRebuild = true;
+		}
+		else if ( strcmp( arg, "-manifold" ) == 0 )
+		{
+			manifoldBenchmark = true;
+		}
 		else if ( strncmp( arg, "-s", 3 ) == 0 )
 		{
 			recordStepTimes = true;
@@ -244,7 +543,15 @@ int main( int argc, char** argv )
 					"-b=<integer>: run a single benchmark\n"
 					"-w=<integer>: run a single worker count\n"
 					"-r=<integer>: number of repeats (default is 4)\n"
-					"-s: record step times\n" );
+					"-nc: disable continuous collision\n"
+					"-sap: find pairs by sort and sweep\n"
+					"-grid: find dynamic pairs with a hashed grid\n"
+					"-refit=<float>: refit the trees, rebuilding when the area ratio grows by this factor\n"
+					"-reuse=<float>: reuse contact manifolds while the bodies move less than this relative to each other\n"
+					"-hybrid: solver workers sleep after a short spin\n"
+					"-s: record step times\n"
+					"-tree: time tree rebuilds instead of running the benchmarks\n"
+					"-manifold: time the polygon collider instead of running the benchmarks\n" );
 			exit( 0 );
 		}
 	}
@@ -257,6 +564,22 @@ int main( int argc, char** argv )
 	printf( "Starting Box2D benchmarks\n" );
 	printf( "======================================\n" );
 
+	if ( treeRebuild )
+	{
+		RunTreeRebuildBenchmark( maxThreadCount, singleWorkerCount, runCount );
+		free( profiles );
+		free( stepResults );
+		return 0;
+	}
+
+	if ( manifoldBenchmark )
+	{
+		RunManifoldBenchmark( runCount );
+		free( profiles );
+		free( stepResults );
+		return 0;
+	}
+
 	for ( int benchmarkIndex = 0; benchmarkIndex < benchmarkCount; ++benchmarkIndex )
 	{
 		if ( singleBenchmark != -1 && benchmarkIndex != singleBenchmark )
@@ -277,6 +600,7 @@ int main( int argc, char** argv )
 		printf( "benchmark: %s, steps = %d\n", benchmarks[benchmarkIndex].name, stepCount );
 
 		float minTime[THREAD_LIMIT] = { 0 };
+		float minCpuTime[THREAD_LIMIT] = { 0 };
 
 		for ( int threadCount = 1; threadCount <= maxThreadCount; ++threadCount )
 		{
@@ -301,9 +625,13 @@ int main( int argc, char** argv )
 
 				b2WorldDef worldDef = b2DefaultWorldDef();
 				worldDef.enableContinuous = enableContinuous;
+				worldDef.broadPhaseType = broadPhaseType;
+				worldDef.treeRefitRatio = treeRefitRatio;
+				worldDef.manifoldReuseTolerance = manifoldReuseTolerance;
 				worldDef.enqueueTask = EnqueueTask;
 				worldDef.finishTask = FinishTask;
 				worldDef.workerCount = threadCount;
+				worldDef.solverWaitType = solverWaitType;
 				b2WorldId worldId = b2CreateWorld( &worldDef );
 
 				benchmark->createFcn( worldId );
@@ -327,6 +655,7 @@ int main( int argc, char** argv )
 				taskCount = 0;
 
 				uint64_t ticks = b2GetTicks();
+				double cpuStart = GetProcessCpuTime();
 
 				for ( int stepIndex = 1; stepIndex < stepCount; ++stepIndex )
 				{
@@ -343,15 +672,18 @@ int main( int argc, char** argv )
 				}
 
 				float ms = b2GetMilliseconds( ticks );
-				printf( "run %d : %g (ms)\n", runIndex, ms );
+				float cpuMs = (float)( GetProcessCpuTime() - cpuStart );
+				printf( "run %d : %g (ms), cpu %g (ms)\n", runIndex, ms, cpuMs );
 
 				if (runIndex == 0)
 				{
 					minTime[threadCount - 1] = ms ;
+					minCpuTime[threadCount - 1] = cpuMs;
 				}
 				else
 				{
 					minTime[threadCount - 1] = b2MinFloat( minTime[threadCount - 1], ms );
+					minCpuTime[threadCount - 1] = b2MinFloat( minCpuTime[threadCount - 1], cpuMs );
 				}
 
 				if ( countersAcquired == false )
@@ -405,10 +737,10 @@ int main( int argc, char** argv )
 			continue;
 		}
 
-		fprintf( file, "threads,ms\n" );
+		fprintf( file, "threads,ms,cpu_ms\n" );
 		for ( int threadIndex = 1; threadIndex <= maxThreadCount; ++threadIndex )
 		{
-			fprintf( file, "%d,%g\n", threadIndex, minTime[threadIndex - 1] );
+			fprintf( file, "%d,%g,%g\n", threadIndex, minTime[threadIndex - 1], minCpuTime[threadIndex - 1] );
 		}
 
 		fclose( file );
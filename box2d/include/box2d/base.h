@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // clang-format off
@@ -66,6 +67,41 @@ B2_API int b2GetByteCount( void );
 /// @param assertFcn a non-null assert callback
 B2_API void b2SetAssertFcn( b2AssertFcn* assertFcn );
 
+/// Task interface
+/// This is prototype for a Box2D task. Your task system is expected to invoke the Box2D task with these arguments.
+/// The task spans a range of the parallel-for: [startIndex, endIndex)
+/// The worker index must correctly identify each worker in the user thread pool, expected in [0, workerCount).
+/// A worker must only exist on only one thread at a time and is analogous to the thread index.
+/// The task context is the context pointer sent from Box2D when it is enqueued.
+/// The startIndex and endIndex are expected in the range [0, itemCount) where itemCount is the argument to b2EnqueueTaskCallback
+/// below. Box2D expects startIndex < endIndex and will execute a loop like this:
+///
+/// @code{.c}
+/// for (int i = startIndex; i < endIndex; ++i)
+/// {
+/// 	DoWork();
+/// }
+/// @endcode
+/// @ingroup world
+typedef void b2TaskCallback( int startIndex, int endIndex, uint32_t workerIndex, void* taskContext );
+
+/// These functions can be provided to Box2D to invoke a task system. These are designed to work well with enkiTS.
+/// Returns a pointer to the user's task object. May be nullptr. A nullptr indicates to Box2D that the work was executed
+/// serially within the callback and there is no need to call b2FinishTaskCallback.
+/// The itemCount is the number of Box2D work items that are to be partitioned among workers by the user's task system.
+/// This is essentially a parallel-for. The minRange parameter is a suggestion of the minimum number of items to assign
+/// per worker to reduce overhead. For example, suppose the task is small and that itemCount is 16. A minRange of 8 suggests
+/// that your task system should split the work items among just two workers, even if you have more available.
+/// In general the range [startIndex, endIndex) send to b2TaskCallback should obey:
+/// endIndex - startIndex >= minRange
+/// The exception of course is when itemCount < minRange.
+/// @ingroup world
+typedef void* b2EnqueueTaskCallback( b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext );
+
+/// Finishes a user task object that wraps a Box2D task.
+/// @ingroup world
+typedef void b2FinishTaskCallback( void* userTask, void* userContext );
+
 /// Version numbering scheme.
 /// See https://semver.org/
 typedef struct b2Version
@@ -83,6 +119,33 @@ typedef struct b2Version
 /// Get the current version of Box2D
 B2_API b2Version b2GetVersion( void );
 
+/// SIMD instruction sets for the wide solver. On x86-64 the solver is built for several of these and
+/// each world picks the widest one the CPU supports when it is created. All backends give the same results.
+/// @see b2World_SetSIMDBackend
+typedef enum b2SIMDBackend
+{
+	/// Portable C, used when SIMD is disabled
+	b2_simdScalar,
+
+	/// 4 lanes
+	b2_simdSSE2,
+
+	/// 4 lanes
+	b2_simdNeon,
+
+	/// 8 lanes
+	b2_simdAVX2,
+
+	/// 16 lanes, needs AVX-512F and AVX-512DQ
+	b2_simdAVX512,
+
+	/// number of backends
+	b2_simdBackendCount,
+} b2SIMDBackend;
+
+/// Is the backend built into this library and supported by the CPU?
+B2_API bool b2IsSIMDBackendSupported( b2SIMDBackend backend );
+
 /**@}*/
 
 //! @cond
@@ -78,6 +78,23 @@ B2_API b2TreeStats b2World_CastRay( b2WorldId worldId, b2Vec2 origin, b2Vec2 tra
 /// This is less general than b2World_CastRay() and does not allow for custom filtering.
 B2_API b2RayResult b2World_CastRayClosest( b2WorldId worldId, b2Vec2 origin, b2Vec2 translation, b2QueryFilter filter );
 
+/// Cast a batch of rays into the world and collect the closest hit of each, like b2World_CastRayClosest.
+/// The trees are walked once for each group of B2_TREE_BATCH_SIZE rays instead of once per ray.
+/// Rays that are close together in the input share more node visits, so keep nearby rays next to each other.
+/// With useTasks the groups are spread over the world task system, so this must be called from the thread
+/// that steps the world.
+/// @param results one result per ray. The visit counters of the results are not used.
+/// @return traversal performance counters for the whole batch
+B2_API b2TreeStats b2World_CastRayBatch( b2WorldId worldId, const b2Vec2* origins, const b2Vec2* translations, int rayCount,
+										 b2QueryFilter filter, b2RayResult* results, bool useTasks );
+
+/// Find the shapes that *potentially* overlap each of a batch of AABBs, like b2World_OverlapAABB.
+/// The trees are walked once for each group of B2_TREE_BATCH_SIZE boxes. The results are grouped by box group
+/// and tree, and are in no particular order when using tasks. See b2World_CastRayBatch for useTasks.
+/// @return the number of overlaps found. Only the first resultCapacity are written to results.
+B2_API int b2World_OverlapAABBBatch( b2WorldId worldId, const b2AABB* boxes, int boxCount, b2QueryFilter filter,
+									 b2OverlapBatchResult* results, int resultCapacity, bool useTasks );
+
 /// Cast a shape through the world. Similar to a cast ray except that a shape is cast instead of a point.
 ///	@see b2World_CastRay
 B2_API b2TreeStats b2World_CastShape( b2WorldId worldId, const b2ShapeProxy* proxy, b2Vec2 translation, b2QueryFilter filter,
@@ -189,9 +206,38 @@ B2_API void b2World_SetRestitutionCallback( b2WorldId worldId, b2RestitutionCall
 /// Dump memory stats to box2d_memory.txt
 B2_API void b2World_DumpMemoryStats( b2WorldId worldId );
 
-/// This is for internal testing
+/// Rebuild the static tree top down. Call this after a level is loaded. Queries use a 4-wide copy of the
+/// static tree until a static shape is created, destroyed or moved.
 B2_API void b2World_RebuildStaticTree( b2WorldId worldId );
 
+/// Get the number of bytes needed to snapshot the world in its current state.
+B2_API int b2World_GetSnapshotSize( b2WorldId worldId );
+
+/// Copy the complete simulation state of the world into a buffer. Returns the number of bytes
+/// written or zero if the buffer is too small. A snapshot is a raw memory image: it is only valid
+/// for the same build and can only be restored into the world it came from.
+B2_API int b2World_SaveSnapshot( b2WorldId worldId, void* buffer, int capacity );
+
+/// Restore the world to a snapshot taken with b2World_SaveSnapshot. Ids held by the application
+/// are valid again if they were valid when the snapshot was taken. Callbacks, user data and
+/// the world id are not affected. Returns false and leaves the world unchanged if the data is invalid.
+B2_API bool b2World_RestoreSnapshot( b2WorldId worldId, const void* buffer, int size );
+
+/// Get the SIMD backend used by the solver. By default this is the widest one the CPU supports.
+B2_API b2SIMDBackend b2World_GetSIMDBackend( b2WorldId worldId );
+
+/// Override the SIMD backend used by the solver. Returns false and keeps the current backend if this
+/// library or the CPU does not support it. @see b2IsSIMDBackendSupported
+B2_API bool b2World_SetSIMDBackend( b2WorldId worldId, b2SIMDBackend backend );
+
+/// Set how the solver workers wait for each other. Spinning has the lowest latency. The hybrid wait
+/// sleeps after a short spin, which saves CPU time when there is little work per worker.
+/// @see b2WorldDef, b2Profile::stageSpin
+B2_API void b2World_SetSolverWaitType( b2WorldId worldId, b2SolverWaitType type );
+
+/// Get how the solver workers wait for each other
+B2_API b2SolverWaitType b2World_GetSolverWaitType( b2WorldId worldId );
+
 /// This is for internal testing
 B2_API void b2World_EnableSpeculative( b2WorldId worldId, bool flag );
 
@@ -660,8 +660,26 @@ typedef struct b2DynamicTree
 	/// Bins for sorting during rebuild
 	int* binIndices;
 
+	/// Internal nodes reserved for the subtrees of a task rebuild
+	int* rebuildNodes;
+
 	/// Allocated space for rebuilding
 	int rebuildCapacity;
+
+	/// Optional 4-wide copy of the tree used by queries, see b2DynamicTree_EnableWideNodes
+	struct b2WideNode* wideNodes;
+
+	/// The number of wide nodes
+	int wideNodeCount;
+
+	/// The allocated wide node space
+	int wideNodeCapacity;
+
+	/// Build the wide nodes when the tree is rebuilt
+	bool wideEnabled;
+
+	/// The wide nodes match the binary tree
+	bool wideValid;
 } b2DynamicTree;
 
 /// These are performance results returned by dynamic tree queries.
@@ -730,6 +748,31 @@ typedef float b2TreeRayCastCallbackFcn( const b2RayCastInput* input, int proxyId
 B2_API b2TreeStats b2DynamicTree_RayCast( const b2DynamicTree* tree, const b2RayCastInput* input, uint64_t maskBits,
 										  b2TreeRayCastCallbackFcn* callback, void* context );
 
+/// The number of queries walked through the tree together by the batched queries
+#define B2_TREE_BATCH_SIZE 64
+
+/// This function receives a proxy found by a batched AABB query, once for each group of queries.
+/// Bit i of queryMask is set if the proxy overlaps box baseIndex + i.
+/// @return true if the query should continue
+typedef bool b2TreeQueryBatchCallbackFcn( int proxyId, uint64_t userData, int baseIndex, uint64_t queryMask, void* context );
+
+/// Query a batch of AABBs for overlapping proxies. The tree is walked once for each group of B2_TREE_BATCH_SIZE
+/// boxes, so nodes are loaded once for the whole group and the callback is called once per proxy and group.
+///	@return performance data
+B2_API b2TreeStats b2DynamicTree_QueryBatch( const b2DynamicTree* tree, const b2AABB* boxes, int boxCount, uint64_t maskBits,
+											 b2TreeQueryBatchCallbackFcn* callback, void* context );
+
+/// This function receives clipped ray cast input for a proxy hit by ray rayIndex of a batched ray cast.
+/// The return value is the same as b2TreeRayCastCallbackFcn, but only applies to that ray.
+typedef float b2TreeRayCastBatchCallbackFcn( const b2RayCastInput* input, int rayIndex, int proxyId, uint64_t userData,
+											 void* context );
+
+/// Ray cast a batch of rays against the proxies in the tree. The tree is walked once for each group of
+/// B2_TREE_BATCH_SIZE rays and each ray is clipped by the callback like b2DynamicTree_RayCast.
+///	@return performance data
+B2_API b2TreeStats b2DynamicTree_RayCastBatch( const b2DynamicTree* tree, const b2RayCastInput* inputs, int rayCount,
+											   uint64_t maskBits, b2TreeRayCastBatchCallbackFcn* callback, void* context );
+
 /// This function receives clipped ray cast input for a proxy. The function
 /// returns the new ray fraction.
 /// - return a value of 0 to terminate the ray cast
@@ -766,6 +809,23 @@ B2_API int b2DynamicTree_GetProxyCount( const b2DynamicTree* tree );
 /// Rebuild the tree while retaining subtrees that haven't changed. Returns the number of boxes sorted.
 B2_API int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild );
 
+/// Shrink the internal nodes above enlarged proxies to the union of their children in one bottom-up pass,
+/// keeping the tree structure. This is much cheaper than a rebuild, but the tree quality degrades as proxies
+/// move apart, see b2DynamicTree_GetAreaRatio. Returns the number of internal nodes refit.
+B2_API int b2DynamicTree_Refit( b2DynamicTree* tree );
+
+/// Same as b2DynamicTree_Rebuild, but the top levels are split serially and the subtrees below them are built
+/// using the task system. The resulting tree is identical to b2DynamicTree_Rebuild for any worker count.
+/// Must be called from the thread that drives the task system. Small trees are built without tasks.
+B2_API int b2DynamicTree_RebuildWithTasks( b2DynamicTree* tree, bool fullBuild, b2EnqueueTaskCallback* enqueueTask,
+										   b2FinishTaskCallback* finishTask, void* userTaskContext );
+
+/// Keep a 4-wide copy of the tree that queries, ray casts and shape casts walk four child boxes at a time.
+/// Nodes are stored in depth-first order. The copy is built by b2DynamicTree_Rebuild and dropped by any proxy
+/// change, so this is meant for trees that are built once and queried often, such as the static tree.
+/// Results are reported in the same order.
+B2_API void b2DynamicTree_EnableWideNodes( b2DynamicTree* tree, bool flag );
+
 /// Get the number of bytes used by this tree
 B2_API int b2DynamicTree_GetByteCount( const b2DynamicTree* tree );
 
@@ -14,41 +14,6 @@
 #define B2_DEFAULT_CATEGORY_BITS 1
 #define B2_DEFAULT_MASK_BITS UINT64_MAX
 
-/// Task interface
-/// This is prototype for a Box2D task. Your task system is expected to invoke the Box2D task with these arguments.
-/// The task spans a range of the parallel-for: [startIndex, endIndex)
-/// The worker index must correctly identify each worker in the user thread pool, expected in [0, workerCount).
-/// A worker must only exist on only one thread at a time and is analogous to the thread index.
-/// The task context is the context pointer sent from Box2D when it is enqueued.
-/// The startIndex and endIndex are expected in the range [0, itemCount) where itemCount is the argument to b2EnqueueTaskCallback
-/// below. Box2D expects startIndex < endIndex and will execute a loop like this:
-///
-/// @code{.c}
-/// for (int i = startIndex; i < endIndex; ++i)
-/// {
-/// 	DoWork();
-/// }
-/// @endcode
-/// @ingroup world
-typedef void b2TaskCallback( int startIndex, int endIndex, uint32_t workerIndex, void* taskContext );
-
-/// These functions can be provided to Box2D to invoke a task system. These are designed to work well with enkiTS.
-/// Returns a pointer to the user's task object. May be nullptr. A nullptr indicates to Box2D that the work was executed
-/// serially within the callback and there is no need to call b2FinishTaskCallback.
-/// The itemCount is the number of Box2D work items that are to be partitioned among workers by the user's task system.
-/// This is essentially a parallel-for. The minRange parameter is a suggestion of the minimum number of items to assign
-/// per worker to reduce overhead. For example, suppose the task is small and that itemCount is 16. A minRange of 8 suggests
-/// that your task system should split the work items among just two workers, even if you have more available.
-/// In general the range [startIndex, endIndex) send to b2TaskCallback should obey:
-/// endIndex - startIndex >= minRange
-/// The exception of course is when itemCount < minRange.
-/// @ingroup world
-typedef void* b2EnqueueTaskCallback( b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext );
-
-/// Finishes a user task object that wraps a Box2D task.
-/// @ingroup world
-typedef void b2FinishTaskCallback( void* userTask, void* userContext );
-
 /// Optional friction mixing callback. This intentionally provides no context objects because this is called
 /// from a worker thread.
 /// @warning This function should not attempt to modify Box2D state or user application state.
@@ -61,6 +26,53 @@ typedef float b2FrictionCallback( float frictionA, int userMaterialIdA, float fr
 /// @ingroup world
 typedef float b2RestitutionCallback( float restitutionA, int userMaterialIdA, float restitutionB, int userMaterialIdB );
 
+/// The method the broad-phase uses to find new contact pairs. All methods find the same pairs, but new
+/// contacts may be created in a different order. The broad-phase trees are maintained for world queries
+/// and casts whatever the method.
+/// @ingroup world
+typedef enum b2BroadPhaseType
+{
+	/// Query the trees for each proxy that moved
+	b2_treeBroadPhase,
+
+	/// Keep all proxies sorted along the x-axis and sweep. This can be faster for dense scenes where most
+	/// bodies move every step.
+	b2_sortAndSweepBroadPhase,
+
+	/// Hash dynamic proxies into a multi-level grid sized from the median proxy extent. Aimed at many
+	/// small bodies of similar size that all move every step. Static and kinematic pairs still use the trees.
+	b2_gridBroadPhase,
+} b2BroadPhaseType;
+
+/// How the solver threads wait for each other between solver stages.
+/// @ingroup world
+typedef enum b2SolverWaitType
+{
+	/// Spin until the next stage is ready. This has the lowest latency, but every worker stays busy
+	/// for the whole constraint solve even when there is little work.
+	b2_spinSolverWait,
+
+	/// Spin for a short time, then sleep until the next stage is ready. This uses less CPU time for
+	/// small scenes and leaves the cores free for other threads, at the cost of some wake up latency.
+	b2_hybridSolverWait,
+} b2SolverWaitType;
+
+/// The stages of the constraint solver. Used to index per stage profile data.
+/// @ingroup world
+typedef enum b2SolverStageType
+{
+	b2_stagePrepareJoints,
+	b2_stagePrepareContacts,
+	b2_stageIntegrateVelocities,
+	b2_stageWarmStart,
+	b2_stageSolve,
+	b2_stageIntegratePositions,
+	b2_stageRelax,
+	b2_stageRestitution,
+	b2_stageStoreImpulses,
+	b2_solverStageCount
+} b2SolverStageType;
+
 /// Result from b2World_RayCastClosest
 /// If there is initial overlap the fraction and normal will be zero while the point is an arbitrary point in the overlap region.
 /// @ingroup world
@@ -75,6 +87,16 @@ typedef struct b2RayResult
 	bool hit;
 } b2RayResult;
 
+/// A shape found by b2World_OverlapAABBBatch
+/// @ingroup world
+typedef struct b2OverlapBatchResult
+{
+	b2ShapeId shapeId;
+
+	/// Index of the box the shape overlaps
+	int queryIndex;
+} b2OverlapBatchResult;
+
 /// World definition used to create a simulation world.
 /// Must be initialized using b2DefaultWorldDef().
 /// @ingroup world
@@ -117,6 +139,21 @@ typedef struct b2WorldDef
 	/// Enable continuous collision
 	bool enableContinuous;
 
+	/// How new contact pairs are found. The default queries the broad-phase trees.
+	b2BroadPhaseType broadPhaseType;
+
+	/// When positive, the dynamic and kinematic trees are refit each step instead of rebuilding the
+	/// parts that moved, and only rebuilt once their area ratio grows past this factor of the ratio
+	/// after the last rebuild. The ratio is checked every few steps. Good for scenes where bodies move in
+	/// place, like settled stacks. Zero (the default) rebuilds every step.
+	float treeRefitRatio;
+
+	/// When positive, a touching contact keeps its manifold while the relative transform of its bodies
+	/// stays within this distance (in meters) and this rotation (in radians) of the transform the manifold
+	/// was computed at. The manifold is only moved along with the bodies. Good for settled stacks.
+	/// Zero (the default) computes every manifold every step.
+	float manifoldReuseTolerance;
+
 	/// Number of workers to use with the provided task system. Box2D performs best when using only
 	/// performance cores and accessing a single L2 cache. Efficiency cores and hyper-threading provide
 	/// little benefit and may even harm performance.
@@ -126,6 +163,9 @@ typedef struct b2WorldDef
 	/// task callbacks (enqueueTask and finishTask).
 	int workerCount;
 
+	/// How the solver workers wait for each other. The default spins.
+	b2SolverWaitType solverWaitType;
+
 	/// Function to spawn tasks
 	b2EnqueueTaskCallback* enqueueTask;
 
@@ -495,6 +535,13 @@ typedef struct b2Profile
 	float bullets;
 	float sleepIslands;
 	float sensors;
+
+	/// Time the solver threads spent spinning while waiting for other threads, summed over the threads
+	float stageSpin[b2_solverStageCount];
+
+	/// Time the solver threads spent sleeping while waiting for other threads, summed over the threads.
+	/// Only the hybrid solver wait sleeps.
+	float stageSleep[b2_solverStageCount];
 } b2Profile;
 
 /// Counters that give details of the simulation size.
@@ -510,7 +557,11 @@ typedef struct b2Counters
 	int treeHeight;
 	int byteCount;
 	int taskCount;
-	int colorCounts[12];
+	int manifoldReuseCount;
+	int overflowContactCount;
+	int overflowJointCount;
+	int recolorCount;
+	int colorCounts[24];
 } b2Counters;
 //! @endcond
 
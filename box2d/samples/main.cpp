@@ -414,6 +414,7 @@ static void UpdateUI()
 				ImGui::Checkbox( "Sleep", &s_context.enableSleep );
 				ImGui::Checkbox( "Warm Starting", &s_context.enableWarmStarting );
 				ImGui::Checkbox( "Continuous", &s_context.enableContinuous );
+				ImGui::Checkbox( "Hybrid Wait", &s_context.enableHybridWait );
 
 				ImGui::Separator();
 
@@ -444,6 +444,7 @@ void Sample::Step(  )
 	b2World_EnableSleeping( m_worldId, m_context->enableSleep );
 	b2World_EnableWarmStarting( m_worldId, m_context->enableWarmStarting );
 	b2World_EnableContinuous( m_worldId, m_context->enableContinuous );
+	b2World_SetSolverWaitType( m_worldId, m_context->enableHybridWait ? b2_hybridSolverWait : b2_spinSolverWait );
 
 	for ( int i = 0; i < 1; ++i )
 	{
@@ -479,6 +480,8 @@ void Sample::Step(  )
 		}
 		snprintf( buffer + offset, 256 - offset, "[%d]", totalCount );
 		DrawTextLine( buffer );
+		DrawTextLine( "overflow contacts/joints/recolored = %d/%d/%d", s.overflowContactCount, s.overflowJointCount,
+					  s.recolorCount );
 		DrawTextLine( "stack allocator size = %d K", s.stackUsed / 1024 );
 		DrawTextLine( "total allocation = %d K", s.byteCount / 1024 );
 	}
@@ -510,6 +513,14 @@ void Sample::Step(  )
 		m_maxProfile.sleepIslands = b2MaxFloat( m_maxProfile.sleepIslands, p.sleepIslands );
 		m_maxProfile.sensors = b2MaxFloat( m_maxProfile.sensors, p.sensors );
 
+		for ( int i = 0; i < b2_solverStageCount; ++i )
+		{
+			m_maxProfile.stageSpin[i] = b2MaxFloat( m_maxProfile.stageSpin[i], p.stageSpin[i] );
+			m_maxProfile.stageSleep[i] = b2MaxFloat( m_maxProfile.stageSleep[i], p.stageSleep[i] );
+			m_totalProfile.stageSpin[i] += p.stageSpin[i];
+			m_totalProfile.stageSleep[i] += p.stageSleep[i];
+		}
+
 		m_totalProfile.step += p.step;
 		m_totalProfile.pairs += p.pairs;
 		m_totalProfile.collide += p.collide;
@@ -566,6 +577,12 @@ void Sample::Step(  )
 			aveProfile.bullets = scale * m_totalProfile.bullets;
 			aveProfile.sleepIslands = scale * m_totalProfile.sleepIslands;
 			aveProfile.sensors = scale * m_totalProfile.sensors;
+
+			for ( int i = 0; i < b2_solverStageCount; ++i )
+			{
+				aveProfile.stageSpin[i] = scale * m_totalProfile.stageSpin[i];
+				aveProfile.stageSleep[i] = scale * m_totalProfile.stageSleep[i];
+			}
 		}
 
 		DrawTextLine( "step [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.step, aveProfile.step, m_maxProfile.step );
@@ -607,6 +624,18 @@ void Sample::Step(  )
 					  m_maxProfile.sleepIslands );
 		DrawTextLine( "> bullets [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.bullets, aveProfile.bullets, m_maxProfile.bullets );
 		DrawTextLine( "sensors [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.sensors, aveProfile.sensors, m_maxProfile.sensors );
+
+		// Solver thread wait times summed over the threads
+		const char* stageNames[b2_solverStageCount] = {
+			"prepare joints", "prepare contacts", "integrate velocities", "warm start", "solve",
+			"integrate positions", "relax", "restitution", "store impulses",
+		};
+
+		for ( int i = 0; i < b2_solverStageCount; ++i )
+		{
+			DrawTextLine( "wait %s spin/sleep [ave] = %5.2f/%5.2f [%6.2f/%6.2f]", stageNames[i], p.stageSpin[i], p.stageSleep[i],
+						  aveProfile.stageSpin[i], aveProfile.stageSleep[i] );
+		}
 	}
 }
 
@@ -45,6 +45,7 @@ struct SampleContext
 	bool enableWarmStarting = true;
 	bool enableContinuous = true;
 	bool enableSleep = true;
+	bool enableHybridWait = false;
 
 	// These are persisted
 	int sampleIndex = 0;
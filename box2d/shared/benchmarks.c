@@ -4,6 +4,7 @@
 #include "benchmarks.h"
 
 #include "human.h"
+#include "random.h"
 
 #include "box2d/box2d.h"
 
@@ -446,6 +447,142 @@ float StepSpinner( b2WorldId worldId, int stepCount )
 	return b2RevoluteJoint_GetAngle(g_spinnerData.spinnerId);
 }
 
+#define CAST_QUERY_COUNT 100
+
+typedef struct
+{
+	float extent;
+	int hitCount;
+} CastData;
+
+CastData g_castData;
+
+// A field of static boxes like the Cast sample, queried with rays, circle casts and box overlaps every step
+void CreateCast( b2WorldId worldId )
+{
+	g_randomSeed = 1234;
+	g_castData.hitCount = 0;
+
+	int gridCount = BENCHMARK_DEBUG ? 100 : 500;
+	float grid = 1.0f;
+	float fill = 0.2f;
+	g_castData.extent = gridCount * grid;
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+
+	float y = 0.0f;
+	for ( int i = 0; i < gridCount; ++i )
+	{
+		float x = 0.0f;
+		for ( int j = 0; j < gridCount; ++j )
+		{
+			if ( RandomFloatRange( 0.0f, 1.0f ) <= fill )
+			{
+				float ratio = RandomFloatRange( 1.0f, 5.0f );
+				float halfWidth = RandomFloatRange( 0.05f, 0.25f );
+				b2Polygon box = b2MakeOffsetBox( ratio * halfWidth, halfWidth, ( b2Vec2 ){ x, y }, b2Rot_identity );
+				b2CreatePolygonShape( groundId, &shapeDef, &box );
+			}
+
+			x += grid;
+		}
+
+		y += grid;
+	}
+
+	b2World_RebuildStaticTree( worldId );
+}
+
+static float CastClosestCallback( b2ShapeId shapeId, b2Vec2 point, b2Vec2 normal, float fraction, void* context )
+{
+	(void)shapeId;
+	(void)point;
+	(void)normal;
+	(void)context;
+	return fraction;
+}
+
+static bool CastOverlapCallback( b2ShapeId shapeId, void* context )
+{
+	(void)shapeId;
+	int* count = context;
+	*count += 1;
+	return true;
+}
+
+float StepCast( b2WorldId worldId, int stepCount )
+{
+	(void)stepCount;
+
+	b2QueryFilter filter = b2DefaultQueryFilter();
+	float extent = g_castData.extent;
+
+	for ( int i = 0; i < CAST_QUERY_COUNT; ++i )
+	{
+		b2Vec2 origin = RandomVec2( 0.0f, extent );
+		b2Vec2 translation = b2Sub( RandomVec2( 0.0f, extent ), origin );
+
+		b2RayResult result = b2World_CastRayClosest( worldId, origin, translation, filter );
+		g_castData.hitCount += result.hit ? 1 : 0;
+
+		b2ShapeProxy proxy = b2MakeProxy( &origin, 1, 0.1f );
+		b2World_CastShape( worldId, &proxy, translation, filter, CastClosestCallback, NULL );
+
+		b2AABB box = { b2Sub( origin, ( b2Vec2 ){ 5.0f, 5.0f } ), b2Add( origin, ( b2Vec2 ){ 5.0f, 5.0f } ) };
+		b2World_OverlapAABB( worldId, box, filter, CastOverlapCallback, &g_castData.hitCount );
+	}
+
+	return (float)g_castData.hitCount;
+}
+
+// Equal sized circles bouncing around a closed box without gravity, so every body moves every step
+void CreateConfetti( b2WorldId worldId )
+{
+	g_randomSeed = 1234;
+	b2World_SetGravity( worldId, b2Vec2_zero );
+
+	int gridCount = BENCHMARK_DEBUG ? 40 : 100;
+	float grid = 1.0f;
+	float extent = 0.5f * gridCount * grid;
+
+	{
+		b2BodyDef bodyDef = b2DefaultBodyDef();
+		b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+
+		b2Vec2 points[4] = { { extent, -extent }, { extent, extent }, { -extent, extent }, { -extent, -extent } };
+		b2SurfaceMaterial material = { 0 };
+		material.restitution = 1.0f;
+
+		b2ChainDef chainDef = b2DefaultChainDef();
+		chainDef.points = points;
+		chainDef.count = 4;
+		chainDef.isLoop = true;
+		chainDef.materials = &material;
+		chainDef.materialCount = 1;
+		b2CreateChain( groundId, &chainDef );
+	}
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.type = b2_dynamicBody;
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.material.friction = 0.0f;
+	shapeDef.material.restitution = 1.0f;
+	b2Circle circle = { { 0.0f, 0.0f }, 0.25f };
+
+	for ( int i = 0; i < gridCount; ++i )
+	{
+		for ( int j = 0; j < gridCount; ++j )
+		{
+			bodyDef.position = ( b2Vec2 ){ -extent + ( i + 0.5f ) * grid, -extent + ( j + 0.5f ) * grid };
+			bodyDef.linearVelocity = RandomVec2( -5.0f, 5.0f );
+			b2BodyId bodyId = b2CreateBody( worldId, &bodyDef );
+			b2CreateCircleShape( bodyId, &shapeDef, &circle );
+		}
+	}
+}
+
 void CreateSmash( b2WorldId worldId )
 {
 	b2World_SetGravity( worldId, b2Vec2_zero );
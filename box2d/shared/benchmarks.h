@@ -11,6 +11,9 @@ extern "C"
 {
 #endif
 
+void CreateCast( b2WorldId worldId );
+float StepCast( b2WorldId worldId, int stepCount );
+void CreateConfetti( b2WorldId worldId );
 void CreateJointGrid( b2WorldId worldId );
 void CreateLargePyramid( b2WorldId worldId );
 void CreateManyPyramids( b2WorldId worldId );
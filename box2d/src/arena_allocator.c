@@ -32,8 +32,8 @@ void b2DestroyArenaAllocator( b2ArenaAllocator* allocator )
 
 void* b2AllocateArenaItem( b2ArenaAllocator* alloc, int size, const char* name )
 {
-	// ensure allocation is 32 byte aligned to support 256-bit SIMD
-	int size32 = ( ( size - 1 ) | 0x1F ) + 1;
+	// ensure allocation is aligned to support the widest SIMD type
+	int size32 = ( ( size - 1 ) | ( B2_ALIGNMENT - 1 ) ) + 1;
 
 	b2ArenaEntry entry;
 	entry.size = size32;
@@ -44,7 +44,7 @@ void* b2AllocateArenaItem( b2ArenaAllocator* alloc, int size, const char* name )
 		entry.data = b2Alloc( size32 );
 		entry.usedMalloc = true;
 
-		B2_ASSERT( ( (uintptr_t)entry.data & 0x1F ) == 0 );
+		B2_ASSERT( ( (uintptr_t)entry.data & ( B2_ALIGNMENT - 1 ) ) == 0 );
 	}
 	else
 	{
@@ -52,7 +52,7 @@ void* b2AllocateArenaItem( b2ArenaAllocator* alloc, int size, const char* name )
 		entry.usedMalloc = false;
 		alloc->index += size32;
 
-		B2_ASSERT( ( (uintptr_t)entry.data & 0x1F ) == 0 );
+		B2_ASSERT( ( (uintptr_t)entry.data & ( B2_ALIGNMENT - 1 ) ) == 0 );
 	}
 
 	alloc->allocation += size32;
@@ -154,7 +154,11 @@
 B2_DECLARE_ARRAY_NATIVE( int, b2Int );
 B2_ARRAY_INLINE( int, b2Int )
 
+B2_DECLARE_ARRAY_NATIVE( float, b2Float );
+B2_ARRAY_INLINE( float, b2Float )
+
 // Declare all the arrays
+B2_ARRAY_DECLARE( b2AABB, b2AABB );
 B2_ARRAY_DECLARE( b2Body, b2Body );
 B2_ARRAY_DECLARE( b2BodyMoveEvent, b2BodyMoveEvent );
 B2_ARRAY_DECLARE( b2BodySim, b2BodySim );
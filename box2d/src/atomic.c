@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#include "atomic.h"
+
+#if defined( _MSC_VER )
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+
+#include <windows.h>
+
+// WaitOnAddress requires Windows 8
+#pragma comment( lib, "Synchronization.lib" )
+
+void b2WaitOnAddress( void* address, uint32_t expected )
+{
+	WaitOnAddress( address, &expected, sizeof( uint32_t ), INFINITE );
+}
+
+void b2WakeOnAddress( void* address )
+{
+	WakeByAddressAll( address );
+}
+
+#elif defined( __linux__ )
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+void b2WaitOnAddress( void* address, uint32_t expected )
+{
+	// Returns immediately if the value no longer matches
+	syscall( SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0 );
+}
+
+void b2WakeOnAddress( void* address )
+{
+	syscall( SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+}
+
+#elif defined( __APPLE__ )
+
+#include <pthread.h>
+
+// The public address wait on Apple platforms needs a recent OS, so use one condition variable
+// shared by all addresses. Waking is rare enough that spurious wake ups don't matter.
+static pthread_mutex_t s_waitMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_waitCondition = PTHREAD_COND_INITIALIZER;
+
+void b2WaitOnAddress( void* address, uint32_t expected )
+{
+	pthread_mutex_lock( &s_waitMutex );
+	if ( __atomic_load_n( (uint32_t*)address, __ATOMIC_SEQ_CST ) == expected )
+	{
+		pthread_cond_wait( &s_waitCondition, &s_waitMutex );
+	}
+	pthread_mutex_unlock( &s_waitMutex );
+}
+
+void b2WakeOnAddress( void* address )
+{
+	B2_UNUSED( address );
+
+	// Taking the lock orders this after a waiter that saw the old value
+	pthread_mutex_lock( &s_waitMutex );
+	pthread_cond_broadcast( &s_waitCondition );
+	pthread_mutex_unlock( &s_waitMutex );
+}
+
+#else
+
+void b2WaitOnAddress( void* address, uint32_t expected )
+{
+	B2_UNUSED( address, expected );
+	b2Yield();
+}
+
+void b2WakeOnAddress( void* address )
+{
+	B2_UNUSED( address );
+}
+
+#endif
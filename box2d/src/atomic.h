@@ -77,3 +77,30 @@ static inline uint32_t b2AtomicLoadU32( b2AtomicU32* a )
 #error "Unsupported platform"
 #endif
 }
+
+// Block the calling thread while the 32-bit value at the address equals the expected value. This may return early,
+// so callers must loop. Falls back to yielding on platforms without an address wait.
+void b2WaitOnAddress( void* address, uint32_t expected );
+
+// Wake all threads blocked in b2WaitOnAddress on this address
+void b2WakeOnAddress( void* address );
+
+static inline void b2AtomicWaitU32( b2AtomicU32* a, uint32_t expected )
+{
+	b2WaitOnAddress( &a->value, expected );
+}
+
+static inline void b2AtomicWakeU32( b2AtomicU32* a )
+{
+	b2WakeOnAddress( &a->value );
+}
+
+static inline void b2AtomicWaitInt( b2AtomicInt* a, int expected )
+{
+	b2WaitOnAddress( &a->value, (uint32_t)expected );
+}
+
+static inline void b2AtomicWakeInt( b2AtomicInt* a )
+{
+	b2WakeOnAddress( &a->value );
+}
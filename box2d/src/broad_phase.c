@@ -13,18 +13,28 @@
 #include "body.h"
 #include "contact.h"
 #include "core.h"
+#include "ctz.h"
 #include "shape.h"
 #include "arena_allocator.h"
 #include "physics_world.h"
 
+#include <float.h>
 #include <stdbool.h>
 #include <string.h>
 
+#if defined( B2_SIMD_AVX512 ) || defined( B2_SIMD_AVX2 ) || defined( B2_SIMD_SSE2 )
+#include <emmintrin.h>
+#elif defined( B2_SIMD_NEON )
+#include <arm_neon.h>
+#endif
+
 // #include <stdio.h>
 
 // static FILE* s_file = NULL;
 
-void b2CreateBroadPhase( b2BroadPhase* bp )
+B2_ARRAY_SOURCE( b2AABB, b2AABB )
+
+void b2CreateBroadPhase( b2BroadPhase* bp, b2BroadPhaseType type, float refitRatio )
 {
 	_Static_assert( b2_bodyTypeCount == 3, "must be three body types" );
 
@@ -34,18 +44,28 @@ void b2CreateBroadPhase( b2BroadPhase* bp )
 	//	fprintf(s_file, "============\n\n");
 	// }
 
-	bp->moveSet = b2CreateSet( 16 );
+	bp->moveSet = b2CreateSet32( 16 );
 	bp->moveArray = b2IntArray_Create( 16 );
 	bp->moveResults = NULL;
 	bp->movePairs = NULL;
+	bp->newContacts = NULL;
 	bp->movePairCapacity = 0;
 	b2AtomicStoreInt(&bp->movePairIndex, 0);
 	bp->pairSet = b2CreateSet( 32 );
+	bp->sweep = ( b2SweepSet ){ 0 };
+	bp->grid = ( b2GridSet ){ 0 };
+	bp->type = type;
+	bp->refitRatio = refitRatio;
 
 	for ( int i = 0; i < b2_bodyTypeCount; ++i )
 	{
 		bp->trees[i] = b2DynamicTree_Create();
+		bp->rebuildAreaRatios[i] = 0.0f;
+		bp->refitSteps[i] = 0;
 	}
+
+	// The static tree is only fully rebuilt by b2World_RebuildStaticTree, after which it is mostly queried
+	b2DynamicTree_EnableWideNodes( bp->trees + b2_staticBody, true );
 }
 
 void b2DestroyBroadPhase( b2BroadPhase* bp )
@@ -55,10 +75,28 @@ void b2DestroyBroadPhase( b2BroadPhase* bp )
 		b2DynamicTree_Destroy( bp->trees + i );
 	}
 
-	b2DestroySet( &bp->moveSet );
+	b2DestroySet32( &bp->moveSet );
 	b2IntArray_Destroy( &bp->moveArray );
 	b2DestroySet( &bp->pairSet );
 
+	b2SweepSet* sweep = &bp->sweep;
+	b2FloatArray_Destroy( &sweep->lowerX );
+	b2FloatArray_Destroy( &sweep->upperX );
+	b2FloatArray_Destroy( &sweep->lowerY );
+	b2FloatArray_Destroy( &sweep->upperY );
+	b2IntArray_Destroy( &sweep->proxyKeys );
+	b2IntArray_Destroy( &sweep->shapeIndices );
+	for ( int i = 0; i < b2_bodyTypeCount; ++i )
+	{
+		b2IntArray_Destroy( sweep->entryIndices + i );
+	}
+
+	b2GridSet* grid = &bp->grid;
+	b2AABBArray_Destroy( &grid->aabbs );
+	b2IntArray_Destroy( &grid->proxyIds );
+	b2IntArray_Destroy( &grid->shapeIndices );
+	b2IntArray_Destroy( &grid->entryIndices );
+
 	memset( bp, 0, sizeof( b2BroadPhase ) );
 
 	// if (s_file != NULL)
@@ -70,7 +108,7 @@ void b2DestroyBroadPhase( b2BroadPhase* bp )
 
 static inline void b2UnBufferMove( b2BroadPhase* bp, int proxyKey )
 {
-	bool found = b2RemoveKey( &bp->moveSet, proxyKey + 1 );
+	bool found = b2RemoveKey32( &bp->moveSet, (uint32_t)proxyKey );
 
 	if ( found )
 	{
@@ -88,12 +126,148 @@ static inline void b2UnBufferMove( b2BroadPhase* bp, int proxyKey )
 	}
 }
 
+static inline void b2SetSweepEntryIndex( b2SweepSet* sweep, int proxyKey, int entryIndex )
+{
+	sweep->entryIndices[B2_PROXY_TYPE( proxyKey )].data[B2_PROXY_ID( proxyKey )] = entryIndex;
+}
+
+// New proxies go at the end and are sorted into place by the next pair update
+static void b2AddSweepEntry( b2SweepSet* sweep, int proxyKey, b2AABB aabb, int shapeIndex )
+{
+	b2IntArray* entryIndices = sweep->entryIndices + B2_PROXY_TYPE( proxyKey );
+	int proxyId = B2_PROXY_ID( proxyKey );
+	while ( entryIndices->count <= proxyId )
+	{
+		b2IntArray_Push( entryIndices, B2_NULL_INDEX );
+	}
+
+	entryIndices->data[proxyId] = sweep->proxyKeys.count;
+	b2FloatArray_Push( &sweep->lowerX, aabb.lowerBound.x );
+	b2FloatArray_Push( &sweep->upperX, aabb.upperBound.x );
+	b2FloatArray_Push( &sweep->lowerY, aabb.lowerBound.y );
+	b2FloatArray_Push( &sweep->upperY, aabb.upperBound.y );
+	b2IntArray_Push( &sweep->proxyKeys, proxyKey );
+	b2IntArray_Push( &sweep->shapeIndices, shapeIndex );
+}
+
+// Level of proxies that are too large for the grid. These query the dynamic tree instead.
+#define B2_GRID_LARGE 0xFF
+
+// A proxy in the grid cell of its lower corner. A copy of the bounds keeps the pair tests local.
+typedef struct b2GridItem
+{
+	b2AABB aabb;
+	int entryIndex;
+	int level;
+	int cellX;
+	int cellY;
+} b2GridItem;
+
+static inline uint32_t b2GridHash( int level, int cellX, int cellY )
+{
+	return ( (uint32_t)cellX * 0x8DA6B343u ) ^ ( (uint32_t)cellY * 0xD8163841u ) ^ ( (uint32_t)level * 0xCB1AB31Fu );
+}
+
+// Far away and NaN bounds are clamped to a valid cell. Rounds down without calling floorf.
+static inline int b2GridCell( float x, float inverseCellSize )
+{
+	float cell = x * inverseCellSize;
+	cell = cell > -1.0e9f ? cell : -1.0e9f;
+	cell = cell < 1.0e9f ? cell : 1.0e9f;
+	int index = (int)cell;
+	return (float)index > cell ? index - 1 : index;
+}
+
+// Partially sorts the values so that the value at index k is the one that would be there if the
+// values were sorted, and returns it
+static float b2SelectFloat( float* values, int count, int k )
+{
+	int left = 0;
+	int right = count - 1;
+	while ( left < right )
+	{
+		float pivot = values[( left + right ) / 2];
+		int i = left;
+		int j = right;
+		while ( i <= j )
+		{
+			while ( values[i] < pivot )
+			{
+				i += 1;
+			}
+			while ( pivot < values[j] )
+			{
+				j -= 1;
+			}
+			if ( i <= j )
+			{
+				float temp = values[i];
+				values[i] = values[j];
+				values[j] = temp;
+				i += 1;
+				j -= 1;
+			}
+		}
+
+		if ( k <= j )
+		{
+			right = j;
+		}
+		else if ( k >= i )
+		{
+			left = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return values[k];
+}
+
+static void b2AddGridEntry( b2GridSet* grid, int proxyId, b2AABB aabb, int shapeIndex )
+{
+	while ( grid->entryIndices.count <= proxyId )
+	{
+		b2IntArray_Push( &grid->entryIndices, B2_NULL_INDEX );
+	}
+
+	grid->entryIndices.data[proxyId] = grid->proxyIds.count;
+	b2AABBArray_Push( &grid->aabbs, aabb );
+	b2IntArray_Push( &grid->proxyIds, proxyId );
+	b2IntArray_Push( &grid->shapeIndices, shapeIndex );
+}
+
+static void b2RemoveGridEntry( b2GridSet* grid, int proxyId )
+{
+	int entryIndex = grid->entryIndices.data[proxyId];
+	grid->entryIndices.data[proxyId] = B2_NULL_INDEX;
+
+	b2AABBArray_RemoveSwap( &grid->aabbs, entryIndex );
+	b2IntArray_RemoveSwap( &grid->shapeIndices, entryIndex );
+	int movedIndex = b2IntArray_RemoveSwap( &grid->proxyIds, entryIndex );
+	if ( movedIndex != B2_NULL_INDEX )
+	{
+		grid->entryIndices.data[grid->proxyIds.data[entryIndex]] = entryIndex;
+	}
+}
+
 int b2BroadPhase_CreateProxy( b2BroadPhase* bp, b2BodyType proxyType, b2AABB aabb, uint64_t categoryBits, int shapeIndex,
 							  bool forcePairCreation )
 {
 	B2_ASSERT( 0 <= proxyType && proxyType < b2_bodyTypeCount );
 	int proxyId = b2DynamicTree_CreateProxy( bp->trees + proxyType, aabb, categoryBits, shapeIndex );
 	int proxyKey = B2_PROXY_KEY( proxyId, proxyType );
+	if ( bp->type == b2_sortAndSweepBroadPhase )
+	{
+		b2AddSweepEntry( &bp->sweep, proxyKey, aabb, shapeIndex );
+	}
+	else if ( bp->type == b2_gridBroadPhase && proxyType == b2_dynamicBody )
+	{
+		b2AddGridEntry( &bp->grid, proxyId, aabb, shapeIndex );
+	}
+
 	if ( proxyType != b2_staticBody || forcePairCreation )
 	{
 		b2BufferMove( bp, proxyKey );
@@ -111,6 +285,19 @@ void b2BroadPhase_DestroyProxy( b2BroadPhase* bp, int proxyKey )
 
 	B2_ASSERT( 0 <= proxyType && proxyType <= b2_bodyTypeCount );
 	b2DynamicTree_DestroyProxy( bp->trees + proxyType, proxyId );
+
+	if ( bp->type == b2_sortAndSweepBroadPhase )
+	{
+		b2SweepSet* sweep = &bp->sweep;
+		int entryIndex = sweep->entryIndices[proxyType].data[proxyId];
+		sweep->proxyKeys.data[entryIndex] = B2_NULL_INDEX;
+		sweep->entryIndices[proxyType].data[proxyId] = B2_NULL_INDEX;
+		sweep->removedCount += 1;
+	}
+	else if ( bp->type == b2_gridBroadPhase && proxyType == b2_dynamicBody )
+	{
+		b2RemoveGridEntry( &bp->grid, proxyId );
+	}
 }
 
 void b2BroadPhase_MoveProxy( b2BroadPhase* bp, int proxyKey, b2AABB aabb )
@@ -156,83 +343,32 @@ typedef struct b2QueryPairContext
 	int queryShapeIndex;
 } b2QueryPairContext;
 
-// This is called from b2DynamicTree::Query when we are gathering pairs.
-static bool b2PairQueryCallback( int proxyId, uint64_t userData, void* context )
+// Applies the shape filters to a candidate pair and appends it to the move result. The candidate
+// has already been de-duplicated against the move set.
+static void b2TryAddPair( b2World* world, b2MoveResult* moveResult, int queryProxyKey, int queryShapeIndex, int proxyKey,
+						  int shapeId )
 {
-	int shapeId = (int)userData;
-
-	b2QueryPairContext* queryContext = context;
-	b2BroadPhase* broadPhase = &queryContext->world->broadPhase;
-
-	int proxyKey = B2_PROXY_KEY( proxyId, queryContext->queryTreeType );
-	int queryProxyKey = queryContext->queryProxyKey;
-
-	// A proxy cannot form a pair with itself.
-	if ( proxyKey == queryContext->queryProxyKey )
-	{
-		return true;
-	}
-
-	b2BodyType treeType = queryContext->queryTreeType;
-	b2BodyType queryProxyType = B2_PROXY_TYPE( queryProxyKey );
-
-	// De-duplication
-	// It is important to prevent duplicate contacts from being created. Ideally I can prevent duplicates
-	// early and in the worker. Most of the time the moveSet contains dynamic and kinematic proxies, but
-	// sometimes it has static proxies.
-
-	// I had an optimization here to skip checking the move set if this is a query into
-	// the static tree. The assumption is that the static proxies are never in the move set
-	// so there is no risk of duplication. However, this is not true with
-	// b2ShapeDef::invokeContactCreation or when a static shape is modified.
-	// There can easily be scenarios where the static proxy is in the moveSet but the dynamic proxy is not.
-	// I could have some flag to indicate that there are any static bodies in the moveSet.
-	
-	// Is this proxy also moving?
-	if ( queryProxyType == b2_dynamicBody)
-	{
-		if ( treeType == b2_dynamicBody && proxyKey < queryProxyKey)
-		{
-			bool moved = b2ContainsKey( &broadPhase->moveSet, proxyKey + 1 );
-			if ( moved )
-			{
-				// Both proxies are moving. Avoid duplicate pairs.
-				return true;
-			}
-		}
-	}
-	else
-	{
-		B2_ASSERT( treeType == b2_dynamicBody );
-		bool moved = b2ContainsKey( &broadPhase->moveSet, proxyKey + 1 );
-		if ( moved )
-		{
-			// Both proxies are moving. Avoid duplicate pairs.
-			return true;
-		}
-	}
+	b2BroadPhase* broadPhase = &world->broadPhase;
 
-	uint64_t pairKey = B2_SHAPE_PAIR_KEY( shapeId, queryContext->queryShapeIndex );
+	uint64_t pairKey = B2_SHAPE_PAIR_KEY( shapeId, queryShapeIndex );
 	if ( b2ContainsKey( &broadPhase->pairSet, pairKey ) )
 	{
 		// contact exists
-		return true;
+		return;
 	}
 
 	int shapeIdA, shapeIdB;
 	if ( proxyKey < queryProxyKey )
 	{
 		shapeIdA = shapeId;
-		shapeIdB = queryContext->queryShapeIndex;
+		shapeIdB = queryShapeIndex;
 	}
 	else
 	{
-		shapeIdA = queryContext->queryShapeIndex;
+		shapeIdA = queryShapeIndex;
 		shapeIdB = shapeId;
 	}
 
-	b2World* world = queryContext->world;
-
 	b2Shape* shapeA = b2ShapeArray_Get( &world->shapes, shapeIdA );
 	b2Shape* shapeB = b2ShapeArray_Get( &world->shapes, shapeIdB );
 
@@ -242,18 +378,18 @@ static bool b2PairQueryCallback( int proxyId, uint64_t userData, void* context )
 	// Are the shapes on the same body?
 	if ( bodyIdA == bodyIdB )
 	{
-		return true;
+		return;
 	}
 
 	// Sensors are handled elsewhere
 	if ( shapeA->sensorIndex != B2_NULL_INDEX || shapeB->sensorIndex != B2_NULL_INDEX )
 	{
-		return true;
+		return;
 	}
 
 	if ( b2ShouldShapesCollide( shapeA->filter, shapeB->filter ) == false )
 	{
-		return true;
+		return;
 	}
 
 	// Does a joint override collision?
@@ -261,19 +397,19 @@ static bool b2PairQueryCallback( int proxyId, uint64_t userData, void* context )
 	b2Body* bodyB = b2BodyArray_Get( &world->bodies, bodyIdB );
 	if ( b2ShouldBodiesCollide( world, bodyA, bodyB ) == false )
 	{
-		return true;
+		return;
 	}
 
 	// Custom user filter
-	b2CustomFilterFcn* customFilterFcn = queryContext->world->customFilterFcn;
+	b2CustomFilterFcn* customFilterFcn = world->customFilterFcn;
 	if ( customFilterFcn != NULL )
 	{
 		b2ShapeId idA = { shapeIdA + 1, world->worldId, shapeA->generation };
 		b2ShapeId idB = { shapeIdB + 1, world->worldId, shapeB->generation };
-		bool shouldCollide = customFilterFcn( idA, idB, queryContext->world->customFilterContext );
+		bool shouldCollide = customFilterFcn( idA, idB, world->customFilterContext );
 		if ( shouldCollide == false )
 		{
-			return true;
+			return;
 		}
 	}
 
@@ -294,8 +430,68 @@ static bool b2PairQueryCallback( int proxyId, uint64_t userData, void* context )
 
 	pair->shapeIndexA = shapeIdA;
 	pair->shapeIndexB = shapeIdB;
-	pair->next = queryContext->moveResult->pairList;
-	queryContext->moveResult->pairList = pair;
+	pair->next = moveResult->pairList;
+	moveResult->pairList = pair;
+}
+
+// This is called from b2DynamicTree::Query when we are gathering pairs.
+static bool b2PairQueryCallback( int proxyId, uint64_t userData, void* context )
+{
+	int shapeId = (int)userData;
+
+	b2QueryPairContext* queryContext = context;
+	b2BroadPhase* broadPhase = &queryContext->world->broadPhase;
+
+	int proxyKey = B2_PROXY_KEY( proxyId, queryContext->queryTreeType );
+	int queryProxyKey = queryContext->queryProxyKey;
+
+	// A proxy cannot form a pair with itself.
+	if ( proxyKey == queryContext->queryProxyKey )
+	{
+		return true;
+	}
+
+	b2BodyType treeType = queryContext->queryTreeType;
+	b2BodyType queryProxyType = B2_PROXY_TYPE( queryProxyKey );
+
+	// De-duplication
+	// It is important to prevent duplicate contacts from being created. Ideally I can prevent duplicates
+	// early and in the worker. Most of the time the moveSet contains dynamic and kinematic proxies, but
+	// sometimes it has static proxies.
+
+	// I had an optimization here to skip checking the move set if this is a query into
+	// the static tree. The assumption is that the static proxies are never in the move set
+	// so there is no risk of duplication. However, this is not true with
+	// b2ShapeDef::invokeContactCreation or when a static shape is modified.
+	// There can easily be scenarios where the static proxy is in the moveSet but the dynamic proxy is not.
+	// I could have some flag to indicate that there are any static bodies in the moveSet.
+	
+	// Is this proxy also moving?
+	if ( queryProxyType == b2_dynamicBody)
+	{
+		if ( treeType == b2_dynamicBody && proxyKey < queryProxyKey)
+		{
+			bool moved = b2ContainsKey32( &broadPhase->moveSet, (uint32_t)proxyKey );
+			if ( moved )
+			{
+				// Both proxies are moving. Avoid duplicate pairs.
+				return true;
+			}
+		}
+	}
+	else
+	{
+		B2_ASSERT( treeType == b2_dynamicBody );
+		bool moved = b2ContainsKey32( &broadPhase->moveSet, (uint32_t)proxyKey );
+		if ( moved )
+		{
+			// Both proxies are moving. Avoid duplicate pairs.
+			return true;
+		}
+	}
+
+	b2TryAddPair( queryContext->world, queryContext->moveResult, queryProxyKey, queryContext->queryShapeIndex, proxyKey,
+				  shapeId );
 
 	// continue the query
 	return true;
@@ -362,6 +558,12 @@ static void b2FindPairsTask( int startIndex, int endIndex, uint32_t threadIndex,
 			stats.leafVisits += statsStatic.leafVisits;
 		}
 
+		// The grid finds the pairs between dynamic proxies
+		if ( proxyType == b2_dynamicBody && bp->type == b2_gridBroadPhase )
+		{
+			continue;
+		}
+
 		// All proxies collide with dynamic proxies
 		// Using B2_DEFAULT_MASK_BITS so that b2Filter::groupIndex works.
 		queryContext.queryTreeType = b2_dynamicBody;
@@ -373,99 +575,807 @@ static void b2FindPairsTask( int startIndex, int endIndex, uint32_t threadIndex,
 	b2TracyCZoneEnd( pair_task );
 }
 
-void b2UpdateBroadPhasePairs( b2World* world )
+// Drops the slots of destroyed proxies, keeping the sorted order
+static void b2CompactSweepSet( b2SweepSet* sweep )
 {
-	b2BroadPhase* bp = &world->broadPhase;
-
-	int moveCount = bp->moveArray.count;
-	B2_ASSERT( moveCount == (int)bp->moveSet.count );
-
-	if ( moveCount == 0 )
+	if ( sweep->removedCount == 0 )
 	{
 		return;
 	}
 
-	b2TracyCZoneNC( update_pairs, "Find Pairs", b2_colorMediumSlateBlue, true );
-
-	b2ArenaAllocator* alloc = &world->arena;
+	float* lowerX = sweep->lowerX.data;
+	float* upperX = sweep->upperX.data;
+	float* lowerY = sweep->lowerY.data;
+	float* upperY = sweep->upperY.data;
+	int* proxyKeys = sweep->proxyKeys.data;
+	int* shapeIndices = sweep->shapeIndices.data;
 
-	// todo these could be in the step context
-	bp->moveResults = b2AllocateArenaItem( alloc, moveCount * sizeof( b2MoveResult ), "move results" );
-	bp->movePairCapacity = 16 * moveCount;
-	bp->movePairs = b2AllocateArenaItem( alloc, bp->movePairCapacity * sizeof( b2MovePair ), "move pairs" );
-	b2AtomicStoreInt(&bp->movePairIndex, 0);
+	int count = sweep->proxyKeys.count;
+	int keepCount = 0;
+	for ( int i = 0; i < count; ++i )
+	{
+		int proxyKey = proxyKeys[i];
+		if ( proxyKey == B2_NULL_INDEX )
+		{
+			continue;
+		}
 
-#if B2_SNOOP_TABLE_COUNTERS
-	extern b2AtomicInt b2_probeCount;
-	b2AtomicStoreInt(&b2_probeCount, 0);
-#endif
+		if ( keepCount != i )
+		{
+			lowerX[keepCount] = lowerX[i];
+			upperX[keepCount] = upperX[i];
+			lowerY[keepCount] = lowerY[i];
+			upperY[keepCount] = upperY[i];
+			proxyKeys[keepCount] = proxyKey;
+			shapeIndices[keepCount] = shapeIndices[i];
+			b2SetSweepEntryIndex( sweep, proxyKey, keepCount );
+		}
 
-	int minRange = 64;
-	void* userPairTask = world->enqueueTaskFcn( &b2FindPairsTask, moveCount, minRange, world, world->userTaskContext );
-	if (userPairTask != NULL)
-	{
-		world->finishTaskFcn( userPairTask, world->userTaskContext );
-		world->taskCount += 1;
+		keepCount += 1;
 	}
 
-	// todo_erin could start tree rebuild here
-
-	b2TracyCZoneNC( create_contacts, "Create Contacts", b2_colorCoral, true );
+	sweep->lowerX.count = keepCount;
+	sweep->upperX.count = keepCount;
+	sweep->lowerY.count = keepCount;
+	sweep->upperY.count = keepCount;
+	sweep->proxyKeys.count = keepCount;
+	sweep->shapeIndices.count = keepCount;
+	sweep->removedCount = 0;
+}
 
-	// Single-threaded work
-	// - Clear move flags
-	// - Create contacts in deterministic order
-	for ( int i = 0; i < moveCount; ++i )
+// Insertion sort on the lower x bound. Proxies only move a little between steps, so the order is
+// nearly sorted and this is close to linear. The sort is stable, which keeps the pair order deterministic.
+static void b2SortSweepSet( b2SweepSet* sweep )
+{
+	float* lowerX = sweep->lowerX.data;
+	float* upperX = sweep->upperX.data;
+	float* lowerY = sweep->lowerY.data;
+	float* upperY = sweep->upperY.data;
+	int* proxyKeys = sweep->proxyKeys.data;
+	int* shapeIndices = sweep->shapeIndices.data;
+
+	int count = sweep->proxyKeys.count;
+	for ( int i = 1; i < count; ++i )
 	{
-		b2MoveResult* result = bp->moveResults + i;
-		b2MovePair* pair = result->pairList;
-		while ( pair != NULL )
+		float key = lowerX[i];
+		if ( lowerX[i - 1] <= key )
 		{
-			int shapeIdA = pair->shapeIndexA;
-			int shapeIdB = pair->shapeIndexB;
-
-			// if (s_file != NULL)
-			//{
-			//	fprintf(s_file, "%d %d\n", shapeIdA, shapeIdB);
-			// }
-
-			b2Shape* shapeA = b2ShapeArray_Get( &world->shapes, shapeIdA );
-			b2Shape* shapeB = b2ShapeArray_Get( &world->shapes, shapeIdB );
+			continue;
+		}
 
-			b2CreateContact( world, shapeA, shapeB );
+		float ux = upperX[i];
+		float ly = lowerY[i];
+		float uy = upperY[i];
+		int proxyKey = proxyKeys[i];
+		int shapeIndex = shapeIndices[i];
 
-			if ( pair->heap )
-			{
-				b2MovePair* temp = pair;
-				pair = pair->next;
-				b2Free( temp, sizeof( b2MovePair ) );
-			}
-			else
-			{
-				pair = pair->next;
-			}
+		int j = i;
+		while ( j > 0 && lowerX[j - 1] > key )
+		{
+			lowerX[j] = lowerX[j - 1];
+			upperX[j] = upperX[j - 1];
+			lowerY[j] = lowerY[j - 1];
+			upperY[j] = upperY[j - 1];
+			proxyKeys[j] = proxyKeys[j - 1];
+			shapeIndices[j] = shapeIndices[j - 1];
+			b2SetSweepEntryIndex( sweep, proxyKeys[j], j );
+			j -= 1;
 		}
 
-		// if (s_file != NULL)
-		//{
-		//	fprintf(s_file, "\n");
-		// }
+		lowerX[j] = key;
+		upperX[j] = ux;
+		lowerY[j] = ly;
+		upperY[j] = uy;
+		proxyKeys[j] = proxyKey;
+		shapeIndices[j] = shapeIndex;
+		b2SetSweepEntryIndex( sweep, proxyKey, j );
 	}
 
-	// if (s_file != NULL)
-	//{
-	//	fprintf(s_file, "count = %d\n\n", pairCount);
-	// }
+	// Pad so the sweep can always load four entries. The lower bound sentinel ends every sweep.
+	b2FloatArray_Reserve( &sweep->lowerX, count + 4 );
+	b2FloatArray_Reserve( &sweep->upperX, count + 4 );
+	b2FloatArray_Reserve( &sweep->lowerY, count + 4 );
+	b2FloatArray_Reserve( &sweep->upperY, count + 4 );
+	for ( int i = count; i < count + 4; ++i )
+	{
+		sweep->lowerX.data[i] = FLT_MAX;
+		sweep->upperX.data[i] = -FLT_MAX;
+		sweep->lowerY.data[i] = FLT_MAX;
+		sweep->upperY.data[i] = -FLT_MAX;
+	}
+}
+
+// Tests entries j to j + 3 against a box. The x result only checks the lower bound because the entries
+// are sorted, so a clear bit ends the sweep. The y result is the full interval overlap test.
+static int b2SweepOverlapMask( const b2SweepSet* sweep, int j, float upperX, float lowerY, float upperY, int* xMask )
+{
+	const float* lx = sweep->lowerX.data + j;
+	const float* ly = sweep->lowerY.data + j;
+	const float* uy = sweep->upperY.data + j;
+
+#if defined( B2_SIMD_AVX512 ) || defined( B2_SIMD_AVX2 ) || defined( B2_SIMD_SSE2 )
+	__m128 bx = _mm_cmple_ps( _mm_loadu_ps( lx ), _mm_set1_ps( upperX ) );
+	__m128 by = _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( ly ), _mm_set1_ps( upperY ) ),
+							_mm_cmple_ps( _mm_set1_ps( lowerY ), _mm_loadu_ps( uy ) ) );
+	*xMask = _mm_movemask_ps( bx );
+	return _mm_movemask_ps( _mm_and_ps( bx, by ) );
+#elif defined( B2_SIMD_NEON )
+	static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+	uint32x4_t lanes = vld1q_u32( laneBits );
+	uint32x4_t bx = vcleq_f32( vld1q_f32( lx ), vdupq_n_f32( upperX ) );
+	uint32x4_t by =
+		vandq_u32( vcleq_f32( vld1q_f32( ly ), vdupq_n_f32( upperY ) ), vcleq_f32( vdupq_n_f32( lowerY ), vld1q_f32( uy ) ) );
+	uint32x4_t xBits = vandq_u32( bx, lanes );
+	uint32x4_t bits = vandq_u32( by, xBits );
+	uint32x2_t xPair = vorr_u32( vget_low_u32( xBits ), vget_high_u32( xBits ) );
+	uint32x2_t pair = vorr_u32( vget_low_u32( bits ), vget_high_u32( bits ) );
+	*xMask = (int)( vget_lane_u32( xPair, 0 ) | vget_lane_u32( xPair, 1 ) );
+	return (int)( vget_lane_u32( pair, 0 ) | vget_lane_u32( pair, 1 ) );
+#else
+	int bx = 0, mask = 0;
+	for ( int k = 0; k < 4; ++k )
+	{
+		if ( lx[k] <= upperX )
+		{
+			bx |= 1 << k;
+			if ( ly[k] <= upperY && lowerY <= uy[k] )
+			{
+				mask |= 1 << k;
+			}
+		}
+	}
+	*xMask = bx;
+	return mask;
+#endif
+}
+
+// Gives an overlapping pair of sorted entries to the same proxy the tree query would have used,
+// so the pair is reported once and passes the same filters.
+static void b2SweepPair( b2World* world, b2MoveResult* moveResult, int entryA, int entryB )
+{
+	b2BroadPhase* bp = &world->broadPhase;
+	const b2SweepSet* sweep = &bp->sweep;
+
+	bool movedA = sweep->moved[entryA];
+	bool movedB = sweep->moved[entryB];
+	if ( movedA == false && movedB == false )
+	{
+		return;
+	}
+
+	int proxyKeyA = sweep->proxyKeys.data[entryA];
+	int proxyKeyB = sweep->proxyKeys.data[entryB];
+	bool dynamicA = B2_PROXY_TYPE( proxyKeyA ) == b2_dynamicBody;
+	bool dynamicB = B2_PROXY_TYPE( proxyKeyB ) == b2_dynamicBody;
+
+	// Only dynamic proxies collide with kinematic and static proxies
+	if ( dynamicA == false && dynamicB == false )
+	{
+		return;
+	}
+
+	// A moved dynamic proxy queries all trees, other moved proxies only query the dynamic tree. Two
+	// moved dynamic proxies leave the pair to the one with the smaller key.
+	bool queryA;
+	if ( dynamicA && dynamicB )
+	{
+		queryA = movedA && ( movedB == false || proxyKeyA < proxyKeyB );
+	}
+	else if ( dynamicA )
+	{
+		queryA = movedA;
+	}
+	else
+	{
+		queryA = movedB == false;
+	}
+
+	int queryEntry = queryA ? entryA : entryB;
+	int otherEntry = queryA ? entryB : entryA;
+	int queryProxyKey = sweep->proxyKeys.data[queryEntry];
+	int proxyKey = sweep->proxyKeys.data[otherEntry];
+
+	// The tree query skips proxies without category bits
+	if ( b2DynamicTree_GetCategoryBits( bp->trees + B2_PROXY_TYPE( proxyKey ), B2_PROXY_ID( proxyKey ) ) == 0 )
+	{
+		return;
+	}
+
+	b2TryAddPair( world, moveResult, queryProxyKey, sweep->shapeIndices.data[queryEntry], proxyKey,
+				  sweep->shapeIndices.data[otherEntry] );
+}
+
+// Sweeps each sorted entry against the entries after it that start before it ends on the x-axis.
+// The pairs go into the result of the first entry so the order does not depend on the task split.
+static void b2SweepPairsTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	b2TracyCZoneNC( sweep_task, "Sweep", b2_colorMediumSlateBlue, true );
+
+	B2_UNUSED( threadIndex );
+
+	b2World* world = context;
+	b2BroadPhase* bp = &world->broadPhase;
+	const b2SweepSet* sweep = &bp->sweep;
+	int count = sweep->proxyKeys.count;
+
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2MoveResult* moveResult = bp->moveResults + i;
+		moveResult->pairList = NULL;
+
+		float upperX = sweep->upperX.data[i];
+		float lowerY = sweep->lowerY.data[i];
+		float upperY = sweep->upperY.data[i];
+
+		for ( int j = i + 1; j < count; j += 4 )
+		{
+			int xMask;
+			int mask = b2SweepOverlapMask( sweep, j, upperX, lowerY, upperY, &xMask );
+			while ( mask != 0 )
+			{
+				int k = (int)b2CTZ32( (uint32_t)mask );
+				mask &= mask - 1;
+				b2SweepPair( world, moveResult, i, j + k );
+			}
+
+			if ( xMask != 0xF )
+			{
+				break;
+			}
+		}
+	}
+
+	b2TracyCZoneEnd( sweep_task );
+}
+
+// Brings the sweep set up to date with the move buffer and flags the moved entries
+static void b2PrepareSweepSet( b2BroadPhase* bp, b2ArenaAllocator* alloc )
+{
+	b2SweepSet* sweep = &bp->sweep;
+	b2CompactSweepSet( sweep );
+
+	int moveCount = bp->moveArray.count;
+	for ( int i = 0; i < moveCount; ++i )
+	{
+		int proxyKey = bp->moveArray.data[i];
+		if ( proxyKey == B2_NULL_INDEX )
+		{
+			continue;
+		}
+
+		b2BodyType proxyType = B2_PROXY_TYPE( proxyKey );
+		int proxyId = B2_PROXY_ID( proxyKey );
+		int entryIndex = sweep->entryIndices[proxyType].data[proxyId];
+		b2AABB fatAABB = b2DynamicTree_GetAABB( bp->trees + proxyType, proxyId );
+		sweep->lowerX.data[entryIndex] = fatAABB.lowerBound.x;
+		sweep->upperX.data[entryIndex] = fatAABB.upperBound.x;
+		sweep->lowerY.data[entryIndex] = fatAABB.lowerBound.y;
+		sweep->upperY.data[entryIndex] = fatAABB.upperBound.y;
+	}
+
+	b2SortSweepSet( sweep );
+
+	int count = sweep->proxyKeys.count;
+	sweep->moved = b2AllocateArenaItem( alloc, count * sizeof( bool ), "sweep moved" );
+	memset( sweep->moved, 0, count * sizeof( bool ) );
+	for ( int i = 0; i < moveCount; ++i )
+	{
+		int proxyKey = bp->moveArray.data[i];
+		if ( proxyKey != B2_NULL_INDEX )
+		{
+			sweep->moved[sweep->entryIndices[B2_PROXY_TYPE( proxyKey )].data[B2_PROXY_ID( proxyKey )]] = true;
+		}
+	}
+}
+
+// Rebuilds the hashed grid in the arena. The base cell size follows the median extent and larger proxies go
+// up one level per doubling of size, so no proxy is larger than the cells of its level. Each proxy goes
+// into the cell of its lower corner. The buckets are filled by a counting sort, keeping the entries of
+// each bucket in entry order.
+static void b2PrepareGrid( b2BroadPhase* bp, b2ArenaAllocator* alloc )
+{
+	b2GridSet* grid = &bp->grid;
+	int count = grid->proxyIds.count;
+	b2AABB* aabbs = grid->aabbs.data;
+
+	// 1) refresh the moved proxies
+	grid->moved = b2AllocateArenaItem( alloc, count * sizeof( bool ), "grid moved" );
+	memset( grid->moved, 0, count * sizeof( bool ) );
+
+	int moveCount = bp->moveArray.count;
+	for ( int i = 0; i < moveCount; ++i )
+	{
+		int proxyKey = bp->moveArray.data[i];
+		if ( proxyKey == B2_NULL_INDEX || B2_PROXY_TYPE( proxyKey ) != b2_dynamicBody )
+		{
+			continue;
+		}
+
+		int proxyId = B2_PROXY_ID( proxyKey );
+		int entryIndex = grid->entryIndices.data[proxyId];
+		aabbs[entryIndex] = b2DynamicTree_GetAABB( bp->trees + b2_dynamicBody, proxyId );
+		grid->moved[entryIndex] = true;
+	}
+
+	// 2) cell size from the median extent
+	float* extents = b2AllocateArenaItem( alloc, count * sizeof( float ), "grid extents" );
+	for ( int i = 0; i < count; ++i )
+	{
+		b2AABB a = aabbs[i];
+		float extent = b2MaxFloat( a.upperBound.x - a.lowerBound.x, a.upperBound.y - a.lowerBound.y );
+
+		// Keep NaN out of the selection
+		extents[i] = extent > 0.0f ? extent : 0.0f;
+	}
+
+	// Slightly larger than the median so that a typical proxy fits level 0 with room for rounding
+	float cellSize = count > 0 ? 1.25f * b2SelectFloat( extents, count, count / 2 ) : 1.0f;
+	b2FreeArenaItem( alloc, extents );
+
+	if ( ( 0.0f < cellSize && cellSize < 1.0e6f * b2_lengthUnitsPerMeter ) == false )
+	{
+		cellSize = b2_lengthUnitsPerMeter;
+	}
+
+	// A proxy must be a bit smaller than the cells of its level, otherwise rounding the cell coordinates
+	// could put two overlapping proxies two cells apart
+	float fitSizes[B2_GRID_LEVEL_COUNT];
+	for ( int level = 0; level < B2_GRID_LEVEL_COUNT; ++level )
+	{
+		fitSizes[level] = 0.99f * cellSize;
+		grid->inverseCellSizes[level] = 1.0f / cellSize;
+		cellSize *= 2.0f;
+	}
+
+	// 3) level and bucket of each proxy
+	grid->levels = b2AllocateArenaItem( alloc, count * sizeof( uint8_t ), "grid levels" );
+	grid->levelMask = 0;
+	grid->largeCount = 0;
+
+	int bucketCount = b2RoundUpPowerOf2( b2MaxInt( count, 16 ) );
+	grid->bucketMask = (uint32_t)bucketCount - 1;
+	grid->bucketStarts = b2AllocateArenaItem( alloc, ( bucketCount + 1 ) * sizeof( int ), "grid buckets" );
+	int* bucketStarts = grid->bucketStarts;
+	memset( bucketStarts, 0, ( bucketCount + 1 ) * sizeof( int ) );
+
+	int* buckets = b2AllocateArenaItem( alloc, count * sizeof( int ), "grid proxy buckets" );
+	int itemCount = 0;
+	for ( int i = 0; i < count; ++i )
+	{
+		b2AABB a = aabbs[i];
+		float extent = b2MaxFloat( a.upperBound.x - a.lowerBound.x, a.upperBound.y - a.lowerBound.y );
+
+		int level = 0;
+		while ( level < B2_GRID_LEVEL_COUNT - 1 && extent > fitSizes[level] )
+		{
+			level += 1;
+		}
+
+		if ( extent > fitSizes[level] )
+		{
+			grid->levels[i] = B2_GRID_LARGE;
+			grid->largeCount += 1;
+			buckets[i] = B2_NULL_INDEX;
+			continue;
+		}
+
+		grid->levels[i] = (uint8_t)level;
+		grid->levelMask |= 1 << level;
+
+		float inverseSize = grid->inverseCellSizes[level];
+		int x = b2GridCell( a.lowerBound.x, inverseSize );
+		int y = b2GridCell( a.lowerBound.y, inverseSize );
+		int bucket = (int)( b2GridHash( level, x, y ) & grid->bucketMask );
+		buckets[i] = bucket;
+		bucketStarts[bucket + 1] += 1;
+		itemCount += 1;
+	}
+
+	// 4) counting sort of the proxies into buckets
+	for ( int bucket = 0; bucket < bucketCount; ++bucket )
+	{
+		bucketStarts[bucket + 1] += bucketStarts[bucket];
+	}
+
+	b2GridItem* items = b2AllocateArenaItem( alloc, itemCount * sizeof( b2GridItem ), "grid items" );
+	for ( int i = 0; i < count; ++i )
+	{
+		int bucket = buckets[i];
+		if ( bucket == B2_NULL_INDEX )
+		{
+			continue;
+		}
+
+		b2AABB a = aabbs[i];
+		int level = grid->levels[i];
+		float inverseSize = grid->inverseCellSizes[level];
+		items[bucketStarts[bucket]++] =
+			( b2GridItem ){ a, i, level, b2GridCell( a.lowerBound.x, inverseSize ), b2GridCell( a.lowerBound.y, inverseSize ) };
+	}
+
+	// The scatter advanced each start to the end of its bucket
+	for ( int bucket = bucketCount; bucket > 0; --bucket )
+	{
+		bucketStarts[bucket] = bucketStarts[bucket - 1];
+	}
+	bucketStarts[0] = 0;
+
+	grid->items = items;
+	grid->proxyBuckets = buckets;
+}
+
+static void b2FreeGrid( b2GridSet* grid, b2ArenaAllocator* alloc )
+{
+	b2FreeArenaItem( alloc, grid->items );
+	b2FreeArenaItem( alloc, grid->proxyBuckets );
+	b2FreeArenaItem( alloc, grid->bucketStarts );
+	b2FreeArenaItem( alloc, grid->levels );
+	b2FreeArenaItem( alloc, grid->moved );
+	grid->items = NULL;
+	grid->proxyBuckets = NULL;
+	grid->bucketStarts = NULL;
+	grid->levels = NULL;
+	grid->moved = NULL;
+}
+
+// Gives an overlapping pair of dynamic proxies to the proxy the tree query would have used
+static void b2GridPair( b2World* world, b2MoveResult* moveResult, int entryA, int entryB )
+{
+	b2BroadPhase* bp = &world->broadPhase;
+	const b2GridSet* grid = &bp->grid;
+
+	bool movedA = grid->moved[entryA];
+	bool movedB = grid->moved[entryB];
+	if ( movedA == false && movedB == false )
+	{
+		return;
+	}
+
+	int proxyIdA = grid->proxyIds.data[entryA];
+	int proxyIdB = grid->proxyIds.data[entryB];
+	bool queryA = movedA && ( movedB == false || proxyIdA < proxyIdB );
+
+	int queryEntry = queryA ? entryA : entryB;
+	int otherEntry = queryA ? entryB : entryA;
+	int queryProxyId = grid->proxyIds.data[queryEntry];
+	int proxyId = grid->proxyIds.data[otherEntry];
+
+	// The tree query skips proxies without category bits
+	if ( b2DynamicTree_GetCategoryBits( bp->trees + b2_dynamicBody, proxyId ) == 0 )
+	{
+		return;
+	}
+
+	b2TryAddPair( world, moveResult, B2_PROXY_KEY( queryProxyId, b2_dynamicBody ), grid->shapeIndices.data[queryEntry],
+				  B2_PROXY_KEY( proxyId, b2_dynamicBody ), grid->shapeIndices.data[otherEntry] );
+}
+
+typedef struct b2GridQueryContext
+{
+	b2World* world;
+	b2MoveResult* moveResult;
+	int entryIndex;
+} b2GridQueryContext;
+
+// Pairs of a proxy that is too large for the grid
+static bool b2GridQueryCallback( int proxyId, uint64_t userData, void* context )
+{
+	B2_UNUSED( userData );
+
+	b2GridQueryContext* queryContext = context;
+	const b2GridSet* grid = &queryContext->world->broadPhase.grid;
+	int entryIndex = grid->entryIndices.data[proxyId];
+
+	// Two large proxies find each other, keep one
+	if ( entryIndex == queryContext->entryIndex ||
+		 ( grid->levels[entryIndex] == B2_GRID_LARGE && entryIndex < queryContext->entryIndex ) )
+	{
+		return true;
+	}
+
+	b2GridPair( queryContext->world, queryContext->moveResult, queryContext->entryIndex, entryIndex );
+	return true;
+}
+
+// Pairs the items of one cell with the items of a cell on the same level
+static void b2GridCellPairs( b2World* world, b2MoveResult* moveResult, const b2GridItem* a, int level, int cellX, int cellY )
+{
+	const b2GridSet* grid = &world->broadPhase.grid;
+	const b2GridItem* items = grid->items;
+	uint32_t bucket = b2GridHash( level, cellX, cellY ) & grid->bucketMask;
+
+	int itemEnd = grid->bucketStarts[bucket + 1];
+	for ( int k = grid->bucketStarts[bucket]; k < itemEnd; ++k )
+	{
+		const b2GridItem* b = items + k;
+		if ( b->cellX != cellX || b->cellY != cellY || b->level != level )
+		{
+			continue;
+		}
+
+		if ( b2AABB_Overlaps( a->aabb, b->aabb ) )
+		{
+			b2GridPair( world, moveResult, a->entryIndex, b->entryIndex );
+		}
+	}
+}
+
+// Pairs the proxies of a level. No proxy is larger than a cell, so overlapping proxies have their lower
+// corners in the same or adjacent cells. Each item checks the later items of its own cell and four of
+// its eight neighbors, which reports every pair once.
+static void b2GridCellPairsTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	b2TracyCZoneNC( grid_task, "Grid Cells", b2_colorMediumSlateBlue, true );
+
+	B2_UNUSED( threadIndex );
+
+	b2World* world = context;
+	b2BroadPhase* bp = &world->broadPhase;
+	const b2GridSet* grid = &bp->grid;
+	const b2GridItem* items = grid->items;
+	const int* bucketStarts = grid->bucketStarts;
+
+	// The bucket results follow the results of the moved proxies
+	b2MoveResult* moveResults = bp->moveResults + bp->moveArray.count;
+
+	for ( int bucket = startIndex; bucket < endIndex; ++bucket )
+	{
+		b2MoveResult* moveResult = moveResults + bucket;
+		moveResult->pairList = NULL;
+
+		int itemEnd = bucketStarts[bucket + 1];
+		for ( int k = bucketStarts[bucket]; k < itemEnd; ++k )
+		{
+			const b2GridItem* a = items + k;
+
+			for ( int m = k + 1; m < itemEnd; ++m )
+			{
+				const b2GridItem* b = items + m;
+				if ( b->cellX != a->cellX || b->cellY != a->cellY || b->level != a->level )
+				{
+					continue;
+				}
+
+				if ( b2AABB_Overlaps( a->aabb, b->aabb ) )
+				{
+					b2GridPair( world, moveResult, a->entryIndex, b->entryIndex );
+				}
+			}
+
+			b2GridCellPairs( world, moveResult, a, a->level, a->cellX + 1, a->cellY );
+			b2GridCellPairs( world, moveResult, a, a->level, a->cellX - 1, a->cellY + 1 );
+			b2GridCellPairs( world, moveResult, a, a->level, a->cellX, a->cellY + 1 );
+			b2GridCellPairs( world, moveResult, a, a->level, a->cellX + 1, a->cellY + 1 );
+		}
+	}
+
+	b2TracyCZoneEnd( grid_task );
+}
+
+// Pairs across levels. Each proxy looks up the 3x3 cells around its lower corner on the levels above its
+// own. Proxies too large for the grid query the dynamic tree instead.
+static void b2GridLevelPairsTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	b2TracyCZoneNC( grid_task, "Grid Levels", b2_colorMediumSlateBlue, true );
+
+	B2_UNUSED( threadIndex );
+
+	b2World* world = context;
+	b2BroadPhase* bp = &world->broadPhase;
+	const b2GridSet* grid = &bp->grid;
+	const b2AABB* aabbs = grid->aabbs.data;
+
+	// These results follow the bucket results
+	b2MoveResult* moveResults = bp->moveResults + bp->moveArray.count + grid->bucketMask + 1;
+
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2MoveResult* moveResult = moveResults + i;
+		moveResult->pairList = NULL;
+
+		b2GridItem a = { aabbs[i], i, 0, 0, 0 };
+		int baseLevel = grid->levels[i];
+		if ( baseLevel == B2_GRID_LARGE )
+		{
+			b2GridQueryContext queryContext = { world, moveResult, i };
+			b2DynamicTree_Query( bp->trees + b2_dynamicBody, a.aabb, B2_DEFAULT_MASK_BITS, b2GridQueryCallback, &queryContext );
+			continue;
+		}
+
+		uint32_t levelMask = (uint32_t)grid->levelMask >> ( baseLevel + 1 ) << ( baseLevel + 1 );
+		while ( levelMask != 0 )
+		{
+			int level = (int)b2CTZ32( levelMask );
+			levelMask &= levelMask - 1;
+
+			float inverseSize = grid->inverseCellSizes[level];
+			int x = b2GridCell( a.aabb.lowerBound.x, inverseSize );
+			int y = b2GridCell( a.aabb.lowerBound.y, inverseSize );
+			for ( int dy = -1; dy <= 1; ++dy )
+			{
+				for ( int dx = -1; dx <= 1; ++dx )
+				{
+					b2GridCellPairs( world, moveResult, &a, level, x + dx, y + dy );
+				}
+			}
+		}
+	}
+
+	b2TracyCZoneEnd( grid_task );
+}
+
+static void b2InitializeContactsTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	b2TracyCZoneNC( init_contacts, "Init Contacts", b2_colorCoral, true );
+
+	B2_UNUSED( threadIndex );
+
+	b2World* world = context;
+	const b2NewContact* newContacts = world->broadPhase.newContacts;
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2InitializeContact( world, newContacts + i );
+	}
+
+	b2TracyCZoneEnd( init_contacts );
+}
+
+void b2UpdateBroadPhasePairs( b2World* world )
+{
+	b2BroadPhase* bp = &world->broadPhase;
+
+	int moveCount = bp->moveArray.count;
+	B2_ASSERT( moveCount == (int)bp->moveSet.count );
+
+	if ( moveCount == 0 )
+	{
+		return;
+	}
+
+	b2TracyCZoneNC( update_pairs, "Find Pairs", b2_colorMediumSlateBlue, true );
+
+	b2ArenaAllocator* alloc = &world->arena;
+
+	// With sort and sweep there is a result for each sorted proxy instead of each moved proxy. The grid
+	// adds a result for each bucket and, when there are pairs across levels, for each dynamic proxy.
+	int resultCount = moveCount;
+	int bucketCount = 0;
+	int gridCount = 0;
+	b2TaskCallback* pairTask = b2FindPairsTask;
+	if ( bp->type == b2_sortAndSweepBroadPhase )
+	{
+		b2PrepareSweepSet( bp, alloc );
+		resultCount = bp->sweep.proxyKeys.count;
+		pairTask = b2SweepPairsTask;
+	}
+	else if ( bp->type == b2_gridBroadPhase )
+	{
+		b2PrepareGrid( bp, alloc );
+
+		b2GridSet* grid = &bp->grid;
+		bucketCount = (int)grid->bucketMask + 1;
+		bool singleLevel = ( grid->levelMask & ( grid->levelMask - 1 ) ) == 0;
+		gridCount = singleLevel && grid->largeCount == 0 ? 0 : grid->proxyIds.count;
+	}
+
+	// todo these could be in the step context
+	bp->moveResults = b2AllocateArenaItem( alloc, ( resultCount + bucketCount + gridCount ) * sizeof( b2MoveResult ),
+											 "move results" );
+	bp->movePairCapacity = 16 * moveCount;
+	bp->movePairs = b2AllocateArenaItem( alloc, bp->movePairCapacity * sizeof( b2MovePair ), "move pairs" );
+	b2AtomicStoreInt(&bp->movePairIndex, 0);
+
+#if B2_SNOOP_TABLE_COUNTERS
+	extern b2AtomicInt b2_probeCount;
+	b2AtomicStoreInt(&b2_probeCount, 0);
+#endif
+
+	int minRange = 64;
+	void* userPairTask = world->enqueueTaskFcn( pairTask, resultCount, minRange, world, world->userTaskContext );
+	if (userPairTask != NULL)
+	{
+		world->finishTaskFcn( userPairTask, world->userTaskContext );
+		world->taskCount += 1;
+	}
+
+	if ( bucketCount > 0 )
+	{
+		void* userCellTask =
+			world->enqueueTaskFcn( &b2GridCellPairsTask, bucketCount, 4 * minRange, world, world->userTaskContext );
+		if ( userCellTask != NULL )
+		{
+			world->finishTaskFcn( userCellTask, world->userTaskContext );
+			world->taskCount += 1;
+		}
+	}
+
+	if ( gridCount > 0 )
+	{
+		void* userLevelTask = world->enqueueTaskFcn( &b2GridLevelPairsTask, gridCount, minRange, world, world->userTaskContext );
+		if ( userLevelTask != NULL )
+		{
+			world->finishTaskFcn( userLevelTask, world->userTaskContext );
+			world->taskCount += 1;
+		}
+	}
+
+	// todo_erin could start tree rebuild here
+
+	b2TracyCZoneNC( create_contacts, "Create Contacts", b2_colorCoral, true );
+
+	// Single-threaded work
+	// - Reserve contacts in deterministic order. This allocates the contact ids and links the contacts
+	//   into the body contact lists and the pair set.
+	int pairCount = b2AtomicLoadInt( &bp->movePairIndex );
+	bp->newContacts = b2AllocateArenaItem( alloc, pairCount * sizeof( b2NewContact ), "new contacts" );
+	int newContactCount = 0;
+	for ( int i = 0; i < resultCount + bucketCount + gridCount; ++i )
+	{
+		b2MoveResult* result = bp->moveResults + i;
+		b2MovePair* pair = result->pairList;
+		while ( pair != NULL )
+		{
+			int shapeIdA = pair->shapeIndexA;
+			int shapeIdB = pair->shapeIndexB;
+
+			b2Shape* shapeA = b2ShapeArray_Get( &world->shapes, shapeIdA );
+			b2Shape* shapeB = b2ShapeArray_Get( &world->shapes, shapeIdB );
+
+			if ( b2ReserveContact( world, shapeA, shapeB, bp->newContacts + newContactCount ) )
+			{
+				newContactCount += 1;
+			}
+
+			if ( pair->heap )
+			{
+				b2MovePair* temp = pair;
+				pair = pair->next;
+				b2Free( temp, sizeof( b2MovePair ) );
+			}
+			else
+			{
+				pair = pair->next;
+			}
+		}
+	}
+
+	B2_ASSERT( newContactCount <= pairCount );
+
+	// The rest of contact creation only touches the new contacts. This matters when many contacts begin
+	// in one step, like after an explosion.
+	if ( newContactCount > 0 )
+	{
+		void* userContactTask =
+			world->enqueueTaskFcn( &b2InitializeContactsTask, newContactCount, minRange, world, world->userTaskContext );
+		if ( userContactTask != NULL )
+		{
+			world->finishTaskFcn( userContactTask, world->userTaskContext );
+			world->taskCount += 1;
+		}
+	}
+
+	b2FreeArenaItem( alloc, bp->newContacts );
+	bp->newContacts = NULL;
 
 	// Reset move buffer
 	b2IntArray_Clear( &bp->moveArray );
-	b2ClearSet( &bp->moveSet );
+	b2ClearSet32( &bp->moveSet );
 
 	b2FreeArenaItem( alloc, bp->movePairs );
 	bp->movePairs = NULL;
 	b2FreeArenaItem( alloc, bp->moveResults );
 	bp->moveResults = NULL;
 
+	if ( bp->type == b2_sortAndSweepBroadPhase )
+	{
+		b2FreeArenaItem( alloc, bp->sweep.moved );
+		bp->sweep.moved = NULL;
+	}
+	else if ( bp->type == b2_gridBroadPhase )
+	{
+		b2FreeGrid( &bp->grid, alloc );
+	}
+
 	b2ValidateSolverSets( world );
 
 	b2TracyCZoneEnd( create_contacts );
@@ -485,10 +1395,46 @@ bool b2BroadPhase_TestOverlap( const b2BroadPhase* bp, int proxyKeyA, int proxyK
 	return b2AABB_Overlaps( aabbA, aabbB );
 }
 
-void b2BroadPhase_RebuildTrees( b2BroadPhase* bp )
+// The area ratio visits every node, so refit trees only check it this often
+#define B2_REFIT_CHECK_INTERVAL 8
+
+void b2BroadPhase_RebuildTrees( b2BroadPhase* bp, b2EnqueueTaskCallback* enqueueTask, b2FinishTaskCallback* finishTask,
+								void* userTaskContext )
 {
-	b2DynamicTree_Rebuild( bp->trees + b2_dynamicBody, false );
-	b2DynamicTree_Rebuild( bp->trees + b2_kinematicBody, false );
+	if ( bp->refitRatio <= 0.0f )
+	{
+		b2DynamicTree_RebuildWithTasks( bp->trees + b2_dynamicBody, false, enqueueTask, finishTask, userTaskContext );
+		b2DynamicTree_RebuildWithTasks( bp->trees + b2_kinematicBody, false, enqueueTask, finishTask, userTaskContext );
+		return;
+	}
+
+	b2BodyType treeTypes[] = { b2_dynamicBody, b2_kinematicBody };
+	for ( int j = 0; j < 2; ++j )
+	{
+		int i = treeTypes[j];
+		b2DynamicTree* tree = bp->trees + i;
+		if ( b2DynamicTree_Refit( tree ) == 0 )
+		{
+			continue;
+		}
+
+		// The first refit always rebuilds because there is no reference ratio yet
+		bp->refitSteps[i] += 1;
+		if ( bp->rebuildAreaRatios[i] > 0.0f && bp->refitSteps[i] < B2_REFIT_CHECK_INTERVAL )
+		{
+			continue;
+		}
+
+		bp->refitSteps[i] = 0;
+		if ( b2DynamicTree_GetAreaRatio( tree ) <= bp->refitRatio * bp->rebuildAreaRatios[i] )
+		{
+			continue;
+		}
+
+		// Refit cleared the enlarged flags, so this must be a full build
+		b2DynamicTree_RebuildWithTasks( tree, true, enqueueTask, finishTask, userTaskContext );
+		bp->rebuildAreaRatios[i] = b2DynamicTree_GetAreaRatio( tree );
+	}
 }
 
 int b2BroadPhase_GetShapeIndex( b2BroadPhase* bp, int proxyKey )
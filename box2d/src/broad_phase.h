@@ -12,14 +12,64 @@
 typedef struct b2Shape b2Shape;
 typedef struct b2MovePair b2MovePair;
 typedef struct b2MoveResult b2MoveResult;
+typedef struct b2NewContact b2NewContact;
 typedef struct b2ArenaAllocator b2ArenaAllocator;
 typedef struct b2World b2World;
+typedef struct b2GridItem b2GridItem;
+
+B2_ARRAY_INLINE( b2AABB, b2AABB )
+
+// Levels of the hashed grid, each with twice the cell size of the one below
+#define B2_GRID_LEVEL_COUNT 16
 
 // Store the proxy type in the lower 2 bits of the proxy key. This leaves 30 bits for the id.
 #define B2_PROXY_TYPE( KEY ) ( (b2BodyType)( ( KEY ) & 3 ) )
 #define B2_PROXY_ID( KEY ) ( ( KEY ) >> 2 )
 #define B2_PROXY_KEY( ID, TYPE ) ( ( ( ID ) << 2 ) | ( TYPE ) )
 
+// Proxies of every body type sorted by the lower x bound of their fat AABB, for finding pairs by sort
+// and sweep. The bounds are stored by component so the y overlap test can run on four proxies at once.
+// A destroyed proxy keeps its slot with a null key until the next pair update compacts the arrays.
+typedef struct b2SweepSet
+{
+	b2FloatArray lowerX;
+	b2FloatArray upperX;
+	b2FloatArray lowerY;
+	b2FloatArray upperY;
+	b2IntArray proxyKeys;
+	b2IntArray shapeIndices;
+
+	// Sorted position of each proxy, indexed by proxy id
+	b2IntArray entryIndices[b2_bodyTypeCount];
+	int removedCount;
+
+	// Flags the sorted entries that are in the move buffer. Only valid while finding pairs.
+	bool* moved;
+} b2SweepSet;
+
+// Dynamic proxies for the grid pair finder, kept in a deterministic order with their fat AABB. The
+// hashed grid itself only lives in the arena while finding pairs.
+typedef struct b2GridSet
+{
+	b2AABBArray aabbs;
+	b2IntArray proxyIds;
+	b2IntArray shapeIndices;
+
+	// Position of each dynamic proxy, indexed by proxy id
+	b2IntArray entryIndices;
+
+	// Only valid while finding pairs
+	b2GridItem* items;
+	int* bucketStarts;
+	int* proxyBuckets;
+	uint32_t bucketMask;
+	uint8_t* levels;
+	bool* moved;
+	float inverseCellSizes[B2_GRID_LEVEL_COUNT];
+	int levelMask;
+	int largeCount;
+} b2GridSet;
+
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
@@ -30,9 +80,7 @@ typedef struct b2BroadPhase
 	// The move set and array are used to track shapes that have moved significantly
 	// and need a pair query for new contacts. The array has a deterministic order.
 	// todo perhaps just a move set?
-	// todo implement a 32bit hash set for faster lookup
-	// todo moveSet can grow quite large on the first time step and remain large
-	b2HashSet moveSet;
+	b2HashSet32 moveSet;
 	b2IntArray moveArray;
 
 	// These are the results from the pair query and are used to create new contacts
@@ -43,13 +91,25 @@ typedef struct b2BroadPhase
 	int movePairCapacity;
 	b2AtomicInt movePairIndex;
 
+	// Contacts reserved from the move results, initialized in parallel
+	b2NewContact* newContacts;
+
 	// Tracks shape pairs that have a b2Contact
-	// todo pairSet can grow quite large on the first time step and remain large
 	b2HashSet pairSet;
 
+	// Pair finder state for the other broad-phase types. See b2BroadPhaseType.
+	b2SweepSet sweep;
+	b2GridSet grid;
+	b2BroadPhaseType type;
+
+	// Refit mode for the dynamic and kinematic trees, see b2WorldDef::treeRefitRatio
+	float refitRatio;
+	float rebuildAreaRatios[b2_bodyTypeCount];
+	int refitSteps[b2_bodyTypeCount];
+
 } b2BroadPhase;
 
-void b2CreateBroadPhase( b2BroadPhase* bp );
+void b2CreateBroadPhase( b2BroadPhase* bp, b2BroadPhaseType type, float refitRatio );
 void b2DestroyBroadPhase( b2BroadPhase* bp );
 
 int b2BroadPhase_CreateProxy( b2BroadPhase* bp, b2BodyType proxyType, b2AABB aabb, uint64_t categoryBits, int shapeIndex,
@@ -59,7 +119,8 @@ void b2BroadPhase_DestroyProxy( b2BroadPhase* bp, int proxyKey );
 void b2BroadPhase_MoveProxy( b2BroadPhase* bp, int proxyKey, b2AABB aabb );
 void b2BroadPhase_EnlargeProxy( b2BroadPhase* bp, int proxyKey, b2AABB aabb );
 
-void b2BroadPhase_RebuildTrees( b2BroadPhase* bp );
+void b2BroadPhase_RebuildTrees( b2BroadPhase* bp, b2EnqueueTaskCallback* enqueueTask, b2FinishTaskCallback* finishTask,
+								void* userTaskContext );
 
 int b2BroadPhase_GetShapeIndex( b2BroadPhase* bp, int proxyKey );
 
@@ -73,8 +134,7 @@ void b2ValidateNoEnlarged( const b2BroadPhase* bp );
 // Warning: this must be called in deterministic order
 static inline void b2BufferMove( b2BroadPhase* bp, int queryProxy )
 {
-	// Adding 1 because 0 is the sentinel
-	bool alreadyAdded = b2AddKey( &bp->moveSet, queryProxy + 1 );
+	bool alreadyAdded = b2AddKey32( &bp->moveSet, (uint32_t)queryProxy );
 	if ( alreadyAdded == false )
 	{
 		b2IntArray_Push( &bp->moveArray, queryProxy );
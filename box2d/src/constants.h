@@ -14,7 +14,8 @@ extern float b2_lengthUnitsPerMeter;
 
 // Maximum number of colors in the constraint graph. Constraints that cannot
 // find a color are added to the overflow set which are solved single-threaded.
-#define B2_GRAPH_COLOR_COUNT 12
+// Colors are only used as needed, so unused colors cost nothing in the solver.
+#define B2_GRAPH_COLOR_COUNT 24
 
 // A small length used as a collision and constraint tolerance. Usually it is
 // chosen to be numerically significant, but visually insignificant. In meters.
@@ -3,6 +3,7 @@
 
 #include "constraint_graph.h"
 
+#include "arena_allocator.h"
 #include "array.h"
 #include "bitset.h"
 #include "body.h"
@@ -11,6 +12,7 @@
 #include "solver_set.h"
 #include "physics_world.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 // Solver using graph coloring. Islands are only used for sleep.
@@ -25,7 +27,12 @@
 // This is used for debugging by making all constraints be assigned to overflow.
 #define B2_FORCE_OVERFLOW 0
 
-_Static_assert( B2_GRAPH_COLOR_COUNT == 12, "graph color count assumed to be 12" );
+_Static_assert( B2_GRAPH_COLOR_COUNT == 24, "graph color count assumed to be 24" );
+
+// Constraints between two dynamic bodies are limited to the lower colors. The upper colors are kept for
+// constraints with a static body. These only need one body to be free, so they can fill in around a body
+// whose lower colors are taken. Colors are used first come first served, so small scenes only use a few.
+#define B2_DYNAMIC_COLOR_COUNT ( B2_GRAPH_COLOR_COUNT - 4 )
 
 void b2CreateGraph( b2ConstraintGraph* graph, int bodyCapacity )
 {
@@ -62,30 +69,14 @@ void b2DestroyGraph( b2ConstraintGraph* graph )
 	}
 }
 
-// Contacts are always created as non-touching. They get cloned into the constraint
-// graph once they are found to be touching.
-// todo maybe kinematic bodies should not go into graph
-void b2AddContactToGraph( b2World* world, b2ContactSim* contactSim, b2Contact* contact )
+static int b2AssignContactColor( b2ConstraintGraph* graph, int bodyIdA, int bodyIdB, bool staticA, bool staticB )
 {
-	B2_ASSERT( contactSim->manifold.pointCount > 0 );
-	B2_ASSERT( contactSim->simFlags & b2_simTouchingFlag );
-	B2_ASSERT( contact->flags & b2_contactTouchingFlag );
-
-	b2ConstraintGraph* graph = &world->constraintGraph;
-	int colorIndex = B2_OVERFLOW_INDEX;
-
-	int bodyIdA = contact->edges[0].bodyId;
-	int bodyIdB = contact->edges[1].bodyId;
-	b2Body* bodyA = b2BodyArray_Get( &world->bodies, bodyIdA );
-	b2Body* bodyB = b2BodyArray_Get( &world->bodies, bodyIdB );
-	bool staticA = bodyA->setIndex == b2_staticSet;
-	bool staticB = bodyB->setIndex == b2_staticSet;
 	B2_ASSERT( staticA == false || staticB == false );
 
 #if B2_FORCE_OVERFLOW == 0
 	if ( staticA == false && staticB == false )
 	{
-		for ( int i = 0; i < B2_OVERFLOW_INDEX; ++i )
+		for ( int i = 0; i < B2_DYNAMIC_COLOR_COUNT; ++i )
 		{
 			b2GraphColor* color = graph->colors + i;
 			if ( b2GetBit( &color->bodySet, bodyIdA ) || b2GetBit( &color->bodySet, bodyIdB ) )
@@ -95,8 +86,7 @@ void b2AddContactToGraph( b2World* world, b2ContactSim* contactSim, b2Contact* c
 
 			b2SetBitGrow( &color->bodySet, bodyIdA );
 			b2SetBitGrow( &color->bodySet, bodyIdB );
-			colorIndex = i;
-			break;
+			return i;
 		}
 	}
 	else if ( staticA == false )
@@ -111,8 +101,7 @@ void b2AddContactToGraph( b2World* world, b2ContactSim* contactSim, b2Contact* c
 			}
 
 			b2SetBitGrow( &color->bodySet, bodyIdA );
-			colorIndex = i;
-			break;
+			return i;
 		}
 	}
 	else if ( staticB == false )
@@ -127,12 +116,37 @@ void b2AddContactToGraph( b2World* world, b2ContactSim* contactSim, b2Contact* c
 			}
 
 			b2SetBitGrow( &color->bodySet, bodyIdB );
-			colorIndex = i;
-			break;
+			return i;
 		}
 	}
+#else
+	B2_UNUSED( graph, bodyIdA, bodyIdB, staticA, staticB );
 #endif
 
+	return B2_OVERFLOW_INDEX;
+}
+
+// Contacts are always created as non-touching. They get cloned into the constraint
+// graph once they are found to be touching.
+// todo maybe kinematic bodies should not go into graph
+void b2AddContactToGraph( b2World* world, b2ContactSim* contactSim, b2Contact* contact )
+{
+	B2_ASSERT( contactSim->manifold.pointCount > 0 );
+	B2_ASSERT( contactSim->simFlags & b2_simTouchingFlag );
+	B2_ASSERT( contact->flags & b2_contactTouchingFlag );
+
+	b2ConstraintGraph* graph = &world->constraintGraph;
+
+	int bodyIdA = contact->edges[0].bodyId;
+	int bodyIdB = contact->edges[1].bodyId;
+	b2Body* bodyA = b2BodyArray_Get( &world->bodies, bodyIdA );
+	b2Body* bodyB = b2BodyArray_Get( &world->bodies, bodyIdB );
+	bool staticA = bodyA->setIndex == b2_staticSet;
+	bool staticB = bodyB->setIndex == b2_staticSet;
+	B2_ASSERT( staticA == false || staticB == false );
+
+	int colorIndex = b2AssignContactColor( graph, bodyIdA, bodyIdB, staticA, staticB );
+
 	b2GraphColor* color = graph->colors + colorIndex;
 	contact->colorIndex = colorIndex;
 	contact->localIndex = color->contactSims.count;
@@ -211,6 +225,101 @@ void b2RemoveContactFromGraph( b2World* world, int bodyIdA, int bodyIdB, int col
 	}
 }
 
+typedef struct b2RecolorCandidate
+{
+	int degree;
+	int contactId;
+} b2RecolorCandidate;
+
+static int b2CompareRecolorCandidates( const void* a, const void* b )
+{
+	const b2RecolorCandidate* ca = a;
+	const b2RecolorCandidate* cb = b;
+
+	if ( ca->degree != cb->degree )
+	{
+		return ca->degree < cb->degree ? -1 : 1;
+	}
+
+	return ca->contactId < cb->contactId ? -1 : ( ca->contactId > cb->contactId ? 1 : 0 );
+}
+
+// A contact stays in the overflow set until it stops touching, even if colors free up later. So each step
+// the overflow contacts try again to find a color. Contacts on bodies with the fewest contacts go first
+// because they are the most likely to fit and placing them first leaves the fewest contacts behind.
+int b2RecolorOverflowContacts( b2World* world )
+{
+	b2ConstraintGraph* graph = &world->constraintGraph;
+	b2GraphColor* overflow = graph->colors + B2_OVERFLOW_INDEX;
+
+	int count = overflow->contactSims.count;
+	if ( count == 0 )
+	{
+		return 0;
+	}
+
+	b2TracyCZoneNC( recolor, "Recolor", b2_colorLightSlateGray, true );
+
+	b2RecolorCandidate* candidates =
+		b2AllocateArenaItem( &world->arena, count * sizeof( b2RecolorCandidate ), "recolor candidates" );
+
+	for ( int i = 0; i < count; ++i )
+	{
+		int contactId = overflow->contactSims.data[i].contactId;
+		b2Contact* contact = b2ContactArray_Get( &world->contacts, contactId );
+		b2Body* bodyA = b2BodyArray_Get( &world->bodies, contact->edges[0].bodyId );
+		b2Body* bodyB = b2BodyArray_Get( &world->bodies, contact->edges[1].bodyId );
+
+		// Static bodies don't use colors
+		int degree = 0;
+		degree += bodyA->setIndex == b2_staticSet ? 0 : bodyA->contactCount + bodyA->jointCount;
+		degree += bodyB->setIndex == b2_staticSet ? 0 : bodyB->contactCount + bodyB->jointCount;
+
+		candidates[i] = ( b2RecolorCandidate ){ degree, contactId };
+	}
+
+	// The contact id breaks ties so the order is deterministic
+	qsort( candidates, count, sizeof( b2RecolorCandidate ), b2CompareRecolorCandidates );
+
+	int recolorCount = 0;
+	for ( int i = 0; i < count; ++i )
+	{
+		b2Contact* contact = b2ContactArray_Get( &world->contacts, candidates[i].contactId );
+		B2_ASSERT( contact->colorIndex == B2_OVERFLOW_INDEX );
+
+		int bodyIdA = contact->edges[0].bodyId;
+		int bodyIdB = contact->edges[1].bodyId;
+		bool staticA = b2BodyArray_Get( &world->bodies, bodyIdA )->setIndex == b2_staticSet;
+		bool staticB = b2BodyArray_Get( &world->bodies, bodyIdB )->setIndex == b2_staticSet;
+
+		int colorIndex = b2AssignContactColor( graph, bodyIdA, bodyIdB, staticA, staticB );
+		if ( colorIndex == B2_OVERFLOW_INDEX )
+		{
+			continue;
+		}
+
+		// The body sim indices and masses are still valid because the bodies have not moved
+		int localIndex = contact->localIndex;
+		b2GraphColor* color = graph->colors + colorIndex;
+		b2ContactSim* newContact = b2ContactSimArray_Add( &color->contactSims );
+		memcpy( newContact, overflow->contactSims.data + localIndex, sizeof( b2ContactSim ) );
+
+		contact->colorIndex = colorIndex;
+		contact->localIndex = color->contactSims.count - 1;
+
+		// Overflow has no body bits to clear
+		b2RemoveContactFromGraph( world, bodyIdA, bodyIdB, B2_OVERFLOW_INDEX, localIndex );
+
+		recolorCount += 1;
+	}
+
+	b2FreeArenaItem( &world->arena, candidates );
+
+	b2TracyCZoneEnd( recolor );
+
+	return recolorCount;
+}
+
 static int b2AssignJointColor( b2ConstraintGraph* graph, int bodyIdA, int bodyIdB, bool staticA, bool staticB )
 {
 	B2_ASSERT( staticA == false || staticB == false );
@@ -218,7 +327,7 @@ static int b2AssignJointColor( b2ConstraintGraph* graph, int bodyIdA, int bodyId
 #if B2_FORCE_OVERFLOW == 0
 	if ( staticA == false && staticB == false )
 	{
-		for ( int i = 0; i < B2_OVERFLOW_INDEX; ++i )
+		for ( int i = 0; i < B2_DYNAMIC_COLOR_COUNT; ++i )
 		{
 			b2GraphColor* color = graph->colors + i;
 			if ( b2GetBit( &color->bodySet, bodyIdA ) || b2GetBit( &color->bodySet, bodyIdB ) )
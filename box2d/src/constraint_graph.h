@@ -12,6 +12,7 @@ typedef struct b2ContactSim b2ContactSim;
 typedef struct b2Contact b2Contact;
 typedef struct b2ContactConstraint b2ContactConstraint;
 typedef struct b2ContactConstraintSIMD b2ContactConstraintSIMD;
+typedef struct b2JointConstraintSIMD b2JointConstraintSIMD;
 typedef struct b2JointSim b2JointSim;
 typedef struct b2Joint b2Joint;
 typedef struct b2StepContext b2StepContext;
@@ -39,6 +40,10 @@ typedef struct b2GraphColor
 		b2ContactConstraintSIMD* simdConstraints;
 		b2ContactConstraint* overflowConstraints;
 	};
+
+	// transient, joints of this color split into scalar joints and SIMD joint constraints
+	b2JointSim** scalarJoints;
+	b2JointConstraintSIMD* simdJoints;
 } b2GraphColor;
 
 typedef struct b2ConstraintGraph
@@ -53,6 +58,9 @@ void b2DestroyGraph( b2ConstraintGraph* graph );
 void b2AddContactToGraph( b2World* world, b2ContactSim* contactSim, b2Contact* contact );
 void b2RemoveContactFromGraph( b2World* world, int bodyIdA, int bodyIdB, int colorIndex, int localIndex );
 
+// Move overflow contacts into colors that have freed up. Returns the number of contacts moved.
+int b2RecolorOverflowContacts( b2World* world );
+
 b2JointSim* b2CreateJointInGraph( b2World* world, b2Joint* joint );
 void b2AddJointToGraph( b2World* world, b2JointSim* jointSim, b2Joint* joint );
 void b2RemoveJointFromGraph( b2World* world, int bodyIdA, int bodyIdB, int colorIndex, int localIndex );
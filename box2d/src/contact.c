@@ -222,7 +222,10 @@ void b2InitializeContactRegisters( void )
 	}
 }
 
-void b2CreateContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB )
+// The serial part of contact creation. This allocates the contact id and the contact sim slot, links the
+// contact into the contact lists of both bodies and adds the pair to the pair set. All of this must happen
+// in the order the broad-phase found the pairs. Returns false if the shape types don't collide.
+bool b2ReserveContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB, b2NewContact* newContact )
 {
 	b2ShapeType type1 = shapeA->type;
 	b2ShapeType type2 = shapeB->type;
@@ -233,14 +236,15 @@ void b2CreateContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB )
 	if ( s_registers[type1][type2].fcn == NULL )
 	{
 		// For example, no segment vs segment collision
-		return;
+		return false;
 	}
 
 	if ( s_registers[type1][type2].primary == false )
 	{
 		// flip order
-		b2CreateContact( world, shapeB, shapeA );
-		return;
+		b2Shape* temp = shapeA;
+		shapeA = shapeB;
+		shapeB = temp;
 	}
 
 	b2Body* bodyA = b2BodyArray_Get( &world->bodies, shapeA->bodyId );
@@ -275,25 +279,6 @@ void b2CreateContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB )
 	int shapeIdB = shapeB->id;
 
 	b2Contact* contact = b2ContactArray_Get( &world->contacts, contactId );
-	contact->contactId = contactId;
-	contact->generation += 1;
-	contact->setIndex = setIndex;
-	contact->colorIndex = B2_NULL_INDEX;
-	contact->localIndex = set->contactSims.count;
-	contact->islandId = B2_NULL_INDEX;
-	contact->islandPrev = B2_NULL_INDEX;
-	contact->islandNext = B2_NULL_INDEX;
-	contact->shapeIdA = shapeIdA;
-	contact->shapeIdB = shapeIdB;
-	contact->isMarked = false;
-	contact->flags = 0;
-
-	B2_ASSERT( shapeA->sensorIndex == B2_NULL_INDEX && shapeB->sensorIndex == B2_NULL_INDEX );
-
-	if ( shapeA->enableContactEvents || shapeB->enableContactEvents )
-	{
-		contact->flags |= b2_contactEnableContactEvents;
-	}
 
 	// Connect to body A
 	{
@@ -335,7 +320,50 @@ void b2CreateContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB )
 
 	// Contacts are created as non-touching. Later if they are found to be touching
 	// they will link islands and be moved into the constraint graph.
-	b2ContactSim* contactSim = b2ContactSimArray_Add( &set->contactSims );
+	b2ContactSimArray_Add( &set->contactSims );
+
+	newContact->contactId = contactId;
+	newContact->shapeIdA = shapeIdA;
+	newContact->shapeIdB = shapeIdB;
+	newContact->setIndex = setIndex;
+	newContact->localIndex = set->contactSims.count - 1;
+	return true;
+}
+
+// The rest of contact creation. This only writes the new contact and its contact sim, so reserved
+// contacts can be initialized on multiple threads.
+void b2InitializeContact( b2World* world, const b2NewContact* newContact )
+{
+	int contactId = newContact->contactId;
+	int shapeIdA = newContact->shapeIdA;
+	int shapeIdB = newContact->shapeIdB;
+	b2Shape* shapeA = world->shapes.data + shapeIdA;
+	b2Shape* shapeB = world->shapes.data + shapeIdB;
+
+	// The edges were set up by b2ReserveContact
+	b2Contact* contact = world->contacts.data + contactId;
+	contact->contactId = contactId;
+	contact->generation += 1;
+	contact->setIndex = newContact->setIndex;
+	contact->colorIndex = B2_NULL_INDEX;
+	contact->localIndex = newContact->localIndex;
+	contact->islandId = B2_NULL_INDEX;
+	contact->islandPrev = B2_NULL_INDEX;
+	contact->islandNext = B2_NULL_INDEX;
+	contact->shapeIdA = shapeIdA;
+	contact->shapeIdB = shapeIdB;
+	contact->isMarked = false;
+	contact->flags = 0;
+
+	B2_ASSERT( shapeA->sensorIndex == B2_NULL_INDEX && shapeB->sensorIndex == B2_NULL_INDEX );
+
+	if ( shapeA->enableContactEvents || shapeB->enableContactEvents )
+	{
+		contact->flags |= b2_contactEnableContactEvents;
+	}
+
+	b2SolverSet* set = world->solverSets.data + newContact->setIndex;
+	b2ContactSim* contactSim = set->contactSims.data + newContact->localIndex;
 	contactSim->contactId = contactId;
 
 #if B2_VALIDATE
@@ -521,6 +549,47 @@ b2ContactSim* b2GetContactSim( b2World* world, b2Contact* contact )
 	return b2ContactSimArray_Get( &set->contactSims, contact->localIndex );
 }
 
+// Can the manifold computed at the cached relative transform be used for this relative transform?
+static bool b2CanReuseManifold( const b2World* world, const b2ContactSim* contactSim, b2Transform relativeTransform )
+{
+	if ( ( contactSim->simFlags & b2_simManifoldCached ) == 0 )
+	{
+		return false;
+	}
+
+	float tolerance = world->manifoldReuseTolerance;
+	b2Vec2 dp = b2Sub( relativeTransform.p, contactSim->relativeTransform.p );
+	b2Rot dq = b2InvMulRot( contactSim->relativeTransform.q, relativeTransform.q );
+	return b2Dot( dp, dp ) < tolerance * tolerance && b2AbsFloat( dq.s ) < tolerance && dq.c > 0.0f;
+}
+
+// Move a reused manifold along with the bodies. The bodies barely moved relative to each other, so
+// the separations and impulses are kept and the points follow body A.
+static void b2MoveManifold( b2ContactSim* contactSim, b2Transform transformA, b2Vec2 centerOffsetA, b2Transform transformB,
+							b2Vec2 centerOffsetB )
+{
+	b2Manifold* manifold = &contactSim->manifold;
+	b2Rot dq = b2InvMulRot( contactSim->rotationA, transformA.q );
+	b2Vec2 dp = b2Sub( transformA.p, transformB.p );
+
+	manifold->normal = b2RotateVector( dq, manifold->normal );
+
+	for ( int i = 0; i < manifold->pointCount; ++i )
+	{
+		b2ManifoldPoint* mp = manifold->points + i;
+
+		// point relative to the origin of body A
+		b2Vec2 rA = b2RotateVector( dq, b2Add( mp->anchorA, contactSim->centerOffsetA ) );
+
+		mp->point = b2Add( transformA.p, rA );
+		mp->anchorA = b2Sub( rA, centerOffsetA );
+		mp->anchorB = b2Sub( b2Add( rA, dp ), centerOffsetB );
+		mp->totalNormalImpulse = 0.0f;
+		mp->normalVelocity = 0.0f;
+		mp->persisted = true;
+	}
+}
+
 // Update the contact manifold and touching status.
 // Note: do not assume the shape AABBs are overlapping or are valid.
 bool b2UpdateContact( b2World* world, b2ContactSim* contactSim, b2Shape* shapeA, b2Transform transformA, b2Vec2 centerOffsetA,
@@ -529,9 +598,37 @@ bool b2UpdateContact( b2World* world, b2ContactSim* contactSim, b2Shape* shapeA,
 	// Save old manifold
 	b2Manifold oldManifold = contactSim->manifold;
 
-	// Compute new manifold
-	b2ManifoldFcn* fcn = s_registers[shapeA->type][shapeB->type].fcn;
-	contactSim->manifold = fcn( shapeA, transformA, shapeB, transformB, &contactSim->cache );
+	bool reuseManifold = false;
+	contactSim->simFlags &= ~b2_simReusedManifold;
+
+	// Pre-solve may disable the contact differently each step, so those contacts are never reused
+	if ( world->manifoldReuseTolerance > 0.0f &&
+		 ( world->preSolveFcn == NULL || ( contactSim->simFlags & b2_simEnablePreSolveEvents ) == 0 ) )
+	{
+		b2Transform relativeTransform = b2InvMulTransforms( transformA, transformB );
+		reuseManifold = b2CanReuseManifold( world, contactSim, relativeTransform );
+
+		if ( reuseManifold == false )
+		{
+			contactSim->relativeTransform = relativeTransform;
+			contactSim->simFlags |= b2_simManifoldCached;
+		}
+	}
+
+	if ( reuseManifold )
+	{
+		b2MoveManifold( contactSim, transformA, centerOffsetA, transformB, centerOffsetB );
+		contactSim->simFlags |= b2_simReusedManifold;
+	}
+	else
+	{
+		// Compute new manifold
+		b2ManifoldFcn* fcn = s_registers[shapeA->type][shapeB->type].fcn;
+		contactSim->manifold = fcn( shapeA, transformA, shapeB, transformB, &contactSim->cache );
+	}
+
+	contactSim->rotationA = transformA.q;
+	contactSim->centerOffsetA = centerOffsetA;
 
 	// Keep these updated in case the values on the shapes are modified
 	contactSim->friction =
@@ -618,9 +715,9 @@ bool b2UpdateContact( b2World* world, b2ContactSim* contactSim, b2Shape* shapeA,
 	}
 
 	// Match old contact ids to new contact ids and copy the
-	// stored impulses to warm start the solver.
+	// stored impulses to warm start the solver. A reused manifold already has them.
 	int unmatchedCount = 0;
-	for ( int i = 0; i < pointCount; ++i )
+	for ( int i = 0; i < pointCount && reuseManifold == false; ++i )
 	{
 		b2ManifoldPoint* mp2 = contactSim->manifold.points + i;
 
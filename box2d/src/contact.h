@@ -94,6 +94,12 @@ enum b2ContactSimFlags
 
 	// This contact wants pre-solve events
 	b2_simEnablePreSolveEvents = 0x00200000,
+
+	// The manifold was computed at relativeTransform and may be reused
+	b2_simManifoldCached = 0x00400000,
+
+	// The manifold was reused this step instead of being computed
+	b2_simReusedManifold = 0x00800000,
 };
 
 /// The class manages contact between two shapes. A contact exists for each overlapping
@@ -132,11 +138,31 @@ typedef struct b2ContactSim
 	uint32_t simFlags;
 
 	b2SimplexCache cache;
+
+	// Manifold reuse, see b2WorldDef::manifoldReuseTolerance
+	// Transform of body B relative to body A when the manifold was computed
+	b2Transform relativeTransform;
+
+	// Rotation and center of mass offset of body A at the last update, used to move a reused manifold
+	b2Rot rotationA;
+	b2Vec2 centerOffsetA;
 } b2ContactSim;
 
 void b2InitializeContactRegisters( void );
 
-void b2CreateContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB );
+// A contact that has an id and a place in its solver set but is not initialized yet
+typedef struct b2NewContact
+{
+	int contactId;
+	int shapeIdA;
+	int shapeIdB;
+	int setIndex;
+	int localIndex;
+} b2NewContact;
+
+// Contact creation is split in a serial and a thread safe part
+bool b2ReserveContact( b2World* world, b2Shape* shapeA, b2Shape* shapeB, b2NewContact* newContact );
+void b2InitializeContact( b2World* world, const b2NewContact* newContact );
 void b2DestroyContact( b2World* world, b2Contact* contact, bool wakeBodies );
 
 b2ContactSim* b2GetContactSim( b2World* world, b2Contact* contact );
@@ -7,7 +7,9 @@
 #include "constraint_graph.h"
 #include "contact.h"
 #include "core.h"
+#include "joint_solver.h"
 #include "physics_world.h"
+#include "simd.h"
 #include "solver_set.h"
 
 #include <stddef.h>
@@ -21,7 +23,10 @@
 // s(t) = s0 + dot(cB0 - cA0, normal) + dot(dpB - dpA + rot(dqB, rB0) - rot(dqA, rA0), normal)
 // s_base = s0 + dot(cB0 - cA0, normal)
 
-void b2PrepareOverflowContacts( b2StepContext* context )
+// The overflow solver is scalar so only the baseline copy of this file builds it
+#if !defined( B2_SIMD_SUFFIX )
+
+void b2PrepareOverflowContacts( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( prepare_overflow_contact, "Prepare Overflow Contact", b2_colorYellow, true );
 
@@ -29,7 +34,7 @@ void b2PrepareOverflowContacts( b2StepContext* context )
 	b2ConstraintGraph* graph = context->graph;
 	b2GraphColor* color = graph->colors + B2_OVERFLOW_INDEX;
 	b2ContactConstraint* constraints = color->overflowConstraints;
-	int contactCount = color->contactSims.count;
+	const int* overflowContacts = context->overflowContacts;
 	b2ContactSim* contacts = color->contactSims.data;
 	b2BodyState* awakeStates = context->states;
 
@@ -43,8 +48,9 @@ void b2PrepareOverflowContacts( b2StepContext* context )
 
 	float warmStartScale = world->enableWarmStarting ? 1.0f : 0.0f;
 
-	for ( int i = 0; i < contactCount; ++i )
+	for ( int k = startIndex; k < endIndex; ++k )
 	{
+		int i = overflowContacts[k];
 		b2ContactSim* contactSim = contacts + i;
 
 		const b2Manifold* manifold = &contactSim->manifold;
@@ -157,14 +163,14 @@ void b2PrepareOverflowContacts( b2StepContext* context )
 	b2TracyCZoneEnd( prepare_overflow_contact );
 }
 
-void b2WarmStartOverflowContacts( b2StepContext* context )
+void b2WarmStartOverflowContacts( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( warmstart_overflow_contact, "WarmStart Overflow Contact", b2_colorDarkOrange, true );
 
 	b2ConstraintGraph* graph = context->graph;
 	b2GraphColor* color = graph->colors + B2_OVERFLOW_INDEX;
 	b2ContactConstraint* constraints = color->overflowConstraints;
-	int contactCount = color->contactSims.count;
+	const int* overflowContacts = context->overflowContacts;
 	b2World* world = context->world;
 	b2SolverSet* awakeSet = b2SolverSetArray_Get( &world->solverSets, b2_awakeSet );
 	b2BodyState* states = awakeSet->bodyStates.data;
@@ -172,8 +178,9 @@ void b2WarmStartOverflowContacts( b2StepContext* context )
 	// This is a dummy state to represent a static body because static bodies don't have a solver body.
 	b2BodyState dummyState = b2_identityBodyState;
 
-	for ( int i = 0; i < contactCount; ++i )
+	for ( int k = startIndex; k < endIndex; ++k )
 	{
+		int i = overflowContacts[k];
 		const b2ContactConstraint* constraint = constraints + i;
 
 		int indexA = constraint->indexA;
@@ -224,14 +231,14 @@ void b2WarmStartOverflowContacts( b2StepContext* context )
 	b2TracyCZoneEnd( warmstart_overflow_contact );
 }
 
-void b2SolveOverflowContacts( b2StepContext* context, bool useBias )
+void b2SolveOverflowContacts( int startIndex, int endIndex, b2StepContext* context, bool useBias )
 {
 	b2TracyCZoneNC( solve_contact, "Solve Contact", b2_colorAliceBlue, true );
 
 	b2ConstraintGraph* graph = context->graph;
 	b2GraphColor* color = graph->colors + B2_OVERFLOW_INDEX;
 	b2ContactConstraint* constraints = color->overflowConstraints;
-	int contactCount = color->contactSims.count;
+	const int* overflowContacts = context->overflowContacts;
 	b2World* world = context->world;
 	b2SolverSet* awakeSet = b2SolverSetArray_Get( &world->solverSets, b2_awakeSet );
 	b2BodyState* states = awakeSet->bodyStates.data;
@@ -242,8 +249,9 @@ void b2SolveOverflowContacts( b2StepContext* context, bool useBias )
 	// This is a dummy body to represent a static body since static bodies don't have a solver body.
 	b2BodyState dummyState = b2_identityBodyState;
 
-	for ( int i = 0; i < contactCount; ++i )
+	for ( int k = startIndex; k < endIndex; ++k )
 	{
+		int i = overflowContacts[k];
 		b2ContactConstraint* constraint = constraints + i;
 		float mA = constraint->invMassA;
 		float iA = constraint->invIA;
@@ -379,14 +387,14 @@ void b2SolveOverflowContacts( b2StepContext* context, bool useBias )
 	b2TracyCZoneEnd( solve_contact );
 }
 
-void b2ApplyOverflowRestitution( b2StepContext* context )
+void b2ApplyOverflowRestitution( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( overflow_resitution, "Overflow Restitution", b2_colorViolet, true );
 
 	b2ConstraintGraph* graph = context->graph;
 	b2GraphColor* color = graph->colors + B2_OVERFLOW_INDEX;
 	b2ContactConstraint* constraints = color->overflowConstraints;
-	int contactCount = color->contactSims.count;
+	const int* overflowContacts = context->overflowContacts;
 	b2World* world = context->world;
 	b2SolverSet* awakeSet = b2SolverSetArray_Get( &world->solverSets, b2_awakeSet );
 	b2BodyState* states = awakeSet->bodyStates.data;
@@ -396,8 +404,9 @@ void b2ApplyOverflowRestitution( b2StepContext* context )
 	// dummy state to represent a static body
 	b2BodyState dummyState = b2_identityBodyState;
 
-	for ( int i = 0; i < contactCount; ++i )
+	for ( int k = startIndex; k < endIndex; ++k )
 	{
+		int i = overflowContacts[k];
 		b2ContactConstraint* constraint = constraints + i;
 
 		float restitution = constraint->restitution;
@@ -477,7 +486,7 @@ void b2ApplyOverflowRestitution( b2StepContext* context )
 	b2TracyCZoneEnd( overflow_resitution );
 }
 
-void b2StoreOverflowImpulses( b2StepContext* context )
+void b2StoreOverflowImpulses( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( store_impulses, "Store", b2_colorFireBrick, true );
 
@@ -485,10 +494,11 @@ void b2StoreOverflowImpulses( b2StepContext* context )
 	b2GraphColor* color = graph->colors + B2_OVERFLOW_INDEX;
 	b2ContactConstraint* constraints = color->overflowConstraints;
 	b2ContactSim* contacts = color->contactSims.data;
-	int contactCount = color->contactSims.count;
+	const int* overflowContacts = context->overflowContacts;
 
-	for ( int i = 0; i < contactCount; ++i )
+	for ( int k = startIndex; k < endIndex; ++k )
 	{
+		int i = overflowContacts[k];
 		const b2ContactConstraint* constraint = constraints + i;
 		b2ContactSim* contact = contacts + i;
 		b2Manifold* manifold = &contact->manifold;
@@ -508,523 +518,7 @@ void b2StoreOverflowImpulses( b2StepContext* context )
 	b2TracyCZoneEnd( store_impulses );
 }
 
-#if defined( B2_SIMD_AVX2 )
-
-#include <immintrin.h>
-
-// wide float holds 8 numbers
-typedef __m256 b2FloatW;
-
-#elif defined( B2_SIMD_NEON )
-
-#include <arm_neon.h>
-
-// wide float holds 4 numbers
-typedef float32x4_t b2FloatW;
-
-#elif defined( B2_SIMD_SSE2 )
-
-#include <emmintrin.h>
-
-// wide float holds 4 numbers
-typedef __m128 b2FloatW;
-
-#else
-
-// scalar math
-typedef struct b2FloatW
-{
-	float x, y, z, w;
-} b2FloatW;
-
-#endif
-
-// Wide vec2
-typedef struct b2Vec2W
-{
-	b2FloatW X, Y;
-} b2Vec2W;
-
-// Wide rotation
-typedef struct b2RotW
-{
-	b2FloatW C, S;
-} b2RotW;
-
-#if defined( B2_SIMD_AVX2 )
-
-static inline b2FloatW b2ZeroW( void )
-{
-	return _mm256_setzero_ps();
-}
-
-static inline b2FloatW b2SplatW( float scalar )
-{
-	return _mm256_set1_ps( scalar );
-}
-
-static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_add_ps( a, b );
-}
-
-static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_sub_ps( a, b );
-}
-
-static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_mul_ps( a, b );
-}
-
-static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	// FMA can be emulated: https://github.com/lattera/glibc/blob/master/sysdeps/ieee754/dbl-64/s_fmaf.c#L34
-	// return _mm256_fmadd_ps( b, c, a );
-	return _mm256_add_ps( _mm256_mul_ps( b, c ), a );
-}
-
-static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	// return _mm256_fnmadd_ps(b, c, a);
-	return _mm256_sub_ps( a, _mm256_mul_ps( b, c ) );
-}
-
-static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_min_ps( a, b );
-}
-
-static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_max_ps( a, b );
-}
-
-// a = clamp(a, -b, b)
-static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW nb = _mm256_sub_ps( _mm256_setzero_ps(), b );
-	return _mm256_max_ps( nb, _mm256_min_ps( a, b ) );
-}
-
-static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_or_ps( a, b );
-}
-
-static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_cmp_ps( a, b, _CMP_GT_OQ );
-}
-
-static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
-{
-	return _mm256_cmp_ps( a, b, _CMP_EQ_OQ );
-}
-
-static inline bool b2AllZeroW( b2FloatW a )
-{
-	// Compare each element with zero
-	b2FloatW zero = _mm256_setzero_ps();
-	b2FloatW cmp = _mm256_cmp_ps( a, zero, _CMP_EQ_OQ );
-
-	// Create a mask from the comparison results
-	int mask = _mm256_movemask_ps( cmp );
-
-	// If all elements are zero, the mask will be 0xFF (11111111 in binary)
-	return mask == 0xFF;
-}
-
-// component-wise returns mask ? b : a
-static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
-{
-	return _mm256_blendv_ps( a, b, mask );
-}
-
-#elif defined( B2_SIMD_NEON )
-
-static inline b2FloatW b2ZeroW( void )
-{
-	return vdupq_n_f32( 0.0f );
-}
-
-static inline b2FloatW b2SplatW( float scalar )
-{
-	return vdupq_n_f32( scalar );
-}
-
-static inline b2FloatW b2SetW( float a, float b, float c, float d )
-{
-	float32_t array[4] = { a, b, c, d };
-	return vld1q_f32( array );
-}
-
-static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
-{
-	return vaddq_f32( a, b );
-}
-
-static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
-{
-	return vsubq_f32( a, b );
-}
-
-static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
-{
-	return vmulq_f32( a, b );
-}
-
-static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	return vmlaq_f32( a, b, c );
-}
-
-static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	return vmlsq_f32( a, b, c );
-}
-
-static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
-{
-	return vminq_f32( a, b );
-}
-
-static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
-{
-	return vmaxq_f32( a, b );
-}
-
-// a = clamp(a, -b, b)
-static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW nb = vnegq_f32( b );
-	return vmaxq_f32( nb, vminq_f32( a, b ) );
-}
-
-static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
-{
-	return vreinterpretq_f32_u32( vorrq_u32( vreinterpretq_u32_f32( a ), vreinterpretq_u32_f32( b ) ) );
-}
-
-static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
-{
-	return vreinterpretq_f32_u32( vcgtq_f32( a, b ) );
-}
-
-static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
-{
-	return vreinterpretq_f32_u32( vceqq_f32( a, b ) );
-}
-
-static inline bool b2AllZeroW( b2FloatW a )
-{
-	// Create a zero vector for comparison
-	b2FloatW zero = vdupq_n_f32( 0.0f );
-
-	// Compare the input vector with zero
-	uint32x4_t cmp_result = vceqq_f32( a, zero );
-
-// Check if all comparison results are non-zero using vminvq
-#ifdef __ARM_FEATURE_SVE
-	// ARM v8.2+ has horizontal minimum instruction
-	return vminvq_u32( cmp_result ) != 0;
-#else
-	// For older ARM architectures, we need to manually check all lanes
-	return vgetq_lane_u32( cmp_result, 0 ) != 0 && vgetq_lane_u32( cmp_result, 1 ) != 0 && vgetq_lane_u32( cmp_result, 2 ) != 0 &&
-		   vgetq_lane_u32( cmp_result, 3 ) != 0;
-#endif
-}
-
-// component-wise returns mask ? b : a
-static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
-{
-	uint32x4_t mask32 = vreinterpretq_u32_f32( mask );
-	return vbslq_f32( mask32, b, a );
-}
-
-static inline b2FloatW b2LoadW( const float32_t* data )
-{
-	return vld1q_f32( data );
-}
-
-static inline void b2StoreW( float32_t* data, b2FloatW a )
-{
-	vst1q_f32( data, a );
-}
-
-static inline b2FloatW b2UnpackLoW( b2FloatW a, b2FloatW b )
-{
-#if defined( __aarch64__ )
-	return vzip1q_f32( a, b );
-#else
-	float32x2_t a1 = vget_low_f32( a );
-	float32x2_t b1 = vget_low_f32( b );
-	float32x2x2_t result = vzip_f32( a1, b1 );
-	return vcombine_f32( result.val[0], result.val[1] );
-#endif
-}
-
-static inline b2FloatW b2UnpackHiW( b2FloatW a, b2FloatW b )
-{
-#if defined( __aarch64__ )
-	return vzip2q_f32( a, b );
-#else
-	float32x2_t a1 = vget_high_f32( a );
-	float32x2_t b1 = vget_high_f32( b );
-	float32x2x2_t result = vzip_f32( a1, b1 );
-	return vcombine_f32( result.val[0], result.val[1] );
 #endif
-}
-
-#elif defined( B2_SIMD_SSE2 )
-
-static inline b2FloatW b2ZeroW( void )
-{
-	return _mm_setzero_ps();
-}
-
-static inline b2FloatW b2SplatW( float scalar )
-{
-	return _mm_set1_ps( scalar );
-}
-
-static inline b2FloatW b2SetW( float a, float b, float c, float d )
-{
-	return _mm_setr_ps( a, b, c, d );
-}
-
-static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
-{
-	return _mm_add_ps( a, b );
-}
-
-static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
-{
-	return _mm_sub_ps( a, b );
-}
-
-static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
-{
-	return _mm_mul_ps( a, b );
-}
-
-static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	return _mm_add_ps( a, _mm_mul_ps( b, c ) );
-}
-
-static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	return _mm_sub_ps( a, _mm_mul_ps( b, c ) );
-}
-
-static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
-{
-	return _mm_min_ps( a, b );
-}
-
-static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
-{
-	return _mm_max_ps( a, b );
-}
-
-// a = clamp(a, -b, b)
-static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
-{
-	// Create a mask with the sign bit set for each element
-	__m128 mask = _mm_set1_ps( -0.0f );
-
-	// XOR the input with the mask to negate each element
-	__m128 nb = _mm_xor_ps( b, mask );
-
-	return _mm_max_ps( nb, _mm_min_ps( a, b ) );
-}
-
-static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
-{
-	return _mm_or_ps( a, b );
-}
-
-static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
-{
-	return _mm_cmpgt_ps( a, b );
-}
-
-static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
-{
-	return _mm_cmpeq_ps( a, b );
-}
-
-static inline bool b2AllZeroW( b2FloatW a )
-{
-	// Compare each element with zero
-	b2FloatW zero = _mm_setzero_ps();
-	b2FloatW cmp = _mm_cmpeq_ps( a, zero );
-
-	// Create a mask from the comparison results
-	int mask = _mm_movemask_ps( cmp );
-
-	// If all elements are zero, the mask will be 0xF (1111 in binary)
-	return mask == 0xF;
-}
-
-// component-wise returns mask ? b : a
-static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
-{
-	return _mm_or_ps( _mm_and_ps( mask, b ), _mm_andnot_ps( mask, a ) );
-}
-
-static inline b2FloatW b2LoadW( const float* data )
-{
-	return _mm_load_ps( data );
-}
-
-static inline void b2StoreW( float* data, b2FloatW a )
-{
-	_mm_store_ps( data, a );
-}
-
-static inline b2FloatW b2UnpackLoW( b2FloatW a, b2FloatW b )
-{
-	return _mm_unpacklo_ps( a, b );
-}
-
-static inline b2FloatW b2UnpackHiW( b2FloatW a, b2FloatW b )
-{
-	return _mm_unpackhi_ps( a, b );
-}
-
-#else
-
-static inline b2FloatW b2ZeroW( void )
-{
-	return (b2FloatW){ 0.0f, 0.0f, 0.0f, 0.0f };
-}
-
-static inline b2FloatW b2SplatW( float scalar )
-{
-	return (b2FloatW){ scalar, scalar, scalar, scalar };
-}
-
-static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
-{
-	return (b2FloatW){ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
-}
-
-static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
-{
-	return (b2FloatW){ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
-}
-
-static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
-{
-	return (b2FloatW){ a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
-}
-
-static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	return (b2FloatW){ a.x + b.x * c.x, a.y + b.y * c.y, a.z + b.z * c.z, a.w + b.w * c.w };
-}
-
-static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
-{
-	return (b2FloatW){ a.x - b.x * c.x, a.y - b.y * c.y, a.z - b.z * c.z, a.w - b.w * c.w };
-}
-
-static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW r;
-	r.x = a.x <= b.x ? a.x : b.x;
-	r.y = a.y <= b.y ? a.y : b.y;
-	r.z = a.z <= b.z ? a.z : b.z;
-	r.w = a.w <= b.w ? a.w : b.w;
-	return r;
-}
-
-static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW r;
-	r.x = a.x >= b.x ? a.x : b.x;
-	r.y = a.y >= b.y ? a.y : b.y;
-	r.z = a.z >= b.z ? a.z : b.z;
-	r.w = a.w >= b.w ? a.w : b.w;
-	return r;
-}
-
-// a = clamp(a, -b, b)
-static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW r;
-	r.x = b2ClampFloat( a.x, -b.x, b.x );
-	r.y = b2ClampFloat( a.y, -b.y, b.y );
-	r.z = b2ClampFloat( a.z, -b.z, b.z );
-	r.w = b2ClampFloat( a.w, -b.w, b.w );
-	return r;
-}
-
-static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW r;
-	r.x = a.x != 0.0f || b.x != 0.0f ? 1.0f : 0.0f;
-	r.y = a.y != 0.0f || b.y != 0.0f ? 1.0f : 0.0f;
-	r.z = a.z != 0.0f || b.z != 0.0f ? 1.0f : 0.0f;
-	r.w = a.w != 0.0f || b.w != 0.0f ? 1.0f : 0.0f;
-	return r;
-}
-
-static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW r;
-	r.x = a.x > b.x ? 1.0f : 0.0f;
-	r.y = a.y > b.y ? 1.0f : 0.0f;
-	r.z = a.z > b.z ? 1.0f : 0.0f;
-	r.w = a.w > b.w ? 1.0f : 0.0f;
-	return r;
-}
-
-static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
-{
-	b2FloatW r;
-	r.x = a.x == b.x ? 1.0f : 0.0f;
-	r.y = a.y == b.y ? 1.0f : 0.0f;
-	r.z = a.z == b.z ? 1.0f : 0.0f;
-	r.w = a.w == b.w ? 1.0f : 0.0f;
-	return r;
-}
-
-static inline bool b2AllZeroW( b2FloatW a )
-{
-	return a.x == 0.0f && a.y == 0.0f && a.z == 0.0f && a.w == 0.0f;
-}
-
-// component-wise returns mask ? b : a
-static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
-{
-	b2FloatW r;
-	r.x = mask.x != 0.0f ? b.x : a.x;
-	r.y = mask.y != 0.0f ? b.y : a.y;
-	r.z = mask.z != 0.0f ? b.z : a.z;
-	r.w = mask.w != 0.0f ? b.w : a.w;
-	return r;
-}
-
-#endif
-
-static inline b2FloatW b2DotW( b2Vec2W a, b2Vec2W b )
-{
-	return b2AddW( b2MulW( a.X, b.X ), b2MulW( a.Y, b.Y ) );
-}
-
-static inline b2FloatW b2CrossW( b2Vec2W a, b2Vec2W b )
-{
-	return b2SubW( b2MulW( a.X, b.Y ), b2MulW( a.Y, b.X ) );
-}
-
-static inline b2Vec2W b2RotateVectorW( b2RotW q, b2Vec2W v )
-{
-	return (b2Vec2W){ b2SubW( b2MulW( q.C, v.X ), b2MulW( q.S, v.Y ) ), b2AddW( b2MulW( q.S, v.X ), b2MulW( q.C, v.Y ) ) };
-}
 
 // Soft contact constraints with sub-stepping support
 // Uses fixed anchors for Jacobians for better behavior on rolling shapes (circles & capsules)
@@ -1068,21 +562,138 @@ int b2GetContactConstraintSIMDByteCount( void )
 	return sizeof( b2ContactConstraintSIMD );
 }
 
-// wide version of b2BodyState
-typedef struct b2BodyStateW
+// Custom gather/scatter for each SIMD type
+#if defined( B2_SIMD_AVX512 )
+
+// Lanes holding B2_NULL_INDEX are masked off
+static inline __mmask16 b2GetBodyMask( __m512i indices )
 {
-	b2Vec2W v;
-	b2FloatW w;
-	b2FloatW flags;
-	b2Vec2W dp;
-	b2RotW dq;
-} b2BodyStateW;
+	return _mm512_cmpneq_epi32_mask( indices, _mm512_set1_epi32( B2_NULL_INDEX ) );
+}
 
-// Custom gather/scatter for each SIMD type
-#if defined( B2_SIMD_AVX2 )
+// Shared by the gather and the scatter. This swaps 128-bit lanes between the field layout and the layout
+// of two 8x8 transposes.
+static inline void b2SwapBodyLanes( b2FloatW* a, b2FloatW* b )
+{
+	__m512i first = _mm512_setr_epi32( 0, 1, 2, 3, 16, 17, 18, 19, 8, 9, 10, 11, 24, 25, 26, 27 );
+	__m512i second = _mm512_setr_epi32( 4, 5, 6, 7, 20, 21, 22, 23, 12, 13, 14, 15, 28, 29, 30, 31 );
+	b2FloatW x = _mm512_permutex2var_ps( *a, first, *b );
+	b2FloatW y = _mm512_permutex2var_ps( *a, second, *b );
+	*a = x;
+	*b = y;
+}
+
+// Loads bodies i and i + 8 into one row. Null lanes get the identity body.
+static inline b2FloatW b2LoadBodyPair( const b2BodyState* states, const int* indices, int i )
+{
+	// b2BodyState b2_identityBodyState = {{0.0f, 0.0f}, 0.0f, 0, {0.0f, 0.0f}, {1.0f, 0.0f}};
+	__m256 identity = _mm256_setr_ps( 0.0f, 0.0f, 0.0f, 0, 0.0f, 0.0f, 1.0f, 0.0f );
+	__m256 lo = indices[i] == B2_NULL_INDEX ? identity : _mm256_load_ps( (const float*)( states + indices[i] ) );
+	__m256 hi = indices[i + 8] == B2_NULL_INDEX ? identity : _mm256_load_ps( (const float*)( states + indices[i + 8] ) );
+	return _mm512_insertf32x8( _mm512_castps256_ps512( lo ), hi, 1 );
+}
+
+// This is a load and two 8x8 transposes side by side, like the AVX2 version. The hardware gather
+// is slower because it issues a load per lane for each of the eight fields.
+b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
+{
+	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
+	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
+	b2FloatW b0 = b2LoadBodyPair( states, indices, 0 );
+	b2FloatW b1 = b2LoadBodyPair( states, indices, 1 );
+	b2FloatW b2 = b2LoadBodyPair( states, indices, 2 );
+	b2FloatW b3 = b2LoadBodyPair( states, indices, 3 );
+	b2FloatW b4 = b2LoadBodyPair( states, indices, 4 );
+	b2FloatW b5 = b2LoadBodyPair( states, indices, 5 );
+	b2FloatW b6 = b2LoadBodyPair( states, indices, 6 );
+	b2FloatW b7 = b2LoadBodyPair( states, indices, 7 );
+
+	// Transpose within each 128-bit lane
+	b2FloatW t0 = _mm512_unpacklo_ps( b0, b1 );
+	b2FloatW t1 = _mm512_unpackhi_ps( b0, b1 );
+	b2FloatW t2 = _mm512_unpacklo_ps( b2, b3 );
+	b2FloatW t3 = _mm512_unpackhi_ps( b2, b3 );
+	b2FloatW t4 = _mm512_unpacklo_ps( b4, b5 );
+	b2FloatW t5 = _mm512_unpackhi_ps( b4, b5 );
+	b2FloatW t6 = _mm512_unpacklo_ps( b6, b7 );
+	b2FloatW t7 = _mm512_unpackhi_ps( b6, b7 );
+	b2FloatW tt0 = _mm512_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	b2FloatW tt1 = _mm512_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	b2FloatW tt2 = _mm512_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	b2FloatW tt3 = _mm512_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	b2FloatW tt4 = _mm512_shuffle_ps( t4, t6, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	b2FloatW tt5 = _mm512_shuffle_ps( t4, t6, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	b2FloatW tt6 = _mm512_shuffle_ps( t5, t7, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	b2FloatW tt7 = _mm512_shuffle_ps( t5, t7, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+	// The 128-bit lanes of tt0 hold v.x of bodies 0-3, dp.x of bodies 0-3, v.x of bodies 8-11 and dp.x of
+	// bodies 8-11. tt4 holds the same for bodies 4-7 and 12-15.
+	b2SwapBodyLanes( &tt0, &tt4 );
+	b2SwapBodyLanes( &tt1, &tt5 );
+	b2SwapBodyLanes( &tt2, &tt6 );
+	b2SwapBodyLanes( &tt3, &tt7 );
+
+	b2BodyStateW simdBody;
+	simdBody.v.X = tt0;
+	simdBody.v.Y = tt1;
+	simdBody.w = tt2;
+	simdBody.flags = tt3;
+	simdBody.dp.X = tt4;
+	simdBody.dp.Y = tt5;
+	simdBody.dq.C = tt6;
+	simdBody.dq.S = tt7;
+	return simdBody;
+}
+
+// Stores the two halves of a row to bodies i and i + 8
+static inline void b2StoreBodyPair( b2BodyState* states, const int* indices, int i, b2FloatW row )
+{
+	if ( indices[i] != B2_NULL_INDEX )
+		_mm256_store_ps( (float*)( states + indices[i] ), _mm512_castps512_ps256( row ) );
+	if ( indices[i + 8] != B2_NULL_INDEX )
+		_mm256_store_ps( (float*)( states + indices[i + 8] ), _mm512_extractf32x8_ps( row, 1 ) );
+}
+
+// This writes everything back to the solver bodies but only the velocities change
+void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
+{
+	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
+	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
+	b2FloatW tt0 = simdBody->v.X, tt4 = simdBody->dp.X;
+	b2FloatW tt1 = simdBody->v.Y, tt5 = simdBody->dp.Y;
+	b2FloatW tt2 = simdBody->w, tt6 = simdBody->dq.C;
+	b2FloatW tt3 = simdBody->flags, tt7 = simdBody->dq.S;
+	b2SwapBodyLanes( &tt0, &tt4 );
+	b2SwapBodyLanes( &tt1, &tt5 );
+	b2SwapBodyLanes( &tt2, &tt6 );
+	b2SwapBodyLanes( &tt3, &tt7 );
+
+	// The 4x4 transpose within each 128-bit lane is its own inverse
+	b2FloatW t0 = _mm512_unpacklo_ps( tt0, tt1 );
+	b2FloatW t1 = _mm512_unpackhi_ps( tt0, tt1 );
+	b2FloatW t2 = _mm512_unpacklo_ps( tt2, tt3 );
+	b2FloatW t3 = _mm512_unpackhi_ps( tt2, tt3 );
+	b2FloatW t4 = _mm512_unpacklo_ps( tt4, tt5 );
+	b2FloatW t5 = _mm512_unpackhi_ps( tt4, tt5 );
+	b2FloatW t6 = _mm512_unpacklo_ps( tt6, tt7 );
+	b2FloatW t7 = _mm512_unpackhi_ps( tt6, tt7 );
+
+	// I don't use any dummy body in the body array because this will lead to multithreaded sharing and the
+	// associated cache flushing.
+	b2StoreBodyPair( states, indices, 0, _mm512_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ) ) );
+	b2StoreBodyPair( states, indices, 1, _mm512_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ) ) );
+	b2StoreBodyPair( states, indices, 2, _mm512_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) ) );
+	b2StoreBodyPair( states, indices, 3, _mm512_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) ) );
+	b2StoreBodyPair( states, indices, 4, _mm512_shuffle_ps( t4, t6, _MM_SHUFFLE( 1, 0, 1, 0 ) ) );
+	b2StoreBodyPair( states, indices, 5, _mm512_shuffle_ps( t4, t6, _MM_SHUFFLE( 3, 2, 3, 2 ) ) );
+	b2StoreBodyPair( states, indices, 6, _mm512_shuffle_ps( t5, t7, _MM_SHUFFLE( 1, 0, 1, 0 ) ) );
+	b2StoreBodyPair( states, indices, 7, _mm512_shuffle_ps( t5, t7, _MM_SHUFFLE( 3, 2, 3, 2 ) ) );
+}
+
+#elif defined( B2_SIMD_AVX2 )
 
 // This is a load and 8x8 transpose
-static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
+b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
 {
 	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
 	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
@@ -1127,7 +738,7 @@ static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int*
 }
 
 // This writes everything back to the solver bodies but only the velocities change
-static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
+void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
 {
 	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
 	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
@@ -1171,7 +782,7 @@ static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT i
 #elif defined( B2_SIMD_NEON )
 
 // This is a load and transpose
-static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
+b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
 {
 	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
 	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
@@ -1225,7 +836,7 @@ static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int*
 
 // This writes only the velocities back to the solver bodies
 // https://developer.arm.com/documentation/102107a/0100/Floating-point-4x4-matrix-transposition
-static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
+void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
 {
 	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
 	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
@@ -1277,7 +888,7 @@ static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT i
 #elif defined( B2_SIMD_SSE2 )
 
 // This is a load and transpose
-static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
+b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
 {
 	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
 	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
@@ -1329,7 +940,7 @@ static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int*
 }
 
 // This writes only the velocities back to the solver bodies
-static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
+void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
 {
 	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
 	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
@@ -1373,7 +984,7 @@ static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT i
 #else
 
 // This is a load and transpose
-static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
+b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices )
 {
 	b2BodyState identity = b2_identityBodyState;
 
@@ -1396,7 +1007,7 @@ static b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int*
 }
 
 // This writes only the velocities back to the solver bodies
-static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
+void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody )
 {
 	// todo somehow skip writing to kinematic bodies
 
@@ -1435,6 +1046,391 @@ static void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT i
 
 #endif
 
+// wide version of the b2BodySim fields read by velocity integration
+typedef struct b2BodySimW
+{
+	b2Vec2W force;
+	b2FloatW torque;
+	b2FloatW invMass;
+	b2FloatW invInertia;
+	b2FloatW linearDamping;
+	b2FloatW angularDamping;
+	b2FloatW gravityScale;
+} b2BodySimW;
+
+// The sim gather loads three runs of four adjacent floats from each body and transposes them
+_Static_assert( offsetof( b2BodySim, torque ) == offsetof( b2BodySim, force ) + 8, "b2BodySim layout changed" );
+_Static_assert( offsetof( b2BodySim, invMass ) == offsetof( b2BodySim, force ) + 12, "b2BodySim layout changed" );
+_Static_assert( offsetof( b2BodySim, linearDamping ) == offsetof( b2BodySim, invInertia ) + 12, "b2BodySim layout changed" );
+_Static_assert( offsetof( b2BodySim, gravityScale ) == offsetof( b2BodySim, angularDamping ) + 4, "b2BodySim layout changed" );
+_Static_assert( offsetof( b2BodySim, angularDamping ) + 16 <= sizeof( b2BodySim ), "b2BodySim layout changed" );
+
+#if defined( B2_SIMD_AVX512 )
+
+_Static_assert( sizeof( b2BodySim ) % sizeof( float ) == 0, "b2BodySim not a whole number of floats" );
+
+static inline b2FloatW b2GatherSimField( const b2BodySim* sims, __m512i offsets, size_t fieldOffset )
+{
+	return _mm512_i32gather_ps( offsets, (const float*)( (const char*)sims + fieldOffset ), 4 );
+}
+
+// Gathers 16 consecutive body sims
+static b2BodySimW b2GatherBodySims( const b2BodySim* B2_RESTRICT sims )
+{
+	int stride = (int)( sizeof( b2BodySim ) / sizeof( float ) );
+	__m512i offsets = _mm512_mullo_epi32( _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ),
+										  _mm512_set1_epi32( stride ) );
+
+	b2BodySimW simdSim;
+	simdSim.force.X = b2GatherSimField( sims, offsets, offsetof( b2BodySim, force.x ) );
+	simdSim.force.Y = b2GatherSimField( sims, offsets, offsetof( b2BodySim, force.y ) );
+	simdSim.torque = b2GatherSimField( sims, offsets, offsetof( b2BodySim, torque ) );
+	simdSim.invMass = b2GatherSimField( sims, offsets, offsetof( b2BodySim, invMass ) );
+	simdSim.invInertia = b2GatherSimField( sims, offsets, offsetof( b2BodySim, invInertia ) );
+	simdSim.linearDamping = b2GatherSimField( sims, offsets, offsetof( b2BodySim, linearDamping ) );
+	simdSim.angularDamping = b2GatherSimField( sims, offsets, offsetof( b2BodySim, angularDamping ) );
+	simdSim.gravityScale = b2GatherSimField( sims, offsets, offsetof( b2BodySim, gravityScale ) );
+	return simdSim;
+}
+
+// This writes only the delta position and rotation back to the solver bodies
+static void b2ScatterBodyDeltas( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices,
+								 const b2BodyStateW* B2_RESTRICT simdBody )
+{
+	__m512i bodyIndices = _mm512_loadu_si512( indices );
+	__mmask16 mask = b2GetBodyMask( bodyIndices );
+	__m512i offsets = _mm512_slli_epi32( bodyIndices, 3 );
+	float* base = (float*)states;
+
+	_mm512_mask_i32scatter_ps( base + 4, mask, offsets, simdBody->dp.X, 4 );
+	_mm512_mask_i32scatter_ps( base + 5, mask, offsets, simdBody->dp.Y, 4 );
+	_mm512_mask_i32scatter_ps( base + 6, mask, offsets, simdBody->dq.C, 4 );
+	_mm512_mask_i32scatter_ps( base + 7, mask, offsets, simdBody->dq.S, 4 );
+}
+
+#elif defined( B2_SIMD_AVX2 )
+
+// Loads the same four floats from sims[index] and sims[index + 4]
+static inline b2FloatW b2LoadSimRow( const b2BodySim* sims, int index, size_t offset )
+{
+	__m128 lo = _mm_loadu_ps( (const float*)( (const char*)( sims + index ) + offset ) );
+	__m128 hi = _mm_loadu_ps( (const float*)( (const char*)( sims + index + 4 ) + offset ) );
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( lo ), hi, 1 );
+}
+
+// Transposes four rows within each 128-bit half
+static inline void b2TransposeSimRows( b2FloatW* rows )
+{
+	b2FloatW t0 = _mm256_unpacklo_ps( rows[0], rows[2] );
+	b2FloatW t1 = _mm256_unpacklo_ps( rows[1], rows[3] );
+	b2FloatW t2 = _mm256_unpackhi_ps( rows[0], rows[2] );
+	b2FloatW t3 = _mm256_unpackhi_ps( rows[1], rows[3] );
+	rows[0] = _mm256_unpacklo_ps( t0, t1 );
+	rows[1] = _mm256_unpackhi_ps( t0, t1 );
+	rows[2] = _mm256_unpacklo_ps( t2, t3 );
+	rows[3] = _mm256_unpackhi_ps( t2, t3 );
+}
+
+// Gathers 8 consecutive body sims
+static b2BodySimW b2GatherBodySims( const b2BodySim* B2_RESTRICT sims )
+{
+	b2FloatW a[4], b[4], c[4];
+	for ( int i = 0; i < 4; ++i )
+	{
+		a[i] = b2LoadSimRow( sims, i, offsetof( b2BodySim, force ) );
+		b[i] = b2LoadSimRow( sims, i, offsetof( b2BodySim, invInertia ) );
+		c[i] = b2LoadSimRow( sims, i, offsetof( b2BodySim, angularDamping ) );
+	}
+
+	b2TransposeSimRows( a );
+	b2TransposeSimRows( b );
+	b2TransposeSimRows( c );
+
+	b2BodySimW simdSim;
+	simdSim.force.X = a[0];
+	simdSim.force.Y = a[1];
+	simdSim.torque = a[2];
+	simdSim.invMass = a[3];
+	simdSim.invInertia = b[0];
+	simdSim.linearDamping = b[3];
+	simdSim.angularDamping = c[0];
+	simdSim.gravityScale = c[1];
+	return simdSim;
+}
+
+// The full scatter already writes the delta position and rotation
+static void b2ScatterBodyDeltas( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices,
+								 const b2BodyStateW* B2_RESTRICT simdBody )
+{
+	b2ScatterBodies( states, indices, simdBody );
+}
+
+#elif defined( B2_SIMD_NEON ) || defined( B2_SIMD_SSE2 )
+
+static inline b2FloatW b2LoadSimRow( const b2BodySim* sims, int index, size_t offset )
+{
+	const float* data = (const float*)( (const char*)( sims + index ) + offset );
+#if defined( B2_SIMD_NEON )
+	return vld1q_f32( data );
+#else
+	return _mm_loadu_ps( data );
+#endif
+}
+
+static inline void b2TransposeSimRows( b2FloatW* rows )
+{
+	b2FloatW t0 = b2UnpackLoW( rows[0], rows[2] );
+	b2FloatW t1 = b2UnpackLoW( rows[1], rows[3] );
+	b2FloatW t2 = b2UnpackHiW( rows[0], rows[2] );
+	b2FloatW t3 = b2UnpackHiW( rows[1], rows[3] );
+	rows[0] = b2UnpackLoW( t0, t1 );
+	rows[1] = b2UnpackHiW( t0, t1 );
+	rows[2] = b2UnpackLoW( t2, t3 );
+	rows[3] = b2UnpackHiW( t2, t3 );
+}
+
+// Gathers 4 consecutive body sims
+static b2BodySimW b2GatherBodySims( const b2BodySim* B2_RESTRICT sims )
+{
+	b2FloatW a[4], b[4], c[4];
+	for ( int i = 0; i < 4; ++i )
+	{
+		a[i] = b2LoadSimRow( sims, i, offsetof( b2BodySim, force ) );
+		b[i] = b2LoadSimRow( sims, i, offsetof( b2BodySim, invInertia ) );
+		c[i] = b2LoadSimRow( sims, i, offsetof( b2BodySim, angularDamping ) );
+	}
+
+	b2TransposeSimRows( a );
+	b2TransposeSimRows( b );
+	b2TransposeSimRows( c );
+
+	b2BodySimW simdSim;
+	simdSim.force.X = a[0];
+	simdSim.force.Y = a[1];
+	simdSim.torque = a[2];
+	simdSim.invMass = a[3];
+	simdSim.invInertia = b[0];
+	simdSim.linearDamping = b[3];
+	simdSim.angularDamping = c[0];
+	simdSim.gravityScale = c[1];
+	return simdSim;
+}
+
+// This writes only the delta position and rotation back to the solver bodies
+static void b2ScatterBodyDeltas( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices,
+								 const b2BodyStateW* B2_RESTRICT simdBody )
+{
+	_Static_assert( sizeof( b2BodyState ) == 32, "b2BodyState not 32 bytes" );
+	B2_ASSERT( ( (uintptr_t)states & 0x1F ) == 0 );
+
+	// [dpx1 dpy1 dpx2 dpy2]
+	b2FloatW t1 = b2UnpackLoW( simdBody->dp.X, simdBody->dp.Y );
+	// [dpx3 dpy3 dpx4 dpy4]
+	b2FloatW t2 = b2UnpackHiW( simdBody->dp.X, simdBody->dp.Y );
+	// [c1 s1 c2 s2]
+	b2FloatW t3 = b2UnpackLoW( simdBody->dq.C, simdBody->dq.S );
+	// [c3 s3 c4 s4]
+	b2FloatW t4 = b2UnpackHiW( simdBody->dq.C, simdBody->dq.S );
+
+#if defined( B2_SIMD_NEON )
+	b2FloatW body1 = vcombine_f32( vget_low_f32( t1 ), vget_low_f32( t3 ) );
+	b2FloatW body2 = vcombine_f32( vget_high_f32( t1 ), vget_high_f32( t3 ) );
+	b2FloatW body3 = vcombine_f32( vget_low_f32( t2 ), vget_low_f32( t4 ) );
+	b2FloatW body4 = vcombine_f32( vget_high_f32( t2 ), vget_high_f32( t4 ) );
+#else
+	b2FloatW body1 = _mm_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	b2FloatW body2 = _mm_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+	b2FloatW body3 = _mm_shuffle_ps( t2, t4, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+	b2FloatW body4 = _mm_shuffle_ps( t2, t4, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+#endif
+
+	if ( indices[0] != B2_NULL_INDEX )
+		b2StoreW( (float*)( states + indices[0] ) + 4, body1 );
+	if ( indices[1] != B2_NULL_INDEX )
+		b2StoreW( (float*)( states + indices[1] ) + 4, body2 );
+	if ( indices[2] != B2_NULL_INDEX )
+		b2StoreW( (float*)( states + indices[2] ) + 4, body3 );
+	if ( indices[3] != B2_NULL_INDEX )
+		b2StoreW( (float*)( states + indices[3] ) + 4, body4 );
+}
+
+#else
+
+// Gathers 4 consecutive body sims
+static b2BodySimW b2GatherBodySims( const b2BodySim* B2_RESTRICT sims )
+{
+	const b2BodySim* s1 = sims + 0;
+	const b2BodySim* s2 = sims + 1;
+	const b2BodySim* s3 = sims + 2;
+	const b2BodySim* s4 = sims + 3;
+
+	b2BodySimW simdSim;
+	simdSim.force.X = (b2FloatW){ s1->force.x, s2->force.x, s3->force.x, s4->force.x };
+	simdSim.force.Y = (b2FloatW){ s1->force.y, s2->force.y, s3->force.y, s4->force.y };
+	simdSim.torque = (b2FloatW){ s1->torque, s2->torque, s3->torque, s4->torque };
+	simdSim.invMass = (b2FloatW){ s1->invMass, s2->invMass, s3->invMass, s4->invMass };
+	simdSim.invInertia = (b2FloatW){ s1->invInertia, s2->invInertia, s3->invInertia, s4->invInertia };
+	simdSim.linearDamping = (b2FloatW){ s1->linearDamping, s2->linearDamping, s3->linearDamping, s4->linearDamping };
+	simdSim.angularDamping = (b2FloatW){ s1->angularDamping, s2->angularDamping, s3->angularDamping, s4->angularDamping };
+	simdSim.gravityScale = (b2FloatW){ s1->gravityScale, s2->gravityScale, s3->gravityScale, s4->gravityScale };
+	return simdSim;
+}
+
+// This writes only the delta position and rotation back to the solver bodies
+static void b2ScatterBodyDeltas( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices,
+								 const b2BodyStateW* B2_RESTRICT simdBody )
+{
+	const float* dpx = &simdBody->dp.X.x;
+	const float* dpy = &simdBody->dp.Y.x;
+	const float* dqc = &simdBody->dq.C.x;
+	const float* dqs = &simdBody->dq.S.x;
+
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( indices[i] != B2_NULL_INDEX )
+		{
+			b2BodyState* state = states + indices[i];
+			state->deltaPosition = (b2Vec2){ dpx[i], dpy[i] };
+			state->deltaRotation = (b2Rot){ dqc[i], dqs[i] };
+		}
+	}
+}
+
+#endif
+
+// Lane access for the rare per-body fix ups
+typedef union b2FloatLanes
+{
+	b2FloatW w;
+	float f[B2_SIMD_WIDTH];
+} b2FloatLanes;
+
+// Matches b2IntegrateVelocities bit for bit. The speed clamps are computed for every lane and blended, the per-body
+// flags are only touched when some lane is over a limit.
+void b2IntegrateVelocitiesWide( b2BodySim* sims, b2BodyState* states, int count, b2Vec2 gravity, float h,
+								float maxLinearSpeed, float maxAngularSpeed )
+{
+	b2FloatW zero = b2ZeroW();
+	b2FloatW one = b2SplatW( 1.0f );
+	b2FloatW hw = b2SplatW( h );
+	b2Vec2W gravityW = { b2SplatW( gravity.x ), b2SplatW( gravity.y ) };
+	b2FloatW maxLinearSpeedW = b2SplatW( maxLinearSpeed );
+	b2FloatW maxAngularSpeedW = b2SplatW( maxAngularSpeed );
+	b2FloatW maxLinearSpeedSquared = b2SplatW( maxLinearSpeed * maxLinearSpeed );
+	b2FloatW maxAngularSpeedSquared = b2SplatW( maxAngularSpeed * maxAngularSpeed );
+
+	int wideCount = count - count % B2_SIMD_WIDTH;
+	int indices[B2_SIMD_WIDTH];
+
+	for ( int base = 0; base < wideCount; base += B2_SIMD_WIDTH )
+	{
+		for ( int i = 0; i < B2_SIMD_WIDTH; ++i )
+		{
+			indices[i] = base + i;
+		}
+
+		b2BodySimW sim = b2GatherBodySims( sims + base );
+		b2BodyStateW body = b2GatherBodies( states, indices );
+
+		b2FloatW linearDamping = b2DivW( one, b2AddW( one, b2MulW( hw, sim.linearDamping ) ) );
+		b2FloatW angularDamping = b2DivW( one, b2AddW( one, b2MulW( hw, sim.angularDamping ) ) );
+
+		// Gravity scale will be zero for kinematic bodies
+		b2FloatW gravityScale = b2BlendW( zero, sim.gravityScale, b2GreaterThanW( sim.invMass, zero ) );
+
+		// lvd = h * im * f + h * g
+		b2FloatW hm = b2MulW( hw, sim.invMass );
+		b2FloatW hg = b2MulW( hw, gravityScale );
+		b2FloatW dvx = b2AddW( b2MulW( hm, sim.force.X ), b2MulW( hg, gravityW.X ) );
+		b2FloatW dvy = b2AddW( b2MulW( hm, sim.force.Y ), b2MulW( hg, gravityW.Y ) );
+		b2FloatW dw = b2MulW( b2MulW( hw, sim.invInertia ), sim.torque );
+
+		b2FloatW vx = b2MulAddW( dvx, linearDamping, body.v.X );
+		b2FloatW vy = b2MulAddW( dvy, linearDamping, body.v.Y );
+		b2FloatW w = b2MulAddW( dw, angularDamping, body.w );
+
+		b2FloatW lengthSquared = b2AddW( b2MulW( vx, vx ), b2MulW( vy, vy ) );
+		b2FloatW linearMask = b2GreaterThanW( lengthSquared, maxLinearSpeedSquared );
+		b2FloatW angularMask = b2GreaterThanW( b2MulW( w, w ), maxAngularSpeedSquared );
+
+		if ( b2AllZeroW( b2OrW( linearMask, angularMask ) ) == false )
+		{
+			// Clamp to max linear speed
+			b2FloatW ratio = b2DivW( maxLinearSpeedW, b2SqrtW( lengthSquared ) );
+			vx = b2BlendW( vx, b2MulW( ratio, vx ), linearMask );
+			vy = b2BlendW( vy, b2MulW( ratio, vy ), linearMask );
+
+			// Clamp to max angular speed unless the body allows fast rotation
+			b2FloatLanes clampedW = { b2MulW( w, b2DivW( maxAngularSpeedW, b2AbsW( w ) ) ) };
+			b2FloatLanes lanesW = { w };
+			b2FloatLanes linearLanes = { linearMask };
+			b2FloatLanes angularLanes = { angularMask };
+
+			for ( int i = 0; i < B2_SIMD_WIDTH; ++i )
+			{
+				b2BodySim* bodySim = sims + base + i;
+				if ( linearLanes.f[i] != 0.0f )
+				{
+					bodySim->isSpeedCapped = true;
+				}
+
+				if ( angularLanes.f[i] != 0.0f && bodySim->allowFastRotation == false )
+				{
+					lanesW.f[i] = clampedW.f[i];
+					bodySim->isSpeedCapped = true;
+				}
+			}
+
+			w = lanesW.w;
+		}
+
+		body.v.X = vx;
+		body.v.Y = vy;
+		body.w = w;
+		b2ScatterBodies( states, indices, &body );
+	}
+
+	b2IntegrateVelocities( sims + wideCount, states + wideCount, count - wideCount, gravity, h, maxLinearSpeed,
+						   maxAngularSpeed );
+}
+
+// Matches b2IntegratePositions bit for bit
+void b2IntegratePositionsWide( b2BodyState* states, int count, float h )
+{
+	b2FloatW zero = b2ZeroW();
+	b2FloatW one = b2SplatW( 1.0f );
+	b2FloatW hw = b2SplatW( h );
+
+	int wideCount = count - count % B2_SIMD_WIDTH;
+	int indices[B2_SIMD_WIDTH];
+
+	for ( int base = 0; base < wideCount; base += B2_SIMD_WIDTH )
+	{
+		for ( int i = 0; i < B2_SIMD_WIDTH; ++i )
+		{
+			indices[i] = base + i;
+		}
+
+		b2BodyStateW body = b2GatherBodies( states, indices );
+
+		// see b2IntegrateRotation
+		b2FloatW deltaAngle = b2MulW( hw, body.w );
+		b2FloatW c = b2MulSubW( body.dq.C, deltaAngle, body.dq.S );
+		b2FloatW s = b2MulAddW( body.dq.S, deltaAngle, body.dq.C );
+		b2FloatW mag = b2SqrtW( b2AddW( b2MulW( s, s ), b2MulW( c, c ) ) );
+		b2FloatW invMag = b2BlendW( zero, b2DivW( one, mag ), b2GreaterThanW( mag, zero ) );
+		body.dq.C = b2MulW( c, invMag );
+		body.dq.S = b2MulW( s, invMag );
+
+		body.dp.X = b2MulAddW( body.dp.X, hw, body.v.X );
+		body.dp.Y = b2MulAddW( body.dp.Y, hw, body.v.Y );
+
+		b2ScatterBodyDeltas( states, indices, &body );
+	}
+
+	b2IntegratePositions( states + wideCount, count - wideCount, h );
+}
+
 void b2PrepareContactsTask( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( prepare_contact, "Prepare Contact", b2_colorYellow, true );
@@ -2118,3 +2114,39 @@ void b2StoreImpulsesTask( int startIndex, int endIndex, b2StepContext* context )
 
 	b2TracyCZoneEnd( store_impulses );
 }
+
+#if defined( B2_SIMD_AVX512 )
+	#define B2_SIMD_BACKEND b2_simdAVX512
+#elif defined( B2_SIMD_AVX2 )
+	#define B2_SIMD_BACKEND b2_simdAVX2
+#elif defined( B2_SIMD_NEON )
+	#define B2_SIMD_BACKEND b2_simdNeon
+#elif defined( B2_SIMD_SSE2 )
+	#define B2_SIMD_BACKEND b2_simdSSE2
+#else
+	#define B2_SIMD_BACKEND b2_simdScalar
+#endif
+
+const b2SIMDKernels B2_SIMD_NAME( b2_simdKernels ) = {
+	.backend = B2_SIMD_BACKEND,
+	.width = B2_SIMD_WIDTH,
+	.getContactConstraintByteCount = b2GetContactConstraintSIMDByteCount,
+	.getJointConstraintByteCount = b2GetJointConstraintSIMDByteCount,
+#if defined( B2_SIMD_NONE )
+	// The scalar integrators are faster than the emulated wide ones
+	.integrateVelocities = b2IntegrateVelocities,
+	.integratePositions = b2IntegratePositions,
+#else
+	.integrateVelocities = b2IntegrateVelocitiesWide,
+	.integratePositions = b2IntegratePositionsWide,
+#endif
+	.prepareContacts = b2PrepareContactsTask,
+	.warmStartContacts = b2WarmStartContactsTask,
+	.solveContacts = b2SolveContactsTask,
+	.applyRestitution = b2ApplyRestitutionTask,
+	.storeImpulses = b2StoreImpulsesTask,
+	.prepareJoints = b2PrepareJointsSIMDTask,
+	.warmStartJoints = b2WarmStartJointsSIMDTask,
+	.solveJoints = b2SolveJointsSIMDTask,
+	.storeJointImpulses = b2StoreJointImpulsesTask,
+};
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "simd.h"
+#include "simd_kernels.h"
 #include "solver.h"
 
 typedef struct b2ContactSim b2ContactSim;
@@ -39,12 +41,29 @@ typedef struct b2ContactConstraint
 
 int b2GetContactConstraintSIMDByteCount( void );
 
-// Overflow contacts don't fit into the constraint graph coloring
-void b2PrepareOverflowContacts( b2StepContext* context );
-void b2WarmStartOverflowContacts( b2StepContext* context );
-void b2SolveOverflowContacts( b2StepContext* context, bool useBias );
-void b2ApplyOverflowRestitution( b2StepContext* context );
-void b2StoreOverflowImpulses( b2StepContext* context );
+// wide version of b2BodyState
+typedef struct b2BodyStateW
+{
+	b2Vec2W v;
+	b2FloatW w;
+	b2FloatW flags;
+	b2Vec2W dp;
+	b2RotW dq;
+} b2BodyStateW;
+
+// Load and transpose the bodies of one lane group. Null indices give the identity body.
+b2BodyStateW b2GatherBodies( const b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices );
+
+// This writes only the velocities back to the solver bodies
+void b2ScatterBodies( b2BodyState* B2_RESTRICT states, int* B2_RESTRICT indices, const b2BodyStateW* B2_RESTRICT simdBody );
+
+// Overflow contacts don't fit into the constraint graph coloring. The range indexes the overflow
+// permutation in the step context, which keeps the contacts of each independent body set together.
+void b2PrepareOverflowContacts( int startIndex, int endIndex, b2StepContext* context );
+void b2WarmStartOverflowContacts( int startIndex, int endIndex, b2StepContext* context );
+void b2SolveOverflowContacts( int startIndex, int endIndex, b2StepContext* context, bool useBias );
+void b2ApplyOverflowRestitution( int startIndex, int endIndex, b2StepContext* context );
+void b2StoreOverflowImpulses( int startIndex, int endIndex, b2StepContext* context );
 
 // Contacts that live within the constraint graph coloring
 void b2PrepareContactsTask( int startIndex, int endIndex, b2StepContext* context );
@@ -52,3 +71,8 @@ void b2WarmStartContactsTask( int startIndex, int endIndex, b2StepContext* conte
 void b2SolveContactsTask( int startIndex, int endIndex, b2StepContext* context, int colorIndex, bool useBias );
 void b2ApplyRestitutionTask( int startIndex, int endIndex, b2StepContext* context, int colorIndex );
 void b2StoreImpulsesTask( int startIndex, int endIndex, b2StepContext* context );
+
+// Wide body integration, matches b2IntegrateVelocities and b2IntegratePositions exactly
+void b2IntegrateVelocitiesWide( b2BodySim* sims, b2BodyState* states, int count, b2Vec2 gravity, float h,
+								float maxLinearSpeed, float maxAngularSpeed );
+void b2IntegratePositionsWide( b2BodyState* states, int count, float h );
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+// AVX2 copy of the wide contact solver for run time dispatch. This file is compiled with AVX2 enabled.
+#define BOX2D_AVX2
+#define B2_SIMD_SUFFIX _avx2
+
+#include "contact_solver.c"
@@ -0,0 +1,8 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+// AVX-512 copy of the wide contact solver for run time dispatch. This file is compiled with AVX-512 enabled.
+#define BOX2D_AVX512
+#define B2_SIMD_SUFFIX _avx512
+
+#include "contact_solver.c"
@@ -86,9 +86,6 @@ void b2SetAllocator( b2AllocFcn* allocFcn, b2FreeFcn* freeFcn )
 	b2_freeFcn = freeFcn;
 }
 
-// Use 32 byte alignment for everything. Works with 256bit SIMD.
-#define B2_ALIGNMENT 32
-
 void* b2Alloc( int size )
 {
 	if ( size == 0 )
@@ -99,9 +96,9 @@ void* b2Alloc( int size )
 	// This could cause some sharing issues, however Box2D rarely calls b2Alloc.
 	b2AtomicFetchAddInt( &b2_byteCount, size );
 
-	// Allocation must be a multiple of 32 or risk a seg fault
+	// Allocation must be a multiple of the alignment or risk a seg fault
 	// https://en.cppreference.com/w/c/memory/aligned_alloc
-	int size32 = ( ( size - 1 ) | 0x1F ) + 1;
+	int size32 = ( ( size - 1 ) | ( B2_ALIGNMENT - 1 ) ) + 1;
 
 	if ( b2_allocFcn != NULL )
 	{
@@ -109,7 +106,7 @@ void* b2Alloc( int size )
 		b2TracyCAlloc( ptr, size );
 
 		B2_ASSERT( ptr != NULL );
-		B2_ASSERT( ( (uintptr_t)ptr & 0x1F ) == 0 );
+		B2_ASSERT( ( (uintptr_t)ptr & ( B2_ALIGNMENT - 1 ) ) == 0 );
 
 		return ptr;
 	}
@@ -130,7 +127,7 @@ void* b2Alloc( int size )
 	b2TracyCAlloc( ptr, size );
 
 	B2_ASSERT( ptr != NULL );
-	B2_ASSERT( ( (uintptr_t)ptr & 0x1F ) == 0 );
+	B2_ASSERT( ( (uintptr_t)ptr & ( B2_ALIGNMENT - 1 ) ) == 0 );
 
 	return ptr;
 }
@@ -62,7 +62,10 @@
 	#define B2_SIMD_WIDTH 4
 #else
 	#if defined( B2_CPU_X86_X64 )
-		#if defined( BOX2D_AVX2 )
+		#if defined( BOX2D_AVX512 )
+			#define B2_SIMD_AVX512
+			#define B2_SIMD_WIDTH 16
+		#elif defined( BOX2D_AVX2 )
 			#define B2_SIMD_AVX2
 			#define B2_SIMD_WIDTH 8
 		#else
@@ -82,6 +85,13 @@
 	#endif
 #endif
 
+// Heap and arena allocations are aligned for the widest SIMD type
+#if defined( B2_SIMD_AVX512 ) || defined( BOX2D_DISPATCH_AVX512 )
+	#define B2_ALIGNMENT 64
+#else
+	#define B2_ALIGNMENT 32
+#endif
+
 // Define compiler
 #if defined( __clang__ )
 	#define B2_COMPILER_CLANG
@@ -91,6 +101,16 @@
 	#define B2_COMPILER_MSVC
 #endif
 
+// Hint that memory is read soon, so the cache misses of gathered data overlap
+#if defined( B2_COMPILER_GCC ) || defined( B2_COMPILER_CLANG )
+	#define B2_PREFETCH( ptr ) __builtin_prefetch( ptr )
+#elif defined( B2_COMPILER_MSVC ) && defined( B2_CPU_X86_X64 )
+	#include <xmmintrin.h>
+	#define B2_PREFETCH( ptr ) _mm_prefetch( (const char*)( ptr ), _MM_HINT_T0 )
+#else
+	#define B2_PREFETCH( ptr ) ( (void)( ptr ) )
+#endif
+
 /// Tracy profiler instrumentation
 /// https://github.com/wolfpld/tracy
 #ifdef BOX2D_PROFILE
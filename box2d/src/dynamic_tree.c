@@ -4,6 +4,8 @@
 #include "aabb.h"
 #include "constants.h"
 #include "core.h"
+#include "ctz.h"
+#include "snapshot.h"
 
 #include "box2d/collision.h"
 #include "box2d/math_functions.h"
@@ -11,6 +13,12 @@
 #include <float.h>
 #include <string.h>
 
+#if defined( B2_SIMD_AVX512 ) || defined( B2_SIMD_AVX2 ) || defined( B2_SIMD_SSE2 )
+#include <emmintrin.h>
+#elif defined( B2_SIMD_NEON )
+#include <arm_neon.h>
+#endif
+
 #define B2_TREE_STACK_SIZE 1024
 
 // todo externalize this to visualize internal nodes and speed up FindPairs
@@ -62,6 +70,19 @@ static b2TreeNode b2_defaultTreeNode = {
 	.flags = b2_allocatedNode,
 };
 
+// A node of the optional 4-wide tree. The child boxes are stored by component so a single SIMD
+// compare tests all four. A child is a wide node index, a leaf encoded as -2 - proxyId, or
+// B2_NULL_INDEX for an unused slot.
+typedef struct b2WideNode
+{
+	float lowerX[4];
+	float lowerY[4];
+	float upperX[4];
+	float upperY[4];
+	uint64_t categoryBits[4];
+	int32_t children[4];
+} b2WideNode;
+
 static bool b2IsLeaf( const b2TreeNode* node )
 {
 	return node->flags & b2_leafNode;
@@ -99,11 +120,18 @@ b2DynamicTree b2DynamicTree_Create( void )
 	tree.proxyCount = 0;
 
 	tree.leafIndices = NULL;
+	tree.rebuildNodes = NULL;
 	tree.leafBoxes = NULL;
 	tree.leafCenters = NULL;
 	tree.binIndices = NULL;
 	tree.rebuildCapacity = 0;
 
+	tree.wideNodes = NULL;
+	tree.wideNodeCount = 0;
+	tree.wideNodeCapacity = 0;
+	tree.wideEnabled = false;
+	tree.wideValid = false;
+
 	return tree;
 }
 
@@ -111,9 +139,11 @@ void b2DynamicTree_Destroy( b2DynamicTree* tree )
 {
 	b2Free( tree->nodes, tree->nodeCapacity * sizeof( b2TreeNode ) );
 	b2Free( tree->leafIndices, tree->rebuildCapacity * sizeof( int32_t ) );
+	b2Free( tree->rebuildNodes, tree->rebuildCapacity * sizeof( int32_t ) );
 	b2Free( tree->leafBoxes, tree->rebuildCapacity * sizeof( b2AABB ) );
 	b2Free( tree->leafCenters, tree->rebuildCapacity * sizeof( b2Vec2 ) );
 	b2Free( tree->binIndices, tree->rebuildCapacity * sizeof( int32_t ) );
+	b2Free( tree->wideNodes, tree->wideNodeCapacity * sizeof( b2WideNode ) );
 
 	memset( tree, 0, sizeof( b2DynamicTree ) );
 }
@@ -787,6 +817,7 @@ int b2DynamicTree_CreateProxy( b2DynamicTree* tree, b2AABB aabb, uint64_t catego
 	b2InsertLeaf( tree, proxyId, shouldRotate );
 
 	tree->proxyCount += 1;
+	tree->wideValid = false;
 
 	return proxyId;
 }
@@ -801,6 +832,7 @@ void b2DynamicTree_DestroyProxy( b2DynamicTree* tree, int proxyId )
 
 	B2_ASSERT( tree->proxyCount > 0 );
 	tree->proxyCount -= 1;
+	tree->wideValid = false;
 }
 
 int b2DynamicTree_GetProxyCount( const b2DynamicTree* tree )
@@ -822,6 +854,8 @@ void b2DynamicTree_MoveProxy( b2DynamicTree* tree, int proxyId, b2AABB aabb )
 
 	bool shouldRotate = false;
 	b2InsertLeaf( tree, proxyId, shouldRotate );
+
+	tree->wideValid = false;
 }
 
 void b2DynamicTree_EnlargeProxy( b2DynamicTree* tree, int proxyId, b2AABB aabb )
@@ -838,6 +872,7 @@ void b2DynamicTree_EnlargeProxy( b2DynamicTree* tree, int proxyId, b2AABB aabb )
 	B2_ASSERT( b2AABB_Contains( nodes[proxyId].aabb, aabb ) == false );
 
 	nodes[proxyId].aabb = aabb;
+	tree->wideValid = false;
 
 	int parentIndex = nodes[proxyId].parent;
 	while (parentIndex != B2_NULL_INDEX)
@@ -874,6 +909,7 @@ void b2DynamicTree_SetCategoryBits( b2DynamicTree* tree, int proxyId, uint64_t c
 	B2_ASSERT( (nodes[proxyId].flags & b2_leafNode) == b2_leafNode );
 
 	nodes[proxyId].categoryBits = categoryBits;
+	tree->wideValid = false;
 
 	// Fix up category bits in ancestor internal nodes
 	int nodeIndex = nodes[proxyId].parent;
@@ -1091,230 +1127,1308 @@ void b2DynamicTree_ValidateNoEnlarged(const b2DynamicTree* tree)
 #endif
 }
 
-int b2DynamicTree_GetByteCount( const b2DynamicTree* tree )
+typedef struct b2WideBuildItem
 {
-	size_t size = sizeof( b2DynamicTree ) + sizeof( b2TreeNode ) * tree->nodeCapacity +
-				  tree->rebuildCapacity * ( sizeof( int ) + sizeof( b2AABB ) + sizeof( b2Vec2 ) + sizeof( int ) );
-
-	return (int)size;
-}
+	int nodeIndex;
+	int parentIndex;
+	int slot;
+} b2WideBuildItem;
 
-uint64_t b2DynamicTree_GetUserData( const b2DynamicTree* tree, int proxyId )
+static int b2WideLeaf( int proxyId )
 {
-	B2_ASSERT( 0 <= proxyId && proxyId < tree->nodeCapacity );
-	return tree->nodes[proxyId].userData;
+	return -2 - proxyId;
 }
 
-b2AABB b2DynamicTree_GetAABB( const b2DynamicTree* tree, int proxyId )
+static void b2WriteWideNode( b2WideNode* wide, const b2TreeNode* nodes, const int* slots, int count )
 {
-	B2_ASSERT( 0 <= proxyId && proxyId < tree->nodeCapacity );
-	return tree->nodes[proxyId].aabb;
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( i >= count )
+		{
+			// Inverted box so unused slots never overlap anything
+			wide->lowerX[i] = FLT_MAX;
+			wide->lowerY[i] = FLT_MAX;
+			wide->upperX[i] = -FLT_MAX;
+			wide->upperY[i] = -FLT_MAX;
+			wide->categoryBits[i] = 0;
+			continue;
+		}
+
+		const b2TreeNode* child = nodes + slots[i];
+		wide->lowerX[i] = child->aabb.lowerBound.x;
+		wide->lowerY[i] = child->aabb.lowerBound.y;
+		wide->upperX[i] = child->aabb.upperBound.x;
+		wide->upperY[i] = child->aabb.upperBound.y;
+		wide->categoryBits[i] = child->categoryBits;
+	}
 }
 
-b2TreeStats b2DynamicTree_Query( const b2DynamicTree* tree, b2AABB aabb, uint64_t maskBits, b2TreeQueryCallbackFcn* callback,
-								 void* context )
+// Collapse the binary tree into 4-wide nodes. A wide node starts with the two children of a binary
+// node and keeps opening its largest internal child until it holds four boxes. Children are opened
+// in place, so the leaves keep their binary tree order and the wide queries report them in the same
+// order as the binary queries. Nodes are numbered in the order the queries visit them, so a walk
+// down the tree moves forward through memory.
+static void b2BuildWideNodes( b2DynamicTree* tree )
 {
-	b2TreeStats result = { 0 };
+	tree->wideNodeCount = 0;
+	tree->wideValid = false;
 
-	if ( tree->nodeCount == 0 )
+	if ( tree->root == B2_NULL_INDEX )
 	{
-		return result;
+		return;
 	}
 
-	int stack[B2_TREE_STACK_SIZE];
+	// Every wide node consumes at least one binary internal node
+	int capacity = b2MaxInt( tree->proxyCount, 1 );
+	if ( capacity > tree->wideNodeCapacity )
+	{
+		b2Free( tree->wideNodes, tree->wideNodeCapacity * sizeof( b2WideNode ) );
+		tree->wideNodeCapacity = capacity + capacity / 2;
+		tree->wideNodes = b2Alloc( tree->wideNodeCapacity * sizeof( b2WideNode ) );
+	}
+
+	const b2TreeNode* nodes = tree->nodes;
+	b2WideNode* wideNodes = tree->wideNodes;
+
+	b2WideBuildItem stack[B2_TREE_STACK_SIZE];
 	int stackCount = 0;
-	stack[stackCount++] = tree->root;
+	stack[stackCount++] = (b2WideBuildItem){ tree->root, B2_NULL_INDEX, 0 };
+	int wideNodeCount = 0;
 
 	while ( stackCount > 0 )
 	{
-		int nodeId = stack[--stackCount];
-		if ( nodeId == B2_NULL_INDEX )
+		b2WideBuildItem item = stack[--stackCount];
+		const b2TreeNode* node = nodes + item.nodeIndex;
+
+		B2_ASSERT( wideNodeCount < tree->wideNodeCapacity );
+		int wideIndex = wideNodeCount++;
+		if ( item.parentIndex != B2_NULL_INDEX )
 		{
-			// todo huh?
-			B2_ASSERT( false );
-			continue;
+			wideNodes[item.parentIndex].children[item.slot] = wideIndex;
 		}
 
-		const b2TreeNode* node = tree->nodes + nodeId;
-		result.nodeVisits += 1;
+		int slots[4];
+		int count;
+		if ( b2IsLeaf( node ) )
+		{
+			// Only the root can get here
+			slots[0] = item.nodeIndex;
+			count = 1;
+		}
+		else
+		{
+			slots[0] = node->children.child1;
+			slots[1] = node->children.child2;
+			count = 2;
+		}
 
-		if ( b2AABB_Overlaps( node->aabb, aabb ) && ( node->categoryBits & maskBits ) != 0 )
+		while ( count < 4 )
 		{
-			if ( b2IsLeaf( node ) )
+			int best = B2_NULL_INDEX;
+			float bestPerimeter = -1.0f;
+			for ( int i = 0; i < count; ++i )
 			{
-				// callback to user code with proxy id
-				bool proceed = callback( nodeId, node->userData, context );
-				result.leafVisits += 1;
-
-				if ( proceed == false )
+				const b2TreeNode* child = nodes + slots[i];
+				float perimeter = b2Perimeter( child->aabb );
+				if ( b2IsLeaf( child ) == false && perimeter > bestPerimeter )
 				{
-					return result;
+					best = i;
+					bestPerimeter = perimeter;
 				}
 			}
-			else
+
+			if ( best == B2_NULL_INDEX )
 			{
-				if ( stackCount < B2_TREE_STACK_SIZE - 1 )
-				{
-					stack[stackCount++] = node->children.child1;
-					stack[stackCount++] = node->children.child2;
-				}
-				else
-				{
-					B2_ASSERT( stackCount < B2_TREE_STACK_SIZE - 1 );
-				}
+				break;
+			}
+
+			const b2TreeNode* opened = nodes + slots[best];
+			for ( int i = count; i > best + 1; --i )
+			{
+				slots[i] = slots[i - 1];
+			}
+
+			slots[best] = opened->children.child1;
+			slots[best + 1] = opened->children.child2;
+			count += 1;
+		}
+
+		b2WriteWideNode( wideNodes + wideIndex, nodes, slots, count );
+
+		int32_t* children = wideNodes[wideIndex].children;
+		for ( int i = 0; i < 4; ++i )
+		{
+			if ( i >= count )
+			{
+				children[i] = B2_NULL_INDEX;
+				continue;
+			}
+
+			if ( b2IsLeaf( nodes + slots[i] ) )
+			{
+				children[i] = b2WideLeaf( slots[i] );
+				continue;
+			}
+
+			if ( stackCount == B2_TREE_STACK_SIZE )
+			{
+				// Leave the wide nodes invalid and fall back to the binary tree
+				B2_ASSERT( stackCount < B2_TREE_STACK_SIZE );
+				return;
 			}
+
+			// Patched when the child is numbered
+			children[i] = B2_NULL_INDEX;
+			stack[stackCount++] = (b2WideBuildItem){ slots[i], wideIndex, i };
 		}
 	}
 
-	return result;
+	tree->wideNodeCount = wideNodeCount;
+	tree->wideValid = true;
 }
 
-b2TreeStats b2DynamicTree_RayCast( const b2DynamicTree* tree, const b2RayCastInput* input, uint64_t maskBits,
-								   b2TreeRayCastCallbackFcn* callback, void* context )
+void b2DynamicTree_EnableWideNodes( b2DynamicTree* tree, bool flag )
 {
-	b2TreeStats result = { 0 };
+	tree->wideEnabled = flag;
 
-	if ( tree->nodeCount == 0 )
+	if ( flag )
 	{
-		return result;
+		b2BuildWideNodes( tree );
 	}
+	else
+	{
+		tree->wideValid = false;
+	}
+}
 
-	b2Vec2 p1 = input->origin;
-	b2Vec2 d = input->translation;
-
-	b2Vec2 r = b2Normalize( d );
+// Returns a bit for each child box of the wide node that overlaps the box
+static int b2WideOverlapMask( const b2WideNode* node, b2AABB a )
+{
+	// Same test as b2AABB_Overlaps, four boxes at a time
+#if defined( B2_SIMD_AVX512 ) || defined( B2_SIMD_AVX2 ) || defined( B2_SIMD_SSE2 )
+	__m128 sx = _mm_or_ps( _mm_cmpgt_ps( _mm_loadu_ps( node->lowerX ), _mm_set1_ps( a.upperBound.x ) ),
+						   _mm_cmpgt_ps( _mm_set1_ps( a.lowerBound.x ), _mm_loadu_ps( node->upperX ) ) );
+	__m128 sy = _mm_or_ps( _mm_cmpgt_ps( _mm_loadu_ps( node->lowerY ), _mm_set1_ps( a.upperBound.y ) ),
+						   _mm_cmpgt_ps( _mm_set1_ps( a.lowerBound.y ), _mm_loadu_ps( node->upperY ) ) );
+	int separated = _mm_movemask_ps( _mm_or_ps( sx, sy ) );
+#elif defined( B2_SIMD_NEON )
+	static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+	uint32x4_t sx = vorrq_u32( vcgtq_f32( vld1q_f32( node->lowerX ), vdupq_n_f32( a.upperBound.x ) ),
+							   vcgtq_f32( vdupq_n_f32( a.lowerBound.x ), vld1q_f32( node->upperX ) ) );
+	uint32x4_t sy = vorrq_u32( vcgtq_f32( vld1q_f32( node->lowerY ), vdupq_n_f32( a.upperBound.y ) ),
+							   vcgtq_f32( vdupq_n_f32( a.lowerBound.y ), vld1q_f32( node->upperY ) ) );
+	uint32x4_t bits = vandq_u32( vorrq_u32( sx, sy ), vld1q_u32( laneBits ) );
+	uint32x2_t pair = vorr_u32( vget_low_u32( bits ), vget_high_u32( bits ) );
+	int separated = (int)( vget_lane_u32( pair, 0 ) | vget_lane_u32( pair, 1 ) );
+#else
+	int separated = 0;
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( node->lowerX[i] > a.upperBound.x || node->lowerY[i] > a.upperBound.y || a.lowerBound.x > node->upperX[i] ||
+			 a.lowerBound.y > node->upperY[i] )
+		{
+			separated |= 1 << i;
+		}
+	}
+#endif
 
-	// v is perpendicular to the segment.
-	b2Vec2 v = b2CrossSV( 1.0f, r );
-	b2Vec2 abs_v = b2Abs( v );
+	return ~separated & 0xF;
+}
 
-	// Separating axis for segment (Gino, p80).
-	// |dot(v, p1 - c)| > dot(|v|, h)
+// Returns a bit for each used child of a wide node with a category in the mask. Unused slots have no
+// category bits.
+static int b2GetWideCategoryMask( const b2WideNode* node, uint64_t maskBits )
+{
+	int mask = 0;
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( node->categoryBits[i] & maskBits )
+		{
+			mask |= 1 << i;
+		}
+	}
 
-	float maxFraction = input->maxFraction;
+	return mask;
+}
 
-	b2Vec2 p2 = b2MulAdd( p1, maxFraction, d );
+// Returns a bit for each used child of a wide node that overlaps the box and has a category in the mask
+static int b2GetWideChildMask( const b2WideNode* node, b2AABB box, uint64_t maskBits )
+{
+	return b2GetWideCategoryMask( node, maskBits ) & b2WideOverlapMask( node, box );
+}
 
-	// Build a bounding box for the segment.
-	b2AABB segmentAABB = { b2Min( p1, p2 ), b2Max( p1, p2 ) };
+// The center and extents of a wide node child
+static void b2GetWideChildBox( const b2WideNode* node, int i, b2Vec2* center, b2Vec2* extents )
+{
+	*center = (b2Vec2){ 0.5f * ( node->lowerX[i] + node->upperX[i] ), 0.5f * ( node->lowerY[i] + node->upperY[i] ) };
+	*extents = (b2Vec2){ 0.5f * ( node->upperX[i] - node->lowerX[i] ), 0.5f * ( node->upperY[i] - node->lowerY[i] ) };
+}
 
-	int stack[B2_TREE_STACK_SIZE];
-	int stackCount = 0;
-	stack[stackCount++] = tree->root;
+// Stack entries of the wide queries are wide node indices, or leaves as -2 - proxyId. Leaves go
+// through the stack so they are reported in the same order as the binary query.
+static b2TreeStats b2QueryWide( const b2DynamicTree* tree, b2AABB aabb, uint64_t maskBits, b2TreeQueryCallbackFcn* callback,
+								void* context )
+{
+	b2TreeStats result = { 0 };
 
 	const b2TreeNode* nodes = tree->nodes;
 
-	b2RayCastInput subInput = *input;
+	int stack[B2_TREE_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = 0;
 
 	while ( stackCount > 0 )
 	{
-		int nodeId = stack[--stackCount];
-		if ( nodeId == B2_NULL_INDEX )
+		int entry = stack[--stackCount];
+		if ( entry < 0 )
 		{
-			// todo is this possible?
-			B2_ASSERT( false );
+			int proxyId = b2WideLeaf( entry );
+			const b2TreeNode* node = nodes + proxyId;
+
+			bool proceed = callback( proxyId, node->userData, context );
+			result.leafVisits += 1;
+
+			if ( proceed == false )
+			{
+				return result;
+			}
+
 			continue;
 		}
 
-		const b2TreeNode* node = nodes + nodeId;
 		result.nodeVisits += 1;
 
-		b2AABB nodeAABB = node->aabb;
-
-		if ( ( node->categoryBits & maskBits ) == 0 || b2AABB_Overlaps( nodeAABB, segmentAABB ) == false )
+		if ( stackCount > B2_TREE_STACK_SIZE - 4 )
 		{
+			B2_ASSERT( stackCount <= B2_TREE_STACK_SIZE - 4 );
 			continue;
 		}
 
-		// Separating axis for segment (Gino, p80).
-		// |dot(v, p1 - c)| > dot(|v|, h)
-		// radius extension is added to the node in this case
-		b2Vec2 c = b2AABB_Center( nodeAABB );
-		b2Vec2 h = b2AABB_Extents( nodeAABB );
-		float term1 = b2AbsFloat( b2Dot( v, b2Sub( p1, c ) ) );
-		float term2 = b2Dot( abs_v, h );
-		if ( term2 < term1 )
+		const b2WideNode* wide = tree->wideNodes + entry;
+		const int32_t* children = wide->children;
+		int mask = b2GetWideChildMask( wide, aabb, maskBits );
+		for ( int i = 0; i < 4; ++i )
 		{
-			continue;
+			if ( mask & ( 1 << i ) )
+			{
+				stack[stackCount++] = children[i];
+			}
 		}
+	}
 
-		if ( b2IsLeaf( node ) )
+	return result;
+}
+
+static b2TreeStats b2RayCastWide( const b2DynamicTree* tree, const b2RayCastInput* input, uint64_t maskBits,
+								  b2TreeRayCastCallbackFcn* callback, void* context )
+{
+	b2TreeStats result = { 0 };
+
+	b2Vec2 p1 = input->origin;
+	b2Vec2 d = input->translation;
+	b2Vec2 r = b2Normalize( d );
+	b2Vec2 v = b2CrossSV( 1.0f, r );
+	b2Vec2 abs_v = b2Abs( v );
+
+	float maxFraction = input->maxFraction;
+	b2Vec2 p2 = b2MulAdd( p1, maxFraction, d );
+	b2AABB segmentAABB = { b2Min( p1, p2 ), b2Max( p1, p2 ) };
+
+	const b2TreeNode* nodes = tree->nodes;
+
+	b2RayCastInput subInput = *input;
+
+	int stack[B2_TREE_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = 0;
+
+	while ( stackCount > 0 )
+	{
+		int entry = stack[--stackCount];
+		if ( entry < 0 )
 		{
+			int proxyId = b2WideLeaf( entry );
+			const b2TreeNode* node = nodes + proxyId;
+
+			// The segment may have been clipped since this leaf was pushed
+			if ( b2AABB_Overlaps( node->aabb, segmentAABB ) == false )
+			{
+				continue;
+			}
+
 			subInput.maxFraction = maxFraction;
 
-			float value = callback( &subInput, nodeId, node->userData, context );
+			float value = callback( &subInput, proxyId, node->userData, context );
 			result.leafVisits += 1;
 
-			// The user may return -1 to indicate this shape should be skipped
-
 			if ( value == 0.0f )
 			{
-				// The client has terminated the ray cast.
 				return result;
 			}
 
 			if ( 0.0f < value && value <= maxFraction )
 			{
-				// Update segment bounding box.
 				maxFraction = value;
 				p2 = b2MulAdd( p1, maxFraction, d );
 				segmentAABB.lowerBound = b2Min( p1, p2 );
 				segmentAABB.upperBound = b2Max( p1, p2 );
 			}
+
+			continue;
 		}
-		else
+
+		result.nodeVisits += 1;
+
+		const b2WideNode* wide = tree->wideNodes + entry;
+		const int32_t* children = wide->children;
+		int mask = b2GetWideChildMask( wide, segmentAABB, maskBits );
+
+		// Children that pass the segment test, farthest first so the nearest is popped first
+		int candidates[4];
+		float distances[4];
+		int candidateCount = 0;
+
+		for ( int i = 0; i < 4; ++i )
 		{
-			if ( stackCount < B2_TREE_STACK_SIZE - 1 )
+			if ( ( mask & ( 1 << i ) ) == 0 )
 			{
-				b2Vec2 c1 = b2AABB_Center( nodes[node->children.child1].aabb );
-				b2Vec2 c2 = b2AABB_Center( nodes[node->children.child2].aabb );
-				if ( b2DistanceSquared( c1, p1 ) < b2DistanceSquared( c2, p1 ) )
-				{
-					stack[stackCount++] = node->children.child2;
-					stack[stackCount++] = node->children.child1;
-				}
-				else
-				{
-					stack[stackCount++] = node->children.child1;
-					stack[stackCount++] = node->children.child2;
-				}
+				continue;
 			}
-			else
+
+			// Separating axis for segment (Gino, p80).
+			// |dot(v, p1 - c)| > dot(|v|, h)
+			b2Vec2 c, h;
+			b2GetWideChildBox( wide, i, &c, &h );
+			float term1 = b2AbsFloat( b2Dot( v, b2Sub( p1, c ) ) );
+			float term2 = b2Dot( abs_v, h );
+			if ( term2 < term1 )
 			{
-				B2_ASSERT( stackCount < B2_TREE_STACK_SIZE - 1 );
+				continue;
+			}
+
+			float distance = b2DistanceSquared( c, p1 );
+			int j = candidateCount;
+			while ( j > 0 && distances[j - 1] < distance )
+			{
+				candidates[j] = candidates[j - 1];
+				distances[j] = distances[j - 1];
+				j -= 1;
 			}
+
+			candidates[j] = children[i];
+			distances[j] = distance;
+			candidateCount += 1;
+		}
+
+		if ( stackCount + candidateCount > B2_TREE_STACK_SIZE )
+		{
+			B2_ASSERT( stackCount + candidateCount <= B2_TREE_STACK_SIZE );
+			continue;
+		}
+
+		for ( int i = 0; i < candidateCount; ++i )
+		{
+			stack[stackCount++] = candidates[i];
 		}
 	}
 
 	return result;
 }
 
-b2TreeStats b2DynamicTree_ShapeCast( const b2DynamicTree* tree, const b2ShapeCastInput* input, uint64_t maskBits,
-									 b2TreeShapeCastCallbackFcn* callback, void* context )
+static b2TreeStats b2ShapeCastWide( const b2DynamicTree* tree, const b2ShapeCastInput* input, b2AABB originAABB,
+									uint64_t maskBits, b2TreeShapeCastCallbackFcn* callback, void* context )
 {
 	b2TreeStats stats = { 0 };
 
-	if ( tree->nodeCount == 0 || input->proxy.count == 0 )
-	{
-		return stats;
-	}
-
-	b2AABB originAABB = { input->proxy.points[0], input->proxy.points[0] };
-	for ( int i = 1; i < input->proxy.count; ++i )
-	{
-		originAABB.lowerBound = b2Min( originAABB.lowerBound, input->proxy.points[i] );
-		originAABB.upperBound = b2Max( originAABB.upperBound, input->proxy.points[i] );
-	}
-
-	b2Vec2 radius = { input->proxy.radius, input->proxy.radius };
-
-	originAABB.lowerBound = b2Sub( originAABB.lowerBound, radius );
-	originAABB.upperBound = b2Add( originAABB.upperBound, radius );
-
 	b2Vec2 p1 = b2AABB_Center( originAABB );
 	b2Vec2 extension = b2AABB_Extents( originAABB );
 
-	// v is perpendicular to the segment.
+	b2Vec2 r = input->translation;
+	b2Vec2 v = b2CrossSV( 1.0f, r );
+	b2Vec2 abs_v = b2Abs( v );
+
+	float maxFraction = input->maxFraction;
+	b2Vec2 t = b2MulSV( maxFraction, input->translation );
+	b2AABB totalAABB = {
+		b2Min( originAABB.lowerBound, b2Add( originAABB.lowerBound, t ) ),
+		b2Max( originAABB.upperBound, b2Add( originAABB.upperBound, t ) ),
+	};
+
+	const b2TreeNode* nodes = tree->nodes;
+
+	b2ShapeCastInput subInput = *input;
+
+	int stack[B2_TREE_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = 0;
+
+	while ( stackCount > 0 )
+	{
+		int entry = stack[--stackCount];
+		if ( entry < 0 )
+		{
+			int proxyId = b2WideLeaf( entry );
+			const b2TreeNode* node = nodes + proxyId;
+
+			// The cast may have been clipped since this leaf was pushed
+			if ( b2AABB_Overlaps( node->aabb, totalAABB ) == false )
+			{
+				continue;
+			}
+
+			subInput.maxFraction = maxFraction;
+
+			float value = callback( &subInput, proxyId, node->userData, context );
+			stats.leafVisits += 1;
+
+			if ( value == 0.0f )
+			{
+				return stats;
+			}
+
+			if ( 0.0f < value && value < maxFraction )
+			{
+				maxFraction = value;
+				t = b2MulSV( maxFraction, input->translation );
+				totalAABB.lowerBound = b2Min( originAABB.lowerBound, b2Add( originAABB.lowerBound, t ) );
+				totalAABB.upperBound = b2Max( originAABB.upperBound, b2Add( originAABB.upperBound, t ) );
+			}
+
+			continue;
+		}
+
+		stats.nodeVisits += 1;
+
+		const b2WideNode* wide = tree->wideNodes + entry;
+		const int32_t* children = wide->children;
+		int mask = b2GetWideChildMask( wide, totalAABB, maskBits );
+
+		int candidates[4];
+		float distances[4];
+		int candidateCount = 0;
+
+		for ( int i = 0; i < 4; ++i )
+		{
+			if ( ( mask & ( 1 << i ) ) == 0 )
+			{
+				continue;
+			}
+
+			// Separating axis for segment with the radius extension added to the child box
+			b2Vec2 c, h;
+			b2GetWideChildBox( wide, i, &c, &h );
+			h = b2Add( h, extension );
+			float term1 = b2AbsFloat( b2Dot( v, b2Sub( p1, c ) ) );
+			float term2 = b2Dot( abs_v, h );
+			if ( term2 < term1 )
+			{
+				continue;
+			}
+
+			float distance = b2DistanceSquared( c, p1 );
+			int j = candidateCount;
+			while ( j > 0 && distances[j - 1] < distance )
+			{
+				candidates[j] = candidates[j - 1];
+				distances[j] = distances[j - 1];
+				j -= 1;
+			}
+
+			candidates[j] = children[i];
+			distances[j] = distance;
+			candidateCount += 1;
+		}
+
+		if ( stackCount + candidateCount > B2_TREE_STACK_SIZE )
+		{
+			B2_ASSERT( stackCount + candidateCount <= B2_TREE_STACK_SIZE );
+			continue;
+		}
+
+		for ( int i = 0; i < candidateCount; ++i )
+		{
+			stack[stackCount++] = candidates[i];
+		}
+	}
+
+	return stats;
+}
+
+int b2DynamicTree_GetByteCount( const b2DynamicTree* tree )
+{
+	size_t size = sizeof( b2DynamicTree ) + sizeof( b2TreeNode ) * tree->nodeCapacity +
+				  tree->rebuildCapacity * ( 2 * sizeof( int ) + sizeof( b2AABB ) + sizeof( b2Vec2 ) + sizeof( int ) ) +
+				  sizeof( b2WideNode ) * tree->wideNodeCapacity;
+
+	return (int)size;
+}
+
+// The whole node pool is saved, including the free list, so proxy ids stay valid.
+// The rebuild scratch buffers are transient and keep their current allocation. The wide nodes
+// are derived from the binary tree and get rebuilt after loading.
+void b2SnapshotTree( b2Snapshot* snapshot, b2DynamicTree* tree )
+{
+	int nodeCapacity = b2SnapshotInt( snapshot, tree->nodeCapacity );
+	bool reading = snapshot->mode != b2_snapshotSave;
+	if ( snapshot->valid == false || nodeCapacity <= 0 ||
+		 ( reading && nodeCapacity > ( snapshot->capacity - snapshot->offset ) / (int)sizeof( b2TreeNode ) ) )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad && nodeCapacity != tree->nodeCapacity )
+	{
+		b2Free( tree->nodes, tree->nodeCapacity * sizeof( b2TreeNode ) );
+		tree->nodes = (b2TreeNode*)b2Alloc( nodeCapacity * sizeof( b2TreeNode ) );
+		tree->nodeCapacity = nodeCapacity;
+	}
+
+	b2SnapshotBytes( snapshot, tree->nodes, nodeCapacity * (int)sizeof( b2TreeNode ) );
+	B2_SNAPSHOT_VALUE( snapshot, tree->root );
+	B2_SNAPSHOT_VALUE( snapshot, tree->nodeCount );
+	B2_SNAPSHOT_VALUE( snapshot, tree->freeList );
+	B2_SNAPSHOT_VALUE( snapshot, tree->proxyCount );
+
+	if ( snapshot->mode == b2_snapshotLoad && snapshot->valid )
+	{
+		tree->wideValid = false;
+		if ( tree->wideEnabled )
+		{
+			b2BuildWideNodes( tree );
+		}
+	}
+}
+
+uint64_t b2DynamicTree_GetUserData( const b2DynamicTree* tree, int proxyId )
+{
+	B2_ASSERT( 0 <= proxyId && proxyId < tree->nodeCapacity );
+	return tree->nodes[proxyId].userData;
+}
+
+b2AABB b2DynamicTree_GetAABB( const b2DynamicTree* tree, int proxyId )
+{
+	B2_ASSERT( 0 <= proxyId && proxyId < tree->nodeCapacity );
+	return tree->nodes[proxyId].aabb;
+}
+
+b2TreeStats b2DynamicTree_Query( const b2DynamicTree* tree, b2AABB aabb, uint64_t maskBits, b2TreeQueryCallbackFcn* callback,
+								 void* context )
+{
+	b2TreeStats result = { 0 };
+
+	if ( tree->nodeCount == 0 )
+	{
+		return result;
+	}
+
+	if ( tree->wideValid )
+	{
+		return b2QueryWide( tree, aabb, maskBits, callback, context );
+	}
+
+	int stack[B2_TREE_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = tree->root;
+
+	while ( stackCount > 0 )
+	{
+		int nodeId = stack[--stackCount];
+		if ( nodeId == B2_NULL_INDEX )
+		{
+			// todo huh?
+			B2_ASSERT( false );
+			continue;
+		}
+
+		const b2TreeNode* node = tree->nodes + nodeId;
+		result.nodeVisits += 1;
+
+		if ( b2AABB_Overlaps( node->aabb, aabb ) && ( node->categoryBits & maskBits ) != 0 )
+		{
+			if ( b2IsLeaf( node ) )
+			{
+				// callback to user code with proxy id
+				bool proceed = callback( nodeId, node->userData, context );
+				result.leafVisits += 1;
+
+				if ( proceed == false )
+				{
+					return result;
+				}
+			}
+			else
+			{
+				if ( stackCount < B2_TREE_STACK_SIZE - 1 )
+				{
+					stack[stackCount++] = node->children.child1;
+					stack[stackCount++] = node->children.child2;
+				}
+				else
+				{
+					B2_ASSERT( stackCount < B2_TREE_STACK_SIZE - 1 );
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+b2TreeStats b2DynamicTree_RayCast( const b2DynamicTree* tree, const b2RayCastInput* input, uint64_t maskBits,
+								   b2TreeRayCastCallbackFcn* callback, void* context )
+{
+	b2TreeStats result = { 0 };
+
+	if ( tree->nodeCount == 0 )
+	{
+		return result;
+	}
+
+	if ( tree->wideValid )
+	{
+		return b2RayCastWide( tree, input, maskBits, callback, context );
+	}
+
+	b2Vec2 p1 = input->origin;
+	b2Vec2 d = input->translation;
+
+	b2Vec2 r = b2Normalize( d );
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2CrossSV( 1.0f, r );
+	b2Vec2 abs_v = b2Abs( v );
+
+	// Separating axis for segment (Gino, p80).
+	// |dot(v, p1 - c)| > dot(|v|, h)
+
+	float maxFraction = input->maxFraction;
+
+	b2Vec2 p2 = b2MulAdd( p1, maxFraction, d );
+
+	// Build a bounding box for the segment.
+	b2AABB segmentAABB = { b2Min( p1, p2 ), b2Max( p1, p2 ) };
+
+	int stack[B2_TREE_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = tree->root;
+
+	const b2TreeNode* nodes = tree->nodes;
+
+	b2RayCastInput subInput = *input;
+
+	while ( stackCount > 0 )
+	{
+		int nodeId = stack[--stackCount];
+		if ( nodeId == B2_NULL_INDEX )
+		{
+			// todo is this possible?
+			B2_ASSERT( false );
+			continue;
+		}
+
+		const b2TreeNode* node = nodes + nodeId;
+		result.nodeVisits += 1;
+
+		b2AABB nodeAABB = node->aabb;
+
+		if ( ( node->categoryBits & maskBits ) == 0 || b2AABB_Overlaps( nodeAABB, segmentAABB ) == false )
+		{
+			continue;
+		}
+
+		// Separating axis for segment (Gino, p80).
+		// |dot(v, p1 - c)| > dot(|v|, h)
+		// radius extension is added to the node in this case
+		b2Vec2 c = b2AABB_Center( nodeAABB );
+		b2Vec2 h = b2AABB_Extents( nodeAABB );
+		float term1 = b2AbsFloat( b2Dot( v, b2Sub( p1, c ) ) );
+		float term2 = b2Dot( abs_v, h );
+		if ( term2 < term1 )
+		{
+			continue;
+		}
+
+		if ( b2IsLeaf( node ) )
+		{
+			subInput.maxFraction = maxFraction;
+
+			float value = callback( &subInput, nodeId, node->userData, context );
+			result.leafVisits += 1;
+
+			// The user may return -1 to indicate this shape should be skipped
+
+			if ( value == 0.0f )
+			{
+				// The client has terminated the ray cast.
+				return result;
+			}
+
+			if ( 0.0f < value && value <= maxFraction )
+			{
+				// Update segment bounding box.
+				maxFraction = value;
+				p2 = b2MulAdd( p1, maxFraction, d );
+				segmentAABB.lowerBound = b2Min( p1, p2 );
+				segmentAABB.upperBound = b2Max( p1, p2 );
+			}
+		}
+		else
+		{
+			if ( stackCount < B2_TREE_STACK_SIZE - 1 )
+			{
+				b2Vec2 c1 = b2AABB_Center( nodes[node->children.child1].aabb );
+				b2Vec2 c2 = b2AABB_Center( nodes[node->children.child2].aabb );
+				if ( b2DistanceSquared( c1, p1 ) < b2DistanceSquared( c2, p1 ) )
+				{
+					stack[stackCount++] = node->children.child2;
+					stack[stackCount++] = node->children.child1;
+				}
+				else
+				{
+					stack[stackCount++] = node->children.child1;
+					stack[stackCount++] = node->children.child2;
+				}
+			}
+			else
+			{
+				B2_ASSERT( stackCount < B2_TREE_STACK_SIZE - 1 );
+			}
+		}
+	}
+
+	return result;
+}
+
+// Batched queries walk the tree once for each group of queries. Each stack entry carries a bit for every
+// query in the group that reached the node.
+typedef struct b2BatchStackItem
+{
+	int nodeId;
+	uint64_t queryMask;
+} b2BatchStackItem;
+
+static uint64_t b2BatchGroupMask( int count )
+{
+	B2_ASSERT( 0 < count && count <= B2_TREE_BATCH_SIZE );
+	return count == 64 ? UINT64_MAX : ( (uint64_t)1 << count ) - 1;
+}
+
+// Stack entries of the wide batch queries are wide node indices or leaves as in b2QueryWide. Each child
+// of a wide node is pushed with the mask of the queries that overlap its box.
+static b2TreeStats b2QueryBatchWide( const b2DynamicTree* tree, const b2AABB* boxes, int boxCount, uint64_t maskBits,
+									 b2TreeQueryBatchCallbackFcn* callback, void* context )
+{
+	b2TreeStats result = { 0 };
+
+	const b2TreeNode* nodes = tree->nodes;
+	b2BatchStackItem stack[B2_TREE_STACK_SIZE];
+
+	for ( int baseIndex = 0; baseIndex < boxCount; baseIndex += B2_TREE_BATCH_SIZE )
+	{
+		const b2AABB* groupBoxes = boxes + baseIndex;
+		int groupCount = b2MinInt( B2_TREE_BATCH_SIZE, boxCount - baseIndex );
+
+		int stackCount = 0;
+		stack[stackCount++] = ( b2BatchStackItem ){ 0, b2BatchGroupMask( groupCount ) };
+
+		while ( stackCount > 0 )
+		{
+			b2BatchStackItem item = stack[--stackCount];
+			if ( item.nodeId < 0 )
+			{
+				int proxyId = b2WideLeaf( item.nodeId );
+				const b2TreeNode* node = nodes + proxyId;
+
+				bool proceed = callback( proxyId, node->userData, baseIndex, item.queryMask, context );
+				result.leafVisits += 1;
+
+				if ( proceed == false )
+				{
+					return result;
+				}
+
+				continue;
+			}
+
+			result.nodeVisits += 1;
+
+			if ( stackCount > B2_TREE_STACK_SIZE - 4 )
+			{
+				B2_ASSERT( stackCount <= B2_TREE_STACK_SIZE - 4 );
+				continue;
+			}
+
+			const b2WideNode* wide = tree->wideNodes + item.nodeId;
+			const int32_t* children = wide->children;
+			int categoryMask = b2GetWideCategoryMask( wide, maskBits );
+
+			uint64_t childMasks[4] = { 0 };
+			for ( uint64_t bits = item.queryMask; bits != 0; bits &= bits - 1 )
+			{
+				uint32_t index = b2CTZ64( bits );
+				int overlapMask = categoryMask & b2WideOverlapMask( wide, groupBoxes[index] );
+				for ( int i = 0; i < 4; ++i )
+				{
+					if ( overlapMask & ( 1 << i ) )
+					{
+						childMasks[i] |= (uint64_t)1 << index;
+					}
+				}
+			}
+
+			for ( int i = 0; i < 4; ++i )
+			{
+				if ( childMasks[i] != 0 )
+				{
+					stack[stackCount++] = ( b2BatchStackItem ){ children[i], childMasks[i] };
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+b2TreeStats b2DynamicTree_QueryBatch( const b2DynamicTree* tree, const b2AABB* boxes, int boxCount, uint64_t maskBits,
+									  b2TreeQueryBatchCallbackFcn* callback, void* context )
+{
+	_Static_assert( B2_TREE_BATCH_SIZE == 64, "one query per mask bit" );
+
+	b2TreeStats result = { 0 };
+
+	if ( tree->nodeCount == 0 )
+	{
+		return result;
+	}
+
+	if ( tree->wideValid )
+	{
+		return b2QueryBatchWide( tree, boxes, boxCount, maskBits, callback, context );
+	}
+
+	const b2TreeNode* nodes = tree->nodes;
+	b2BatchStackItem stack[B2_TREE_STACK_SIZE];
+
+	for ( int baseIndex = 0; baseIndex < boxCount; baseIndex += B2_TREE_BATCH_SIZE )
+	{
+		const b2AABB* groupBoxes = boxes + baseIndex;
+		int groupCount = b2MinInt( B2_TREE_BATCH_SIZE, boxCount - baseIndex );
+
+		int stackCount = 0;
+		stack[stackCount++] = ( b2BatchStackItem ){ tree->root, b2BatchGroupMask( groupCount ) };
+
+		while ( stackCount > 0 )
+		{
+			b2BatchStackItem item = stack[--stackCount];
+			const b2TreeNode* node = nodes + item.nodeId;
+			result.nodeVisits += 1;
+
+			if ( ( node->categoryBits & maskBits ) == 0 )
+			{
+				continue;
+			}
+
+			uint64_t overlapMask = 0;
+			uint64_t bits = item.queryMask;
+			while ( bits != 0 )
+			{
+				uint32_t index = b2CTZ64( bits );
+				bits &= bits - 1;
+
+				if ( b2AABB_Overlaps( node->aabb, groupBoxes[index] ) )
+				{
+					overlapMask |= (uint64_t)1 << index;
+				}
+			}
+
+			if ( overlapMask == 0 )
+			{
+				continue;
+			}
+
+			if ( b2IsLeaf( node ) )
+			{
+				bool proceed = callback( item.nodeId, node->userData, baseIndex, overlapMask, context );
+				result.leafVisits += 1;
+
+				if ( proceed == false )
+				{
+					return result;
+				}
+			}
+			else
+			{
+				if ( stackCount < B2_TREE_STACK_SIZE - 1 )
+				{
+					stack[stackCount++] = ( b2BatchStackItem ){ node->children.child1, overlapMask };
+					stack[stackCount++] = ( b2BatchStackItem ){ node->children.child2, overlapMask };
+				}
+				else
+				{
+					B2_ASSERT( stackCount < B2_TREE_STACK_SIZE - 1 );
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+// The per ray data of a ray group
+typedef struct b2RayBatchItem
+{
+	b2Vec2 origin;
+	b2Vec2 translation;
+	b2Vec2 v;
+	b2Vec2 abs_v;
+	b2AABB segmentAABB;
+	float maxFraction;
+} b2RayBatchItem;
+
+static void b2PrepareRayBatch( const b2RayCastInput* inputs, int count, b2RayBatchItem* rays )
+{
+	for ( int i = 0; i < count; ++i )
+	{
+		const b2RayCastInput* input = inputs + i;
+		b2RayBatchItem* ray = rays + i;
+		ray->origin = input->origin;
+		ray->translation = input->translation;
+
+		// v is perpendicular to the segment.
+		ray->v = b2CrossSV( 1.0f, b2Normalize( input->translation ) );
+		ray->abs_v = b2Abs( ray->v );
+		ray->maxFraction = input->maxFraction;
+
+		b2Vec2 p2 = b2MulAdd( input->origin, input->maxFraction, input->translation );
+		ray->segmentAABB = ( b2AABB ){ b2Min( input->origin, p2 ), b2Max( input->origin, p2 ) };
+	}
+}
+
+// Reports a ray that reached a leaf and clips or terminates it. Returns false if the ray was terminated.
+static bool b2ReportBatchRay( b2RayBatchItem* ray, int rayIndex, int proxyId, uint64_t userData,
+							  b2TreeRayCastBatchCallbackFcn* callback, void* context )
+{
+	b2RayCastInput subInput = { ray->origin, ray->translation, ray->maxFraction };
+	float value = callback( &subInput, rayIndex, proxyId, userData, context );
+
+	// The user may return -1 to indicate this shape should be skipped
+
+	if ( value == 0.0f )
+	{
+		// The client has terminated this ray.
+		return false;
+	}
+
+	if ( 0.0f < value && value <= ray->maxFraction )
+	{
+		// Update segment bounding box.
+		ray->maxFraction = value;
+		b2Vec2 p2 = b2MulAdd( ray->origin, value, ray->translation );
+		ray->segmentAABB.lowerBound = b2Min( ray->origin, p2 );
+		ray->segmentAABB.upperBound = b2Max( ray->origin, p2 );
+	}
+
+	return true;
+}
+
+// The batch ray cast on the wide nodes. Each child of a wide node is pushed with the mask of the rays
+// that pass its box, nearest to the first of those rays last so it is visited first.
+static b2TreeStats b2RayCastBatchWide( const b2DynamicTree* tree, const b2RayCastInput* inputs, int rayCount,
+									   uint64_t maskBits, b2TreeRayCastBatchCallbackFcn* callback, void* context )
+{
+	b2TreeStats result = { 0 };
+
+	const b2TreeNode* nodes = tree->nodes;
+	b2BatchStackItem stack[B2_TREE_STACK_SIZE];
+	b2RayBatchItem rays[B2_TREE_BATCH_SIZE];
+
+	for ( int baseIndex = 0; baseIndex < rayCount; baseIndex += B2_TREE_BATCH_SIZE )
+	{
+		int groupCount = b2MinInt( B2_TREE_BATCH_SIZE, rayCount - baseIndex );
+		b2PrepareRayBatch( inputs + baseIndex, groupCount, rays );
+
+		// Rays drop out of this mask when the callback terminates them
+		uint64_t liveMask = b2BatchGroupMask( groupCount );
+
+		int stackCount = 0;
+		stack[stackCount++] = ( b2BatchStackItem ){ 0, liveMask };
+
+		while ( stackCount > 0 )
+		{
+			b2BatchStackItem item = stack[--stackCount];
+			uint64_t bits = item.queryMask & liveMask;
+			if ( bits == 0 )
+			{
+				continue;
+			}
+
+			if ( item.nodeId < 0 )
+			{
+				int proxyId = b2WideLeaf( item.nodeId );
+				const b2TreeNode* node = nodes + proxyId;
+
+				for ( ; bits != 0; bits &= bits - 1 )
+				{
+					uint32_t index = b2CTZ64( bits );
+					b2RayBatchItem* ray = rays + index;
+
+					// The segment may have been clipped since this leaf was pushed
+					if ( b2AABB_Overlaps( node->aabb, ray->segmentAABB ) == false )
+					{
+						continue;
+					}
+
+					int rayIndex = baseIndex + (int)index;
+					result.leafVisits += 1;
+					if ( b2ReportBatchRay( ray, rayIndex, proxyId, node->userData, callback, context ) == false )
+					{
+						liveMask &= ~( (uint64_t)1 << index );
+					}
+				}
+
+				continue;
+			}
+
+			result.nodeVisits += 1;
+
+			const b2WideNode* wide = tree->wideNodes + item.nodeId;
+			const int32_t* children = wide->children;
+			int categoryMask = b2GetWideCategoryMask( wide, maskBits );
+
+			b2Vec2 centers[4], extents[4];
+			for ( int i = 0; i < 4; ++i )
+			{
+				if ( categoryMask & ( 1 << i ) )
+				{
+					b2GetWideChildBox( wide, i, centers + i, extents + i );
+				}
+			}
+
+			uint64_t childMasks[4] = { 0 };
+			for ( uint64_t rayBits = bits; rayBits != 0; rayBits &= rayBits - 1 )
+			{
+				uint32_t index = b2CTZ64( rayBits );
+				const b2RayBatchItem* ray = rays + index;
+				int overlapMask = categoryMask & b2WideOverlapMask( wide, ray->segmentAABB );
+
+				for ( int i = 0; i < 4; ++i )
+				{
+					if ( ( overlapMask & ( 1 << i ) ) == 0 )
+					{
+						continue;
+					}
+
+					// Separating axis for segment (Gino, p80).
+					// |dot(v, p1 - c)| > dot(|v|, h)
+					float term1 = b2AbsFloat( b2Dot( ray->v, b2Sub( ray->origin, centers[i] ) ) );
+					float term2 = b2Dot( ray->abs_v, extents[i] );
+					if ( term1 <= term2 )
+					{
+						childMasks[i] |= (uint64_t)1 << index;
+					}
+				}
+			}
+
+			// Children that some ray passes, farthest first from the first ray of the group
+			b2Vec2 p1 = rays[b2CTZ64( bits )].origin;
+			int candidates[4];
+			float distances[4];
+			int candidateCount = 0;
+			for ( int i = 0; i < 4; ++i )
+			{
+				if ( childMasks[i] == 0 )
+				{
+					continue;
+				}
+
+				float distance = b2DistanceSquared( centers[i], p1 );
+				int j = candidateCount;
+				while ( j > 0 && distances[j - 1] < distance )
+				{
+					candidates[j] = candidates[j - 1];
+					distances[j] = distances[j - 1];
+					j -= 1;
+				}
+
+				candidates[j] = i;
+				distances[j] = distance;
+				candidateCount += 1;
+			}
+
+			if ( stackCount + candidateCount > B2_TREE_STACK_SIZE )
+			{
+				B2_ASSERT( stackCount + candidateCount <= B2_TREE_STACK_SIZE );
+				continue;
+			}
+
+			for ( int j = 0; j < candidateCount; ++j )
+			{
+				int i = candidates[j];
+				stack[stackCount++] = ( b2BatchStackItem ){ children[i], childMasks[i] };
+			}
+		}
+	}
+
+	return result;
+}
+
+b2TreeStats b2DynamicTree_RayCastBatch( const b2DynamicTree* tree, const b2RayCastInput* inputs, int rayCount,
+										uint64_t maskBits, b2TreeRayCastBatchCallbackFcn* callback, void* context )
+{
+	b2TreeStats result = { 0 };
+
+	if ( tree->nodeCount == 0 )
+	{
+		return result;
+	}
+
+	if ( tree->wideValid )
+	{
+		return b2RayCastBatchWide( tree, inputs, rayCount, maskBits, callback, context );
+	}
+
+	const b2TreeNode* nodes = tree->nodes;
+	b2BatchStackItem stack[B2_TREE_STACK_SIZE];
+	b2RayBatchItem rays[B2_TREE_BATCH_SIZE];
+
+	for ( int baseIndex = 0; baseIndex < rayCount; baseIndex += B2_TREE_BATCH_SIZE )
+	{
+		int groupCount = b2MinInt( B2_TREE_BATCH_SIZE, rayCount - baseIndex );
+		b2PrepareRayBatch( inputs + baseIndex, groupCount, rays );
+
+		// Rays drop out of this mask when the callback terminates them
+		uint64_t liveMask = b2BatchGroupMask( groupCount );
+
+		int stackCount = 0;
+		stack[stackCount++] = ( b2BatchStackItem ){ tree->root, liveMask };
+
+		while ( stackCount > 0 )
+		{
+			b2BatchStackItem item = stack[--stackCount];
+			uint64_t bits = item.queryMask & liveMask;
+			if ( bits == 0 )
+			{
+				continue;
+			}
+
+			const b2TreeNode* node = nodes + item.nodeId;
+			result.nodeVisits += 1;
+
+			if ( ( node->categoryBits & maskBits ) == 0 )
+			{
+				continue;
+			}
+
+			b2AABB nodeAABB = node->aabb;
+			b2Vec2 c = b2AABB_Center( nodeAABB );
+			b2Vec2 h = b2AABB_Extents( nodeAABB );
+
+			uint64_t hitMask = 0;
+			while ( bits != 0 )
+			{
+				uint32_t index = b2CTZ64( bits );
+				bits &= bits - 1;
+
+				const b2RayBatchItem* ray = rays + index;
+				if ( b2AABB_Overlaps( nodeAABB, ray->segmentAABB ) == false )
+				{
+					continue;
+				}
+
+				// Separating axis for segment (Gino, p80).
+				// |dot(v, p1 - c)| > dot(|v|, h)
+				float term1 = b2AbsFloat( b2Dot( ray->v, b2Sub( ray->origin, c ) ) );
+				float term2 = b2Dot( ray->abs_v, h );
+				if ( term2 < term1 )
+				{
+					continue;
+				}
+
+				hitMask |= (uint64_t)1 << index;
+			}
+
+			if ( hitMask == 0 )
+			{
+				continue;
+			}
+
+			if ( b2IsLeaf( node ) )
+			{
+				while ( hitMask != 0 )
+				{
+					uint32_t index = b2CTZ64( hitMask );
+					hitMask &= hitMask - 1;
+
+					int rayIndex = baseIndex + (int)index;
+					result.leafVisits += 1;
+					if ( b2ReportBatchRay( rays + index, rayIndex, item.nodeId, node->userData, callback, context ) == false )
+					{
+						liveMask &= ~( (uint64_t)1 << index );
+					}
+				}
+			}
+			else
+			{
+				if ( stackCount < B2_TREE_STACK_SIZE - 1 )
+				{
+					// Visit the child closer to the first ray of the group first
+					b2Vec2 p1 = rays[b2CTZ64( hitMask )].origin;
+					b2Vec2 c1 = b2AABB_Center( nodes[node->children.child1].aabb );
+					b2Vec2 c2 = b2AABB_Center( nodes[node->children.child2].aabb );
+					if ( b2DistanceSquared( c1, p1 ) < b2DistanceSquared( c2, p1 ) )
+					{
+						stack[stackCount++] = ( b2BatchStackItem ){ node->children.child2, hitMask };
+						stack[stackCount++] = ( b2BatchStackItem ){ node->children.child1, hitMask };
+					}
+					else
+					{
+						stack[stackCount++] = ( b2BatchStackItem ){ node->children.child1, hitMask };
+						stack[stackCount++] = ( b2BatchStackItem ){ node->children.child2, hitMask };
+					}
+				}
+				else
+				{
+					B2_ASSERT( stackCount < B2_TREE_STACK_SIZE - 1 );
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+b2TreeStats b2DynamicTree_ShapeCast( const b2DynamicTree* tree, const b2ShapeCastInput* input, uint64_t maskBits,
+									 b2TreeShapeCastCallbackFcn* callback, void* context )
+{
+	b2TreeStats stats = { 0 };
+
+	if ( tree->nodeCount == 0 || input->proxy.count == 0 )
+	{
+		return stats;
+	}
+
+	b2AABB originAABB = { input->proxy.points[0], input->proxy.points[0] };
+	for ( int i = 1; i < input->proxy.count; ++i )
+	{
+		originAABB.lowerBound = b2Min( originAABB.lowerBound, input->proxy.points[i] );
+		originAABB.upperBound = b2Max( originAABB.upperBound, input->proxy.points[i] );
+	}
+
+	b2Vec2 radius = { input->proxy.radius, input->proxy.radius };
+
+	originAABB.lowerBound = b2Sub( originAABB.lowerBound, radius );
+	originAABB.upperBound = b2Add( originAABB.upperBound, radius );
+
+	if ( tree->wideValid )
+	{
+		return b2ShapeCastWide( tree, input, originAABB, maskBits, callback, context );
+	}
+
+	b2Vec2 p1 = b2AABB_Center( originAABB );
+	b2Vec2 extension = b2AABB_Extents( originAABB );
+
+	// v is perpendicular to the segment.
 	b2Vec2 r = input->translation;
 	b2Vec2 v = b2CrossSV( 1.0f, r );
 	b2Vec2 abs_v = b2Abs( v );
@@ -1700,6 +2814,19 @@ static int b2PartitionSAH( int* indices, int* binIndices, b2AABB* boxes, int cou
 
 #endif
 
+// Sorts the leaves in [startIndex, endIndex) about the split plane and returns the split index
+static int b2PartitionLeaves( b2DynamicTree* tree, int startIndex, int endIndex )
+{
+	int count = endIndex - startIndex;
+#if B2_TREE_HEURISTIC == 0
+	int splitIndex = b2PartitionMid( tree->leafIndices + startIndex, tree->leafCenters + startIndex, count );
+#else
+	int splitIndex = b2PartitionSAH( tree->leafIndices + startIndex, tree->binIndices + startIndex,
+									 tree->leafBoxes + startIndex, count );
+#endif
+	return startIndex + splitIndex;
+}
+
 // Temporary data used to track the rebuild of a tree node
 struct b2RebuildItem
 {
@@ -1712,38 +2839,32 @@ struct b2RebuildItem
 	int endIndex;
 };
 
-// Returns root node index
-static int b2BuildTree( b2DynamicTree* tree, int leafCount )
+// Builds a tree over the leaves in [startIndex, endIndex) and returns the root node index.
+// The internal nodes are taken from reservedNodes in depth-first order. This only touches the
+// reserved nodes and the leaves in range, so disjoint ranges can be built at the same time.
+static int b2BuildTree( b2DynamicTree* tree, int startIndex, int endIndex, const int* reservedNodes )
 {
 	b2TreeNode* nodes = tree->nodes;
 	int* leafIndices = tree->leafIndices;
 
-	if ( leafCount == 1 )
+	if ( endIndex - startIndex == 1 )
 	{
-		nodes[leafIndices[0]].parent = B2_NULL_INDEX;
-		return leafIndices[0];
+		nodes[leafIndices[startIndex]].parent = B2_NULL_INDEX;
+		return leafIndices[startIndex];
 	}
 
-#if B2_TREE_HEURISTIC == 0
-	b2Vec2* leafCenters = tree->leafCenters;
-#else
-	b2AABB* leafBoxes = tree->leafBoxes;
-	int* binIndices = tree->binIndices;
-#endif
+	int reservedCount = 0;
 
 	// todo large stack item
 	struct b2RebuildItem stack[B2_TREE_STACK_SIZE];
 	int top = 0;
 
-	stack[0].nodeIndex = b2AllocateNode( tree );
+	stack[0].nodeIndex = reservedNodes[reservedCount++];
+	nodes[stack[0].nodeIndex] = b2_defaultTreeNode;
 	stack[0].childCount = -1;
-	stack[0].startIndex = 0;
-	stack[0].endIndex = leafCount;
-#if B2_TREE_HEURISTIC == 0
-	stack[0].splitIndex = b2PartitionMid( leafIndices, leafCenters, leafCount );
-#else
-	stack[0].splitIndex = b2PartitionSAH( leafIndices, binIndices, leafBoxes, leafCount );
-#endif
+	stack[0].startIndex = startIndex;
+	stack[0].endIndex = endIndex;
+	stack[0].splitIndex = b2PartitionLeaves( tree, startIndex, endIndex );
 
 	while ( true )
 	{
@@ -1795,24 +2916,24 @@ static int b2BuildTree( b2DynamicTree* tree, int leafCount )
 		}
 		else
 		{
-			int startIndex, endIndex;
+			int childStart, childEnd;
 			if ( item->childCount == 0 )
 			{
-				startIndex = item->startIndex;
-				endIndex = item->splitIndex;
+				childStart = item->startIndex;
+				childEnd = item->splitIndex;
 			}
 			else
 			{
 				B2_ASSERT( item->childCount == 1 );
-				startIndex = item->splitIndex;
-				endIndex = item->endIndex;
+				childStart = item->splitIndex;
+				childEnd = item->endIndex;
 			}
 
-			int count = endIndex - startIndex;
+			int count = childEnd - childStart;
 
 			if ( count == 1 )
 			{
-				int childIndex = leafIndices[startIndex];
+				int childIndex = leafIndices[childStart];
 				b2TreeNode* node = nodes + item->nodeIndex;
 
 				if ( item->childCount == 0 )
@@ -1838,21 +2959,18 @@ static int b2BuildTree( b2DynamicTree* tree, int leafCount )
 
 				top += 1;
 				struct b2RebuildItem* newItem = stack + top;
-				newItem->nodeIndex = b2AllocateNode( tree );
+				newItem->nodeIndex = reservedNodes[reservedCount++];
+				nodes[newItem->nodeIndex] = b2_defaultTreeNode;
 				newItem->childCount = -1;
-				newItem->startIndex = startIndex;
-				newItem->endIndex = endIndex;
-#if B2_TREE_HEURISTIC == 0
-				newItem->splitIndex = b2PartitionMid( leafIndices + startIndex, leafCenters + startIndex, count );
-#else
-				newItem->splitIndex =
-					b2PartitionSAH( leafIndices + startIndex, binIndices + startIndex, leafBoxes + startIndex, count );
-#endif
-				newItem->splitIndex += startIndex;
+				newItem->startIndex = childStart;
+				newItem->endIndex = childEnd;
+				newItem->splitIndex = b2PartitionLeaves( tree, childStart, childEnd );
 			}
 		}
 	}
 
+	B2_ASSERT( reservedCount == endIndex - startIndex - 1 );
+
 	b2TreeNode* rootNode = nodes + stack[0].nodeIndex;
 	B2_ASSERT( rootNode->parent == B2_NULL_INDEX );
 	B2_ASSERT( rootNode->children.child1 != B2_NULL_INDEX );
@@ -1868,14 +2986,11 @@ static int b2BuildTree( b2DynamicTree* tree, int leafCount )
 	return stack[0].nodeIndex;
 }
 
-// Not safe to access tree during this operation because it may grow
-int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
+// Gathers the leaves for the build and the internal nodes above them, which are reused for the new internal
+// nodes. Returns the leaf count.
+static int b2GatherRebuildLeaves( b2DynamicTree* tree, bool fullBuild )
 {
 	int proxyCount = tree->proxyCount;
-	if ( proxyCount == 0 )
-	{
-		return 0;
-	}
 
 	// Ensure capacity for rebuild space
 	if ( proxyCount > tree->rebuildCapacity )
@@ -1885,6 +3000,9 @@ int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
 		b2Free( tree->leafIndices, tree->rebuildCapacity * sizeof( int ) );
 		tree->leafIndices = b2Alloc( newCapacity * sizeof( int ) );
 
+		b2Free( tree->rebuildNodes, tree->rebuildCapacity * sizeof( int ) );
+		tree->rebuildNodes = b2Alloc( newCapacity * sizeof( int ) );
+
 #if B2_TREE_HEURISTIC == 0
 		b2Free( tree->leafCenters, tree->rebuildCapacity * sizeof( b2Vec2 ) );
 		tree->leafCenters = b2Alloc( newCapacity * sizeof( b2Vec2 ) );
@@ -1898,6 +3016,7 @@ int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
 	}
 
 	int leafCount = 0;
+	int reusedCount = 0;
 	int stack[B2_TREE_STACK_SIZE];
 	int stackCount = 0;
 
@@ -1906,8 +3025,8 @@ int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
 	b2TreeNode* node = nodes + nodeIndex;
 
 	// These are the nodes that get sorted to rebuild the tree.
-	// I'm using indices because the node pool may grow during the build.
 	int* leafIndices = tree->leafIndices;
+	int* reusedNodes = tree->rebuildNodes;
 
 #if B2_TREE_HEURISTIC == 0
 	b2Vec2* leafCenters = tree->leafCenters;
@@ -1917,7 +3036,7 @@ int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
 
 	// Gather all proxy nodes that have grown and all internal nodes that haven't grown. Both are
 	// considered leaves in the tree rebuild.
-	// Free all internal nodes that have grown.
+	// Reuse all internal nodes that have grown.
 	// todo use a node growth metric instead of simply enlarged to reduce rebuild size and frequency
 	// this should be weighed against B2_AABB_MARGIN
 	while ( true )
@@ -1953,8 +3072,9 @@ int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
 
 			node = nodes + nodeIndex;
 
-			// Remove doomed node
-			b2FreeNode( tree, doomedNodeIndex );
+			// Keep doomed node for the build
+			nodes[doomedNodeIndex].flags = 0;
+			reusedNodes[reusedCount++] = doomedNodeIndex;
 
 			continue;
 		}
@@ -1981,9 +3101,268 @@ int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
 
 	B2_ASSERT( leafCount <= proxyCount );
 
-	tree->root = b2BuildTree( tree, leafCount );
+	// A binary tree over the leaves needs one less internal node than leaves, which is exactly the number
+	// of internal nodes above the leaves. Reverse them so they are used in the order freeing and
+	// reallocating them would give.
+	B2_ASSERT( reusedCount == leafCount - 1 );
+	for ( int i = 0, j = reusedCount - 1; i < j; ++i, --j )
+	{
+		int temp = reusedNodes[i];
+		reusedNodes[i] = reusedNodes[j];
+		reusedNodes[j] = temp;
+	}
+
+	return leafCount;
+}
+
+// Not safe to access tree during this operation
+int b2DynamicTree_Rebuild( b2DynamicTree* tree, bool fullBuild )
+{
+	if ( tree->proxyCount == 0 )
+	{
+		return 0;
+	}
+
+	int leafCount = b2GatherRebuildLeaves( tree, fullBuild );
+
+	tree->root = b2BuildTree( tree, 0, leafCount, tree->rebuildNodes );
+
+	b2DynamicTree_Validate( tree );
+
+	if ( tree->wideEnabled )
+	{
+		b2BuildWideNodes( tree );
+	}
+
+	return leafCount;
+}
+
+// The top levels of a task rebuild are split serially down to this depth, giving at most 2^depth subtrees
+#define B2_REBUILD_TASK_DEPTH 4
+#define B2_REBUILD_MAX_SUBTREES ( 1 << B2_REBUILD_TASK_DEPTH )
+
+// Ranges smaller than this are not split further because the task would be too small to pay off
+#define B2_REBUILD_MIN_SUBTREE_LEAVES 1024
+
+// A range of leaves built by a task and the top level node slot it hangs from
+typedef struct b2RebuildSubtree
+{
+	int startIndex;
+	int endIndex;
+	int parentIndex;
+	int childSlot;
+	int firstNode;
+	int rootIndex;
+} b2RebuildSubtree;
+
+typedef struct b2RebuildContext
+{
+	b2DynamicTree* tree;
+	b2RebuildSubtree subtrees[B2_REBUILD_MAX_SUBTREES];
+	int subtreeCount;
+	int topNodes[B2_REBUILD_MAX_SUBTREES];
+	int topNodeCount;
+	int reservedCount;
+} b2RebuildContext;
+
+static void b2LinkRebuildChild( b2TreeNode* nodes, int parentIndex, int childSlot, int childIndex )
+{
+	if ( childSlot == 0 )
+	{
+		B2_ASSERT( nodes[parentIndex].children.child1 == B2_NULL_INDEX );
+		nodes[parentIndex].children.child1 = childIndex;
+	}
+	else
+	{
+		B2_ASSERT( nodes[parentIndex].children.child2 == B2_NULL_INDEX );
+		nodes[parentIndex].children.child2 = childIndex;
+	}
+
+	nodes[childIndex].parent = parentIndex;
+}
+
+// Splits the top levels serially. Nodes are taken in the same depth-first order as b2BuildTree,
+// including the nodes reserved for each subtree, so the result matches the serial build exactly.
+static void b2SplitRebuildLevels( b2RebuildContext* context, int startIndex, int endIndex, int depth, int parentIndex,
+								  int childSlot )
+{
+	b2DynamicTree* tree = context->tree;
+	int count = endIndex - startIndex;
+
+	if ( count == 1 )
+	{
+		b2LinkRebuildChild( tree->nodes, parentIndex, childSlot, tree->leafIndices[startIndex] );
+		return;
+	}
+
+	if ( depth == B2_REBUILD_TASK_DEPTH || count < 2 * B2_REBUILD_MIN_SUBTREE_LEAVES )
+	{
+		B2_ASSERT( context->subtreeCount < B2_REBUILD_MAX_SUBTREES );
+		b2RebuildSubtree* subtree = context->subtrees + context->subtreeCount;
+		context->subtreeCount += 1;
+
+		subtree->startIndex = startIndex;
+		subtree->endIndex = endIndex;
+		subtree->parentIndex = parentIndex;
+		subtree->childSlot = childSlot;
+		subtree->firstNode = context->reservedCount;
+		subtree->rootIndex = B2_NULL_INDEX;
+		context->reservedCount += count - 1;
+		return;
+	}
+
+	int nodeIndex = tree->rebuildNodes[context->reservedCount++];
+	tree->nodes[nodeIndex] = b2_defaultTreeNode;
+	B2_ASSERT( context->topNodeCount < B2_REBUILD_MAX_SUBTREES );
+	context->topNodes[context->topNodeCount++] = nodeIndex;
+
+	if ( parentIndex != B2_NULL_INDEX )
+	{
+		b2LinkRebuildChild( tree->nodes, parentIndex, childSlot, nodeIndex );
+	}
+
+	int splitIndex = b2PartitionLeaves( tree, startIndex, endIndex );
+	b2SplitRebuildLevels( context, startIndex, splitIndex, depth + 1, nodeIndex, 0 );
+	b2SplitRebuildLevels( context, splitIndex, endIndex, depth + 1, nodeIndex, 1 );
+}
+
+static void b2RebuildSubtreesTask( int startIndex, int endIndex, uint32_t threadIndex, void* taskContext )
+{
+	B2_UNUSED( threadIndex );
+
+	b2RebuildContext* context = taskContext;
+	b2DynamicTree* tree = context->tree;
+
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2RebuildSubtree* subtree = context->subtrees + i;
+		subtree->rootIndex =
+			b2BuildTree( tree, subtree->startIndex, subtree->endIndex, tree->rebuildNodes + subtree->firstNode );
+	}
+}
+
+int b2DynamicTree_RebuildWithTasks( b2DynamicTree* tree, bool fullBuild, b2EnqueueTaskCallback* enqueueTask,
+									b2FinishTaskCallback* finishTask, void* userTaskContext )
+{
+	if ( tree->proxyCount == 0 )
+	{
+		return 0;
+	}
+
+	int leafCount = b2GatherRebuildLeaves( tree, fullBuild );
+
+	if ( leafCount < 2 * B2_REBUILD_MIN_SUBTREE_LEAVES )
+	{
+		tree->root = b2BuildTree( tree, 0, leafCount, tree->rebuildNodes );
+	}
+	else
+	{
+		b2RebuildContext context;
+		context.tree = tree;
+		context.subtreeCount = 0;
+		context.topNodeCount = 0;
+		context.reservedCount = 0;
+
+		b2SplitRebuildLevels( &context, 0, leafCount, 0, B2_NULL_INDEX, 0 );
+		B2_ASSERT( context.topNodeCount > 0 );
+
+		void* userTask = enqueueTask( &b2RebuildSubtreesTask, context.subtreeCount, 1, &context, userTaskContext );
+		if ( userTask != NULL )
+		{
+			finishTask( userTask, userTaskContext );
+		}
+
+		// Stitch the subtrees to the top levels
+		b2TreeNode* nodes = tree->nodes;
+		for ( int i = 0; i < context.subtreeCount; ++i )
+		{
+			b2RebuildSubtree* subtree = context.subtrees + i;
+			B2_ASSERT( subtree->rootIndex != B2_NULL_INDEX );
+			b2LinkRebuildChild( nodes, subtree->parentIndex, subtree->childSlot, subtree->rootIndex );
+		}
+
+		// Children come after their parent in depth-first order, so walk backwards to fix the bounds
+		for ( int i = context.topNodeCount - 1; i >= 0; --i )
+		{
+			b2TreeNode* node = nodes + context.topNodes[i];
+			b2TreeNode* child1 = nodes + node->children.child1;
+			b2TreeNode* child2 = nodes + node->children.child2;
+
+			node->aabb = b2AABB_Union( child1->aabb, child2->aabb );
+			node->height = 1 + b2MaxUInt16( child1->height, child2->height );
+			node->categoryBits = child1->categoryBits | child2->categoryBits;
+		}
+
+		tree->root = context.topNodes[0];
+		B2_ASSERT( nodes[tree->root].parent == B2_NULL_INDEX );
+	}
 
 	b2DynamicTree_Validate( tree );
 
+	if ( tree->wideEnabled )
+	{
+		b2BuildWideNodes( tree );
+	}
+
 	return leafCount;
 }
+
+int b2DynamicTree_Refit( b2DynamicTree* tree )
+{
+	if ( tree->root == B2_NULL_INDEX )
+	{
+		return 0;
+	}
+
+	b2TreeNode* nodes = tree->nodes;
+	int refitCount = 0;
+
+	// Post-order walk over the enlarged nodes. Every ancestor of an enlarged node is also enlarged,
+	// so the walk stays within the enlarged part of the tree. Complemented entries are nodes whose
+	// children are done.
+	int stack[B2_TREE_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = tree->root;
+
+	while ( stackCount > 0 )
+	{
+		int entry = stack[--stackCount];
+
+		if ( entry < 0 )
+		{
+			b2TreeNode* node = nodes + ~entry;
+			b2TreeNode* child1 = nodes + node->children.child1;
+			b2TreeNode* child2 = nodes + node->children.child2;
+			node->aabb = b2AABB_Union( child1->aabb, child2->aabb );
+			node->flags &= ~b2_enlargedNode;
+			refitCount += 1;
+			continue;
+		}
+
+		b2TreeNode* node = nodes + entry;
+		if ( b2IsLeaf( node ) || ( node->flags & b2_enlargedNode ) == 0 )
+		{
+			continue;
+		}
+
+		B2_ASSERT( stackCount + 3 <= B2_TREE_STACK_SIZE );
+		if ( stackCount + 3 <= B2_TREE_STACK_SIZE )
+		{
+			stack[stackCount++] = ~entry;
+			stack[stackCount++] = node->children.child2;
+			stack[stackCount++] = node->children.child1;
+		}
+	}
+
+	if ( refitCount > 0 )
+	{
+		b2DynamicTree_Validate( tree );
+
+		if ( tree->wideEnabled )
+		{
+			b2BuildWideNodes( tree );
+		}
+	}
+
+	return refitCount;
+}
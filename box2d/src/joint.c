@@ -1404,51 +1404,51 @@ void b2SolveJoint( b2JointSim* joint, b2StepContext* context, bool useBias )
 	}
 }
 
-void b2PrepareOverflowJoints( b2StepContext* context )
+void b2PrepareOverflowJoints( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( prepare_joints, "PrepJoints", b2_colorOldLace, true );
 
 	b2ConstraintGraph* graph = context->graph;
 	b2JointSim* joints = graph->colors[B2_OVERFLOW_INDEX].jointSims.data;
-	int jointCount = graph->colors[B2_OVERFLOW_INDEX].jointSims.count;
+	const int* overflowJoints = context->overflowJoints;
 
-	for ( int i = 0; i < jointCount; ++i )
+	for ( int i = startIndex; i < endIndex; ++i )
 	{
-		b2JointSim* joint = joints + i;
+		b2JointSim* joint = joints + overflowJoints[i];
 		b2PrepareJoint( joint, context );
 	}
 
 	b2TracyCZoneEnd( prepare_joints );
 }
 
-void b2WarmStartOverflowJoints( b2StepContext* context )
+void b2WarmStartOverflowJoints( int startIndex, int endIndex, b2StepContext* context )
 {
 	b2TracyCZoneNC( prepare_joints, "PrepJoints", b2_colorOldLace, true );
 
 	b2ConstraintGraph* graph = context->graph;
 	b2JointSim* joints = graph->colors[B2_OVERFLOW_INDEX].jointSims.data;
-	int jointCount = graph->colors[B2_OVERFLOW_INDEX].jointSims.count;
+	const int* overflowJoints = context->overflowJoints;
 
-	for ( int i = 0; i < jointCount; ++i )
+	for ( int i = startIndex; i < endIndex; ++i )
 	{
-		b2JointSim* joint = joints + i;
+		b2JointSim* joint = joints + overflowJoints[i];
 		b2WarmStartJoint( joint, context );
 	}
 
 	b2TracyCZoneEnd( prepare_joints );
 }
 
-void b2SolveOverflowJoints( b2StepContext* context, bool useBias )
+void b2SolveOverflowJoints( int startIndex, int endIndex, b2StepContext* context, bool useBias )
 {
 	b2TracyCZoneNC( solve_joints, "SolveJoints", b2_colorLemonChiffon, true );
 
 	b2ConstraintGraph* graph = context->graph;
 	b2JointSim* joints = graph->colors[B2_OVERFLOW_INDEX].jointSims.data;
-	int jointCount = graph->colors[B2_OVERFLOW_INDEX].jointSims.count;
+	const int* overflowJoints = context->overflowJoints;
 
-	for ( int i = 0; i < jointCount; ++i )
+	for ( int i = startIndex; i < endIndex; ++i )
 	{
-		b2JointSim* joint = joints + i;
+		b2JointSim* joint = joints + overflowJoints[i];
 		b2SolveJoint( joint, context, useBias );
 	}
 
@@ -1514,9 +1514,12 @@ void b2DrawJoint( b2DebugDraw* draw, b2World* world, b2Joint* joint )
 
 	if ( draw->drawGraphColors )
 	{
-		b2HexColor colors[B2_GRAPH_COLOR_COUNT] = { b2_colorRed,	   b2_colorOrange,	  b2_colorYellow, b2_colorGreen,
-													b2_colorCyan,	   b2_colorBlue,	  b2_colorViolet, b2_colorPink,
-													b2_colorChocolate, b2_colorGoldenRod, b2_colorCoral,  b2_colorBlack };
+		b2HexColor colors[B2_GRAPH_COLOR_COUNT] = { b2_colorRed, b2_colorOrange, b2_colorYellow, b2_colorGreen,
+													b2_colorCyan, b2_colorBlue, b2_colorViolet, b2_colorPink,
+													b2_colorChocolate, b2_colorGoldenRod, b2_colorCoral, b2_colorRosyBrown,
+													b2_colorAqua, b2_colorPeru, b2_colorLime, b2_colorGold,
+													b2_colorPlum, b2_colorSnow, b2_colorTeal, b2_colorKhaki,
+													b2_colorSalmon, b2_colorPeachPuff, b2_colorHoneyDew, b2_colorBlack };
 
 		int colorIndex = joint->colorIndex;
 		if ( colorIndex != B2_NULL_INDEX )
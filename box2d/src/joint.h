@@ -280,9 +280,10 @@ void b2PrepareJoint( b2JointSim* joint, b2StepContext* context );
 void b2WarmStartJoint( b2JointSim* joint, b2StepContext* context );
 void b2SolveJoint( b2JointSim* joint, b2StepContext* context, bool useBias );
 
-void b2PrepareOverflowJoints( b2StepContext* context );
-void b2WarmStartOverflowJoints( b2StepContext* context );
-void b2SolveOverflowJoints( b2StepContext* context, bool useBias );
+// The range indexes the overflow joint permutation in the step context
+void b2PrepareOverflowJoints( int startIndex, int endIndex, b2StepContext* context );
+void b2WarmStartOverflowJoints( int startIndex, int endIndex, b2StepContext* context );
+void b2SolveOverflowJoints( int startIndex, int endIndex, b2StepContext* context, bool useBias );
 
 float b2GetJointConstraintForceMagnitude( b2JointSim* jointSim, float invTimeStep );
 float b2GetJointConstraintTorqueMagnitude( b2JointSim* jointSim, float invTimeStep );
@@ -0,0 +1,586 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#include "joint_solver.h"
+
+#include "body.h"
+#include "constraint_graph.h"
+#include "contact_solver.h"
+#include "core.h"
+#include "joint.h"
+#include "simd.h"
+
+#include <float.h>
+#include <stddef.h>
+
+// Revolute and weld joints share one wide constraint. A weld joint is a revolute joint with a permanent
+// angular spring and no motor or limit, so each lane has flags that enable the parts it uses.
+// Every step mirrors the scalar solver operation for operation so the results are bit identical.
+typedef struct b2JointConstraintSIMD
+{
+	int indexA[B2_SIMD_WIDTH];
+	int indexB[B2_SIMD_WIDTH];
+
+	b2FloatW invMassA, invMassB;
+	b2FloatW invIA, invIB;
+	b2Vec2W frameAP, frameBP;
+	b2RotW frameAQ, frameBQ;
+	b2Vec2W deltaCenter;
+	b2FloatW axialMass;
+
+	// point constraint: constraint softness for revolute, linear softness for weld
+	b2FloatW linearBiasRate, linearMassScale, linearImpulseScale;
+
+	// spring softness for revolute, angular softness for weld
+	b2FloatW angularBiasRate, angularMassScale, angularImpulseScale;
+
+	// constraint softness for the revolute limit
+	b2FloatW limitBiasRate, limitMassScale, limitImpulseScale;
+
+	b2FloatW targetAngle;
+	b2FloatW motorSpeed;
+	b2FloatW maxMotorImpulse;
+	b2FloatW lowerAngle, upperAngle;
+
+	// Lane masks. These are packed as 1 or 0 and converted to SIMD masks once the lanes are full.
+	b2FloatW enableAngular;
+	b2FloatW softAngular;
+	b2FloatW softLinear;
+	b2FloatW enableMotor;
+	b2FloatW enableLimit;
+	b2FloatW isWeld;
+
+	// spring impulse for revolute, angular impulse for weld
+	b2FloatW angularImpulse;
+	b2FloatW motorImpulse;
+	b2FloatW lowerImpulse;
+	b2FloatW upperImpulse;
+	b2Vec2W linearImpulse;
+} b2JointConstraintSIMD;
+
+int b2GetJointConstraintSIMDByteCount( void )
+{
+	return sizeof( b2JointConstraintSIMD );
+}
+
+#if !defined( B2_SIMD_SUFFIX )
+bool b2IsSIMDJoint( const b2JointSim* joint )
+{
+#if defined( B2_SIMD_NONE )
+	// The scalar fallback is slower than solving each joint directly
+	B2_UNUSED( joint );
+	return false;
+#else
+	if ( joint->type != b2_revoluteJoint && joint->type != b2_weldJoint )
+	{
+		return false;
+	}
+
+	// Joint events read the impulses of each joint right after it is solved
+	return joint->forceThreshold == FLT_MAX && joint->torqueThreshold == FLT_MAX;
+#endif
+}
+#endif
+
+static inline b2FloatW b2NegW( b2FloatW a )
+{
+	// Multiplying by -1 flips the sign of zero like scalar negation does
+	return b2MulW( a, b2SplatW( -1.0f ) );
+}
+
+static inline b2RotW b2MulRotW( b2RotW q, b2RotW r )
+{
+	return (b2RotW){ b2SubW( b2MulW( q.C, r.C ), b2MulW( q.S, r.S ) ), b2AddW( b2MulW( q.S, r.C ), b2MulW( q.C, r.S ) ) };
+}
+
+static inline b2RotW b2InvMulRotW( b2RotW a, b2RotW b )
+{
+	return (b2RotW){ b2AddW( b2MulW( a.C, b.C ), b2MulW( a.S, b.S ) ), b2SubW( b2MulW( a.C, b.S ), b2MulW( a.S, b.C ) ) };
+}
+
+// Same as b2Atan2, using blends for the branches
+static b2FloatW b2Atan2W( b2FloatW y, b2FloatW x )
+{
+	b2FloatW zero = b2ZeroW();
+
+	b2FloatW ax = b2BlendW( x, b2NegW( x ), b2GreaterThanW( zero, x ) );
+	b2FloatW ay = b2BlendW( y, b2NegW( y ), b2GreaterThanW( zero, y ) );
+	b2FloatW mx = b2BlendW( ax, ay, b2GreaterThanW( ay, ax ) );
+	b2FloatW mn = b2BlendW( ax, ay, b2GreaterThanW( ax, ay ) );
+	b2FloatW a = b2DivW( mn, mx );
+
+	b2FloatW s = b2MulW( a, a );
+	b2FloatW c = b2MulW( s, a );
+	b2FloatW q = b2MulW( s, s );
+	b2FloatW r = b2AddW( b2MulW( b2SplatW( 0.024840285f ), q ), b2SplatW( 0.18681418f ) );
+	b2FloatW t = b2SubW( b2MulW( b2SplatW( -0.094097948f ), q ), b2SplatW( 0.33213072f ) );
+	r = b2AddW( b2MulW( r, s ), t );
+	r = b2AddW( b2MulW( r, c ), a );
+
+	r = b2BlendW( r, b2SubW( b2SplatW( 1.57079637f ), r ), b2GreaterThanW( ay, ax ) );
+	r = b2BlendW( r, b2SubW( b2SplatW( 3.14159274f ), r ), b2GreaterThanW( zero, x ) );
+	r = b2BlendW( r, b2NegW( r ), b2GreaterThanW( zero, y ) );
+
+	// (0,0) gives zero. The absolute values are not negative, so the sum is only zero at the origin.
+	return b2BlendW( r, zero, b2EqualsW( b2AddW( ax, ay ), zero ) );
+}
+
+// Same as b2UnwindAngle. The IEEE remainder of an angle below 2pi in magnitude is the angle itself or
+// the angle -/+ 2pi, and that subtraction is exact. Larger angles can only come from the target angle
+// and fall back to remainderf.
+static b2FloatW b2UnwindAngleW( b2FloatW radians )
+{
+	b2FloatW pi = b2SplatW( B2_PI );
+	b2FloatW twoPi = b2SplatW( 2.0f * B2_PI );
+	b2FloatW magnitude = b2AbsW( radians );
+
+	if ( b2AllZeroW( b2OrW( b2GreaterThanW( magnitude, twoPi ), b2EqualsW( magnitude, twoPi ) ) ) == false )
+	{
+		float* lanes = (float*)&radians;
+		for ( int i = 0; i < B2_SIMD_WIDTH; ++i )
+		{
+			lanes[i] = b2UnwindAngle( lanes[i] );
+		}
+		return radians;
+	}
+
+	b2FloatW r = b2BlendW( radians, b2SubW( radians, twoPi ), b2GreaterThanW( radians, pi ) );
+	return b2BlendW( r, b2AddW( radians, twoPi ), b2GreaterThanW( b2NegW( pi ), radians ) );
+}
+
+// Keeps the remainder lanes harmless: no mass, no enabled parts, identity frames
+static void b2ClearJointLane( b2JointConstraintSIMD* constraint, int laneIndex )
+{
+	constraint->indexA[laneIndex] = B2_NULL_INDEX;
+	constraint->indexB[laneIndex] = B2_NULL_INDEX;
+
+	float* lanes = (float*)&constraint->invMassA;
+	int wideCount =
+		(int)( ( sizeof( b2JointConstraintSIMD ) - offsetof( b2JointConstraintSIMD, invMassA ) ) / sizeof( b2FloatW ) );
+	for ( int i = 0; i < wideCount; ++i )
+	{
+		lanes[B2_SIMD_WIDTH * i + laneIndex] = 0.0f;
+	}
+
+	( (float*)&constraint->frameAQ.C )[laneIndex] = 1.0f;
+	( (float*)&constraint->frameBQ.C )[laneIndex] = 1.0f;
+}
+
+void b2PrepareJointsSIMDTask( int startIndex, int endIndex, b2StepContext* context )
+{
+	b2TracyCZoneNC( prepare_joints_simd, "PrepJoints SIMD", b2_colorOldLace, true );
+
+	b2JointSim** joints = context->simdJoints;
+	b2JointConstraintSIMD* constraints = context->simdJointConstraints;
+	float h = context->h;
+	b2FloatW zero = b2ZeroW();
+
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2JointConstraintSIMD* constraint = constraints + i;
+
+		for ( int j = 0; j < B2_SIMD_WIDTH; ++j )
+		{
+			b2JointSim* base = joints[B2_SIMD_WIDTH * i + j];
+
+			if ( base == NULL )
+			{
+				b2ClearJointLane( constraint, j );
+				continue;
+			}
+
+			b2PrepareJoint( base, context );
+
+			float mA = base->invMassA;
+			float mB = base->invMassB;
+			float iA = base->invIA;
+			float iB = base->invIB;
+			bool fixedRotation = ( iA + iB == 0.0f );
+
+			( (float*)&constraint->invMassA )[j] = mA;
+			( (float*)&constraint->invMassB )[j] = mB;
+			( (float*)&constraint->invIA )[j] = iA;
+			( (float*)&constraint->invIB )[j] = iB;
+
+			( (float*)&constraint->limitBiasRate )[j] = base->constraintSoftness.biasRate;
+			( (float*)&constraint->limitMassScale )[j] = base->constraintSoftness.massScale;
+			( (float*)&constraint->limitImpulseScale )[j] = base->constraintSoftness.impulseScale;
+
+			if ( base->type == b2_revoluteJoint )
+			{
+				b2RevoluteJoint* joint = &base->revoluteJoint;
+
+				constraint->indexA[j] = joint->indexA;
+				constraint->indexB[j] = joint->indexB;
+
+				( (float*)&constraint->frameAP.X )[j] = joint->frameA.p.x;
+				( (float*)&constraint->frameAP.Y )[j] = joint->frameA.p.y;
+				( (float*)&constraint->frameAQ.C )[j] = joint->frameA.q.c;
+				( (float*)&constraint->frameAQ.S )[j] = joint->frameA.q.s;
+				( (float*)&constraint->frameBP.X )[j] = joint->frameB.p.x;
+				( (float*)&constraint->frameBP.Y )[j] = joint->frameB.p.y;
+				( (float*)&constraint->frameBQ.C )[j] = joint->frameB.q.c;
+				( (float*)&constraint->frameBQ.S )[j] = joint->frameB.q.s;
+				( (float*)&constraint->deltaCenter.X )[j] = joint->deltaCenter.x;
+				( (float*)&constraint->deltaCenter.Y )[j] = joint->deltaCenter.y;
+				( (float*)&constraint->axialMass )[j] = joint->axialMass;
+
+				( (float*)&constraint->linearBiasRate )[j] = base->constraintSoftness.biasRate;
+				( (float*)&constraint->linearMassScale )[j] = base->constraintSoftness.massScale;
+				( (float*)&constraint->linearImpulseScale )[j] = base->constraintSoftness.impulseScale;
+				( (float*)&constraint->angularBiasRate )[j] = joint->springSoftness.biasRate;
+				( (float*)&constraint->angularMassScale )[j] = joint->springSoftness.massScale;
+				( (float*)&constraint->angularImpulseScale )[j] = joint->springSoftness.impulseScale;
+
+				( (float*)&constraint->targetAngle )[j] = joint->targetAngle;
+				( (float*)&constraint->motorSpeed )[j] = joint->motorSpeed;
+				( (float*)&constraint->maxMotorImpulse )[j] = h * joint->maxMotorTorque;
+				( (float*)&constraint->lowerAngle )[j] = joint->lowerAngle;
+				( (float*)&constraint->upperAngle )[j] = joint->upperAngle;
+
+				( (float*)&constraint->enableAngular )[j] = joint->enableSpring && fixedRotation == false ? 1.0f : 0.0f;
+				( (float*)&constraint->softAngular )[j] = 1.0f;
+				( (float*)&constraint->softLinear )[j] = 0.0f;
+				( (float*)&constraint->enableMotor )[j] = joint->enableMotor && fixedRotation == false ? 1.0f : 0.0f;
+				( (float*)&constraint->enableLimit )[j] = joint->enableLimit && fixedRotation == false ? 1.0f : 0.0f;
+				( (float*)&constraint->isWeld )[j] = 0.0f;
+
+				( (float*)&constraint->angularImpulse )[j] = joint->springImpulse;
+				( (float*)&constraint->motorImpulse )[j] = joint->motorImpulse;
+				( (float*)&constraint->lowerImpulse )[j] = joint->lowerImpulse;
+				( (float*)&constraint->upperImpulse )[j] = joint->upperImpulse;
+				( (float*)&constraint->linearImpulse.X )[j] = joint->linearImpulse.x;
+				( (float*)&constraint->linearImpulse.Y )[j] = joint->linearImpulse.y;
+			}
+			else
+			{
+				B2_ASSERT( base->type == b2_weldJoint );
+				b2WeldJoint* joint = &base->weldJoint;
+
+				constraint->indexA[j] = joint->indexA;
+				constraint->indexB[j] = joint->indexB;
+
+				( (float*)&constraint->frameAP.X )[j] = joint->frameA.p.x;
+				( (float*)&constraint->frameAP.Y )[j] = joint->frameA.p.y;
+				( (float*)&constraint->frameAQ.C )[j] = joint->frameA.q.c;
+				( (float*)&constraint->frameAQ.S )[j] = joint->frameA.q.s;
+				( (float*)&constraint->frameBP.X )[j] = joint->frameB.p.x;
+				( (float*)&constraint->frameBP.Y )[j] = joint->frameB.p.y;
+				( (float*)&constraint->frameBQ.C )[j] = joint->frameB.q.c;
+				( (float*)&constraint->frameBQ.S )[j] = joint->frameB.q.s;
+				( (float*)&constraint->deltaCenter.X )[j] = joint->deltaCenter.x;
+				( (float*)&constraint->deltaCenter.Y )[j] = joint->deltaCenter.y;
+				( (float*)&constraint->axialMass )[j] = joint->axialMass;
+
+				( (float*)&constraint->linearBiasRate )[j] = joint->linearSoftness.biasRate;
+				( (float*)&constraint->linearMassScale )[j] = joint->linearSoftness.massScale;
+				( (float*)&constraint->linearImpulseScale )[j] = joint->linearSoftness.impulseScale;
+				( (float*)&constraint->angularBiasRate )[j] = joint->angularSoftness.biasRate;
+				( (float*)&constraint->angularMassScale )[j] = joint->angularSoftness.massScale;
+				( (float*)&constraint->angularImpulseScale )[j] = joint->angularSoftness.impulseScale;
+
+				// The weld angle is used as is, which the unwind leaves unchanged
+				( (float*)&constraint->targetAngle )[j] = 0.0f;
+				( (float*)&constraint->motorSpeed )[j] = 0.0f;
+				( (float*)&constraint->maxMotorImpulse )[j] = 0.0f;
+				( (float*)&constraint->lowerAngle )[j] = 0.0f;
+				( (float*)&constraint->upperAngle )[j] = 0.0f;
+
+				( (float*)&constraint->enableAngular )[j] = 1.0f;
+				( (float*)&constraint->softAngular )[j] = joint->angularHertz > 0.0f ? 1.0f : 0.0f;
+				( (float*)&constraint->softLinear )[j] = joint->linearHertz > 0.0f ? 1.0f : 0.0f;
+				( (float*)&constraint->enableMotor )[j] = 0.0f;
+				( (float*)&constraint->enableLimit )[j] = 0.0f;
+				( (float*)&constraint->isWeld )[j] = 1.0f;
+
+				( (float*)&constraint->angularImpulse )[j] = joint->angularImpulse;
+				( (float*)&constraint->motorImpulse )[j] = 0.0f;
+				( (float*)&constraint->lowerImpulse )[j] = 0.0f;
+				( (float*)&constraint->upperImpulse )[j] = 0.0f;
+				( (float*)&constraint->linearImpulse.X )[j] = joint->linearImpulse.x;
+				( (float*)&constraint->linearImpulse.Y )[j] = joint->linearImpulse.y;
+			}
+		}
+
+		constraint->enableAngular = b2GreaterThanW( constraint->enableAngular, zero );
+		constraint->softAngular = b2GreaterThanW( constraint->softAngular, zero );
+		constraint->softLinear = b2GreaterThanW( constraint->softLinear, zero );
+		constraint->enableMotor = b2GreaterThanW( constraint->enableMotor, zero );
+		constraint->enableLimit = b2GreaterThanW( constraint->enableLimit, zero );
+		constraint->isWeld = b2GreaterThanW( constraint->isWeld, zero );
+	}
+
+	b2TracyCZoneEnd( prepare_joints_simd );
+}
+
+void b2WarmStartJointsSIMDTask( int startIndex, int endIndex, b2StepContext* context, int colorIndex )
+{
+	b2TracyCZoneNC( warm_joints_simd, "WarmJoints SIMD", b2_colorGold, true );
+
+	b2BodyState* states = context->states;
+	b2JointConstraintSIMD* constraints = context->graph->colors[colorIndex].simdJoints;
+
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2JointConstraintSIMD* c = constraints + i;
+		b2BodyStateW bA = b2GatherBodies( states, c->indexA );
+		b2BodyStateW bB = b2GatherBodies( states, c->indexB );
+
+		b2Vec2W rA = b2RotateVectorW( bA.dq, c->frameAP );
+		b2Vec2W rB = b2RotateVectorW( bB.dq, c->frameBP );
+
+		b2FloatW revoluteImpulse =
+			b2SubW( b2AddW( b2AddW( c->angularImpulse, c->motorImpulse ), c->lowerImpulse ), c->upperImpulse );
+		b2FloatW axialImpulse = b2BlendW( revoluteImpulse, c->angularImpulse, c->isWeld );
+
+		b2Vec2W P = c->linearImpulse;
+		bA.v.X = b2MulSubW( bA.v.X, c->invMassA, P.X );
+		bA.v.Y = b2MulSubW( bA.v.Y, c->invMassA, P.Y );
+		bA.w = b2MulSubW( bA.w, c->invIA, b2AddW( b2CrossW( rA, P ), axialImpulse ) );
+
+		bB.v.X = b2MulAddW( bB.v.X, c->invMassB, P.X );
+		bB.v.Y = b2MulAddW( bB.v.Y, c->invMassB, P.Y );
+		bB.w = b2MulAddW( bB.w, c->invIB, b2AddW( b2CrossW( rB, P ), axialImpulse ) );
+
+		b2ScatterBodies( states, c->indexA, &bA );
+		b2ScatterBodies( states, c->indexB, &bB );
+	}
+
+	b2TracyCZoneEnd( warm_joints_simd );
+}
+
+void b2SolveJointsSIMDTask( int startIndex, int endIndex, b2StepContext* context, int colorIndex, bool useBias )
+{
+	b2TracyCZoneNC( solve_joints_simd, "SolveJoints SIMD", b2_colorLemonChiffon, true );
+
+	b2BodyState* states = context->states;
+	b2JointConstraintSIMD* constraints = context->graph->colors[colorIndex].simdJoints;
+	b2FloatW zero = b2ZeroW();
+	b2FloatW one = b2SplatW( 1.0f );
+	b2FloatW inv_h = b2SplatW( context->inv_h );
+
+	// All lanes use their softness when solving with bias
+	b2FloatW biasMask = useBias ? b2EqualsW( zero, zero ) : zero;
+
+	for ( int i = startIndex; i < endIndex; ++i )
+	{
+		b2JointConstraintSIMD* c = constraints + i;
+
+		b2BodyStateW bA = b2GatherBodies( states, c->indexA );
+		b2BodyStateW bB = b2GatherBodies( states, c->indexB );
+
+		b2FloatW mA = c->invMassA;
+		b2FloatW mB = c->invMassB;
+		b2FloatW iA = c->invIA;
+		b2FloatW iB = c->invIB;
+		b2FloatW wA = bA.w;
+		b2FloatW wB = bB.w;
+
+		// Plain revolute joints skip the angle, so only pay for it when some lane needs it
+		b2FloatW jointAngle = zero;
+		if ( b2AllZeroW( b2OrW( c->enableAngular, c->enableLimit ) ) == false )
+		{
+			b2RotW qA = b2MulRotW( bA.dq, c->frameAQ );
+			b2RotW qB = b2MulRotW( bB.dq, c->frameBQ );
+			b2RotW relQ = b2InvMulRotW( qA, qB );
+			jointAngle = b2Atan2W( relQ.S, relQ.C );
+		}
+
+		// Revolute spring or weld angular constraint
+		if ( b2AllZeroW( c->enableAngular ) == false )
+		{
+			b2FloatW C = b2UnwindAngleW( b2SubW( jointAngle, c->targetAngle ) );
+
+			b2FloatW soft = b2OrW( c->softAngular, biasMask );
+			b2FloatW bias = b2BlendW( zero, b2MulW( c->angularBiasRate, C ), soft );
+			b2FloatW massScale = b2BlendW( one, c->angularMassScale, soft );
+			b2FloatW impulseScale = b2BlendW( zero, c->angularImpulseScale, soft );
+
+			b2FloatW Cdot = b2SubW( wB, wA );
+			b2FloatW impulse = b2SubW( b2MulW( b2MulW( b2NegW( massScale ), c->axialMass ), b2AddW( Cdot, bias ) ),
+									   b2MulW( impulseScale, c->angularImpulse ) );
+
+			b2FloatW mask = c->enableAngular;
+			c->angularImpulse = b2BlendW( c->angularImpulse, b2AddW( c->angularImpulse, impulse ), mask );
+			wA = b2BlendW( wA, b2MulSubW( wA, iA, impulse ), mask );
+			wB = b2BlendW( wB, b2MulAddW( wB, iB, impulse ), mask );
+		}
+
+		// Motor
+		if ( b2AllZeroW( c->enableMotor ) == false )
+		{
+			b2FloatW Cdot = b2SubW( b2SubW( wB, wA ), c->motorSpeed );
+			b2FloatW impulse = b2MulW( b2NegW( c->axialMass ), Cdot );
+			b2FloatW oldImpulse = c->motorImpulse;
+			b2FloatW maxImpulse = c->maxMotorImpulse;
+
+			// b2ClampFloat
+			b2FloatW newImpulse = b2AddW( oldImpulse, impulse );
+			newImpulse = b2BlendW( newImpulse, maxImpulse, b2GreaterThanW( newImpulse, maxImpulse ) );
+			b2FloatW minImpulse = b2NegW( maxImpulse );
+			newImpulse = b2BlendW( newImpulse, minImpulse, b2GreaterThanW( minImpulse, b2AddW( oldImpulse, impulse ) ) );
+			impulse = b2SubW( newImpulse, oldImpulse );
+
+			b2FloatW mask = c->enableMotor;
+			c->motorImpulse = b2BlendW( oldImpulse, newImpulse, mask );
+			wA = b2BlendW( wA, b2MulSubW( wA, iA, impulse ), mask );
+			wB = b2BlendW( wB, b2MulAddW( wB, iB, impulse ), mask );
+		}
+
+		// Lower limit
+		if ( b2AllZeroW( c->enableLimit ) == false )
+		{
+			b2FloatW C = b2SubW( jointAngle, c->lowerAngle );
+
+			// speculative when C > 0, otherwise soft with bias and rigid without
+			b2FloatW speculative = b2GreaterThanW( C, zero );
+			b2FloatW bias =
+				b2BlendW( b2BlendW( zero, b2MulW( c->limitBiasRate, C ), biasMask ), b2MulW( C, inv_h ), speculative );
+			b2FloatW massScale = b2BlendW( b2BlendW( one, c->limitMassScale, biasMask ), one, speculative );
+			b2FloatW impulseScale = b2BlendW( b2BlendW( zero, c->limitImpulseScale, biasMask ), zero, speculative );
+
+			b2FloatW Cdot = b2SubW( wB, wA );
+			b2FloatW oldImpulse = c->lowerImpulse;
+			b2FloatW impulse = b2SubW( b2MulW( b2MulW( b2NegW( massScale ), c->axialMass ), b2AddW( Cdot, bias ) ),
+									   b2MulW( impulseScale, oldImpulse ) );
+			b2FloatW newImpulse = b2AddW( oldImpulse, impulse );
+			newImpulse = b2BlendW( zero, newImpulse, b2GreaterThanW( newImpulse, zero ) );
+			impulse = b2SubW( newImpulse, oldImpulse );
+
+			b2FloatW mask = c->enableLimit;
+			c->lowerImpulse = b2BlendW( oldImpulse, newImpulse, mask );
+			wA = b2BlendW( wA, b2MulSubW( wA, iA, impulse ), mask );
+			wB = b2BlendW( wB, b2MulAddW( wB, iB, impulse ), mask );
+		}
+
+		// Upper limit
+		// Note: signs are flipped to keep C positive when the constraint is satisfied.
+		if ( b2AllZeroW( c->enableLimit ) == false )
+		{
+			b2FloatW C = b2SubW( c->upperAngle, jointAngle );
+
+			b2FloatW speculative = b2GreaterThanW( C, zero );
+			b2FloatW bias =
+				b2BlendW( b2BlendW( zero, b2MulW( c->limitBiasRate, C ), biasMask ), b2MulW( C, inv_h ), speculative );
+			b2FloatW massScale = b2BlendW( b2BlendW( one, c->limitMassScale, biasMask ), one, speculative );
+			b2FloatW impulseScale = b2BlendW( b2BlendW( zero, c->limitImpulseScale, biasMask ), zero, speculative );
+
+			b2FloatW Cdot = b2SubW( wA, wB );
+			b2FloatW oldImpulse = c->upperImpulse;
+			b2FloatW impulse = b2SubW( b2MulW( b2MulW( b2NegW( massScale ), c->axialMass ), b2AddW( Cdot, bias ) ),
+									   b2MulW( impulseScale, oldImpulse ) );
+			b2FloatW newImpulse = b2AddW( oldImpulse, impulse );
+			newImpulse = b2BlendW( zero, newImpulse, b2GreaterThanW( newImpulse, zero ) );
+			impulse = b2SubW( newImpulse, oldImpulse );
+
+			b2FloatW mask = c->enableLimit;
+			c->upperImpulse = b2BlendW( oldImpulse, newImpulse, mask );
+			wA = b2BlendW( wA, b2MulAddW( wA, iA, impulse ), mask );
+			wB = b2BlendW( wB, b2MulSubW( wB, iB, impulse ), mask );
+		}
+
+		// Point constraint
+		{
+			b2Vec2W rA = b2RotateVectorW( bA.dq, c->frameAP );
+			b2Vec2W rB = b2RotateVectorW( bB.dq, c->frameBP );
+
+			b2Vec2W Cdot;
+			Cdot.X = b2SubW( b2SubW( bB.v.X, b2MulW( wB, rB.Y ) ), b2SubW( bA.v.X, b2MulW( wA, rA.Y ) ) );
+			Cdot.Y = b2SubW( b2AddW( bB.v.Y, b2MulW( wB, rB.X ) ), b2AddW( bA.v.Y, b2MulW( wA, rA.X ) ) );
+
+			b2FloatW soft = b2OrW( c->softLinear, biasMask );
+			b2FloatW separationX =
+				b2AddW( b2AddW( b2SubW( bB.dp.X, bA.dp.X ), b2SubW( rB.X, rA.X ) ), c->deltaCenter.X );
+			b2FloatW separationY =
+				b2AddW( b2AddW( b2SubW( bB.dp.Y, bA.dp.Y ), b2SubW( rB.Y, rA.Y ) ), c->deltaCenter.Y );
+			b2FloatW biasX = b2BlendW( zero, b2MulW( c->linearBiasRate, separationX ), soft );
+			b2FloatW biasY = b2BlendW( zero, b2MulW( c->linearBiasRate, separationY ), soft );
+			b2FloatW massScale = b2BlendW( one, c->linearMassScale, soft );
+			b2FloatW impulseScale = b2BlendW( zero, c->linearImpulseScale, soft );
+
+			b2FloatW mAB = b2AddW( mA, mB );
+			b2FloatW k11 = b2AddW( b2AddW( mAB, b2MulW( b2MulW( rA.Y, rA.Y ), iA ) ), b2MulW( b2MulW( rB.Y, rB.Y ), iB ) );
+			b2FloatW k12 = b2SubW( b2MulW( b2MulW( b2NegW( rA.Y ), rA.X ), iA ), b2MulW( b2MulW( rB.Y, rB.X ), iB ) );
+			b2FloatW k22 = b2AddW( b2AddW( mAB, b2MulW( b2MulW( rA.X, rA.X ), iA ) ), b2MulW( b2MulW( rB.X, rB.X ), iB ) );
+
+			// b2Solve22
+			b2FloatW bx = b2AddW( Cdot.X, biasX );
+			b2FloatW by = b2AddW( Cdot.Y, biasY );
+			b2FloatW det = b2SubW( b2MulW( k11, k22 ), b2MulW( k12, k12 ) );
+			det = b2BlendW( b2DivW( one, det ), det, b2EqualsW( det, zero ) );
+			b2FloatW solveX = b2MulW( det, b2SubW( b2MulW( k22, bx ), b2MulW( k12, by ) ) );
+			b2FloatW solveY = b2MulW( det, b2SubW( b2MulW( k11, by ), b2MulW( k12, bx ) ) );
+
+			b2Vec2W impulse;
+			impulse.X = b2SubW( b2MulW( b2NegW( massScale ), solveX ), b2MulW( impulseScale, c->linearImpulse.X ) );
+			impulse.Y = b2SubW( b2MulW( b2NegW( massScale ), solveY ), b2MulW( impulseScale, c->linearImpulse.Y ) );
+			c->linearImpulse.X = b2AddW( c->linearImpulse.X, impulse.X );
+			c->linearImpulse.Y = b2AddW( c->linearImpulse.Y, impulse.Y );
+
+			bA.v.X = b2MulSubW( bA.v.X, mA, impulse.X );
+			bA.v.Y = b2MulSubW( bA.v.Y, mA, impulse.Y );
+			wA = b2MulSubW( wA, iA, b2CrossW( rA, impulse ) );
+			bB.v.X = b2MulAddW( bB.v.X, mB, impulse.X );
+			bB.v.Y = b2MulAddW( bB.v.Y, mB, impulse.Y );
+			wB = b2MulAddW( wB, iB, b2CrossW( rB, impulse ) );
+		}
+
+		bA.w = wA;
+		bB.w = wB;
+
+		b2ScatterBodies( states, c->indexA, &bA );
+		b2ScatterBodies( states, c->indexB, &bB );
+	}
+
+	b2TracyCZoneEnd( solve_joints_simd );
+}
+
+void b2StoreJointImpulsesTask( int startIndex, int endIndex, b2StepContext* context )
+{
+	b2TracyCZoneNC( store_joint_impulses, "Store Joints", b2_colorFireBrick, true );
+
+	b2JointSim** joints = context->simdJoints;
+	const b2JointConstraintSIMD* constraints = context->simdJointConstraints;
+
+	for ( int constraintIndex = startIndex; constraintIndex < endIndex; ++constraintIndex )
+	{
+		const b2JointConstraintSIMD* c = constraints + constraintIndex;
+		const float* angularImpulse = (float*)&c->angularImpulse;
+		const float* motorImpulse = (float*)&c->motorImpulse;
+		const float* lowerImpulse = (float*)&c->lowerImpulse;
+		const float* upperImpulse = (float*)&c->upperImpulse;
+		const float* linearImpulseX = (float*)&c->linearImpulse.X;
+		const float* linearImpulseY = (float*)&c->linearImpulse.Y;
+
+		int baseIndex = B2_SIMD_WIDTH * constraintIndex;
+
+		for ( int laneIndex = 0; laneIndex < B2_SIMD_WIDTH; ++laneIndex )
+		{
+			b2JointSim* base = joints[baseIndex + laneIndex];
+			if ( base == NULL )
+			{
+				continue;
+			}
+
+			b2Vec2 linearImpulse = { linearImpulseX[laneIndex], linearImpulseY[laneIndex] };
+
+			if ( base->type == b2_revoluteJoint )
+			{
+				b2RevoluteJoint* joint = &base->revoluteJoint;
+				joint->linearImpulse = linearImpulse;
+				joint->springImpulse = angularImpulse[laneIndex];
+				joint->motorImpulse = motorImpulse[laneIndex];
+				joint->lowerImpulse = lowerImpulse[laneIndex];
+				joint->upperImpulse = upperImpulse[laneIndex];
+			}
+			else
+			{
+				b2WeldJoint* joint = &base->weldJoint;
+				joint->linearImpulse = linearImpulse;
+				joint->angularImpulse = angularImpulse[laneIndex];
+			}
+		}
+	}
+
+	b2TracyCZoneEnd( store_joint_impulses );
+}
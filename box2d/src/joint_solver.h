@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "simd_kernels.h"
+#include "solver.h"
+
+typedef struct b2JointSim b2JointSim;
+
+int b2GetJointConstraintSIMDByteCount( void );
+
+// Revolute and weld joints without force or torque thresholds can be packed into SIMD lanes
+bool b2IsSIMDJoint( const b2JointSim* joint );
+
+// Graph color joints packed into SIMD lanes. These give the same results as the scalar joint functions.
+void b2PrepareJointsSIMDTask( int startIndex, int endIndex, b2StepContext* context );
+void b2WarmStartJointsSIMDTask( int startIndex, int endIndex, b2StepContext* context, int colorIndex );
+void b2SolveJointsSIMDTask( int startIndex, int endIndex, b2StepContext* context, int colorIndex, bool useBias );
+void b2StoreJointImpulsesTask( int startIndex, int endIndex, b2StepContext* context );
@@ -1,8 +1,11 @@
 // SPDX-FileCopyrightText: 2023 Erin Catto
 // SPDX-License-Identifier: MIT
 
+#include "manifold.h"
+
 #include "constants.h"
 #include "core.h"
+#include "simd.h"
 
 #include "box2d/collision.h"
 #include "box2d/math_functions.h"
@@ -715,6 +718,287 @@ static float b2FindMaxSeparation( int* edgeIndex, const b2Polygon* poly1, const
 	return maxSeparation;
 }
 
+// Find the edge of poly whose normal is most anti-parallel to the search direction.
+static int b2FindIncidentEdge( b2Vec2 searchDirection, const b2Polygon* poly )
+{
+	int count = poly->count;
+	const b2Vec2* normals = poly->normals;
+	int edge = 0;
+	float minDot = FLT_MAX;
+	for ( int i = 0; i < count; ++i )
+	{
+		float dot = b2Dot( searchDirection, normals[i] );
+		if ( dot < minDot )
+		{
+			minDot = dot;
+			edge = i;
+		}
+	}
+
+	return edge;
+}
+
+// The wide separating axis search loads whole polygons into SIMD blocks. AVX-512 blocks are wider than
+// any polygon, so that build uses the scalar search.
+#if B2_SIMD_WIDTH <= B2_MAX_POLYGON_VERTICES
+#define B2_POLYGON_SIMD 1
+#else
+#define B2_POLYGON_SIMD 0
+#endif
+
+#if B2_POLYGON_SIMD
+
+#define B2_POLYGON_BLOCK_COUNT ( B2_MAX_POLYGON_VERTICES / B2_SIMD_WIDTH )
+
+_Static_assert( B2_MAX_POLYGON_VERTICES % B2_SIMD_WIDTH == 0, "polygon must fill whole SIMD blocks" );
+
+// Polygon edges in structure of arrays form. Lane i holds vertex i and normal i. Whole blocks are loaded
+// from the polygon arrays, so lanes past the polygon count hold whatever follows and must be ignored.
+typedef struct b2PolygonEdgesW
+{
+	b2Vec2W vertices[B2_POLYGON_BLOCK_COUNT];
+	b2Vec2W normals[B2_POLYGON_BLOCK_COUNT];
+} b2PolygonEdgesW;
+
+static inline int b2GetPolygonBlockCount( int count )
+{
+	return ( count + B2_SIMD_WIDTH - 1 ) / B2_SIMD_WIDTH;
+}
+
+// Wide version of shifting polyA to the origin. The edges are built straight from the source polygon
+// rather than from the local copy so the stores of the local copy are not read back as vectors.
+static void b2ShiftPolygonEdgesW( b2PolygonEdgesW* edges, const b2Polygon* polygon, b2Vec2 origin )
+{
+	b2FloatW originX = b2SplatW( origin.x );
+	b2FloatW originY = b2SplatW( origin.y );
+
+	int blockCount = b2GetPolygonBlockCount( polygon->count );
+	for ( int block = 0; block < blockCount; ++block )
+	{
+		b2Vec2W v = b2LoadVec2W( polygon->vertices + block * B2_SIMD_WIDTH );
+		edges->vertices[block] = (b2Vec2W){ b2SubW( v.X, originX ), b2SubW( v.Y, originY ) };
+		edges->normals[block] = b2LoadVec2W( polygon->normals + block * B2_SIMD_WIDTH );
+	}
+}
+
+// Wide version of putting polyB in polyA's frame. Same operations as b2TransformPoint and b2RotateVector.
+static void b2TransformPolygonEdgesW( b2PolygonEdgesW* edges, const b2Polygon* polygon, b2Transform xf )
+{
+	b2RotW q = { b2SplatW( xf.q.c ), b2SplatW( xf.q.s ) };
+	b2FloatW px = b2SplatW( xf.p.x );
+	b2FloatW py = b2SplatW( xf.p.y );
+
+	int blockCount = b2GetPolygonBlockCount( polygon->count );
+	for ( int block = 0; block < blockCount; ++block )
+	{
+		b2Vec2W v = b2RotateVectorW( q, b2LoadVec2W( polygon->vertices + block * B2_SIMD_WIDTH ) );
+		edges->vertices[block] = (b2Vec2W){ b2AddW( v.X, px ), b2AddW( v.Y, py ) };
+		edges->normals[block] = b2RotateVectorW( q, b2LoadVec2W( polygon->normals + block * B2_SIMD_WIDTH ) );
+	}
+}
+
+// Pick the first lane holding the largest value, like the scalar loops do
+static float b2FindMaxLane( int* laneIndex, const b2FloatW* blocks, int count )
+{
+	const float* values = (const float*)blocks;
+	int bestIndex = 0;
+	float maxValue = -FLT_MAX;
+	for ( int i = 0; i < count; ++i )
+	{
+		if ( values[i] > maxValue )
+		{
+			maxValue = values[i];
+			bestIndex = i;
+		}
+	}
+
+	*laneIndex = bestIndex;
+	return maxValue;
+}
+
+// The separation of vertex v2 along the edge normals. Same operations as the scalar b2Dot( n, b2Sub( v2, v1 ) ).
+static inline b2FloatW b2EdgeSeparationW( b2Vec2W normal, b2Vec2W vertex, b2Vec2 v2 )
+{
+	b2FloatW dx = b2SubW( b2SplatW( v2.x ), vertex.X );
+	b2FloatW dy = b2SubW( b2SplatW( v2.y ), vertex.Y );
+	return b2AddW( b2MulW( normal.X, dx ), b2MulW( normal.Y, dy ) );
+}
+
+// Keep the old value on ties to match the scalar comparison
+static inline b2FloatW b2KeepLesserW( b2FloatW current, b2FloatW candidate )
+{
+	return b2BlendW( current, candidate, b2GreaterThanW( current, candidate ) );
+}
+
+// Wide version of b2FindMaxSeparation. Each lane tests one normal of poly1.
+static float b2FindMaxSeparationW( int* edgeIndex, const b2PolygonEdgesW* edges1, int count1, const b2Polygon* poly2 )
+{
+	int count2 = poly2->count;
+	const b2Vec2* v2s = poly2->vertices;
+
+	b2FloatW separations[B2_POLYGON_BLOCK_COUNT];
+	int blockCount = b2GetPolygonBlockCount( count1 );
+	for ( int block = 0; block < blockCount; ++block )
+	{
+		b2Vec2W normal = edges1->normals[block];
+		b2Vec2W vertex = edges1->vertices[block];
+
+		// Vertices are combined in pairs to halve the dependency chain. Pairs are still merged in vertex order,
+		// so ties resolve like the scalar loop.
+		b2FloatW separation = b2SplatW( FLT_MAX );
+		int j = 0;
+		for ( ; j + 1 < count2; j += 2 )
+		{
+			b2FloatW s1 = b2EdgeSeparationW( normal, vertex, v2s[j] );
+			b2FloatW s2 = b2EdgeSeparationW( normal, vertex, v2s[j + 1] );
+			separation = b2KeepLesserW( separation, b2KeepLesserW( s1, s2 ) );
+		}
+
+		if ( j < count2 )
+		{
+			separation = b2KeepLesserW( separation, b2EdgeSeparationW( normal, vertex, v2s[j] ) );
+		}
+
+		separations[block] = separation;
+	}
+
+	return b2FindMaxLane( edgeIndex, separations, count1 );
+}
+
+// Box versus box is the most common polygon pair. Each box fits in a single block, so both directions
+// of the separating axis search run together with the vertex loop unrolled.
+static void b2FindMaxSeparationBoxesW( float* separationA, int* edgeA, float* separationB, int* edgeB,
+									   const b2PolygonEdgesW* edgesA, const b2Polygon* boxA, const b2PolygonEdgesW* edgesB,
+									   const b2Polygon* boxB )
+{
+	_Static_assert( B2_SIMD_WIDTH >= 4, "a box must fit in one block" );
+
+	b2Vec2W normalA = edgesA->normals[0];
+	b2Vec2W vertexA = edgesA->vertices[0];
+	b2Vec2W normalB = edgesB->normals[0];
+	b2Vec2W vertexB = edgesB->vertices[0];
+	const b2Vec2* vas = boxA->vertices;
+	const b2Vec2* vbs = boxB->vertices;
+
+	// Merge the vertices as a tree that keeps the earlier vertex on ties, which matches the scalar loop
+	b2FloatW maxSeparation = b2SplatW( FLT_MAX );
+	b2FloatW sa01 = b2KeepLesserW( b2KeepLesserW( maxSeparation, b2EdgeSeparationW( normalA, vertexA, vbs[0] ) ),
+								   b2EdgeSeparationW( normalA, vertexA, vbs[1] ) );
+	b2FloatW sa23 = b2KeepLesserW( b2EdgeSeparationW( normalA, vertexA, vbs[2] ), b2EdgeSeparationW( normalA, vertexA, vbs[3] ) );
+	b2FloatW sb01 = b2KeepLesserW( b2KeepLesserW( maxSeparation, b2EdgeSeparationW( normalB, vertexB, vas[0] ) ),
+								   b2EdgeSeparationW( normalB, vertexB, vas[1] ) );
+	b2FloatW sb23 = b2KeepLesserW( b2EdgeSeparationW( normalB, vertexB, vas[2] ), b2EdgeSeparationW( normalB, vertexB, vas[3] ) );
+	b2FloatW sa = b2KeepLesserW( sa01, sa23 );
+	b2FloatW sb = b2KeepLesserW( sb01, sb23 );
+
+	*separationA = b2FindMaxLane( edgeA, &sa, 4 );
+	*separationB = b2FindMaxLane( edgeB, &sb, 4 );
+}
+
+// Wide version of b2FindIncidentEdge
+static int b2FindIncidentEdgeW( b2Vec2 searchDirection, const b2PolygonEdgesW* edges, int count )
+{
+	b2FloatW searchX = b2SplatW( searchDirection.x );
+	b2FloatW searchY = b2SplatW( searchDirection.y );
+
+	// Negate the dot products so the first minimum becomes the first maximum
+	b2FloatW negativeDots[B2_POLYGON_BLOCK_COUNT];
+	int blockCount = b2GetPolygonBlockCount( count );
+	for ( int block = 0; block < blockCount; ++block )
+	{
+		b2Vec2W normal = edges->normals[block];
+		b2FloatW dot = b2AddW( b2MulW( searchX, normal.X ), b2MulW( searchY, normal.Y ) );
+		negativeDots[block] = b2SubW( b2ZeroW(), dot );
+	}
+
+	int edge;
+	b2FindMaxLane( &edge, negativeDots, count );
+	return edge;
+}
+
+#endif
+
+// The reference and incident edges passed to the clipper
+typedef struct b2ClipEdges
+{
+	float separationA;
+	float separationB;
+	int edgeA;
+	int edgeB;
+	bool flip;
+} b2ClipEdges;
+
+// Find the reference edge with the separating axis test (SAT) and then the incident edge.
+// Returns false if the polygons are separated by more than maxSeparation.
+static bool b2FindClipEdges( b2ClipEdges* edges, const b2Polygon* localPolyA, const b2Polygon* localPolyB, float maxSeparation )
+{
+	edges->separationA = b2FindMaxSeparation( &edges->edgeA, localPolyA, localPolyB );
+	edges->separationB = b2FindMaxSeparation( &edges->edgeB, localPolyB, localPolyA );
+
+	if ( edges->separationA > maxSeparation || edges->separationB > maxSeparation )
+	{
+		return false;
+	}
+
+	if ( edges->separationA >= edges->separationB )
+	{
+		// Find the incident edge on polyB
+		edges->flip = false;
+		edges->edgeB = b2FindIncidentEdge( localPolyA->normals[edges->edgeA], localPolyB );
+	}
+	else
+	{
+		// Find the incident edge on polyA
+		edges->flip = true;
+		edges->edgeA = b2FindIncidentEdge( localPolyB->normals[edges->edgeB], localPolyA );
+	}
+
+	return true;
+}
+
+#if B2_POLYGON_SIMD
+
+// Wide version of b2FindClipEdges. The edges are built from the source polygons with the same shift and
+// transform used for the local polygons.
+static bool b2FindClipEdgesW( b2ClipEdges* edges, const b2Polygon* polygonA, b2Vec2 origin, const b2Polygon* polygonB,
+							  b2Transform xf, const b2Polygon* localPolyA, const b2Polygon* localPolyB, float maxSeparation )
+{
+	b2PolygonEdgesW edgesA, edgesB;
+	b2ShiftPolygonEdgesW( &edgesA, polygonA, origin );
+	b2TransformPolygonEdgesW( &edgesB, polygonB, xf );
+
+	if ( localPolyA->count == 4 && localPolyB->count == 4 )
+	{
+		b2FindMaxSeparationBoxesW( &edges->separationA, &edges->edgeA, &edges->separationB, &edges->edgeB, &edgesA, localPolyA,
+								   &edgesB, localPolyB );
+	}
+	else
+	{
+		edges->separationA = b2FindMaxSeparationW( &edges->edgeA, &edgesA, localPolyA->count, localPolyB );
+		edges->separationB = b2FindMaxSeparationW( &edges->edgeB, &edgesB, localPolyB->count, localPolyA );
+	}
+
+	if ( edges->separationA > maxSeparation || edges->separationB > maxSeparation )
+	{
+		return false;
+	}
+
+	if ( edges->separationA >= edges->separationB )
+	{
+		edges->flip = false;
+		edges->edgeB = b2FindIncidentEdgeW( localPolyA->normals[edges->edgeA], &edgesB, localPolyB->count );
+	}
+	else
+	{
+		edges->flip = true;
+		edges->edgeA = b2FindIncidentEdgeW( localPolyB->normals[edges->edgeB], &edgesA, localPolyA->count );
+	}
+
+	return true;
+}
+
+#endif
+
 // Due to speculation, every polygon is rounded
 // Algorithm:
 //
@@ -733,7 +1017,8 @@ static float b2FindMaxSeparation( int* edgeIndex, const b2Polygon* poly1, const
 //   clip edges
 // end
 
-b2Manifold b2CollidePolygons( const b2Polygon* polygonA, b2Transform xfA, const b2Polygon* polygonB, b2Transform xfB )
+static b2Manifold b2CollidePolygonsImpl( const b2Polygon* polygonA, b2Transform xfA, const b2Polygon* polygonB, b2Transform xfB,
+										 bool useSIMD )
 {
 	b2Vec2 origin = polygonA->vertices[0];
 	float linearSlop = B2_LINEAR_SLOP;
@@ -767,63 +1052,27 @@ b2Manifold b2CollidePolygons( const b2Polygon* polygonA, b2Transform xfA, const
 		localPolyB.normals[i] = b2RotateVector( xf.q, polygonB->normals[i] );
 	}
 
-	int edgeA = 0;
-	float separationA = b2FindMaxSeparation( &edgeA, &localPolyA, &localPolyB );
-
-	int edgeB = 0;
-	float separationB = b2FindMaxSeparation( &edgeB, &localPolyB, &localPolyA );
-
 	float radius = localPolyA.radius + localPolyB.radius;
 
-	if ( separationA > speculativeDistance + radius || separationB > speculativeDistance + radius )
+	b2ClipEdges clipEdges;
+#if B2_POLYGON_SIMD
+	bool touching = useSIMD ? b2FindClipEdgesW( &clipEdges, polygonA, origin, polygonB, xf, &localPolyA, &localPolyB,
+												speculativeDistance + radius )
+							: b2FindClipEdges( &clipEdges, &localPolyA, &localPolyB, speculativeDistance + radius );
+#else
+	B2_UNUSED( useSIMD );
+	bool touching = b2FindClipEdges( &clipEdges, &localPolyA, &localPolyB, speculativeDistance + radius );
+#endif
+	if ( touching == false )
 	{
 		return (b2Manifold){ 0 };
 	}
 
-	// Find incident edge
-	bool flip;
-	if ( separationA >= separationB )
-	{
-		flip = false;
-
-		b2Vec2 searchDirection = localPolyA.normals[edgeA];
-
-		// Find the incident edge on polyB
-		int count = localPolyB.count;
-		const b2Vec2* normals = localPolyB.normals;
-		edgeB = 0;
-		float minDot = FLT_MAX;
-		for ( int i = 0; i < count; ++i )
-		{
-			float dot = b2Dot( searchDirection, normals[i] );
-			if ( dot < minDot )
-			{
-				minDot = dot;
-				edgeB = i;
-			}
-		}
-	}
-	else
-	{
-		flip = true;
-
-		b2Vec2 searchDirection = localPolyB.normals[edgeB];
-
-		// Find the incident edge on polyA
-		int count = localPolyA.count;
-		const b2Vec2* normals = localPolyA.normals;
-		edgeA = 0;
-		float minDot = FLT_MAX;
-		for ( int i = 0; i < count; ++i )
-		{
-			float dot = b2Dot( searchDirection, normals[i] );
-			if ( dot < minDot )
-			{
-				minDot = dot;
-				edgeA = i;
-			}
-		}
-	}
+	int edgeA = clipEdges.edgeA;
+	int edgeB = clipEdges.edgeB;
+	float separationA = clipEdges.separationA;
+	float separationB = clipEdges.separationB;
+	bool flip = clipEdges.flip;
 
 	b2Manifold manifold = { 0 };
 
@@ -1074,6 +1323,21 @@ b2Manifold b2CollidePolygons( const b2Polygon* polygonA, b2Transform xfA, const
 	return manifold;
 }
 
+b2Manifold b2CollidePolygons( const b2Polygon* polygonA, b2Transform xfA, const b2Polygon* polygonB, b2Transform xfB )
+{
+#if defined( B2_SIMD_NONE ) || B2_POLYGON_SIMD == 0
+	// The emulated wide math is slower than the scalar search
+	return b2CollidePolygonsImpl( polygonA, xfA, polygonB, xfB, false );
+#else
+	return b2CollidePolygonsImpl( polygonA, xfA, polygonB, xfB, true );
+#endif
+}
+
+b2Manifold b2CollidePolygonsScalar( const b2Polygon* polygonA, b2Transform xfA, const b2Polygon* polygonB, b2Transform xfB )
+{
+	return b2CollidePolygonsImpl( polygonA, xfA, polygonB, xfB, false );
+}
+
 b2Manifold b2CollideSegmentAndCircle( const b2Segment* segmentA, b2Transform xfA, const b2Circle* circleB, b2Transform xfB )
 {
 	b2Capsule capsuleA = { segmentA->point1, segmentA->point2, 0.0f };
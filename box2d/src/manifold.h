@@ -0,0 +1,10 @@
+// SPDX-FileCopyrightText: 2023 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "box2d/collision.h"
+
+// b2CollidePolygons with the scalar separating axis search. The SIMD search used by b2CollidePolygons
+// must produce bit-identical manifolds, and this is the reference it is tested against.
+b2Manifold b2CollidePolygonsScalar( const b2Polygon* polygonA, b2Transform xfA, const b2Polygon* polygonB, b2Transform xfB );
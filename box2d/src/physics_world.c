@@ -9,6 +9,7 @@
 
 #include "arena_allocator.h"
 #include "array.h"
+#include "atomic.h"
 #include "bitset.h"
 #include "body.h"
 #include "broad_phase.h"
@@ -21,6 +22,7 @@
 #include "joint.h"
 #include "sensor.h"
 #include "shape.h"
+#include "simd_kernels.h"
 #include "solver.h"
 #include "solver_set.h"
 
@@ -129,7 +131,7 @@ b2WorldId b2CreateWorld( const b2WorldDef* def )
 	world->inUse = true;
 
 	world->arena = b2CreateArenaAllocator( 2048 );
-	b2CreateBroadPhase( &world->broadPhase );
+	b2CreateBroadPhase( &world->broadPhase, def->broadPhaseType, def->treeRefitRatio );
 	b2CreateGraph( &world->constraintGraph, 16 );
 
 	// pools
@@ -195,6 +197,7 @@ b2WorldId b2CreateWorld( const b2WorldDef* def )
 	world->contactSpeed = def->contactSpeed;
 	world->contactHertz = def->contactHertz;
 	world->contactDampingRatio = def->contactDampingRatio;
+	world->manifoldReuseTolerance = b2MaxFloat( def->manifoldReuseTolerance, 0.0f );
 
 	if ( def->frictionCallback == NULL )
 	{
@@ -219,8 +222,9 @@ b2WorldId b2CreateWorld( const b2WorldDef* def )
 	world->enableWarmStarting = true;
 	world->enableContinuous = def->enableContinuous;
 	world->enableSpeculative = true;
-	world->userTreeTask = NULL;
 	world->userData = def->userData;
+	world->simdKernels = b2GetDefaultSIMDKernels();
+	world->solverWaitType = def->solverWaitType == b2_hybridSolverWait ? b2_hybridSolverWait : b2_spinSolverWait;
 
 	if ( def->workerCount > 0 && def->enqueueTask != NULL && def->finishTask != NULL )
 	{
@@ -361,106 +365,204 @@ void b2DestroyWorld( b2WorldId worldId )
 	world->generation = generation + 1;
 }
 
-static void b2CollideTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+// Contacts are collided in blocks so the body data of a block can be gathered up front
+#define B2_COLLIDE_BLOCK_SIZE 64
+
+// The body data a contact needs, gathered for a block of contacts before any of them is collided.
+// Reaching the body sim of a shape takes three dependent loads: shape, body, then body sim. The gather
+// takes one step for the whole block while prefetching the next, so the cache misses of a block overlap
+// instead of stalling each contact three times.
+typedef struct b2CollideInput
 {
-	b2TracyCZoneNC( collide_task, "Collide", b2_colorDodgerBlue, true );
+	b2Transform transformA;
+	b2Transform transformB;
+	b2Vec2 localCenterA;
+	b2Vec2 localCenterB;
+	float invMassA, invIA;
+	float invMassB, invIB;
+	int bodySimIndexA;
+	int bodySimIndexB;
+	b2Shape* shapeA;
+	b2Shape* shapeB;
+	b2ContactSim* contactSim;
+} b2CollideInput;
 
-	b2StepContext* stepContext = context;
-	b2World* world = stepContext->world;
-	B2_ASSERT( (int)threadIndex < world->workerCount );
-	b2TaskContext* taskContext = world->taskContexts.data + threadIndex;
-	b2ContactSim** contactSims = stepContext->contacts;
+static void b2GatherCollideInputs( b2World* world, b2ContactSim** contactSims, b2CollideInput* inputs, int count )
+{
 	b2Shape* shapes = world->shapes.data;
 	b2Body* bodies = world->bodies.data;
+	b2SolverSet* sets = world->solverSets.data;
+	const b2BodySim* bodySimsA[B2_COLLIDE_BLOCK_SIZE];
+	const b2BodySim* bodySimsB[B2_COLLIDE_BLOCK_SIZE];
 
-	B2_ASSERT( startIndex < endIndex );
+	B2_ASSERT( count <= B2_COLLIDE_BLOCK_SIZE );
 
-	for ( int contactIndex = startIndex; contactIndex < endIndex; ++contactIndex )
+	// The shapes were prefetched by b2CollideTask
+	for ( int i = 0; i < count; ++i )
 	{
-		b2ContactSim* contactSim = contactSims[contactIndex];
-
-		int contactId = contactSim->contactId;
-
+		b2ContactSim* contactSim = contactSims[i];
 		b2Shape* shapeA = shapes + contactSim->shapeIdA;
 		b2Shape* shapeB = shapes + contactSim->shapeIdB;
 
-		// Do proxies still overlap?
-		bool overlap = b2AABB_Overlaps( shapeA->fatAABB, shapeB->fatAABB );
-		if ( overlap == false )
+		inputs[i].contactSim = contactSim;
+		inputs[i].shapeA = shapeA;
+		inputs[i].shapeB = shapeB;
+
+		B2_PREFETCH( bodies + shapeA->bodyId );
+		B2_PREFETCH( bodies + shapeB->bodyId );
+	}
+
+	for ( int i = 0; i < count; ++i )
+	{
+		b2CollideInput* input = inputs + i;
+		const b2Body* bodyA = bodies + input->shapeA->bodyId;
+		const b2Body* bodyB = bodies + input->shapeB->bodyId;
+
+		input->bodySimIndexA = bodyA->setIndex == b2_awakeSet ? bodyA->localIndex : B2_NULL_INDEX;
+		input->bodySimIndexB = bodyB->setIndex == b2_awakeSet ? bodyB->localIndex : B2_NULL_INDEX;
+
+		bodySimsA[i] = sets[bodyA->setIndex].bodySims.data + bodyA->localIndex;
+		bodySimsB[i] = sets[bodyB->setIndex].bodySims.data + bodyB->localIndex;
+
+		B2_PREFETCH( bodySimsA[i] );
+		B2_PREFETCH( bodySimsB[i] );
+	}
+
+	for ( int i = 0; i < count; ++i )
+	{
+		b2CollideInput* input = inputs + i;
+		const b2BodySim* bodySimA = bodySimsA[i];
+		const b2BodySim* bodySimB = bodySimsB[i];
+
+		input->transformA = bodySimA->transform;
+		input->localCenterA = bodySimA->localCenter;
+		input->invMassA = bodySimA->invMass;
+		input->invIA = bodySimA->invInertia;
+
+		input->transformB = bodySimB->transform;
+		input->localCenterB = bodySimB->localCenter;
+		input->invMassB = bodySimB->invMass;
+		input->invIB = bodySimB->invInertia;
+	}
+}
+
+static void b2CollideContact( b2World* world, b2TaskContext* taskContext, const b2CollideInput* input )
+{
+	b2ContactSim* contactSim = input->contactSim;
+	int contactId = contactSim->contactId;
+
+	b2Shape* shapeA = input->shapeA;
+	b2Shape* shapeB = input->shapeB;
+
+	// Do proxies still overlap?
+	bool overlap = b2AABB_Overlaps( shapeA->fatAABB, shapeB->fatAABB );
+	if ( overlap == false )
+	{
+		contactSim->simFlags |= b2_simDisjoint;
+		contactSim->simFlags &= ~b2_simTouchingFlag;
+		b2SetBit( &taskContext->contactStateBitSet, contactId );
+	}
+	else
+	{
+		bool wasTouching = ( contactSim->simFlags & b2_simTouchingFlag );
+
+		// avoid cache misses in b2PrepareContactsTask
+		contactSim->bodySimIndexA = input->bodySimIndexA;
+		contactSim->invMassA = input->invMassA;
+		contactSim->invIA = input->invIA;
+
+		contactSim->bodySimIndexB = input->bodySimIndexB;
+		contactSim->invMassB = input->invMassB;
+		contactSim->invIB = input->invIB;
+
+		// Update contact respecting shape/body order (A,B)
+		b2Transform transformA = input->transformA;
+		b2Transform transformB = input->transformB;
+
+		b2Vec2 centerOffsetA = b2RotateVector( transformA.q, input->localCenterA );
+		b2Vec2 centerOffsetB = b2RotateVector( transformB.q, input->localCenterB );
+
+		// This updates solid contacts
+		bool touching =
+			b2UpdateContact( world, contactSim, shapeA, transformA, centerOffsetA, shapeB, transformB, centerOffsetB );
+
+		if ( contactSim->simFlags & b2_simReusedManifold )
 		{
-			contactSim->simFlags |= b2_simDisjoint;
-			contactSim->simFlags &= ~b2_simTouchingFlag;
+			taskContext->manifoldReuseCount += 1;
+		}
+
+		// State changes that affect island connectivity. Also affects contact events.
+		if ( touching == true && wasTouching == false )
+		{
+			contactSim->simFlags |= b2_simStartedTouching;
 			b2SetBit( &taskContext->contactStateBitSet, contactId );
 		}
-		else
+		else if ( touching == false && wasTouching == true )
 		{
-			bool wasTouching = ( contactSim->simFlags & b2_simTouchingFlag );
+			contactSim->simFlags |= b2_simStoppedTouching;
+			b2SetBit( &taskContext->contactStateBitSet, contactId );
+		}
+
+		// To make this work, the time of impact code needs to adjust the target
+		// distance based on the number of TOI events for a body.
+		// if (touching && bodySimB->isFast)
+		//{
+		//	b2Manifold* manifold = &contactSim->manifold;
+		//	int pointCount = manifold->pointCount;
+		//	for (int i = 0; i < pointCount; ++i)
+		//	{
+		//		// trick the solver into pushing the fast shapes apart
+		//		manifold->points[i].separation -= 0.25f * B2_SPECULATIVE_DISTANCE;
+		//	}
+		//}
+	}
+}
 
-			// Update contact respecting shape/body order (A,B)
-			b2Body* bodyA = bodies + shapeA->bodyId;
-			b2Body* bodyB = bodies + shapeB->bodyId;
-			b2BodySim* bodySimA = b2GetBodySim( world, bodyA );
-			b2BodySim* bodySimB = b2GetBodySim( world, bodyB );
+static void b2CollideTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	b2TracyCZoneNC( collide_task, "Collide", b2_colorDodgerBlue, true );
 
-			// avoid cache misses in b2PrepareContactsTask
-			contactSim->bodySimIndexA = bodyA->setIndex == b2_awakeSet ? bodyA->localIndex : B2_NULL_INDEX;
-			contactSim->invMassA = bodySimA->invMass;
-			contactSim->invIA = bodySimA->invInertia;
+	b2StepContext* stepContext = context;
+	b2World* world = stepContext->world;
+	B2_ASSERT( (int)threadIndex < world->workerCount );
+	b2TaskContext* taskContext = world->taskContexts.data + threadIndex;
+	b2ContactSim** contactSims = stepContext->contacts;
+	const b2Shape* shapes = world->shapes.data;
 
-			contactSim->bodySimIndexB = bodyB->setIndex == b2_awakeSet ? bodyB->localIndex : B2_NULL_INDEX;
-			contactSim->invMassB = bodySimB->invMass;
-			contactSim->invIB = bodySimB->invInertia;
+	B2_ASSERT( startIndex < endIndex );
 
-			b2Transform transformA = bodySimA->transform;
-			b2Transform transformB = bodySimB->transform;
+	b2CollideInput inputs[B2_COLLIDE_BLOCK_SIZE];
 
-			b2Vec2 centerOffsetA = b2RotateVector( transformA.q, bodySimA->localCenter );
-			b2Vec2 centerOffsetB = b2RotateVector( transformB.q, bodySimB->localCenter );
+	for ( int blockStart = startIndex; blockStart < endIndex; blockStart += B2_COLLIDE_BLOCK_SIZE )
+	{
+		int blockCount = b2MinInt( B2_COLLIDE_BLOCK_SIZE, endIndex - blockStart );
+		b2ContactSim** blockSims = contactSims + blockStart;
 
-			// This updates solid contacts
-			bool touching =
-				b2UpdateContact( world, contactSim, shapeA, transformA, centerOffsetA, shapeB, transformB, centerOffsetB );
+		for ( int i = 0; i < blockCount; ++i )
+		{
+			const b2ContactSim* contactSim = blockSims[i];
+			B2_PREFETCH( shapes + contactSim->shapeIdA );
+			B2_PREFETCH( shapes + contactSim->shapeIdB );
+		}
 
-			// State changes that affect island connectivity. Also affects contact events.
-			if ( touching == true && wasTouching == false )
-			{
-				contactSim->simFlags |= b2_simStartedTouching;
-				b2SetBit( &taskContext->contactStateBitSet, contactId );
-			}
-			else if ( touching == false && wasTouching == true )
-			{
-				contactSim->simFlags |= b2_simStoppedTouching;
-				b2SetBit( &taskContext->contactStateBitSet, contactId );
-			}
+		b2GatherCollideInputs( world, blockSims, inputs, blockCount );
 
-			// To make this work, the time of impact code needs to adjust the target
-			// distance based on the number of TOI events for a body.
-			// if (touching && bodySimB->isFast)
-			//{
-			//	b2Manifold* manifold = &contactSim->manifold;
-			//	int pointCount = manifold->pointCount;
-			//	for (int i = 0; i < pointCount; ++i)
-			//	{
-			//		// trick the solver into pushing the fast shapes apart
-			//		manifold->points[i].separation -= 0.25f * B2_SPECULATIVE_DISTANCE;
-			//	}
-			//}
+		for ( int i = 0; i < blockCount; ++i )
+		{
+			b2CollideContact( world, taskContext, inputs + i );
 		}
 	}
 
 	b2TracyCZoneEnd( collide_task );
 }
 
-static void b2UpdateTreesTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+// Rebuild the collision tree for dynamic and kinematic bodies to keep their query performance good.
+// The subtrees are built using the task system, so this overlaps with any narrow phase task still running.
+static void b2UpdateTrees( b2World* world )
 {
-	B2_UNUSED( startIndex );
-	B2_UNUSED( endIndex );
-	B2_UNUSED( threadIndex );
-
 	b2TracyCZoneNC( tree_task, "Rebuild BVH", b2_colorFireBrick, true );
 
-	b2World* world = context;
-	b2BroadPhase_RebuildTrees( &world->broadPhase );
+	b2BroadPhase_RebuildTrees( &world->broadPhase, world->enqueueTaskFcn, world->finishTaskFcn, world->userTaskContext );
 
 	b2TracyCZoneEnd( tree_task );
 }
@@ -500,13 +602,6 @@ static void b2Collide( b2StepContext* context )
 
 	b2TracyCZoneNC( collide, "Narrow Phase", b2_colorDodgerBlue, true );
 
-	// Task that can be done in parallel with the narrow-phase
-	// - rebuild the collision tree for dynamic and kinematic bodies to keep their query performance good
-	// todo_erin move this to start when contacts are being created
-	world->userTreeTask = world->enqueueTaskFcn( &b2UpdateTreesTask, 1, 1, world, world->userTaskContext );
-	world->taskCount += 1;
-	world->activeTaskCount += world->userTreeTask == NULL ? 0 : 1;
-
 	// gather contacts into a single array for easier parallel-for
 	int contactCount = 0;
 	b2GraphColor* graphColors = world->constraintGraph.colors;
@@ -518,8 +613,12 @@ static void b2Collide( b2StepContext* context )
 	int nonTouchingCount = world->solverSets.data[b2_awakeSet].contactSims.count;
 	contactCount += nonTouchingCount;
 
+	world->manifoldReuseCount = 0;
+	world->recolorCount = 0;
+
 	if ( contactCount == 0 )
 	{
+		b2UpdateTrees( world );
 		b2TracyCZoneEnd( collide );
 		return;
 	}
@@ -557,12 +656,18 @@ static void b2Collide( b2StepContext* context )
 	for ( int i = 0; i < world->workerCount; ++i )
 	{
 		b2SetBitCountAndClear( &world->taskContexts.data[i].contactStateBitSet, contactIdCapacity );
+		world->taskContexts.data[i].manifoldReuseCount = 0;
 	}
 
 	// Task should take at least 40us on a 4GHz CPU (10K cycles)
 	int minRange = 64;
 	void* userCollideTask = world->enqueueTaskFcn( &b2CollideTask, contactCount, minRange, context, world->userTaskContext );
 	world->taskCount += 1;
+
+	// The narrow phase does not touch the trees
+	// todo_erin move this to start when contacts are being created
+	b2UpdateTrees( world );
+
 	if ( userCollideTask != NULL )
 	{
 		world->finishTaskFcn( userCollideTask, world->userTaskContext );
@@ -572,6 +677,11 @@ static void b2Collide( b2StepContext* context )
 	context->contacts = NULL;
 	contactSims = NULL;
 
+	for ( int i = 0; i < world->workerCount; ++i )
+	{
+		world->manifoldReuseCount += world->taskContexts.data[i].manifoldReuseCount;
+	}
+
 	// Serially update contact state
 	// todo_erin bring this zone together with island merge
 	b2TracyCZoneNC( contact_state, "Contact State", b2_colorLightSlateGray, true );
@@ -698,6 +808,9 @@ static void b2Collide( b2StepContext* context )
 		}
 	}
 
+	// Give overflow contacts another chance at a color now that contacts have been removed
+	world->recolorCount = b2RecolorOverflowContacts( world );
+
 	b2ValidateSolverSets( world );
 	b2ValidateContacts( world );
 
@@ -780,7 +893,9 @@ void b2World_Step( b2WorldId worldId, float timeStep, int subStepCount )
 
 	context.restitutionThreshold = world->restitutionThreshold;
 	context.maxLinearVelocity = world->maxLinearSpeed;
+	context.simd = world->simdKernels;
 	context.enableWarmStarting = world->enableWarmStarting;
+	context.waitType = world->solverWaitType;
 
 	// Update contacts
 	{
@@ -983,9 +1098,12 @@ static void b2DrawWithBounds( b2World* world, b2DebugDraw* draw )
 	b2HexColor impulseColor = b2_colorMagenta;
 	b2HexColor frictionColor = b2_colorYellow;
 
-	b2HexColor graphColors[B2_GRAPH_COLOR_COUNT] = { b2_colorRed,		b2_colorOrange,	   b2_colorYellow, b2_colorGreen,
-													 b2_colorCyan,		b2_colorBlue,	   b2_colorViolet, b2_colorPink,
-													 b2_colorChocolate, b2_colorGoldenRod, b2_colorCoral,  b2_colorBlack };
+	b2HexColor graphColors[B2_GRAPH_COLOR_COUNT] = { b2_colorRed, b2_colorOrange, b2_colorYellow, b2_colorGreen,
+													 b2_colorCyan, b2_colorBlue, b2_colorViolet, b2_colorPink,
+													 b2_colorChocolate, b2_colorGoldenRod, b2_colorCoral, b2_colorRosyBrown,
+													 b2_colorAqua, b2_colorPeru, b2_colorLime, b2_colorGold,
+													 b2_colorPlum, b2_colorSnow, b2_colorTeal, b2_colorKhaki,
+													 b2_colorSalmon, b2_colorPeachPuff, b2_colorHoneyDew, b2_colorBlack };
 
 	int bodyCapacity = b2GetIdCapacity( &world->bodyIdPool );
 	b2SetBitCountAndClear( &world->debugBodySet, bodyCapacity );
@@ -1376,9 +1494,12 @@ void b2World_Draw( b2WorldId worldId, b2DebugDraw* draw )
 		b2HexColor impulseColor = b2_colorMagenta;
 		b2HexColor frictionColor = b2_colorYellow;
 
-		b2HexColor colors[B2_GRAPH_COLOR_COUNT] = { b2_colorRed,	   b2_colorOrange,	  b2_colorYellow, b2_colorGreen,
-													b2_colorCyan,	   b2_colorBlue,	  b2_colorViolet, b2_colorPink,
-													b2_colorChocolate, b2_colorGoldenRod, b2_colorCoral,  b2_colorBlack };
+		b2HexColor colors[B2_GRAPH_COLOR_COUNT] = { b2_colorRed, b2_colorOrange, b2_colorYellow, b2_colorGreen,
+													b2_colorCyan, b2_colorBlue, b2_colorViolet, b2_colorPink,
+													b2_colorChocolate, b2_colorGoldenRod, b2_colorCoral, b2_colorRosyBrown,
+													b2_colorAqua, b2_colorPeru, b2_colorLime, b2_colorGold,
+													b2_colorPlum, b2_colorSnow, b2_colorTeal, b2_colorKhaki,
+													b2_colorSalmon, b2_colorPeachPuff, b2_colorHoneyDew, b2_colorBlack };
 
 		for ( int colorIndex = 0; colorIndex < B2_GRAPH_COLOR_COUNT; ++colorIndex )
 		{
@@ -1914,6 +2035,51 @@ float b2World_GetMaximumLinearSpeed( b2WorldId worldId )
 	return world->maxLinearSpeed;
 }
 
+b2SIMDBackend b2World_GetSIMDBackend( b2WorldId worldId )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	return world->simdKernels->backend;
+}
+
+bool b2World_SetSIMDBackend( b2WorldId worldId, b2SIMDBackend backend )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	B2_ASSERT( world->locked == false );
+	if ( world->locked )
+	{
+		return false;
+	}
+
+	const b2SIMDKernels* kernels = b2GetSIMDKernels( backend );
+	if ( kernels == NULL )
+	{
+		return false;
+	}
+
+	// All backends give identical results and the wide constraints only live for one step
+	world->simdKernels = kernels;
+	return true;
+}
+
+void b2World_SetSolverWaitType( b2WorldId worldId, b2SolverWaitType type )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	B2_ASSERT( world->locked == false );
+	B2_ASSERT( type == b2_spinSolverWait || type == b2_hybridSolverWait );
+	if ( world->locked )
+	{
+		return;
+	}
+
+	world->solverWaitType = type;
+}
+
+b2SolverWaitType b2World_GetSolverWaitType( b2WorldId worldId )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	return world->solverWaitType;
+}
+
 b2Profile b2World_GetProfile( b2WorldId worldId )
 {
 	b2World* world = b2GetWorldFromId( worldId );
@@ -1940,6 +2106,10 @@ b2Counters b2World_GetCounters( b2WorldId worldId )
 	s.stackUsed = b2GetMaxArenaAllocation( &world->arena );
 	s.byteCount = b2GetByteCount();
 	s.taskCount = world->taskCount;
+	s.manifoldReuseCount = world->manifoldReuseCount;
+	s.overflowContactCount = world->constraintGraph.colors[B2_OVERFLOW_INDEX].contactSims.count;
+	s.overflowJointCount = world->constraintGraph.colors[B2_OVERFLOW_INDEX].jointSims.count;
+	s.recolorCount = world->recolorCount;
 
 	for ( int i = 0; i < B2_GRAPH_COLOR_COUNT; ++i )
 	{
@@ -2033,8 +2203,8 @@ void b2World_DumpMemoryStats( b2WorldId worldId )
 	fprintf( file, "static tree: %d\n", b2DynamicTree_GetByteCount( world->broadPhase.trees + b2_staticBody ) );
 	fprintf( file, "kinematic tree: %d\n", b2DynamicTree_GetByteCount( world->broadPhase.trees + b2_kinematicBody ) );
 	fprintf( file, "dynamic tree: %d\n", b2DynamicTree_GetByteCount( world->broadPhase.trees + b2_dynamicBody ) );
-	b2HashSet* moveSet = &world->broadPhase.moveSet;
-	fprintf( file, "moveSet: %d (%d, %d)\n", b2GetHashSetBytes( moveSet ), moveSet->count, moveSet->capacity );
+	b2HashSet32* moveSet = &world->broadPhase.moveSet;
+	fprintf( file, "moveSet: %d (%d, %d)\n", b2GetHashSet32Bytes( moveSet ), moveSet->count, moveSet->capacity );
 	fprintf( file, "moveArray: %d\n", b2IntArray_ByteCount( &world->broadPhase.moveArray ) );
 	b2HashSet* pairSet = &world->broadPhase.pairSet;
 	fprintf( file, "pairSet: %d (%d, %d)\n", b2GetHashSetBytes( pairSet ), pairSet->count, pairSet->capacity );
@@ -2367,6 +2537,319 @@ b2RayResult b2World_CastRayClosest( b2WorldId worldId, b2Vec2 origin, b2Vec2 tra
 	return result;
 }
 
+typedef struct WorldRayBatchContext
+{
+	b2World* world;
+	b2QueryFilter filter;
+	const b2Vec2* origins;
+	const b2Vec2* translations;
+	int rayCount;
+	b2RayResult* results;
+	b2AtomicInt nodeVisits;
+	b2AtomicInt leafVisits;
+} WorldRayBatchContext;
+
+typedef struct WorldRayGroupContext
+{
+	WorldRayBatchContext* batch;
+	b2RayResult* results;
+} WorldRayGroupContext;
+
+// Keeps the closest hit of each ray, like b2RayCastClosestFcn
+static float RayCastBatchCallback( const b2RayCastInput* input, int rayIndex, int proxyId, uint64_t userData, void* context )
+{
+	B2_UNUSED( proxyId );
+
+	int shapeId = (int)userData;
+
+	WorldRayGroupContext* groupContext = context;
+	b2World* world = groupContext->batch->world;
+
+	b2Shape* shape = b2ShapeArray_Get( &world->shapes, shapeId );
+
+	if ( b2ShouldQueryCollide( shape->filter, groupContext->batch->filter ) == false )
+	{
+		return input->maxFraction;
+	}
+
+	b2Body* body = b2BodyArray_Get( &world->bodies, shape->bodyId );
+	b2Transform transform = b2GetBodyTransformQuick( world, body );
+	b2CastOutput output = b2RayCastShape( input, shape, transform );
+
+	// Ignore initial overlap
+	if ( output.hit == false || output.fraction == 0.0f )
+	{
+		return input->maxFraction;
+	}
+
+	b2RayResult* result = groupContext->results + rayIndex;
+	result->shapeId = ( b2ShapeId ){ shapeId + 1, world->worldId, shape->generation };
+	result->point = output.point;
+	result->normal = output.normal;
+	result->fraction = output.fraction;
+	result->hit = true;
+	return output.fraction;
+}
+
+typedef struct WorldRaySingleContext
+{
+	WorldRayGroupContext* groupContext;
+	int rayIndex;
+} WorldRaySingleContext;
+
+static float RayCastSingleCallback( const b2RayCastInput* input, int proxyId, uint64_t userData, void* context )
+{
+	WorldRaySingleContext* singleContext = context;
+	return RayCastBatchCallback( input, singleContext->rayIndex, proxyId, userData, singleContext->groupContext );
+}
+
+static void b2CastRayBatchTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	B2_UNUSED( threadIndex );
+
+	WorldRayBatchContext* batch = context;
+	b2BroadPhase* broadPhase = &batch->world->broadPhase;
+	b2TreeStats stats = { 0 };
+
+	b2RayCastInput inputs[B2_TREE_BATCH_SIZE];
+
+	for ( int groupIndex = startIndex; groupIndex < endIndex; ++groupIndex )
+	{
+		int baseIndex = groupIndex * B2_TREE_BATCH_SIZE;
+		int count = b2MinInt( B2_TREE_BATCH_SIZE, batch->rayCount - baseIndex );
+
+		WorldRayGroupContext groupContext = { batch, batch->results + baseIndex };
+
+		for ( int i = 0; i < count; ++i )
+		{
+			inputs[i] = ( b2RayCastInput ){ batch->origins[baseIndex + i], batch->translations[baseIndex + i], 1.0f };
+			groupContext.results[i] = ( b2RayResult ){ 0 };
+		}
+
+		for ( int i = 0; i < b2_bodyTypeCount; ++i )
+		{
+			b2DynamicTree* tree = broadPhase->trees + i;
+
+			// The static tree is large and has wide nodes. A single ray walk of the wide nodes beats the
+			// batch walk there, so the batch is only used for the smaller trees.
+			if ( i == b2_staticBody )
+			{
+				for ( int j = 0; j < count; ++j )
+				{
+					WorldRaySingleContext singleContext = { &groupContext, j };
+					b2TreeStats treeResult = b2DynamicTree_RayCast( tree, inputs + j, batch->filter.maskBits,
+																	RayCastSingleCallback, &singleContext );
+					stats.nodeVisits += treeResult.nodeVisits;
+					stats.leafVisits += treeResult.leafVisits;
+				}
+			}
+			else
+			{
+				b2TreeStats treeResult = b2DynamicTree_RayCastBatch( tree, inputs, count, batch->filter.maskBits,
+																	 RayCastBatchCallback, &groupContext );
+				stats.nodeVisits += treeResult.nodeVisits;
+				stats.leafVisits += treeResult.leafVisits;
+			}
+
+			// The next tree only needs to beat the closest hit so far
+			for ( int j = 0; j < count; ++j )
+			{
+				if ( groupContext.results[j].hit )
+				{
+					inputs[j].maxFraction = groupContext.results[j].fraction;
+				}
+			}
+		}
+	}
+
+	b2AtomicFetchAddInt( &batch->nodeVisits, stats.nodeVisits );
+	b2AtomicFetchAddInt( &batch->leafVisits, stats.leafVisits );
+}
+
+b2TreeStats b2World_CastRayBatch( b2WorldId worldId, const b2Vec2* origins, const b2Vec2* translations, int rayCount,
+								  b2QueryFilter filter, b2RayResult* results, bool useTasks )
+{
+	b2TreeStats treeStats = { 0 };
+
+	b2World* world = b2GetWorldFromId( worldId );
+	B2_ASSERT( world->locked == false );
+	if ( world->locked || rayCount <= 0 )
+	{
+		return treeStats;
+	}
+
+	WorldRayBatchContext batch;
+	batch.world = world;
+	batch.filter = filter;
+	batch.origins = origins;
+	batch.translations = translations;
+	batch.rayCount = rayCount;
+	batch.results = results;
+	b2AtomicStoreInt( &batch.nodeVisits, 0 );
+	b2AtomicStoreInt( &batch.leafVisits, 0 );
+
+	int groupCount = ( rayCount + B2_TREE_BATCH_SIZE - 1 ) / B2_TREE_BATCH_SIZE;
+	void* userTask = NULL;
+	if ( useTasks )
+	{
+		userTask = world->enqueueTaskFcn( b2CastRayBatchTask, groupCount, 1, &batch, world->userTaskContext );
+	}
+	else
+	{
+		b2CastRayBatchTask( 0, groupCount, 0, &batch );
+	}
+
+	if ( userTask != NULL )
+	{
+		world->finishTaskFcn( userTask, world->userTaskContext );
+	}
+
+	treeStats.nodeVisits = b2AtomicLoadInt( &batch.nodeVisits );
+	treeStats.leafVisits = b2AtomicLoadInt( &batch.leafVisits );
+	return treeStats;
+}
+
+typedef struct WorldOverlapBatchContext
+{
+	b2World* world;
+	b2QueryFilter filter;
+	const b2AABB* boxes;
+	int boxCount;
+	b2OverlapBatchResult* results;
+	int resultCapacity;
+	b2AtomicInt resultCount;
+} WorldOverlapBatchContext;
+
+typedef struct WorldOverlapGroupContext
+{
+	WorldOverlapBatchContext* batch;
+	int baseIndex;
+} WorldOverlapGroupContext;
+
+static bool TreeQueryBatchCallback( int proxyId, uint64_t userData, int baseIndex, uint64_t queryMask, void* context )
+{
+	B2_UNUSED( proxyId );
+
+	int shapeId = (int)userData;
+
+	WorldOverlapGroupContext* groupContext = context;
+	WorldOverlapBatchContext* batch = groupContext->batch;
+	b2World* world = batch->world;
+
+	b2Shape* shape = b2ShapeArray_Get( &world->shapes, shapeId );
+
+	if ( b2ShouldQueryCollide( shape->filter, batch->filter ) == false )
+	{
+		return true;
+	}
+
+	int count = 0;
+	for ( uint64_t bits = queryMask; bits != 0; bits &= bits - 1 )
+	{
+		count += 1;
+	}
+
+	// Reserve all the results of this shape at once
+	int resultIndex = b2AtomicFetchAddInt( &batch->resultCount, count );
+
+	b2ShapeId id = { shapeId + 1, world->worldId, shape->generation };
+	int queryBase = groupContext->baseIndex + baseIndex;
+	for ( uint64_t bits = queryMask; bits != 0 && resultIndex < batch->resultCapacity; bits &= bits - 1 )
+	{
+		batch->results[resultIndex] = ( b2OverlapBatchResult ){ id, queryBase + (int)b2CTZ64( bits ) };
+		resultIndex += 1;
+	}
+
+	return true;
+}
+
+typedef struct WorldOverlapSingleContext
+{
+	WorldOverlapGroupContext* groupContext;
+	int queryIndex;
+} WorldOverlapSingleContext;
+
+static bool TreeQuerySingleCallback( int proxyId, uint64_t userData, void* context )
+{
+	WorldOverlapSingleContext* singleContext = context;
+	return TreeQueryBatchCallback( proxyId, userData, singleContext->queryIndex, 1, singleContext->groupContext );
+}
+
+static void b2OverlapAABBBatchTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
+{
+	B2_UNUSED( threadIndex );
+
+	WorldOverlapBatchContext* batch = context;
+	b2BroadPhase* broadPhase = &batch->world->broadPhase;
+
+	for ( int groupIndex = startIndex; groupIndex < endIndex; ++groupIndex )
+	{
+		int baseIndex = groupIndex * B2_TREE_BATCH_SIZE;
+		int count = b2MinInt( B2_TREE_BATCH_SIZE, batch->boxCount - baseIndex );
+
+		WorldOverlapGroupContext groupContext = { batch, baseIndex };
+
+		for ( int i = 0; i < b2_bodyTypeCount; ++i )
+		{
+			b2DynamicTree* tree = broadPhase->trees + i;
+
+			// Like the ray batch, the static tree is walked one query at a time
+			if ( i == b2_staticBody )
+			{
+				for ( int j = 0; j < count; ++j )
+				{
+					WorldOverlapSingleContext singleContext = { &groupContext, j };
+					b2DynamicTree_Query( tree, batch->boxes[baseIndex + j], batch->filter.maskBits, TreeQuerySingleCallback,
+										 &singleContext );
+				}
+			}
+			else
+			{
+				b2DynamicTree_QueryBatch( tree, batch->boxes + baseIndex, count, batch->filter.maskBits,
+										  TreeQueryBatchCallback, &groupContext );
+			}
+		}
+	}
+}
+
+int b2World_OverlapAABBBatch( b2WorldId worldId, const b2AABB* boxes, int boxCount, b2QueryFilter filter,
+							  b2OverlapBatchResult* results, int resultCapacity, bool useTasks )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	B2_ASSERT( world->locked == false );
+	if ( world->locked || boxCount <= 0 )
+	{
+		return 0;
+	}
+
+	WorldOverlapBatchContext batch;
+	batch.world = world;
+	batch.filter = filter;
+	batch.boxes = boxes;
+	batch.boxCount = boxCount;
+	batch.results = results;
+	batch.resultCapacity = resultCapacity;
+	b2AtomicStoreInt( &batch.resultCount, 0 );
+
+	int groupCount = ( boxCount + B2_TREE_BATCH_SIZE - 1 ) / B2_TREE_BATCH_SIZE;
+	void* userTask = NULL;
+	if ( useTasks )
+	{
+		userTask = world->enqueueTaskFcn( b2OverlapAABBBatchTask, groupCount, 1, &batch, world->userTaskContext );
+	}
+	else
+	{
+		b2OverlapAABBBatchTask( 0, groupCount, 0, &batch );
+	}
+
+	if ( userTask != NULL )
+	{
+		world->finishTaskFcn( userTask, world->userTaskContext );
+	}
+
+	return b2AtomicLoadInt( &batch.resultCount );
+}
+
 static float ShapeCastCallback( const b2ShapeCastInput* input, int proxyId, uint64_t userData, void* context )
 {
 	B2_UNUSED( proxyId );
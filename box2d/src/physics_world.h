@@ -43,6 +43,9 @@ typedef struct b2TaskContext
 	float splitSleepTime;
 	int splitIslandId;
 
+	// Number of contacts that kept their manifold this step
+	int manifoldReuseCount;
+
 } b2TaskContext;
 
 // The world struct manages all physics entities, dynamic simulation,  and asynchronous queries.
@@ -142,6 +145,7 @@ typedef struct b2World
 	float contactSpeed;
 	float contactHertz;
 	float contactDampingRatio;
+	float manifoldReuseTolerance;
 
 	b2FrictionCallback* frictionCallback;
 	b2RestitutionCallback* restitutionCallback;
@@ -160,15 +164,23 @@ typedef struct b2World
 	b2EnqueueTaskCallback* enqueueTaskFcn;
 	b2FinishTaskCallback* finishTaskFcn;
 	void* userTaskContext;
-	void* userTreeTask;
 
 	void* userData;
 
+	// wide solver kernels, may be switched between steps
+	const struct b2SIMDKernels* simdKernels;
+
+	b2SolverWaitType solverWaitType;
+
 	// Remember type step used for reporting forces and torques
 	float inv_h;
 
 	int activeTaskCount;
 	int taskCount;
+	int manifoldReuseCount;
+
+	// overflow contacts moved into a graph color this step
+	int recolorCount;
 
 	uint16_t worldId;
 
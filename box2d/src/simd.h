@@ -0,0 +1,769 @@
+// SPDX-FileCopyrightText: 2023 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "core.h"
+
+#include "box2d/math_functions.h"
+
+#include <stdbool.h>
+
+// Wide float math shared by the solvers and the narrow phase. B2_SIMD_WIDTH lanes are processed at once.
+// The scalar fallback holds 4 lanes.
+
+#if defined( B2_SIMD_AVX512 )
+
+#include <immintrin.h>
+
+// wide float holds 16 numbers
+typedef __m512 b2FloatW;
+
+#elif defined( B2_SIMD_AVX2 )
+
+#include <immintrin.h>
+
+// wide float holds 8 numbers
+typedef __m256 b2FloatW;
+
+#elif defined( B2_SIMD_NEON )
+
+#include <arm_neon.h>
+
+// wide float holds 4 numbers
+typedef float32x4_t b2FloatW;
+
+#elif defined( B2_SIMD_SSE2 )
+
+#include <emmintrin.h>
+
+// wide float holds 4 numbers
+typedef __m128 b2FloatW;
+
+#else
+
+// scalar math
+typedef struct b2FloatW
+{
+	float x, y, z, w;
+} b2FloatW;
+
+#endif
+
+// Wide vec2
+typedef struct b2Vec2W
+{
+	b2FloatW X, Y;
+} b2Vec2W;
+
+// Wide rotation
+typedef struct b2RotW
+{
+	b2FloatW C, S;
+} b2RotW;
+
+#if defined( B2_SIMD_AVX512 )
+
+// Comparisons produce a mask register. Masks are expanded to all bits set so they can be combined
+// and blended like the other backends. This needs AVX-512DQ.
+static inline b2FloatW b2MaskToW( __mmask16 mask )
+{
+	return _mm512_castsi512_ps( _mm512_movm_epi32( mask ) );
+}
+
+static inline b2FloatW b2ZeroW( void )
+{
+	return _mm512_setzero_ps();
+}
+
+static inline b2FloatW b2SplatW( float scalar )
+{
+	return _mm512_set1_ps( scalar );
+}
+
+static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_add_ps( a, b );
+}
+
+static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_sub_ps( a, b );
+}
+
+static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_mul_ps( a, b );
+}
+
+static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	// no FMA, see the AVX2 version
+	return _mm512_add_ps( _mm512_mul_ps( b, c ), a );
+}
+
+static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return _mm512_sub_ps( a, _mm512_mul_ps( b, c ) );
+}
+
+static inline b2FloatW b2DivW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_div_ps( a, b );
+}
+
+static inline b2FloatW b2SqrtW( b2FloatW a )
+{
+	return _mm512_sqrt_ps( a );
+}
+
+static inline b2FloatW b2AbsW( b2FloatW a )
+{
+	return _mm512_abs_ps( a );
+}
+
+static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_min_ps( a, b );
+}
+
+static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_max_ps( a, b );
+}
+
+// a = clamp(a, -b, b)
+static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW nb = _mm512_sub_ps( _mm512_setzero_ps(), b );
+	return _mm512_max_ps( nb, _mm512_min_ps( a, b ) );
+}
+
+static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
+{
+	return _mm512_or_ps( a, b );
+}
+
+static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
+{
+	return b2MaskToW( _mm512_cmp_ps_mask( a, b, _CMP_GT_OQ ) );
+}
+
+static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
+{
+	return b2MaskToW( _mm512_cmp_ps_mask( a, b, _CMP_EQ_OQ ) );
+}
+
+static inline bool b2AllZeroW( b2FloatW a )
+{
+	return _mm512_cmp_ps_mask( a, _mm512_setzero_ps(), _CMP_EQ_OQ ) == 0xFFFF;
+}
+
+// component-wise returns mask ? b : a
+static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
+{
+	// Like blendv this only looks at the sign bit
+	return _mm512_mask_blend_ps( _mm512_movepi32_mask( _mm512_castps_si512( mask ) ), a, b );
+}
+
+// Load 16 consecutive points and split them into x and y lanes
+static inline b2Vec2W b2LoadVec2W( const b2Vec2* points )
+{
+	b2FloatW a = _mm512_loadu_ps( &points[0].x );
+	b2FloatW b = _mm512_loadu_ps( &points[8].x );
+
+	__m512i evens = _mm512_setr_epi32( 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30 );
+	__m512i odds = _mm512_setr_epi32( 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31 );
+	return (b2Vec2W){ _mm512_permutex2var_ps( a, evens, b ), _mm512_permutex2var_ps( a, odds, b ) };
+}
+
+#elif defined( B2_SIMD_AVX2 )
+
+static inline b2FloatW b2ZeroW( void )
+{
+	return _mm256_setzero_ps();
+}
+
+static inline b2FloatW b2SplatW( float scalar )
+{
+	return _mm256_set1_ps( scalar );
+}
+
+static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_add_ps( a, b );
+}
+
+static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_sub_ps( a, b );
+}
+
+static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_mul_ps( a, b );
+}
+
+static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	// FMA can be emulated: https://github.com/lattera/glibc/blob/master/sysdeps/ieee754/dbl-64/s_fmaf.c#L34
+	// return _mm256_fmadd_ps( b, c, a );
+	return _mm256_add_ps( _mm256_mul_ps( b, c ), a );
+}
+
+static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	// return _mm256_fnmadd_ps(b, c, a);
+	return _mm256_sub_ps( a, _mm256_mul_ps( b, c ) );
+}
+
+static inline b2FloatW b2DivW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_div_ps( a, b );
+}
+
+static inline b2FloatW b2SqrtW( b2FloatW a )
+{
+	return _mm256_sqrt_ps( a );
+}
+
+static inline b2FloatW b2AbsW( b2FloatW a )
+{
+	return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a );
+}
+
+static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_min_ps( a, b );
+}
+
+static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_max_ps( a, b );
+}
+
+// a = clamp(a, -b, b)
+static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW nb = _mm256_sub_ps( _mm256_setzero_ps(), b );
+	return _mm256_max_ps( nb, _mm256_min_ps( a, b ) );
+}
+
+static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_or_ps( a, b );
+}
+
+static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_cmp_ps( a, b, _CMP_GT_OQ );
+}
+
+static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
+{
+	return _mm256_cmp_ps( a, b, _CMP_EQ_OQ );
+}
+
+static inline bool b2AllZeroW( b2FloatW a )
+{
+	// Compare each element with zero
+	b2FloatW zero = _mm256_setzero_ps();
+	b2FloatW cmp = _mm256_cmp_ps( a, zero, _CMP_EQ_OQ );
+
+	// Create a mask from the comparison results
+	int mask = _mm256_movemask_ps( cmp );
+
+	// If all elements are zero, the mask will be 0xFF (11111111 in binary)
+	return mask == 0xFF;
+}
+
+// component-wise returns mask ? b : a
+static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
+{
+	return _mm256_blendv_ps( a, b, mask );
+}
+
+// Load 8 consecutive points and split them into x and y lanes
+static inline b2Vec2W b2LoadVec2W( const b2Vec2* points )
+{
+	b2FloatW a = _mm256_loadu_ps( &points[0].x );
+	b2FloatW b = _mm256_loadu_ps( &points[4].x );
+
+	// x0 x1 x4 x5 | x2 x3 x6 x7
+	b2FloatW x = _mm256_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	b2FloatW y = _mm256_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+
+	// Swap the middle 64-bit pairs to restore the order
+	x = _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( x ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+	y = _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( y ), _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+	return (b2Vec2W){ x, y };
+}
+
+#elif defined( B2_SIMD_NEON )
+
+static inline b2FloatW b2ZeroW( void )
+{
+	return vdupq_n_f32( 0.0f );
+}
+
+static inline b2FloatW b2SplatW( float scalar )
+{
+	return vdupq_n_f32( scalar );
+}
+
+static inline b2FloatW b2SetW( float a, float b, float c, float d )
+{
+	float32_t array[4] = { a, b, c, d };
+	return vld1q_f32( array );
+}
+
+static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
+{
+	return vaddq_f32( a, b );
+}
+
+static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
+{
+	return vsubq_f32( a, b );
+}
+
+static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
+{
+	return vmulq_f32( a, b );
+}
+
+static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return vmlaq_f32( a, b, c );
+}
+
+static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return vmlsq_f32( a, b, c );
+}
+
+static inline b2FloatW b2DivW( b2FloatW a, b2FloatW b )
+{
+#if defined( __aarch64__ )
+	return vdivq_f32( a, b );
+#else
+	// ARMv7 has no vector divide, only a reciprocal estimate that would not match the scalar code
+	float32_t x[4], y[4];
+	vst1q_f32( x, a );
+	vst1q_f32( y, b );
+	float32_t r[4] = { x[0] / y[0], x[1] / y[1], x[2] / y[2], x[3] / y[3] };
+	return vld1q_f32( r );
+#endif
+}
+
+static inline b2FloatW b2SqrtW( b2FloatW a )
+{
+#if defined( __aarch64__ )
+	return vsqrtq_f32( a );
+#else
+	float32_t x[4];
+	vst1q_f32( x, a );
+	float32_t r[4] = { sqrtf( x[0] ), sqrtf( x[1] ), sqrtf( x[2] ), sqrtf( x[3] ) };
+	return vld1q_f32( r );
+#endif
+}
+
+static inline b2FloatW b2AbsW( b2FloatW a )
+{
+	return vabsq_f32( a );
+}
+
+static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
+{
+	return vminq_f32( a, b );
+}
+
+static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
+{
+	return vmaxq_f32( a, b );
+}
+
+// a = clamp(a, -b, b)
+static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW nb = vnegq_f32( b );
+	return vmaxq_f32( nb, vminq_f32( a, b ) );
+}
+
+static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
+{
+	return vreinterpretq_f32_u32( vorrq_u32( vreinterpretq_u32_f32( a ), vreinterpretq_u32_f32( b ) ) );
+}
+
+static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
+{
+	return vreinterpretq_f32_u32( vcgtq_f32( a, b ) );
+}
+
+static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
+{
+	return vreinterpretq_f32_u32( vceqq_f32( a, b ) );
+}
+
+static inline bool b2AllZeroW( b2FloatW a )
+{
+	// Create a zero vector for comparison
+	b2FloatW zero = vdupq_n_f32( 0.0f );
+
+	// Compare the input vector with zero
+	uint32x4_t cmp_result = vceqq_f32( a, zero );
+
+// Check if all comparison results are non-zero using vminvq
+#ifdef __ARM_FEATURE_SVE
+	// ARM v8.2+ has horizontal minimum instruction
+	return vminvq_u32( cmp_result ) != 0;
+#else
+	// For older ARM architectures, we need to manually check all lanes
+	return vgetq_lane_u32( cmp_result, 0 ) != 0 && vgetq_lane_u32( cmp_result, 1 ) != 0 && vgetq_lane_u32( cmp_result, 2 ) != 0 &&
+		   vgetq_lane_u32( cmp_result, 3 ) != 0;
+#endif
+}
+
+// component-wise returns mask ? b : a
+static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
+{
+	uint32x4_t mask32 = vreinterpretq_u32_f32( mask );
+	return vbslq_f32( mask32, b, a );
+}
+
+static inline b2FloatW b2LoadW( const float32_t* data )
+{
+	return vld1q_f32( data );
+}
+
+static inline void b2StoreW( float32_t* data, b2FloatW a )
+{
+	vst1q_f32( data, a );
+}
+
+// Load 4 consecutive points and split them into x and y lanes
+static inline b2Vec2W b2LoadVec2W( const b2Vec2* points )
+{
+	float32x4x2_t xy = vld2q_f32( &points[0].x );
+	return (b2Vec2W){ xy.val[0], xy.val[1] };
+}
+
+static inline b2FloatW b2UnpackLoW( b2FloatW a, b2FloatW b )
+{
+#if defined( __aarch64__ )
+	return vzip1q_f32( a, b );
+#else
+	float32x2_t a1 = vget_low_f32( a );
+	float32x2_t b1 = vget_low_f32( b );
+	float32x2x2_t result = vzip_f32( a1, b1 );
+	return vcombine_f32( result.val[0], result.val[1] );
+#endif
+}
+
+static inline b2FloatW b2UnpackHiW( b2FloatW a, b2FloatW b )
+{
+#if defined( __aarch64__ )
+	return vzip2q_f32( a, b );
+#else
+	float32x2_t a1 = vget_high_f32( a );
+	float32x2_t b1 = vget_high_f32( b );
+	float32x2x2_t result = vzip_f32( a1, b1 );
+	return vcombine_f32( result.val[0], result.val[1] );
+#endif
+}
+
+#elif defined( B2_SIMD_SSE2 )
+
+static inline b2FloatW b2ZeroW( void )
+{
+	return _mm_setzero_ps();
+}
+
+static inline b2FloatW b2SplatW( float scalar )
+{
+	return _mm_set1_ps( scalar );
+}
+
+static inline b2FloatW b2SetW( float a, float b, float c, float d )
+{
+	return _mm_setr_ps( a, b, c, d );
+}
+
+static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
+{
+	return _mm_add_ps( a, b );
+}
+
+static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
+{
+	return _mm_sub_ps( a, b );
+}
+
+static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
+{
+	return _mm_mul_ps( a, b );
+}
+
+static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return _mm_add_ps( a, _mm_mul_ps( b, c ) );
+}
+
+static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return _mm_sub_ps( a, _mm_mul_ps( b, c ) );
+}
+
+static inline b2FloatW b2DivW( b2FloatW a, b2FloatW b )
+{
+	return _mm_div_ps( a, b );
+}
+
+static inline b2FloatW b2SqrtW( b2FloatW a )
+{
+	return _mm_sqrt_ps( a );
+}
+
+static inline b2FloatW b2AbsW( b2FloatW a )
+{
+	return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a );
+}
+
+static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
+{
+	return _mm_min_ps( a, b );
+}
+
+static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
+{
+	return _mm_max_ps( a, b );
+}
+
+// a = clamp(a, -b, b)
+static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
+{
+	// Create a mask with the sign bit set for each element
+	__m128 mask = _mm_set1_ps( -0.0f );
+
+	// XOR the input with the mask to negate each element
+	__m128 nb = _mm_xor_ps( b, mask );
+
+	return _mm_max_ps( nb, _mm_min_ps( a, b ) );
+}
+
+static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
+{
+	return _mm_or_ps( a, b );
+}
+
+static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
+{
+	return _mm_cmpgt_ps( a, b );
+}
+
+static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
+{
+	return _mm_cmpeq_ps( a, b );
+}
+
+static inline bool b2AllZeroW( b2FloatW a )
+{
+	// Compare each element with zero
+	b2FloatW zero = _mm_setzero_ps();
+	b2FloatW cmp = _mm_cmpeq_ps( a, zero );
+
+	// Create a mask from the comparison results
+	int mask = _mm_movemask_ps( cmp );
+
+	// If all elements are zero, the mask will be 0xF (1111 in binary)
+	return mask == 0xF;
+}
+
+// component-wise returns mask ? b : a
+static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
+{
+	return _mm_or_ps( _mm_and_ps( mask, b ), _mm_andnot_ps( mask, a ) );
+}
+
+static inline b2FloatW b2LoadW( const float* data )
+{
+	return _mm_load_ps( data );
+}
+
+static inline void b2StoreW( float* data, b2FloatW a )
+{
+	_mm_store_ps( data, a );
+}
+
+// Load 4 consecutive points and split them into x and y lanes
+static inline b2Vec2W b2LoadVec2W( const b2Vec2* points )
+{
+	b2FloatW a = _mm_loadu_ps( &points[0].x );
+	b2FloatW b = _mm_loadu_ps( &points[2].x );
+	return (b2Vec2W){ _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ), _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) };
+}
+
+static inline b2FloatW b2UnpackLoW( b2FloatW a, b2FloatW b )
+{
+	return _mm_unpacklo_ps( a, b );
+}
+
+static inline b2FloatW b2UnpackHiW( b2FloatW a, b2FloatW b )
+{
+	return _mm_unpackhi_ps( a, b );
+}
+
+#else
+
+static inline b2FloatW b2ZeroW( void )
+{
+	return (b2FloatW){ 0.0f, 0.0f, 0.0f, 0.0f };
+}
+
+static inline b2FloatW b2SplatW( float scalar )
+{
+	return (b2FloatW){ scalar, scalar, scalar, scalar };
+}
+
+static inline b2FloatW b2AddW( b2FloatW a, b2FloatW b )
+{
+	return (b2FloatW){ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+}
+
+static inline b2FloatW b2SubW( b2FloatW a, b2FloatW b )
+{
+	return (b2FloatW){ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+}
+
+static inline b2FloatW b2MulW( b2FloatW a, b2FloatW b )
+{
+	return (b2FloatW){ a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
+}
+
+static inline b2FloatW b2MulAddW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return (b2FloatW){ a.x + b.x * c.x, a.y + b.y * c.y, a.z + b.z * c.z, a.w + b.w * c.w };
+}
+
+static inline b2FloatW b2MulSubW( b2FloatW a, b2FloatW b, b2FloatW c )
+{
+	return (b2FloatW){ a.x - b.x * c.x, a.y - b.y * c.y, a.z - b.z * c.z, a.w - b.w * c.w };
+}
+
+static inline b2FloatW b2DivW( b2FloatW a, b2FloatW b )
+{
+	return (b2FloatW){ a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w };
+}
+
+static inline b2FloatW b2SqrtW( b2FloatW a )
+{
+	return (b2FloatW){ sqrtf( a.x ), sqrtf( a.y ), sqrtf( a.z ), sqrtf( a.w ) };
+}
+
+static inline b2FloatW b2AbsW( b2FloatW a )
+{
+	return (b2FloatW){ b2AbsFloat( a.x ), b2AbsFloat( a.y ), b2AbsFloat( a.z ), b2AbsFloat( a.w ) };
+}
+
+static inline b2FloatW b2MinW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW r;
+	r.x = a.x <= b.x ? a.x : b.x;
+	r.y = a.y <= b.y ? a.y : b.y;
+	r.z = a.z <= b.z ? a.z : b.z;
+	r.w = a.w <= b.w ? a.w : b.w;
+	return r;
+}
+
+static inline b2FloatW b2MaxW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW r;
+	r.x = a.x >= b.x ? a.x : b.x;
+	r.y = a.y >= b.y ? a.y : b.y;
+	r.z = a.z >= b.z ? a.z : b.z;
+	r.w = a.w >= b.w ? a.w : b.w;
+	return r;
+}
+
+// a = clamp(a, -b, b)
+static inline b2FloatW b2SymClampW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW r;
+	r.x = b2ClampFloat( a.x, -b.x, b.x );
+	r.y = b2ClampFloat( a.y, -b.y, b.y );
+	r.z = b2ClampFloat( a.z, -b.z, b.z );
+	r.w = b2ClampFloat( a.w, -b.w, b.w );
+	return r;
+}
+
+static inline b2FloatW b2OrW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW r;
+	r.x = a.x != 0.0f || b.x != 0.0f ? 1.0f : 0.0f;
+	r.y = a.y != 0.0f || b.y != 0.0f ? 1.0f : 0.0f;
+	r.z = a.z != 0.0f || b.z != 0.0f ? 1.0f : 0.0f;
+	r.w = a.w != 0.0f || b.w != 0.0f ? 1.0f : 0.0f;
+	return r;
+}
+
+static inline b2FloatW b2GreaterThanW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW r;
+	r.x = a.x > b.x ? 1.0f : 0.0f;
+	r.y = a.y > b.y ? 1.0f : 0.0f;
+	r.z = a.z > b.z ? 1.0f : 0.0f;
+	r.w = a.w > b.w ? 1.0f : 0.0f;
+	return r;
+}
+
+static inline b2FloatW b2EqualsW( b2FloatW a, b2FloatW b )
+{
+	b2FloatW r;
+	r.x = a.x == b.x ? 1.0f : 0.0f;
+	r.y = a.y == b.y ? 1.0f : 0.0f;
+	r.z = a.z == b.z ? 1.0f : 0.0f;
+	r.w = a.w == b.w ? 1.0f : 0.0f;
+	return r;
+}
+
+static inline bool b2AllZeroW( b2FloatW a )
+{
+	return a.x == 0.0f && a.y == 0.0f && a.z == 0.0f && a.w == 0.0f;
+}
+
+// component-wise returns mask ? b : a
+static inline b2FloatW b2BlendW( b2FloatW a, b2FloatW b, b2FloatW mask )
+{
+	b2FloatW r;
+	r.x = mask.x != 0.0f ? b.x : a.x;
+	r.y = mask.y != 0.0f ? b.y : a.y;
+	r.z = mask.z != 0.0f ? b.z : a.z;
+	r.w = mask.w != 0.0f ? b.w : a.w;
+	return r;
+}
+
+// Load 4 consecutive points and split them into x and y lanes
+static inline b2Vec2W b2LoadVec2W( const b2Vec2* points )
+{
+	b2Vec2W r;
+	r.X = (b2FloatW){ points[0].x, points[1].x, points[2].x, points[3].x };
+	r.Y = (b2FloatW){ points[0].y, points[1].y, points[2].y, points[3].y };
+	return r;
+}
+
+#endif
+
+static inline b2FloatW b2DotW( b2Vec2W a, b2Vec2W b )
+{
+	return b2AddW( b2MulW( a.X, b.X ), b2MulW( a.Y, b.Y ) );
+}
+
+static inline b2FloatW b2CrossW( b2Vec2W a, b2Vec2W b )
+{
+	return b2SubW( b2MulW( a.X, b.Y ), b2MulW( a.Y, b.X ) );
+}
+
+static inline b2Vec2W b2RotateVectorW( b2RotW q, b2Vec2W v )
+{
+	return (b2Vec2W){ b2SubW( b2MulW( q.C, v.X ), b2MulW( q.S, v.Y ) ), b2AddW( b2MulW( q.S, v.X ), b2MulW( q.C, v.Y ) ) };
+}
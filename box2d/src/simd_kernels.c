@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#include "simd_kernels.h"
+
+#include "core.h"
+
+#include <stddef.h>
+
+#if defined( BOX2D_DISPATCH_AVX2 ) || defined( BOX2D_DISPATCH_AVX512 )
+	#if defined( _MSC_VER ) && !defined( __clang__ )
+		#include <immintrin.h>
+		#include <intrin.h>
+	#endif
+#endif
+
+// The baseline kernels built with the compile time instruction set
+extern const b2SIMDKernels b2_simdKernels;
+
+#if defined( BOX2D_DISPATCH_AVX2 )
+extern const b2SIMDKernels b2_simdKernels_avx2;
+#endif
+
+#if defined( BOX2D_DISPATCH_AVX512 )
+extern const b2SIMDKernels b2_simdKernels_avx512;
+#endif
+
+#if defined( BOX2D_DISPATCH_AVX2 ) || defined( BOX2D_DISPATCH_AVX512 )
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+
+// The OS must save the wide registers on a context switch, so check XCR0 as well as the feature bits
+static bool b2CpuSupports( bool avx512 )
+{
+	int info[4];
+	__cpuid( info, 0 );
+	if ( info[0] < 7 )
+	{
+		return false;
+	}
+
+	__cpuid( info, 1 );
+	bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+	bool avx = ( info[2] & ( 1 << 28 ) ) != 0;
+	if ( osxsave == false || avx == false )
+	{
+		return false;
+	}
+
+	unsigned long long xcr0 = _xgetbv( 0 );
+
+	__cpuidex( info, 7, 0 );
+	if ( avx512 )
+	{
+		bool avx512f = ( info[1] & ( 1 << 16 ) ) != 0;
+		bool avx512dq = ( info[1] & ( 1 << 17 ) ) != 0;
+		return avx512f && avx512dq && ( xcr0 & 0xE6 ) == 0xE6;
+	}
+
+	bool avx2 = ( info[1] & ( 1 << 5 ) ) != 0;
+	return avx2 && ( xcr0 & 0x6 ) == 0x6;
+}
+
+#else
+
+static bool b2CpuSupports( bool avx512 )
+{
+	__builtin_cpu_init();
+	if ( avx512 )
+	{
+		return __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512dq" );
+	}
+
+	return __builtin_cpu_supports( "avx2" );
+}
+
+#endif
+
+#endif
+
+const b2SIMDKernels* b2GetSIMDKernels( b2SIMDBackend backend )
+{
+	if ( backend == b2_simdKernels.backend )
+	{
+		return &b2_simdKernels;
+	}
+
+#if defined( BOX2D_DISPATCH_AVX2 )
+	if ( backend == b2_simdAVX2 && b2CpuSupports( false ) )
+	{
+		return &b2_simdKernels_avx2;
+	}
+#endif
+
+#if defined( BOX2D_DISPATCH_AVX512 )
+	if ( backend == b2_simdAVX512 && b2CpuSupports( true ) )
+	{
+		return &b2_simdKernels_avx512;
+	}
+#endif
+
+	return NULL;
+}
+
+const b2SIMDKernels* b2GetDefaultSIMDKernels( void )
+{
+	for ( int backend = b2_simdBackendCount - 1; backend >= 0; --backend )
+	{
+		const b2SIMDKernels* kernels = b2GetSIMDKernels( (b2SIMDBackend)backend );
+		if ( kernels != NULL )
+		{
+			return kernels;
+		}
+	}
+
+	B2_ASSERT( false );
+	return &b2_simdKernels;
+}
+
+bool b2IsSIMDBackendSupported( b2SIMDBackend backend )
+{
+	return b2GetSIMDKernels( backend ) != NULL;
+}
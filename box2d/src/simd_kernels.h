@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "box2d/base.h"
+#include "box2d/math_functions.h"
+
+#include <stdbool.h>
+
+typedef struct b2BodySim b2BodySim;
+typedef struct b2BodyState b2BodyState;
+typedef struct b2StepContext b2StepContext;
+
+// The wide solver kernels for one SIMD backend. On x86-64 the contact and joint solvers are compiled
+// once for the baseline instruction set and again for each wider instruction set, then picked at run
+// time. Everything else in the solver works with any lane width.
+typedef struct b2SIMDKernels
+{
+	b2SIMDBackend backend;
+	int width;
+
+	int ( *getContactConstraintByteCount )( void );
+	int ( *getJointConstraintByteCount )( void );
+
+	void ( *integrateVelocities )( b2BodySim* sims, b2BodyState* states, int count, b2Vec2 gravity, float h,
+								   float maxLinearSpeed, float maxAngularSpeed );
+	void ( *integratePositions )( b2BodyState* states, int count, float h );
+
+	void ( *prepareContacts )( int startIndex, int endIndex, b2StepContext* context );
+	void ( *warmStartContacts )( int startIndex, int endIndex, b2StepContext* context, int colorIndex );
+	void ( *solveContacts )( int startIndex, int endIndex, b2StepContext* context, int colorIndex, bool useBias );
+	void ( *applyRestitution )( int startIndex, int endIndex, b2StepContext* context, int colorIndex );
+	void ( *storeImpulses )( int startIndex, int endIndex, b2StepContext* context );
+
+	void ( *prepareJoints )( int startIndex, int endIndex, b2StepContext* context );
+	void ( *warmStartJoints )( int startIndex, int endIndex, b2StepContext* context, int colorIndex );
+	void ( *solveJoints )( int startIndex, int endIndex, b2StepContext* context, int colorIndex, bool useBias );
+	void ( *storeJointImpulses )( int startIndex, int endIndex, b2StepContext* context );
+} b2SIMDKernels;
+
+// Returns NULL if the backend is not built into the library or not supported by the CPU
+const b2SIMDKernels* b2GetSIMDKernels( b2SIMDBackend backend );
+
+// The widest backend supported by the CPU
+const b2SIMDKernels* b2GetDefaultSIMDKernels( void );
+
+// The solver sources are compiled once per backend with B2_SIMD_SUFFIX set to a unique suffix, such
+// as _avx2. These macros rename the width dependent functions so the copies can be linked together.
+#define B2_SIMD_CONCAT_INNER( a, b ) a##b
+#define B2_SIMD_CONCAT( a, b ) B2_SIMD_CONCAT_INNER( a, b )
+
+#if defined( B2_SIMD_SUFFIX )
+	#define B2_SIMD_NAME( name ) B2_SIMD_CONCAT( name, B2_SIMD_SUFFIX )
+
+	#define b2GetContactConstraintSIMDByteCount B2_SIMD_NAME( b2GetContactConstraintSIMDByteCount )
+	#define b2GatherBodies B2_SIMD_NAME( b2GatherBodies )
+	#define b2ScatterBodies B2_SIMD_NAME( b2ScatterBodies )
+	#define b2IntegrateVelocitiesWide B2_SIMD_NAME( b2IntegrateVelocitiesWide )
+	#define b2IntegratePositionsWide B2_SIMD_NAME( b2IntegratePositionsWide )
+	#define b2PrepareContactsTask B2_SIMD_NAME( b2PrepareContactsTask )
+	#define b2WarmStartContactsTask B2_SIMD_NAME( b2WarmStartContactsTask )
+	#define b2SolveContactsTask B2_SIMD_NAME( b2SolveContactsTask )
+	#define b2ApplyRestitutionTask B2_SIMD_NAME( b2ApplyRestitutionTask )
+	#define b2StoreImpulsesTask B2_SIMD_NAME( b2StoreImpulsesTask )
+
+	#define b2GetJointConstraintSIMDByteCount B2_SIMD_NAME( b2GetJointConstraintSIMDByteCount )
+	#define b2PrepareJointsSIMDTask B2_SIMD_NAME( b2PrepareJointsSIMDTask )
+	#define b2WarmStartJointsSIMDTask B2_SIMD_NAME( b2WarmStartJointsSIMDTask )
+	#define b2SolveJointsSIMDTask B2_SIMD_NAME( b2SolveJointsSIMDTask )
+	#define b2StoreJointImpulsesTask B2_SIMD_NAME( b2StoreJointImpulsesTask )
+#else
+	#define B2_SIMD_NAME( name ) name
+#endif
@@ -0,0 +1,578 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#include "snapshot.h"
+
+#include "array.h"
+#include "bitset.h"
+#include "body.h"
+#include "broad_phase.h"
+#include "constants.h"
+#include "constraint_graph.h"
+#include "contact.h"
+#include "core.h"
+#include "ctz.h"
+#include "id_pool.h"
+#include "island.h"
+#include "joint.h"
+#include "physics_world.h"
+#include "sensor.h"
+#include "shape.h"
+#include "solver_set.h"
+#include "table.h"
+
+#include "box2d/box2d.h"
+
+#include <string.h>
+
+// Bump this whenever the traversal below changes
+#define B2_SNAPSHOT_VERSION 4
+#define B2_SNAPSHOT_MAGIC 0x53533242 // "B2SS"
+
+// Guards against loading a blob written by a build with a different memory layout
+typedef struct b2SnapshotHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint16_t bodySize;
+	uint16_t bodySimSize;
+	uint16_t bodyStateSize;
+	uint16_t shapeSize;
+	uint16_t chainSize;
+	uint16_t contactSize;
+	uint16_t contactSimSize;
+	uint16_t jointSize;
+	uint16_t jointSimSize;
+	uint16_t islandSize;
+	uint16_t islandSimSize;
+	uint16_t graphColorCount;
+} b2SnapshotHeader;
+
+static b2SnapshotHeader b2MakeSnapshotHeader( void )
+{
+	b2SnapshotHeader header = {
+		.magic = B2_SNAPSHOT_MAGIC,
+		.version = B2_SNAPSHOT_VERSION,
+		.bodySize = sizeof( b2Body ),
+		.bodySimSize = sizeof( b2BodySim ),
+		.bodyStateSize = sizeof( b2BodyState ),
+		.shapeSize = sizeof( b2Shape ),
+		.chainSize = sizeof( b2ChainShape ),
+		.contactSize = sizeof( b2Contact ),
+		.contactSimSize = sizeof( b2ContactSim ),
+		.jointSize = sizeof( b2Joint ),
+		.jointSimSize = sizeof( b2JointSim ),
+		.islandSize = sizeof( b2Island ),
+		.islandSimSize = sizeof( b2IslandSim ),
+		.graphColorCount = B2_GRAPH_COLOR_COUNT,
+	};
+	return header;
+}
+
+void b2SnapshotBytes( b2Snapshot* snapshot, void* data, int byteCount )
+{
+	if ( snapshot->valid == false || byteCount == 0 )
+	{
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotSave )
+	{
+		if ( snapshot->buffer != NULL && snapshot->offset + byteCount <= snapshot->capacity )
+		{
+			memcpy( snapshot->buffer + snapshot->offset, data, byteCount );
+		}
+		snapshot->offset += byteCount;
+		return;
+	}
+
+	if ( byteCount < 0 || byteCount > snapshot->capacity - snapshot->offset )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad )
+	{
+		memcpy( data, snapshot->buffer + snapshot->offset, byteCount );
+	}
+	snapshot->offset += byteCount;
+}
+
+int b2SnapshotInt( b2Snapshot* snapshot, int value )
+{
+	if ( snapshot->mode == b2_snapshotSave )
+	{
+		b2SnapshotBytes( snapshot, &value, sizeof( int ) );
+		return value;
+	}
+
+	int result = 0;
+	b2SnapshotMode mode = snapshot->mode;
+	snapshot->mode = b2_snapshotLoad;
+	b2SnapshotBytes( snapshot, &result, sizeof( int ) );
+	snapshot->mode = mode;
+	return result;
+}
+
+// Number of elements that still fit in the remaining data, used to reject bad counts
+static bool b2IsValidCount( b2Snapshot* snapshot, int count, int elementSize )
+{
+	if ( snapshot->valid == false || count < 0 )
+	{
+		return false;
+	}
+
+	if ( snapshot->mode == b2_snapshotSave )
+	{
+		return true;
+	}
+
+	return count <= ( snapshot->capacity - snapshot->offset ) / b2MaxInt( elementSize, 1 );
+}
+
+void b2SnapshotArray( b2Snapshot* snapshot, void** data, int* count, int* capacity, int elementSize )
+{
+	int n = b2SnapshotInt( snapshot, *count );
+	if ( b2IsValidCount( snapshot, n, elementSize ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad )
+	{
+		if ( *capacity < n )
+		{
+			b2Free( *data, *capacity * elementSize );
+			*data = b2Alloc( n * elementSize );
+			*capacity = n;
+		}
+		*count = n;
+	}
+
+	b2SnapshotBytes( snapshot, *data, n * elementSize );
+}
+
+static void b2SnapshotIdPool( b2Snapshot* snapshot, b2IdPool* pool )
+{
+	B2_SNAPSHOT_ARRAY( snapshot, pool->freeArray );
+	B2_SNAPSHOT_VALUE( snapshot, pool->nextIndex );
+}
+
+static void b2SnapshotBitSet( b2Snapshot* snapshot, b2BitSet* bitSet )
+{
+	int blockCount = b2SnapshotInt( snapshot, (int)bitSet->blockCount );
+	if ( b2IsValidCount( snapshot, blockCount, sizeof( uint64_t ) ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad )
+	{
+		if ( (uint32_t)blockCount > bitSet->blockCapacity )
+		{
+			b2Free( bitSet->bits, bitSet->blockCapacity * sizeof( uint64_t ) );
+			bitSet->bits = b2Alloc( blockCount * sizeof( uint64_t ) );
+			bitSet->blockCapacity = blockCount;
+		}
+		bitSet->blockCount = blockCount;
+	}
+
+	b2SnapshotBytes( snapshot, bitSet->bits, blockCount * (int)sizeof( uint64_t ) );
+
+	// Growing within capacity relies on the unused blocks being clear
+	if ( snapshot->mode == b2_snapshotLoad && snapshot->valid && bitSet->blockCapacity > (uint32_t)blockCount )
+	{
+		memset( bitSet->bits + blockCount, 0, ( bitSet->blockCapacity - blockCount ) * sizeof( uint64_t ) );
+	}
+}
+
+static bool b2IsValidSetCapacity( b2Snapshot* snapshot, int capacity, int keySize )
+{
+	return b2IsValidCount( snapshot, capacity, keySize + 1 ) && capacity >= B2_SET_GROUP_SIZE && b2IsPowerOf2( capacity );
+}
+
+// The slot of each key depends on the insertion history, so the keys and control bytes are stored as is
+static void b2SnapshotHashSet( b2Snapshot* snapshot, b2HashSet* set )
+{
+	int capacity = b2SnapshotInt( snapshot, (int)set->capacity );
+	if ( b2IsValidSetCapacity( snapshot, capacity, sizeof( uint64_t ) ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad && (uint32_t)capacity != set->capacity )
+	{
+		b2DestroySet( set );
+		*set = b2CreateSet( capacity );
+	}
+
+	b2SnapshotBytes( snapshot, set->keys, capacity * (int)sizeof( uint64_t ) );
+	b2SnapshotBytes( snapshot, set->controls, capacity + B2_SET_GROUP_SIZE - 1 );
+	B2_SNAPSHOT_VALUE( snapshot, set->count );
+	B2_SNAPSHOT_VALUE( snapshot, set->minCapacity );
+}
+
+static void b2SnapshotHashSet32( b2Snapshot* snapshot, b2HashSet32* set )
+{
+	int capacity = b2SnapshotInt( snapshot, (int)set->capacity );
+	if ( b2IsValidSetCapacity( snapshot, capacity, sizeof( uint32_t ) ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad && (uint32_t)capacity != set->capacity )
+	{
+		b2DestroySet32( set );
+		*set = b2CreateSet32( capacity );
+	}
+
+	b2SnapshotBytes( snapshot, set->keys, capacity * (int)sizeof( uint32_t ) );
+	b2SnapshotBytes( snapshot, set->controls, capacity + B2_SET_GROUP_SIZE - 1 );
+	B2_SNAPSHOT_VALUE( snapshot, set->count );
+	B2_SNAPSHOT_VALUE( snapshot, set->minCapacity );
+}
+
+static void b2SnapshotSolverSets( b2Snapshot* snapshot, b2World* world )
+{
+	int setCount = b2SnapshotInt( snapshot, world->solverSets.count );
+	if ( b2IsValidCount( snapshot, setCount, 1 ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad )
+	{
+		int oldCount = world->solverSets.count;
+		for ( int i = setCount; i < oldCount; ++i )
+		{
+			b2SolverSet* set = world->solverSets.data + i;
+			b2BodySimArray_Destroy( &set->bodySims );
+			b2BodyStateArray_Destroy( &set->bodyStates );
+			b2ContactSimArray_Destroy( &set->contactSims );
+			b2JointSimArray_Destroy( &set->jointSims );
+			b2IslandSimArray_Destroy( &set->islandSims );
+		}
+
+		b2SolverSetArray_Reserve( &world->solverSets, setCount );
+		for ( int i = oldCount; i < setCount; ++i )
+		{
+			world->solverSets.data[i] = ( b2SolverSet ){ 0 };
+		}
+		world->solverSets.count = setCount;
+	}
+
+	for ( int i = 0; i < setCount; ++i )
+	{
+		b2SolverSet scratch = { 0 };
+		b2SolverSet* set = snapshot->mode == b2_snapshotVerify ? &scratch : world->solverSets.data + i;
+		B2_SNAPSHOT_ARRAY( snapshot, set->bodySims );
+		B2_SNAPSHOT_ARRAY( snapshot, set->bodyStates );
+		B2_SNAPSHOT_ARRAY( snapshot, set->jointSims );
+		B2_SNAPSHOT_ARRAY( snapshot, set->contactSims );
+		B2_SNAPSHOT_ARRAY( snapshot, set->islandSims );
+		B2_SNAPSHOT_VALUE( snapshot, set->setIndex );
+	}
+}
+
+// Chains own their shape index and material arrays
+static void b2SnapshotChains( b2Snapshot* snapshot, b2World* world )
+{
+	int chainCount = b2SnapshotInt( snapshot, world->chainShapes.count );
+	if ( b2IsValidCount( snapshot, chainCount, 1 ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad )
+	{
+		for ( int i = 0; i < world->chainShapes.count; ++i )
+		{
+			b2ChainShape* chain = world->chainShapes.data + i;
+			if ( chain->id != B2_NULL_INDEX )
+			{
+				b2FreeChainData( chain );
+			}
+		}
+
+		b2ChainShapeArray_Resize( &world->chainShapes, chainCount );
+	}
+
+	for ( int i = 0; i < chainCount; ++i )
+	{
+		b2ChainShape scratch = { 0 };
+		b2ChainShape* chain = snapshot->mode == b2_snapshotVerify ? &scratch : world->chainShapes.data + i;
+
+		int id = b2SnapshotInt( snapshot, chain->id );
+		int count = b2SnapshotInt( snapshot, id != B2_NULL_INDEX ? chain->count : 0 );
+		int materialCount = b2SnapshotInt( snapshot, id != B2_NULL_INDEX ? chain->materialCount : 0 );
+		B2_SNAPSHOT_VALUE( snapshot, chain->bodyId );
+		B2_SNAPSHOT_VALUE( snapshot, chain->nextChainId );
+		B2_SNAPSHOT_VALUE( snapshot, chain->generation );
+
+		if ( b2IsValidCount( snapshot, count, sizeof( int ) ) == false ||
+			 b2IsValidCount( snapshot, materialCount, sizeof( b2SurfaceMaterial ) ) == false )
+		{
+			snapshot->valid = false;
+			return;
+		}
+
+		if ( snapshot->mode == b2_snapshotLoad )
+		{
+			chain->id = id;
+			chain->count = count;
+			chain->materialCount = materialCount;
+			chain->shapeIndices = count > 0 ? b2Alloc( count * sizeof( int ) ) : NULL;
+			chain->materials = materialCount > 0 ? b2Alloc( materialCount * sizeof( b2SurfaceMaterial ) ) : NULL;
+		}
+
+		b2SnapshotBytes( snapshot, chain->shapeIndices, count * (int)sizeof( int ) );
+		b2SnapshotBytes( snapshot, chain->materials, materialCount * (int)sizeof( b2SurfaceMaterial ) );
+	}
+}
+
+static void b2SnapshotSensors( b2Snapshot* snapshot, b2World* world )
+{
+	int sensorCount = b2SnapshotInt( snapshot, world->sensors.count );
+	if ( b2IsValidCount( snapshot, sensorCount, 1 ) == false )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( snapshot->mode == b2_snapshotLoad )
+	{
+		int oldCount = world->sensors.count;
+		for ( int i = sensorCount; i < oldCount; ++i )
+		{
+			b2Sensor* sensor = world->sensors.data + i;
+			b2ShapeRefArray_Destroy( &sensor->hits );
+			b2ShapeRefArray_Destroy( &sensor->overlaps1 );
+			b2ShapeRefArray_Destroy( &sensor->overlaps2 );
+		}
+
+		b2SensorArray_Reserve( &world->sensors, sensorCount );
+		for ( int i = oldCount; i < sensorCount; ++i )
+		{
+			world->sensors.data[i] = ( b2Sensor ){ 0 };
+		}
+		world->sensors.count = sensorCount;
+	}
+
+	for ( int i = 0; i < sensorCount; ++i )
+	{
+		b2Sensor scratch = { 0 };
+		b2Sensor* sensor = snapshot->mode == b2_snapshotVerify ? &scratch : world->sensors.data + i;
+		B2_SNAPSHOT_ARRAY( snapshot, sensor->hits );
+		B2_SNAPSHOT_ARRAY( snapshot, sensor->overlaps1 );
+		B2_SNAPSHOT_ARRAY( snapshot, sensor->overlaps2 );
+		B2_SNAPSHOT_VALUE( snapshot, sensor->shapeId );
+	}
+}
+
+static void b2SnapshotGraph( b2Snapshot* snapshot, b2World* world )
+{
+	for ( int i = 0; i < B2_GRAPH_COLOR_COUNT; ++i )
+	{
+		b2GraphColor scratch = { 0 };
+		b2GraphColor* color = snapshot->mode == b2_snapshotVerify ? &scratch : world->constraintGraph.colors + i;
+		b2SnapshotBitSet( snapshot, &color->bodySet );
+		B2_SNAPSHOT_ARRAY( snapshot, color->contactSims );
+		B2_SNAPSHOT_ARRAY( snapshot, color->jointSims );
+	}
+}
+
+static void b2SnapshotBroadPhase( b2Snapshot* snapshot, b2World* world )
+{
+	b2BroadPhase* bp = &world->broadPhase;
+	for ( int i = 0; i < b2_bodyTypeCount; ++i )
+	{
+		b2DynamicTree scratch = { 0 };
+		b2SnapshotTree( snapshot, snapshot->mode == b2_snapshotVerify ? &scratch : bp->trees + i );
+	}
+
+	b2HashSet32 scratchMoveSet = { 0 };
+	b2HashSet scratchPairSet = { 0 };
+	b2IntArray scratchMoveArray = { 0 };
+	bool verify = snapshot->mode == b2_snapshotVerify;
+	b2IntArray* moveArray = verify ? &scratchMoveArray : &bp->moveArray;
+	b2SnapshotHashSet32( snapshot, verify ? &scratchMoveSet : &bp->moveSet );
+	B2_SNAPSHOT_ARRAY( snapshot, *moveArray );
+	b2SnapshotHashSet( snapshot, verify ? &scratchPairSet : &bp->pairSet );
+
+	// These decide when a refit tree is rebuilt next
+	B2_SNAPSHOT_VALUE( snapshot, bp->rebuildAreaRatios );
+	B2_SNAPSHOT_VALUE( snapshot, bp->refitSteps );
+
+	// The order of the sweep and grid entries decides the order of new contacts
+	int type = b2SnapshotInt( snapshot, bp->type );
+	if ( type != (int)bp->type )
+	{
+		snapshot->valid = false;
+		return;
+	}
+
+	if ( type == b2_sortAndSweepBroadPhase )
+	{
+		b2SweepSet scratch = { 0 };
+		b2SweepSet* sweep = verify ? &scratch : &bp->sweep;
+		B2_SNAPSHOT_ARRAY( snapshot, sweep->lowerX );
+		B2_SNAPSHOT_ARRAY( snapshot, sweep->upperX );
+		B2_SNAPSHOT_ARRAY( snapshot, sweep->lowerY );
+		B2_SNAPSHOT_ARRAY( snapshot, sweep->upperY );
+		B2_SNAPSHOT_ARRAY( snapshot, sweep->proxyKeys );
+		B2_SNAPSHOT_ARRAY( snapshot, sweep->shapeIndices );
+		for ( int i = 0; i < b2_bodyTypeCount; ++i )
+		{
+			B2_SNAPSHOT_ARRAY( snapshot, sweep->entryIndices[i] );
+		}
+		B2_SNAPSHOT_VALUE( snapshot, sweep->removedCount );
+	}
+	else if ( type == b2_gridBroadPhase )
+	{
+		b2GridSet scratch = { 0 };
+		b2GridSet* grid = verify ? &scratch : &bp->grid;
+		B2_SNAPSHOT_ARRAY( snapshot, grid->aabbs );
+		B2_SNAPSHOT_ARRAY( snapshot, grid->proxyIds );
+		B2_SNAPSHOT_ARRAY( snapshot, grid->shapeIndices );
+		B2_SNAPSHOT_ARRAY( snapshot, grid->entryIndices );
+	}
+}
+
+// Walks every persistent container of the world in a fixed order. Transient data (events,
+// task contexts, arena, debug draw bits, callbacks and the world identity) is not included.
+static void b2SnapshotWorld( b2Snapshot* snapshot, b2World* world )
+{
+	b2SnapshotHeader header = b2MakeSnapshotHeader();
+	b2SnapshotHeader stored = header;
+	if ( snapshot->mode == b2_snapshotSave )
+	{
+		b2SnapshotBytes( snapshot, &header, sizeof( header ) );
+	}
+	else
+	{
+		b2SnapshotMode mode = snapshot->mode;
+		snapshot->mode = b2_snapshotLoad;
+		b2SnapshotBytes( snapshot, &stored, sizeof( stored ) );
+		snapshot->mode = mode;
+		if ( memcmp( &stored, &header, sizeof( header ) ) != 0 )
+		{
+			snapshot->valid = false;
+			return;
+		}
+	}
+
+	B2_SNAPSHOT_VALUE( snapshot, world->gravity );
+	B2_SNAPSHOT_VALUE( snapshot, world->hitEventThreshold );
+	B2_SNAPSHOT_VALUE( snapshot, world->restitutionThreshold );
+	B2_SNAPSHOT_VALUE( snapshot, world->maxLinearSpeed );
+	B2_SNAPSHOT_VALUE( snapshot, world->contactSpeed );
+	B2_SNAPSHOT_VALUE( snapshot, world->contactHertz );
+	B2_SNAPSHOT_VALUE( snapshot, world->contactDampingRatio );
+	B2_SNAPSHOT_VALUE( snapshot, world->inv_h );
+	B2_SNAPSHOT_VALUE( snapshot, world->stepIndex );
+	B2_SNAPSHOT_VALUE( snapshot, world->splitIslandId );
+	B2_SNAPSHOT_VALUE( snapshot, world->enableSleep );
+	B2_SNAPSHOT_VALUE( snapshot, world->enableWarmStarting );
+	B2_SNAPSHOT_VALUE( snapshot, world->enableContinuous );
+	B2_SNAPSHOT_VALUE( snapshot, world->enableSpeculative );
+
+	b2SnapshotIdPool( snapshot, &world->bodyIdPool );
+	b2SnapshotIdPool( snapshot, &world->solverSetIdPool );
+	b2SnapshotIdPool( snapshot, &world->jointIdPool );
+	b2SnapshotIdPool( snapshot, &world->contactIdPool );
+	b2SnapshotIdPool( snapshot, &world->islandIdPool );
+	b2SnapshotIdPool( snapshot, &world->shapeIdPool );
+	b2SnapshotIdPool( snapshot, &world->chainIdPool );
+
+	// Use scratch arrays while verifying so the world is never written
+	b2BodyArray scratchBodies = { 0 };
+	b2JointArray scratchJoints = { 0 };
+	b2ContactArray scratchContacts = { 0 };
+	b2IslandArray scratchIslands = { 0 };
+	b2ShapeArray scratchShapes = { 0 };
+	bool verify = snapshot->mode == b2_snapshotVerify;
+	B2_SNAPSHOT_ARRAY( snapshot, *( verify ? &scratchBodies : &world->bodies ) );
+	B2_SNAPSHOT_ARRAY( snapshot, *( verify ? &scratchJoints : &world->joints ) );
+	B2_SNAPSHOT_ARRAY( snapshot, *( verify ? &scratchContacts : &world->contacts ) );
+	B2_SNAPSHOT_ARRAY( snapshot, *( verify ? &scratchIslands : &world->islands ) );
+	B2_SNAPSHOT_ARRAY( snapshot, *( verify ? &scratchShapes : &world->shapes ) );
+
+	b2SnapshotChains( snapshot, world );
+	b2SnapshotSensors( snapshot, world );
+	b2SnapshotSolverSets( snapshot, world );
+	b2SnapshotGraph( snapshot, world );
+	b2SnapshotBroadPhase( snapshot, world );
+}
+
+int b2World_GetSnapshotSize( b2WorldId worldId )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	b2Snapshot snapshot = { .mode = b2_snapshotSave, .valid = true };
+	b2SnapshotWorld( &snapshot, world );
+	return snapshot.offset;
+}
+
+int b2World_SaveSnapshot( b2WorldId worldId, void* buffer, int capacity )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	B2_ASSERT( world->locked == false );
+	if ( world->locked || buffer == NULL )
+	{
+		return 0;
+	}
+
+	b2Snapshot snapshot = { .mode = b2_snapshotSave, .buffer = buffer, .capacity = capacity, .valid = true };
+	b2SnapshotWorld( &snapshot, world );
+	if ( snapshot.offset > capacity )
+	{
+		return 0;
+	}
+
+	return snapshot.offset;
+}
+
+bool b2World_RestoreSnapshot( b2WorldId worldId, const void* buffer, int size )
+{
+	b2World* world = b2GetWorldFromId( worldId );
+	B2_ASSERT( world->locked == false );
+	if ( world->locked || buffer == NULL || size <= 0 )
+	{
+		return false;
+	}
+
+	// Verify the whole blob first so a bad snapshot leaves the world untouched
+	b2Snapshot snapshot = { .mode = b2_snapshotVerify, .buffer = (uint8_t*)buffer, .capacity = size, .valid = true };
+	b2SnapshotWorld( &snapshot, world );
+	if ( snapshot.valid == false || snapshot.offset != size )
+	{
+		return false;
+	}
+
+	snapshot = ( b2Snapshot ){ .mode = b2_snapshotLoad, .buffer = (uint8_t*)buffer, .capacity = size, .valid = true };
+	b2SnapshotWorld( &snapshot, world );
+	B2_ASSERT( snapshot.valid && snapshot.offset == size );
+
+	// Events belong to the step that produced them
+	b2BodyMoveEventArray_Clear( &world->bodyMoveEvents );
+	b2SensorBeginTouchEventArray_Clear( &world->sensorBeginEvents );
+	b2SensorEndTouchEventArray_Clear( world->sensorEndEvents + 0 );
+	b2SensorEndTouchEventArray_Clear( world->sensorEndEvents + 1 );
+	b2ContactBeginTouchEventArray_Clear( &world->contactBeginEvents );
+	b2ContactEndTouchEventArray_Clear( world->contactEndEvents + 0 );
+	b2ContactEndTouchEventArray_Clear( world->contactEndEvents + 1 );
+	b2ContactHitEventArray_Clear( &world->contactHitEvents );
+	b2JointEventArray_Clear( &world->jointEvents );
+
+	b2ValidateSolverSets( world );
+	b2ValidateContacts( world );
+	b2ValidateConnectivity( world );
+
+	return true;
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 Erin Catto
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct b2DynamicTree b2DynamicTree;
+
+// A world snapshot is a raw memory image of the persistent world containers. The same
+// traversal code is used to save, to verify and to load so the three can never disagree.
+typedef enum b2SnapshotMode
+{
+	// Write into the buffer. A NULL buffer only measures the size.
+	b2_snapshotSave,
+
+	// Walk the buffer without touching the world. Used to reject bad data before loading.
+	b2_snapshotVerify,
+
+	// Read the buffer into the world.
+	b2_snapshotLoad,
+} b2SnapshotMode;
+
+typedef struct b2Snapshot
+{
+	b2SnapshotMode mode;
+	uint8_t* buffer;
+	int capacity;
+	int offset;
+	bool valid;
+} b2Snapshot;
+
+// Copy raw bytes in or out depending on the mode. Verify mode only advances.
+void b2SnapshotBytes( b2Snapshot* snapshot, void* data, int byteCount );
+
+// Save an int, or read it back in verify and load mode. Unlike B2_SNAPSHOT_VALUE the result is
+// valid while verifying so it can drive the traversal.
+int b2SnapshotInt( b2Snapshot* snapshot, int value );
+
+// Copy a b2Array style container { T* data; int count; int capacity; }. Loading grows the
+// storage when needed. Verify mode only advances.
+void b2SnapshotArray( b2Snapshot* snapshot, void** data, int* count, int* capacity, int elementSize );
+
+// Tree nodes are private to dynamic_tree.c
+void b2SnapshotTree( b2Snapshot* snapshot, b2DynamicTree* tree );
+
+#define B2_SNAPSHOT_VALUE( snapshot, value ) b2SnapshotBytes( snapshot, &( value ), (int)sizeof( value ) )
+
+#define B2_SNAPSHOT_ARRAY( snapshot, array )                                                                                     \
+	b2SnapshotArray( snapshot, (void**)&( array ).data, &( array ).count, &( array ).capacity, (int)sizeof( *( array ).data ) )
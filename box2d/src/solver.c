@@ -14,6 +14,7 @@
 #include "ctz.h"
 #include "island.h"
 #include "joint.h"
+#include "joint_solver.h"
 #include "physics_world.h"
 #include "sensor.h"
 #include "shape.h"
@@ -22,6 +23,7 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
 // todo testing
 #define ITERATIONS 1
@@ -54,29 +56,28 @@ static inline void b2Pause( void )
 }
 #endif
 
+// With b2_hybridSolverWait a waiting solver thread spins this long before it sleeps
+#define B2_SOLVER_SPIN_MILLISECONDS 0.05f
+
 typedef struct b2WorkerContext
 {
 	b2StepContext* context;
 	int workerIndex;
 	void* userTask;
+
+	// Time this thread waited for other threads, by the stage it waited on
+	float spinTime[b2_solverStageCount];
+	float sleepTime[b2_solverStageCount];
 } b2WorkerContext;
 
 // Integrate velocities and apply damping
-static void b2IntegrateVelocitiesTask( int startIndex, int endIndex, b2StepContext* context )
+void b2IntegrateVelocities( b2BodySim* sims, b2BodyState* states, int count, b2Vec2 gravity, float h, float maxLinearSpeed,
+							float maxAngularSpeed )
 {
-	b2TracyCZoneNC( integrate_velocity, "IntVel", b2_colorDeepPink, true );
-
-	b2BodyState* states = context->states;
-	b2BodySim* sims = context->sims;
-
-	b2Vec2 gravity = context->world->gravity;
-	float h = context->h;
-	float maxLinearSpeed = context->maxLinearVelocity;
-	float maxAngularSpeed = B2_MAX_ROTATION * context->inv_dt;
 	float maxLinearSpeedSquared = maxLinearSpeed * maxLinearSpeed;
 	float maxAngularSpeedSquared = maxAngularSpeed * maxAngularSpeed;
 
-	for ( int i = startIndex; i < endIndex; ++i )
+	for ( int i = 0; i < count; ++i )
 	{
 		b2BodySim* sim = sims + i;
 		b2BodyState* state = states + i;
@@ -124,6 +125,24 @@ static void b2IntegrateVelocitiesTask( int startIndex, int endIndex, b2StepConte
 		state->linearVelocity = v;
 		state->angularVelocity = w;
 	}
+}
+
+static void b2IntegrateVelocitiesTask( int startIndex, int endIndex, b2StepContext* context )
+{
+	b2TracyCZoneNC( integrate_velocity, "IntVel", b2_colorDeepPink, true );
+
+	B2_ASSERT( startIndex <= endIndex );
+
+	b2BodyState* states = context->states + startIndex;
+	b2BodySim* sims = context->sims + startIndex;
+	int count = endIndex - startIndex;
+
+	b2Vec2 gravity = context->world->gravity;
+	float h = context->h;
+	float maxLinearSpeed = context->maxLinearVelocity;
+	float maxAngularSpeed = B2_MAX_ROTATION * context->inv_dt;
+
+	context->simd->integrateVelocities( sims, states, count, gravity, h, maxLinearSpeed, maxAngularSpeed );
 
 	b2TracyCZoneEnd( integrate_velocity );
 }
@@ -148,13 +167,13 @@ static void b2WarmStartJointsTask( int startIndex, int endIndex, b2StepContext*
 	b2TracyCZoneNC( warm_joints, "WarmJoints", b2_colorGold, true );
 
 	b2GraphColor* color = context->graph->colors + colorIndex;
-	b2JointSim* joints = color->jointSims.data;
+	b2JointSim** joints = color->scalarJoints;
 	B2_ASSERT( 0 <= startIndex && startIndex < color->jointSims.count );
 	B2_ASSERT( startIndex <= endIndex && endIndex <= color->jointSims.count );
 
 	for ( int i = startIndex; i < endIndex; ++i )
 	{
-		b2JointSim* joint = joints + i;
+		b2JointSim* joint = joints[i];
 		b2WarmStartJoint( joint, context );
 	}
 
@@ -167,7 +186,7 @@ static void b2SolveJointsTask( int startIndex, int endIndex, b2StepContext* cont
 	b2TracyCZoneNC( solve_joints, "SolveJoints", b2_colorLemonChiffon, true );
 
 	b2GraphColor* color = context->graph->colors + colorIndex;
-	b2JointSim* joints = color->jointSims.data;
+	b2JointSim** joints = color->scalarJoints;
 	B2_ASSERT( 0 <= startIndex && startIndex < color->jointSims.count );
 	B2_ASSERT( startIndex <= endIndex && endIndex <= color->jointSims.count );
 
@@ -175,7 +194,7 @@ static void b2SolveJointsTask( int startIndex, int endIndex, b2StepContext* cont
 
 	for ( int i = startIndex; i < endIndex; ++i )
 	{
-		b2JointSim* joint = joints + i;
+		b2JointSim* joint = joints[i];
 		b2SolveJoint( joint, context, useBias );
 
 		if ( useBias && ( joint->forceThreshold < FLT_MAX || joint->torqueThreshold < FLT_MAX ) &&
@@ -196,21 +215,26 @@ static void b2SolveJointsTask( int startIndex, int endIndex, b2StepContext* cont
 	b2TracyCZoneEnd( solve_joints );
 }
 
-static void b2IntegratePositionsTask( int startIndex, int endIndex, b2StepContext* context )
+void b2IntegratePositions( b2BodyState* states, int count, float h )
 {
-	b2TracyCZoneNC( integrate_positions, "IntPos", b2_colorDarkSeaGreen, true );
-
-	b2BodyState* states = context->states;
-	float h = context->h;
-
-	B2_ASSERT( startIndex <= endIndex );
-
-	for ( int i = startIndex; i < endIndex; ++i )
+	for ( int i = 0; i < count; ++i )
 	{
 		b2BodyState* state = states + i;
 		state->deltaRotation = b2IntegrateRotation( state->deltaRotation, h * state->angularVelocity );
 		state->deltaPosition = b2MulAdd( state->deltaPosition, h, state->linearVelocity );
 	}
+}
+
+static void b2IntegratePositionsTask( int startIndex, int endIndex, b2StepContext* context )
+{
+	b2TracyCZoneNC( integrate_positions, "IntPos", b2_colorDarkSeaGreen, true );
+
+	B2_ASSERT( startIndex <= endIndex );
+
+	b2BodyState* states = context->states + startIndex;
+	int count = endIndex - startIndex;
+
+	context->simd->integratePositions( states, count, context->h );
 
 	b2TracyCZoneEnd( integrate_positions );
 }
@@ -791,10 +815,56 @@ typedef enum b2SolverBlockType
 	b2_jointBlock,
 	b2_contactBlock,
 	b2_graphJointBlock,
-	b2_graphContactBlock
+	b2_graphContactBlock,
+	b2_jointSIMDBlock,
+	b2_graphJointSIMDBlock,
+	b2_overflowBlock
 } b2SolverBlockType;
 */
 
+static void b2ExecuteOverflowBlock( b2SolverStageType stageType, b2StepContext* context, int blockIndex )
+{
+	int jointStart = context->overflowJointStarts[blockIndex];
+	int jointEnd = context->overflowJointStarts[blockIndex + 1];
+	int contactStart = context->overflowContactStarts[blockIndex];
+	int contactEnd = context->overflowContactStarts[blockIndex + 1];
+
+	switch ( stageType )
+	{
+		case b2_stagePrepareContacts:
+			b2PrepareOverflowJoints( jointStart, jointEnd, context );
+			b2PrepareOverflowContacts( contactStart, contactEnd, context );
+			break;
+
+		case b2_stageWarmStart:
+			b2WarmStartOverflowJoints( jointStart, jointEnd, context );
+			b2WarmStartOverflowContacts( contactStart, contactEnd, context );
+			break;
+
+		case b2_stageSolve:
+			b2SolveOverflowJoints( jointStart, jointEnd, context, true );
+			b2SolveOverflowContacts( contactStart, contactEnd, context, true );
+			break;
+
+		case b2_stageRelax:
+			b2SolveOverflowJoints( jointStart, jointEnd, context, false );
+			b2SolveOverflowContacts( contactStart, contactEnd, context, false );
+			break;
+
+		case b2_stageRestitution:
+			b2ApplyOverflowRestitution( contactStart, contactEnd, context );
+			break;
+
+		case b2_stageStoreImpulses:
+			b2StoreOverflowImpulses( contactStart, contactEnd, context );
+			break;
+
+		default:
+			B2_ASSERT( false );
+			break;
+	}
+}
+
 static void b2ExecuteBlock( b2SolverStage* stage, b2StepContext* context, b2SolverBlock* block, int workerIndex )
 {
 	b2SolverStageType stageType = stage->type;
@@ -802,14 +872,27 @@ static void b2ExecuteBlock( b2SolverStage* stage, b2StepContext* context, b2Solv
 	int startIndex = block->startIndex;
 	int endIndex = startIndex + block->count;
 
+	if ( blockType == b2_overflowBlock )
+	{
+		b2ExecuteOverflowBlock( stageType, context, startIndex );
+		return;
+	}
+
 	switch ( stageType )
 	{
 		case b2_stagePrepareJoints:
-			b2PrepareJointsTask( startIndex, endIndex, context );
+			if ( blockType == b2_jointSIMDBlock )
+			{
+				context->simd->prepareJoints( startIndex, endIndex, context );
+			}
+			else
+			{
+				b2PrepareJointsTask( startIndex, endIndex, context );
+			}
 			break;
 
 		case b2_stagePrepareContacts:
-			b2PrepareContactsTask( startIndex, endIndex, context );
+			context->simd->prepareContacts( startIndex, endIndex, context );
 			break;
 
 		case b2_stageIntegrateVelocities:
@@ -819,23 +902,31 @@ static void b2ExecuteBlock( b2SolverStage* stage, b2StepContext* context, b2Solv
 		case b2_stageWarmStart:
 			if ( blockType == b2_graphContactBlock )
 			{
-				b2WarmStartContactsTask( startIndex, endIndex, context, stage->colorIndex );
+				context->simd->warmStartContacts( startIndex, endIndex, context, stage->colorIndex );
 			}
 			else if ( blockType == b2_graphJointBlock )
 			{
 				b2WarmStartJointsTask( startIndex, endIndex, context, stage->colorIndex );
 			}
+			else if ( blockType == b2_graphJointSIMDBlock )
+			{
+				context->simd->warmStartJoints( startIndex, endIndex, context, stage->colorIndex );
+			}
 			break;
 
 		case b2_stageSolve:
 			if ( blockType == b2_graphContactBlock )
 			{
-				b2SolveContactsTask( startIndex, endIndex, context, stage->colorIndex, true );
+				context->simd->solveContacts( startIndex, endIndex, context, stage->colorIndex, true );
 			}
 			else if ( blockType == b2_graphJointBlock )
 			{
 				b2SolveJointsTask( startIndex, endIndex, context, stage->colorIndex, true, workerIndex );
 			}
+			else if ( blockType == b2_graphJointSIMDBlock )
+			{
+				context->simd->solveJoints( startIndex, endIndex, context, stage->colorIndex, true );
+			}
 			break;
 
 		case b2_stageIntegratePositions:
@@ -845,23 +936,38 @@ static void b2ExecuteBlock( b2SolverStage* stage, b2StepContext* context, b2Solv
 		case b2_stageRelax:
 			if ( blockType == b2_graphContactBlock )
 			{
-				b2SolveContactsTask( startIndex, endIndex, context, stage->colorIndex, false );
+				context->simd->solveContacts( startIndex, endIndex, context, stage->colorIndex, false );
 			}
 			else if ( blockType == b2_graphJointBlock )
 			{
 				b2SolveJointsTask( startIndex, endIndex, context, stage->colorIndex, false, workerIndex );
 			}
+			else if ( blockType == b2_graphJointSIMDBlock )
+			{
+				context->simd->solveJoints( startIndex, endIndex, context, stage->colorIndex, false );
+			}
 			break;
 
 		case b2_stageRestitution:
 			if ( blockType == b2_graphContactBlock )
 			{
-				b2ApplyRestitutionTask( startIndex, endIndex, context, stage->colorIndex );
+				context->simd->applyRestitution( startIndex, endIndex, context, stage->colorIndex );
 			}
 			break;
 
 		case b2_stageStoreImpulses:
-			b2StoreImpulsesTask( startIndex, endIndex, context );
+			if ( blockType == b2_jointSIMDBlock )
+			{
+				context->simd->storeJointImpulses( startIndex, endIndex, context );
+			}
+			else
+			{
+				context->simd->storeImpulses( startIndex, endIndex, context );
+			}
+			break;
+
+		default:
+			B2_ASSERT( false );
 			break;
 	}
 }
@@ -937,9 +1043,134 @@ static void b2ExecuteStage( b2SolverStage* stage, b2StepContext* context, int pr
 	}
 
 	(void)b2AtomicFetchAddInt( &stage->completionCount, completedCount );
+
+	if ( b2AtomicLoadInt( &context->mainSleeping ) != 0 )
+	{
+		b2AtomicWakeInt( &stage->completionCount );
+	}
+}
+
+// Publish new sync bits to the workers
+static void b2SignalWorkers( b2StepContext* context, uint32_t syncBits )
+{
+	b2AtomicStoreU32( &context->atomicSyncBits, syncBits );
+
+	if ( b2AtomicLoadInt( &context->sleepingWorkerCount ) > 0 )
+	{
+		b2AtomicWakeU32( &context->atomicSyncBits );
+	}
+}
+
+// The main thread waits for the workers to finish their blocks of a stage
+static void b2WaitForStage( b2SolverStage* stage, b2StepContext* context, b2WorkerContext* workerContext )
+{
+	int blockCount = stage->blockCount;
+	if ( b2AtomicLoadInt( &stage->completionCount ) == blockCount )
+	{
+		return;
+	}
+
+	bool hybrid = context->waitType == b2_hybridSolverWait;
+	uint64_t ticks = b2GetTicks();
+
+	// todo consider using the cycle counter as well
+	int completionCount;
+	while ( ( completionCount = b2AtomicLoadInt( &stage->completionCount ) ) != blockCount )
+	{
+		if ( hybrid && b2GetMilliseconds( ticks ) > B2_SOLVER_SPIN_MILLISECONDS )
+		{
+			break;
+		}
+
+		b2Pause();
+	}
+
+	workerContext->spinTime[stage->type] += b2GetMillisecondsAndReset( &ticks );
+
+	if ( completionCount == blockCount )
+	{
+		return;
+	}
+
+	// The workers check this flag after adding to the completion count
+	b2AtomicStoreInt( &context->mainSleeping, 1 );
+	while ( ( completionCount = b2AtomicLoadInt( &stage->completionCount ) ) != blockCount )
+	{
+		b2AtomicWaitInt( &stage->completionCount, completionCount );
+	}
+	b2AtomicStoreInt( &context->mainSleeping, 0 );
+
+	workerContext->sleepTime[stage->type] += b2GetMilliseconds( ticks );
+}
+
+// A worker waits for the main thread to change the sync bits. Returns the new sync bits.
+static uint32_t b2WaitForSyncBits( b2StepContext* context, uint32_t lastSyncBits, float* spinTime, float* sleepTime )
+{
+	*spinTime = 0.0f;
+	*sleepTime = 0.0f;
+
+	uint32_t syncBits = b2AtomicLoadU32( &context->atomicSyncBits );
+	if ( syncBits != lastSyncBits )
+	{
+		return syncBits;
+	}
+
+	bool hybrid = context->waitType == b2_hybridSolverWait;
+	uint64_t ticks = b2GetTicks();
+
+	// Spin until main thread bumps changes the sync bits. This can waste significant time overall, but it is necessary for
+	// parallel simulation with graph coloring.
+	int spinCount = 0;
+	// uint64_t maxSpinTime = 10;
+	while ( ( syncBits = b2AtomicLoadU32( &context->atomicSyncBits ) ) == lastSyncBits )
+	{
+		if ( hybrid && b2GetMilliseconds( ticks ) > B2_SOLVER_SPIN_MILLISECONDS )
+		{
+			break;
+		}
+
+		if ( spinCount > 5 )
+		{
+			b2Yield();
+			spinCount = 0;
+		}
+		else
+		{
+			// Using the cycle counter helps to account for variation in mm_pause timing across different
+			// CPUs. However, this is X64 only.
+			// uint64_t prev = __rdtsc();
+			// do
+			//{
+			//	b2Pause();
+			//}
+			// while ((__rdtsc() - prev) < maxSpinTime);
+			// maxSpinTime += 10;
+			b2Pause();
+			b2Pause();
+			spinCount += 1;
+		}
+	}
+
+	*spinTime = b2GetMillisecondsAndReset( &ticks );
+
+	if ( syncBits != lastSyncBits )
+	{
+		return syncBits;
+	}
+
+	// The main thread checks the sleeper count after storing new sync bits
+	(void)b2AtomicFetchAddInt( &context->sleepingWorkerCount, 1 );
+	while ( ( syncBits = b2AtomicLoadU32( &context->atomicSyncBits ) ) == lastSyncBits )
+	{
+		b2AtomicWaitU32( &context->atomicSyncBits, lastSyncBits );
+	}
+	(void)b2AtomicFetchAddInt( &context->sleepingWorkerCount, -1 );
+
+	*sleepTime = b2GetMilliseconds( ticks );
+	return syncBits;
 }
 
-static void b2ExecuteMainStage( b2SolverStage* stage, b2StepContext* context, uint32_t syncBits )
+static void b2ExecuteMainStage( b2SolverStage* stage, b2StepContext* context, uint32_t syncBits, b2WorkerContext* workerContext )
 {
 	int blockCount = stage->blockCount;
 	if ( blockCount == 0 )
@@ -955,7 +1186,7 @@ static void b2ExecuteMainStage( b2SolverStage* stage, b2StepContext* context, ui
 	}
 	else
 	{
-		b2AtomicStoreU32( &context->atomicSyncBits, syncBits );
+		b2SignalWorkers( context, syncBits );
 
 		int syncIndex = ( syncBits >> 16 ) & 0xFFFF;
 		B2_ASSERT( syncIndex > 0 );
@@ -963,11 +1194,7 @@ static void b2ExecuteMainStage( b2SolverStage* stage, b2StepContext* context, ui
 
 		b2ExecuteStage( stage, context, previousSyncIndex, syncIndex, workerIndex );
 
-		// todo consider using the cycle counter as well
-		while ( b2AtomicLoadInt( &stage->completionCount ) != blockCount )
-		{
-			b2Pause();
-		}
+		b2WaitForStage( stage, context, workerContext );
 
 		b2AtomicStoreInt( &stage->completionCount, 0 );
 	}
@@ -981,10 +1208,12 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 	b2WorkerContext* workerContext = taskContext;
 	int workerIndex = workerContext->workerIndex;
 	b2StepContext* context = workerContext->context;
-	int activeColorCount = context->activeColorCount;
 	b2SolverStage* stages = context->stages;
 	b2Profile* profile = &context->world->profile;
 
+	// The overflow stage comes first in each group of color stages
+	int colorStageCount = context->activeColorCount + ( context->overflowBlockCount > 0 ? 1 : 0 );
+
 	if ( workerIndex == 0 )
 	{
 		// Main thread synchronizes the workers and does work itself.
@@ -1016,7 +1245,7 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 		uint32_t jointSyncIndex = 1;
 		uint32_t syncBits = ( jointSyncIndex << 16 ) | stageIndex;
 		B2_ASSERT( stages[stageIndex].type == b2_stagePrepareJoints );
-		b2ExecuteMainStage( stages + stageIndex, context, syncBits );
+		b2ExecuteMainStage( stages + stageIndex, context, syncBits, workerContext );
 		stageIndex += 1;
 		jointSyncIndex += 1;
 
@@ -1024,16 +1253,12 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 		uint32_t contactSyncIndex = 1;
 		syncBits = ( contactSyncIndex << 16 ) | stageIndex;
 		B2_ASSERT( stages[stageIndex].type == b2_stagePrepareContacts );
-		b2ExecuteMainStage( stages + stageIndex, context, syncBits );
+		b2ExecuteMainStage( stages + stageIndex, context, syncBits, workerContext );
 		stageIndex += 1;
 		contactSyncIndex += 1;
 
 		int graphSyncIndex = 1;
 
-		// Single-threaded overflow work. These constraints don't fit in the graph coloring.
-		b2PrepareOverflowJoints( context );
-		b2PrepareOverflowContacts( context );
-
 		profile->prepareConstraints += b2GetMillisecondsAndReset( &ticks );
 
 		int subStepCount = context->subStepCount;
@@ -1046,21 +1271,18 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 			// integrate velocities
 			syncBits = ( bodySyncIndex << 16 ) | iterStageIndex;
 			B2_ASSERT( stages[iterStageIndex].type == b2_stageIntegrateVelocities );
-			b2ExecuteMainStage( stages + iterStageIndex, context, syncBits );
+			b2ExecuteMainStage( stages + iterStageIndex, context, syncBits, workerContext );
 			iterStageIndex += 1;
 			bodySyncIndex += 1;
 
 			profile->integrateVelocities += b2GetMillisecondsAndReset( &ticks );
 
 			// warm start constraints
-			b2WarmStartOverflowJoints( context );
-			b2WarmStartOverflowContacts( context );
-
-			for ( int colorIndex = 0; colorIndex < activeColorCount; ++colorIndex )
+			for ( int colorIndex = 0; colorIndex < colorStageCount; ++colorIndex )
 			{
 				syncBits = ( graphSyncIndex << 16 ) | iterStageIndex;
 				B2_ASSERT( stages[iterStageIndex].type == b2_stageWarmStart );
-				b2ExecuteMainStage( stages + iterStageIndex, context, syncBits );
+				b2ExecuteMainStage( stages + iterStageIndex, context, syncBits, workerContext );
 				iterStageIndex += 1;
 			}
 			graphSyncIndex += 1;
@@ -1068,18 +1290,13 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 			profile->warmStart += b2GetMillisecondsAndReset( &ticks );
 
 			// solve constraints
-			bool useBias = true;
-
 			for ( int j = 0; j < ITERATIONS; ++j )
 			{
-				b2SolveOverflowJoints( context, useBias );
-				b2SolveOverflowContacts( context, useBias );
-
-				for ( int colorIndex = 0; colorIndex < activeColorCount; ++colorIndex )
+				for ( int colorIndex = 0; colorIndex < colorStageCount; ++colorIndex )
 				{
 					syncBits = ( graphSyncIndex << 16 ) | iterStageIndex;
 					B2_ASSERT( stages[iterStageIndex].type == b2_stageSolve );
-					b2ExecuteMainStage( stages + iterStageIndex, context, syncBits );
+					b2ExecuteMainStage( stages + iterStageIndex, context, syncBits, workerContext );
 					iterStageIndex += 1;
 				}
 				graphSyncIndex += 1;
@@ -1090,24 +1307,20 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 			// integrate positions
 			B2_ASSERT( stages[iterStageIndex].type == b2_stageIntegratePositions );
 			syncBits = ( bodySyncIndex << 16 ) | iterStageIndex;
-			b2ExecuteMainStage( stages + iterStageIndex, context, syncBits );
+			b2ExecuteMainStage( stages + iterStageIndex, context, syncBits, workerContext );
 			iterStageIndex += 1;
 			bodySyncIndex += 1;
 
 			profile->integratePositions += b2GetMillisecondsAndReset( &ticks );
 
 			// relax constraints
-			useBias = false;
 			for ( int j = 0; j < RELAX_ITERATIONS; ++j )
 			{
-				b2SolveOverflowJoints( context, useBias );
-				b2SolveOverflowContacts( context, useBias );
-
-				for ( int colorIndex = 0; colorIndex < activeColorCount; ++colorIndex )
+				for ( int colorIndex = 0; colorIndex < colorStageCount; ++colorIndex )
 				{
 					syncBits = ( graphSyncIndex << 16 ) | iterStageIndex;
 					B2_ASSERT( stages[iterStageIndex].type == b2_stageRelax );
-					b2ExecuteMainStage( stages + iterStageIndex, context, syncBits );
+					b2ExecuteMainStage( stages + iterStageIndex, context, syncBits, workerContext );
 					iterStageIndex += 1;
 				}
 				graphSyncIndex += 1;
@@ -1118,73 +1331,52 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 
 		// advance the stage according to the sub-stepping tasks just completed
 		// integrate velocities / warm start / solve / integrate positions / relax
-		stageIndex += 1 + activeColorCount + ITERATIONS * activeColorCount + 1 + RELAX_ITERATIONS * activeColorCount;
+		stageIndex += 1 + colorStageCount + ITERATIONS * colorStageCount + 1 + RELAX_ITERATIONS * colorStageCount;
 
 		// Restitution
 		{
-			b2ApplyOverflowRestitution( context );
-
 			int iterStageIndex = stageIndex;
-			for ( int colorIndex = 0; colorIndex < activeColorCount; ++colorIndex )
+			for ( int colorIndex = 0; colorIndex < colorStageCount; ++colorIndex )
 			{
 				syncBits = ( graphSyncIndex << 16 ) | iterStageIndex;
 				B2_ASSERT( stages[iterStageIndex].type == b2_stageRestitution );
-				b2ExecuteMainStage( stages + iterStageIndex, context, syncBits );
+				b2ExecuteMainStage( stages + iterStageIndex, context, syncBits, workerContext );
 				iterStageIndex += 1;
 			}
 			// graphSyncIndex += 1;
-			stageIndex += activeColorCount;
+			stageIndex += colorStageCount;
 		}
 
 		profile->applyRestitution += b2GetMillisecondsAndReset( &ticks );
 
-		b2StoreOverflowImpulses( context );
-
-		syncBits = ( contactSyncIndex << 16 ) | stageIndex;
+		// This stage loops over all SIMD joint constraints and contact constraints
+		uint32_t storeSyncIndex = 1;
+		syncBits = ( storeSyncIndex << 16 ) | stageIndex;
 		B2_ASSERT( stages[stageIndex].type == b2_stageStoreImpulses );
-		b2ExecuteMainStage( stages + stageIndex, context, syncBits );
+		b2ExecuteMainStage( stages + stageIndex, context, syncBits, workerContext );
 
 		profile->storeImpulses += b2GetMillisecondsAndReset( &ticks );
 
 		// Signal workers to finish
-		b2AtomicStoreU32( &context->atomicSyncBits, UINT_MAX );
+		b2SignalWorkers( context, UINT_MAX );
 
 		B2_ASSERT( stageIndex + 1 == context->stageCount );
 		return;
 	}
 
-	// Worker spins and waits for work
+	// Worker spins and waits for work. The wait times are kept local to avoid false sharing.
+	float spinTime[b2_solverStageCount] = { 0 };
+	float sleepTime[b2_solverStageCount] = { 0 };
 	uint32_t lastSyncBits = 0;
-	// uint64_t maxSpinTime = 10;
 	while ( true )
 	{
-		// Spin until main thread bumps changes the sync bits. This can waste significant time overall, but it is necessary for
-		// parallel simulation with graph coloring.
-		uint32_t syncBits;
-		int spinCount = 0;
-		while ( ( syncBits = b2AtomicLoadU32( &context->atomicSyncBits ) ) == lastSyncBits )
-		{
-			if ( spinCount > 5 )
-			{
-				b2Yield();
-				spinCount = 0;
-			}
-			else
-			{
-				// Using the cycle counter helps to account for variation in mm_pause timing across different
-				// CPUs. However, this is X64 only.
-				// uint64_t prev = __rdtsc();
-				// do
-				//{
-				//	b2Pause();
-				//}
-				// while ((__rdtsc() - prev) < maxSpinTime);
-				// maxSpinTime += 10;
-				b2Pause();
-				b2Pause();
-				spinCount += 1;
-			}
-		}
+		float spin, sleep;
+		uint32_t syncBits = b2WaitForSyncBits( context, lastSyncBits, &spin, &sleep );
+
+		// The wait for the finish sentinel counts toward the last stage
+		b2SolverStageType waitStage = syncBits == UINT_MAX ? b2_stageStoreImpulses : stages[syncBits & 0xFFFF].type;
+		spinTime[waitStage] += spin;
+		sleepTime[waitStage] += sleep;
 
 		if ( syncBits == UINT_MAX )
 		{
@@ -1205,6 +1397,9 @@ static void b2SolverTask( int startIndex, int endIndex, uint32_t threadIndexIgno
 
 		lastSyncBits = syncBits;
 	}
+
+	memcpy( workerContext->spinTime, spinTime, sizeof( spinTime ) );
+	memcpy( workerContext->sleepTime, sleepTime, sizeof( sleepTime ) );
 }
 
 static void b2BulletBodyTask( int startIndex, int endIndex, uint32_t threadIndex, void* context )
@@ -1227,15 +1422,193 @@ static void b2BulletBodyTask( int startIndex, int endIndex, uint32_t threadIndex
 	b2TracyCZoneEnd( bullet_body_task );
 }
 
-#if B2_SIMD_WIDTH == 8
-#define B2_SIMD_SHIFT 3
-#elif B2_SIMD_WIDTH == 4
-#define B2_SIMD_SHIFT 2
-#else
-#define B2_SIMD_SHIFT 0
-#endif
-
 // Solve with graph coloring
+static int b2FindOverflowRoot( int* parents, int index )
+{
+	while ( parents[index] != index )
+	{
+		// path halving
+		parents[index] = parents[parents[index]];
+		index = parents[index];
+	}
+
+	return index;
+}
+
+// The overflow constraints are solved one at a time, but constraints that share no awake body are independent.
+// This finds the sets of overflow constraints that are connected through awake bodies and packs whole sets
+// into blocks, so the blocks can be solved in parallel. Static bodies don't connect sets because they use a
+// dummy state. Kinematic bodies do connect sets because the solver writes their velocity.
+// Within a set the joints are solved before the contacts and each keeps its original order, so each body sees
+// the same sequence of impulses as a serial solve and the result is bit identical.
+// Returns the number of overflow blocks.
+static int b2PrepareOverflowBlocks( b2World* world, b2StepContext* stepContext, int awakeBodyCount, int maxBlockCount )
+{
+	b2GraphColor* color = world->constraintGraph.colors + B2_OVERFLOW_INDEX;
+	int jointCount = color->jointSims.count;
+	int contactCount = color->contactSims.count;
+	int constraintCount = jointCount + contactCount;
+
+	stepContext->overflowJoints = b2AllocateArenaItem( &world->arena, jointCount * sizeof( int ), "overflow joints" );
+	stepContext->overflowContacts = b2AllocateArenaItem( &world->arena, contactCount * sizeof( int ), "overflow contacts" );
+
+	// Greedy packing closes a block once it reaches the target, so there can be one block beyond the maximum
+	int maxOverflowBlockCount = b2MinInt( constraintCount, maxBlockCount + 1 );
+	stepContext->overflowJointStarts =
+		b2AllocateArenaItem( &world->arena, ( maxOverflowBlockCount + 1 ) * sizeof( int ), "overflow joint starts" );
+	stepContext->overflowContactStarts =
+		b2AllocateArenaItem( &world->arena, ( maxOverflowBlockCount + 1 ) * sizeof( int ), "overflow contact starts" );
+
+	if ( constraintCount == 0 )
+	{
+		return 0;
+	}
+
+	b2Body* bodies = world->bodies.data;
+	b2JointSim* jointSims = color->jointSims.data;
+	b2ContactSim* contactSims = color->contactSims.data;
+
+	// Union-find over the awake bodies. Then map each root to a set index in order of first appearance.
+	int* parents = b2AllocateArenaItem( &world->arena, awakeBodyCount * sizeof( int ), "overflow parents" );
+	int* setIndices = b2AllocateArenaItem( &world->arena, awakeBodyCount * sizeof( int ), "overflow set indices" );
+
+	// Constraint set indices, joints followed by contacts
+	int* constraintSets = b2AllocateArenaItem( &world->arena, constraintCount * sizeof( int ), "overflow constraint sets" );
+
+	// Per set joint and contact counts that become offsets
+	int* jointOffsets = b2AllocateArenaItem( &world->arena, ( constraintCount + 1 ) * sizeof( int ), "overflow joint offsets" );
+	int* contactOffsets =
+		b2AllocateArenaItem( &world->arena, ( constraintCount + 1 ) * sizeof( int ), "overflow contact offsets" );
+
+	for ( int i = 0; i < awakeBodyCount; ++i )
+	{
+		parents[i] = i;
+		setIndices[i] = B2_NULL_INDEX;
+	}
+
+	for ( int i = 0; i < constraintCount; ++i )
+	{
+		int indexA, indexB;
+		if ( i < jointCount )
+		{
+			b2JointSim* jointSim = jointSims + i;
+			b2Body* bodyA = bodies + jointSim->bodyIdA;
+			b2Body* bodyB = bodies + jointSim->bodyIdB;
+			indexA = bodyA->setIndex == b2_awakeSet ? bodyA->localIndex : B2_NULL_INDEX;
+			indexB = bodyB->setIndex == b2_awakeSet ? bodyB->localIndex : B2_NULL_INDEX;
+		}
+		else
+		{
+			b2ContactSim* contactSim = contactSims + ( i - jointCount );
+			indexA = contactSim->bodySimIndexA;
+			indexB = contactSim->bodySimIndexB;
+		}
+
+		B2_ASSERT( indexA != B2_NULL_INDEX || indexB != B2_NULL_INDEX );
+
+		// Stash a body for finding the set later
+		constraintSets[i] = indexA != B2_NULL_INDEX ? indexA : indexB;
+
+		if ( indexA != B2_NULL_INDEX && indexB != B2_NULL_INDEX )
+		{
+			int rootA = b2FindOverflowRoot( parents, indexA );
+			int rootB = b2FindOverflowRoot( parents, indexB );
+			if ( rootA < rootB )
+			{
+				parents[rootB] = rootA;
+			}
+			else if ( rootB < rootA )
+			{
+				parents[rootA] = rootB;
+			}
+		}
+	}
+
+	int setCount = 0;
+	for ( int i = 0; i < constraintCount; ++i )
+	{
+		int root = b2FindOverflowRoot( parents, constraintSets[i] );
+		if ( setIndices[root] == B2_NULL_INDEX )
+		{
+			setIndices[root] = setCount;
+			jointOffsets[setCount] = 0;
+			contactOffsets[setCount] = 0;
+			setCount += 1;
+		}
+
+		int setIndex = setIndices[root];
+		constraintSets[i] = setIndex;
+
+		if ( i < jointCount )
+		{
+			jointOffsets[setIndex] += 1;
+		}
+		else
+		{
+			contactOffsets[setIndex] += 1;
+		}
+	}
+
+	// Pack whole sets into blocks. Sets are not split, so one large set limits the parallelism.
+	int targetCount = b2MaxInt( 8, ( constraintCount + maxBlockCount - 1 ) / maxBlockCount );
+	int* jointStarts = stepContext->overflowJointStarts;
+	int* contactStarts = stepContext->overflowContactStarts;
+	int blockCount = 0;
+	int blockSize = 0;
+	int jointBase = 0;
+	int contactBase = 0;
+	jointStarts[0] = 0;
+	contactStarts[0] = 0;
+
+	for ( int i = 0; i < setCount; ++i )
+	{
+		int setJointCount = jointOffsets[i];
+		int setContactCount = contactOffsets[i];
+
+		// Convert counts to offsets
+		jointOffsets[i] = jointBase;
+		contactOffsets[i] = contactBase;
+		jointBase += setJointCount;
+		contactBase += setContactCount;
+		blockSize += setJointCount + setContactCount;
+
+		if ( blockSize >= targetCount || i == setCount - 1 )
+		{
+			B2_ASSERT( blockCount < maxOverflowBlockCount );
+			blockCount += 1;
+			jointStarts[blockCount] = jointBase;
+			contactStarts[blockCount] = contactBase;
+			blockSize = 0;
+		}
+	}
+
+	B2_ASSERT( jointBase == jointCount && contactBase == contactCount );
+
+	// Stable counting sort
+	for ( int i = 0; i < constraintCount; ++i )
+	{
+		int setIndex = constraintSets[i];
+		if ( i < jointCount )
+		{
+			stepContext->overflowJoints[jointOffsets[setIndex]] = i;
+			jointOffsets[setIndex] += 1;
+		}
+		else
+		{
+			stepContext->overflowContacts[contactOffsets[setIndex]] = i - jointCount;
+			contactOffsets[setIndex] += 1;
+		}
+	}
+
+	b2FreeArenaItem( &world->arena, contactOffsets );
+	b2FreeArenaItem( &world->arena, jointOffsets );
+	b2FreeArenaItem( &world->arena, constraintSets );
+	b2FreeArenaItem( &world->arena, setIndices );
+	b2FreeArenaItem( &world->arena, parents );
+
+	return blockCount;
+}
+
 void b2Solve( b2World* world, b2StepContext* stepContext )
 {
 	world->stepIndex += 1;
@@ -1256,14 +1629,7 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 	int awakeBodyCount = awakeSet->bodySims.count;
 	if ( awakeBodyCount == 0 )
 	{
-		// Nothing to simulate, however the tree rebuild must be finished.
-		if ( world->userTreeTask != NULL )
-		{
-			world->finishTaskFcn( world->userTreeTask, world->userTaskContext );
-			world->userTreeTask = NULL;
-			world->activeTaskCount -= 1;
-		}
-
+		// Nothing to simulate
 		b2ValidateNoEnlarged( &world->broadPhase );
 		return;
 	}
@@ -1283,8 +1649,7 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		stepContext->sims = awakeSet->bodySims.data;
 		stepContext->states = awakeSet->bodyStates.data;
 
-		// count contacts, joints, and colors
-		int awakeJointCount = 0;
+		// count colors
 		int activeColorCount = 0;
 		for ( int i = 0; i < B2_GRAPH_COLOR_COUNT - 1; ++i )
 		{
@@ -1292,7 +1657,6 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 			int perColorJointCount = colors[i].jointSims.count;
 			int occupancyCount = perColorContactCount + perColorJointCount;
 			activeColorCount += occupancyCount > 0 ? 1 : 0;
-			awakeJointCount += perColorJointCount;
 		}
 
 		// prepare for move events
@@ -1336,10 +1700,21 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		int colorJointBlockSizes[B2_GRAPH_COLOR_COUNT];
 		int colorJointBlockCounts[B2_GRAPH_COLOR_COUNT];
 
+		int colorSIMDJointCounts[B2_GRAPH_COLOR_COUNT];
+		int colorSIMDJointBlockSizes[B2_GRAPH_COLOR_COUNT];
+		int colorSIMDJointBlockCounts[B2_GRAPH_COLOR_COUNT];
+
 		int graphBlockCount = 0;
 
+		// The lane width depends on the SIMD backend picked at run time
+		int simdWidth = stepContext->simd->width;
+		int simdShift = (int)b2CTZ32( (uint32_t)simdWidth );
+		B2_ASSERT( simdWidth == ( 1 << simdShift ) );
+
 		// c is the active color index
 		int simdContactCount = 0;
+		int scalarJointCount = 0;
+		int simdJointCount = 0;
 		int c = 0;
 		for ( int i = 0; i < B2_GRAPH_COLOR_COUNT - 1; ++i )
 		{
@@ -1350,8 +1725,17 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 			{
 				activeColorIndices[c] = i;
 
-				// 4/8-way SIMD
-				int colorContactCountSIMD = colorContactCount > 0 ? ( ( colorContactCount - 1 ) >> B2_SIMD_SHIFT ) + 1 : 0;
+				// Revolute and weld joints are packed into SIMD lanes, the rest are solved one at a time
+				int colorLaneJointCount = 0;
+				for ( int k = 0; k < colorJointCount; ++k )
+				{
+					colorLaneJointCount += b2IsSIMDJoint( colors[i].jointSims.data + k ) ? 1 : 0;
+				}
+				int colorJointCountSIMD = colorLaneJointCount > 0 ? ( ( colorLaneJointCount - 1 ) >> simdShift ) + 1 : 0;
+				colorJointCount -= colorLaneJointCount;
+
+				// 4/8/16-way SIMD
+				int colorContactCountSIMD = colorContactCount > 0 ? ( ( colorContactCount - 1 ) >> simdShift ) + 1 : 0;
 
 				colorContactCounts[c] = colorContactCountSIMD;
 
@@ -1396,8 +1780,29 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 					colorJointBlockCounts[c] = 0;
 				}
 
-				graphBlockCount += colorContactBlockCounts[c] + colorJointBlockCounts[c];
+				colorSIMDJointCounts[c] = colorJointCountSIMD;
+
+				// determine the number of SIMD joint work blocks for this color
+				if ( colorJointCountSIMD > blocksPerWorker * maxBlockCount )
+				{
+					colorSIMDJointBlockSizes[c] = colorJointCountSIMD / maxBlockCount;
+					colorSIMDJointBlockCounts[c] = maxBlockCount;
+				}
+				else if ( colorJointCountSIMD > 0 )
+				{
+					colorSIMDJointBlockSizes[c] = blocksPerWorker;
+					colorSIMDJointBlockCounts[c] = ( ( colorJointCountSIMD - 1 ) >> 2 ) + 1;
+				}
+				else
+				{
+					colorSIMDJointBlockSizes[c] = 0;
+					colorSIMDJointBlockCounts[c] = 0;
+				}
+
+				graphBlockCount += colorContactBlockCounts[c] + colorJointBlockCounts[c] + colorSIMDJointBlockCounts[c];
 				simdContactCount += colorContactCountSIMD;
+				scalarJointCount += colorJointCount;
+				simdJointCount += colorJointCountSIMD;
 				c += 1;
 			}
 		}
@@ -1405,25 +1810,43 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 		// Gather contact pointers for easy parallel-for traversal. Some may be NULL due to SIMD remainders.
 		b2ContactSim** contacts =
-			b2AllocateArenaItem( &world->arena, B2_SIMD_WIDTH * simdContactCount * sizeof( b2ContactSim* ), "contact pointers" );
+			b2AllocateArenaItem( &world->arena, simdWidth * simdContactCount * sizeof( b2ContactSim* ), "contact pointers" );
 
 		// Gather joint pointers for easy parallel-for traversal.
-		b2JointSim** joints = b2AllocateArenaItem( &world->arena, awakeJointCount * sizeof( b2JointSim* ), "joint pointers" );
+		b2JointSim** joints = b2AllocateArenaItem( &world->arena, scalarJointCount * sizeof( b2JointSim* ), "joint pointers" );
+
+		// SIMD joint pointers may be NULL due to SIMD remainders.
+		b2JointSim** simdJoints =
+			b2AllocateArenaItem( &world->arena, simdWidth * simdJointCount * sizeof( b2JointSim* ), "simd joint pointers" );
 
-		int simdConstraintSize = b2GetContactConstraintSIMDByteCount();
+		int simdConstraintSize = stepContext->simd->getContactConstraintByteCount();
 		b2ContactConstraintSIMD* simdContactConstraints =
 			b2AllocateArenaItem( &world->arena, simdContactCount * simdConstraintSize, "contact constraint" );
 
+		int simdJointConstraintSize = stepContext->simd->getJointConstraintByteCount();
+		b2JointConstraintSIMD* simdJointConstraints =
+			b2AllocateArenaItem( &world->arena, simdJointCount * simdJointConstraintSize, "joint constraint" );
+
 		int overflowContactCount = colors[B2_OVERFLOW_INDEX].contactSims.count;
 		b2ContactConstraint* overflowContactConstraints = b2AllocateArenaItem(
 			&world->arena, overflowContactCount * sizeof( b2ContactConstraint ), "overflow contact constraint" );
 
 		graph->colors[B2_OVERFLOW_INDEX].overflowConstraints = overflowContactConstraints;
 
+		// A single worker solves the overflow in one block to avoid stage overhead
+		int overflowBlockCount =
+			b2PrepareOverflowBlocks( world, stepContext, awakeBodyCount, workerCount > 1 ? maxBlockCount : 1 );
+		stepContext->overflowBlockCount = overflowBlockCount;
+
+		// The overflow is solved in its own stage before each group of color stages
+		int overflowStageCount = overflowBlockCount > 0 ? 1 : 0;
+		int colorStageCount = overflowStageCount + activeColorCount;
+
 		// Distribute transient constraints to each graph color and build flat arrays of contact and joint pointers
 		{
 			int contactBase = 0;
 			int jointBase = 0;
+			int simdJointBase = 0;
 			for ( int i = 0; i < activeColorCount; ++i )
 			{
 				int j = activeColorIndices[i];
@@ -1442,29 +1865,53 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 					for ( int k = 0; k < colorContactCount; ++k )
 					{
-						contacts[B2_SIMD_WIDTH * contactBase + k] = color->contactSims.data + k;
+						contacts[simdWidth * contactBase + k] = color->contactSims.data + k;
 					}
 
 					// remainder
-					int colorContactCountSIMD = ( ( colorContactCount - 1 ) >> B2_SIMD_SHIFT ) + 1;
-					for ( int k = colorContactCount; k < B2_SIMD_WIDTH * colorContactCountSIMD; ++k )
+					int colorContactCountSIMD = ( ( colorContactCount - 1 ) >> simdShift ) + 1;
+					for ( int k = colorContactCount; k < simdWidth * colorContactCountSIMD; ++k )
 					{
-						contacts[B2_SIMD_WIDTH * contactBase + k] = NULL;
+						contacts[simdWidth * contactBase + k] = NULL;
 					}
 
 					contactBase += colorContactCountSIMD;
 				}
 
+				color->scalarJoints = joints + jointBase;
+				color->simdJoints =
+					(b2JointConstraintSIMD*)( (uint8_t*)simdJointConstraints + simdJointBase * simdJointConstraintSize );
+
 				int colorJointCount = color->jointSims.count;
+				int laneCount = 0;
 				for ( int k = 0; k < colorJointCount; ++k )
 				{
-					joints[jointBase + k] = color->jointSims.data + k;
+					b2JointSim* joint = color->jointSims.data + k;
+					if ( b2IsSIMDJoint( joint ) )
+					{
+						simdJoints[simdWidth * simdJointBase + laneCount] = joint;
+						laneCount += 1;
+					}
+					else
+					{
+						joints[jointBase] = joint;
+						jointBase += 1;
+					}
 				}
-				jointBase += colorJointCount;
+
+				// remainder
+				int colorJointCountSIMD = colorSIMDJointCounts[i];
+				for ( int k = laneCount; k < simdWidth * colorJointCountSIMD; ++k )
+				{
+					simdJoints[simdWidth * simdJointBase + k] = NULL;
+				}
+
+				simdJointBase += colorJointCountSIMD;
 			}
 
 			B2_ASSERT( contactBase == simdContactCount );
-			B2_ASSERT( jointBase == awakeJointCount );
+			B2_ASSERT( jointBase == scalarJointCount );
+			B2_ASSERT( simdJointBase == simdJointCount );
 		}
 
 		// Define work blocks for preparing contacts and storing contact impulses
@@ -1479,14 +1926,24 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 		// Define work blocks for preparing joints
 		int jointBlockSize = blocksPerWorker;
-		int jointBlockCount = awakeJointCount > 0 ? ( ( awakeJointCount - 1 ) >> 2 ) + 1 : 0;
-		if ( awakeJointCount > jointBlockSize * maxBlockCount )
+		int jointBlockCount = scalarJointCount > 0 ? ( ( scalarJointCount - 1 ) >> 2 ) + 1 : 0;
+		if ( scalarJointCount > jointBlockSize * maxBlockCount )
 		{
 			// Too many blocks, increase block size
-			jointBlockSize = awakeJointCount / maxBlockCount;
+			jointBlockSize = scalarJointCount / maxBlockCount;
 			jointBlockCount = maxBlockCount;
 		}
 
+		// Define work blocks for preparing SIMD joints and storing their impulses
+		int simdJointBlockSize = blocksPerWorker;
+		int simdJointBlockCount = simdJointCount > 0 ? ( ( simdJointCount - 1 ) >> 2 ) + 1 : 0;
+		if ( simdJointCount > simdJointBlockSize * maxBlockCount )
+		{
+			// Too many blocks, increase block size
+			simdJointBlockSize = simdJointCount / maxBlockCount;
+			simdJointBlockCount = maxBlockCount;
+		}
+
 		int stageCount = 0;
 
 		// b2_stagePrepareJoints
@@ -1496,27 +1953,41 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		// b2_stageIntegrateVelocities
 		stageCount += 1;
 		// b2_stageWarmStart
-		stageCount += activeColorCount;
+		stageCount += colorStageCount;
 		// b2_stageSolve
-		stageCount += ITERATIONS * activeColorCount;
+		stageCount += ITERATIONS * colorStageCount;
 		// b2_stageIntegratePositions
 		stageCount += 1;
 		// b2_stageRelax
-		stageCount += RELAX_ITERATIONS * activeColorCount;
+		stageCount += RELAX_ITERATIONS * colorStageCount;
 		// b2_stageRestitution
-		stageCount += activeColorCount;
+		stageCount += colorStageCount;
 		// b2_stageStoreImpulses
 		stageCount += 1;
 
 		b2SolverStage* stages = b2AllocateArenaItem( &world->arena, stageCount * sizeof( b2SolverStage ), "stages" );
 		b2SolverBlock* bodyBlocks = b2AllocateArenaItem( &world->arena, bodyBlockCount * sizeof( b2SolverBlock ), "body blocks" );
-		b2SolverBlock* contactBlocks =
-			b2AllocateArenaItem( &world->arena, contactBlockCount * sizeof( b2SolverBlock ), "contact blocks" );
-		b2SolverBlock* jointBlocks =
-			b2AllocateArenaItem( &world->arena, jointBlockCount * sizeof( b2SolverBlock ), "joint blocks" );
+
+		// Contact blocks followed by overflow blocks
+		b2SolverBlock* contactBlocks = b2AllocateArenaItem(
+			&world->arena, ( contactBlockCount + overflowBlockCount ) * sizeof( b2SolverBlock ), "contact blocks" );
+
+		// Scalar joint blocks followed by SIMD joint blocks
+		b2SolverBlock* jointBlocks = b2AllocateArenaItem(
+			&world->arena, ( jointBlockCount + simdJointBlockCount ) * sizeof( b2SolverBlock ), "joint blocks" );
+		b2SolverBlock* simdJointBlocks = jointBlocks + jointBlockCount;
+
+		// SIMD joint blocks followed by contact blocks and overflow blocks
+		int storeBlockCount = simdJointBlockCount + contactBlockCount + overflowBlockCount;
+		b2SolverBlock* storeBlocks =
+			b2AllocateArenaItem( &world->arena, storeBlockCount * sizeof( b2SolverBlock ), "store blocks" );
 		b2SolverBlock* graphBlocks =
 			b2AllocateArenaItem( &world->arena, graphBlockCount * sizeof( b2SolverBlock ), "graph blocks" );
 
+		// Overflow blocks shared by the warm start, solve, relax, and restitution stages
+		b2SolverBlock* overflowBlocks =
+			b2AllocateArenaItem( &world->arena, overflowBlockCount * sizeof( b2SolverBlock ), "overflow blocks" );
+
 		// Split an awake island. This modifies:
 		// - stack allocator
 		// - world island array and solver set
@@ -1554,7 +2025,23 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 		if ( jointBlockCount > 0 )
 		{
-			jointBlocks[jointBlockCount - 1].count = (int16_t)( awakeJointCount - ( jointBlockCount - 1 ) * jointBlockSize );
+			jointBlocks[jointBlockCount - 1].count = (int16_t)( scalarJointCount - ( jointBlockCount - 1 ) * jointBlockSize );
+		}
+
+		// Prepare SIMD joint work blocks
+		for ( int i = 0; i < simdJointBlockCount; ++i )
+		{
+			b2SolverBlock* block = simdJointBlocks + i;
+			block->startIndex = i * simdJointBlockSize;
+			block->count = (int16_t)simdJointBlockSize;
+			block->blockType = b2_jointSIMDBlock;
+			b2AtomicStoreInt( &block->syncIndex, 0 );
+		}
+
+		if ( simdJointBlockCount > 0 )
+		{
+			simdJointBlocks[simdJointBlockCount - 1].count =
+				(int16_t)( simdJointCount - ( simdJointBlockCount - 1 ) * simdJointBlockSize );
 		}
 
 		// Prepare contact work blocks
@@ -1573,6 +2060,24 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 				(int16_t)( simdContactCount - ( contactBlockCount - 1 ) * contactBlockSize );
 		}
 
+		// Prepare overflow work blocks. These cover whole sets of overflow constraints.
+		for ( int i = 0; i < overflowBlockCount; ++i )
+		{
+			b2SolverBlock* block = overflowBlocks + i;
+			block->startIndex = i;
+			block->count = 1;
+			block->blockType = b2_overflowBlock;
+			b2AtomicStoreInt( &block->syncIndex, 0 );
+		}
+
+		// Overflow prepare runs alongside the contact prepare
+		memcpy( contactBlocks + contactBlockCount, overflowBlocks, overflowBlockCount * sizeof( b2SolverBlock ) );
+
+		// Store impulse work blocks have their own sync index
+		memcpy( storeBlocks, simdJointBlocks, simdJointBlockCount * sizeof( b2SolverBlock ) );
+		memcpy( storeBlocks + simdJointBlockCount, contactBlocks,
+				( contactBlockCount + overflowBlockCount ) * sizeof( b2SolverBlock ) );
+
 		// Prepare graph work blocks
 		b2SolverBlock* graphColorBlocks[B2_GRAPH_COLOR_COUNT];
 		b2SolverBlock* baseGraphBlock = graphBlocks;
@@ -1599,6 +2104,24 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 				baseGraphBlock += colorJointBlockCount;
 			}
 
+			int colorSIMDJointBlockCount = colorSIMDJointBlockCounts[i];
+			int colorSIMDJointBlockSize = colorSIMDJointBlockSizes[i];
+			for ( int j = 0; j < colorSIMDJointBlockCount; ++j )
+			{
+				b2SolverBlock* block = baseGraphBlock + j;
+				block->startIndex = j * colorSIMDJointBlockSize;
+				block->count = (int16_t)colorSIMDJointBlockSize;
+				block->blockType = b2_graphJointSIMDBlock;
+				b2AtomicStoreInt( &block->syncIndex, 0 );
+			}
+
+			if ( colorSIMDJointBlockCount > 0 )
+			{
+				baseGraphBlock[colorSIMDJointBlockCount - 1].count =
+					(int16_t)( colorSIMDJointCounts[i] - ( colorSIMDJointBlockCount - 1 ) * colorSIMDJointBlockSize );
+				baseGraphBlock += colorSIMDJointBlockCount;
+			}
+
 			int colorContactBlockCount = colorContactBlockCounts[i];
 			int colorContactBlockSize = colorContactBlockSizes[i];
 			for ( int j = 0; j < colorContactBlockCount; ++j )
@@ -1625,7 +2148,7 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		// Prepare joints
 		stage->type = b2_stagePrepareJoints;
 		stage->blocks = jointBlocks;
-		stage->blockCount = jointBlockCount;
+		stage->blockCount = jointBlockCount + simdJointBlockCount;
 		stage->colorIndex = -1;
 		b2AtomicStoreInt( &stage->completionCount, 0 );
 		stage += 1;
@@ -1633,7 +2156,7 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		// Prepare contacts
 		stage->type = b2_stagePrepareContacts;
 		stage->blocks = contactBlocks;
-		stage->blockCount = contactBlockCount;
+		stage->blockCount = contactBlockCount + overflowBlockCount;
 		stage->colorIndex = -1;
 		b2AtomicStoreInt( &stage->completionCount, 0 );
 		stage += 1;
@@ -1647,11 +2170,21 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		stage += 1;
 
 		// Warm start
+		if ( overflowStageCount > 0 )
+		{
+			stage->type = b2_stageWarmStart;
+			stage->blocks = overflowBlocks;
+			stage->blockCount = overflowBlockCount;
+			stage->colorIndex = B2_OVERFLOW_INDEX;
+			b2AtomicStoreInt( &stage->completionCount, 0 );
+			stage += 1;
+		}
+
 		for ( int i = 0; i < activeColorCount; ++i )
 		{
 			stage->type = b2_stageWarmStart;
 			stage->blocks = graphColorBlocks[i];
-			stage->blockCount = colorJointBlockCounts[i] + colorContactBlockCounts[i];
+			stage->blockCount = colorJointBlockCounts[i] + colorSIMDJointBlockCounts[i] + colorContactBlockCounts[i];
 			stage->colorIndex = activeColorIndices[i];
 			b2AtomicStoreInt( &stage->completionCount, 0 );
 			stage += 1;
@@ -1660,11 +2193,21 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		// Solve graph
 		for ( int j = 0; j < ITERATIONS; ++j )
 		{
+			if ( overflowStageCount > 0 )
+			{
+				stage->type = b2_stageSolve;
+				stage->blocks = overflowBlocks;
+				stage->blockCount = overflowBlockCount;
+				stage->colorIndex = B2_OVERFLOW_INDEX;
+				b2AtomicStoreInt( &stage->completionCount, 0 );
+				stage += 1;
+			}
+
 			for ( int i = 0; i < activeColorCount; ++i )
 			{
 				stage->type = b2_stageSolve;
 				stage->blocks = graphColorBlocks[i];
-				stage->blockCount = colorJointBlockCounts[i] + colorContactBlockCounts[i];
+				stage->blockCount = colorJointBlockCounts[i] + colorSIMDJointBlockCounts[i] + colorContactBlockCounts[i];
 				stage->colorIndex = activeColorIndices[i];
 				b2AtomicStoreInt( &stage->completionCount, 0 );
 				stage += 1;
@@ -1682,11 +2225,21 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		// Relax constraints
 		for ( int j = 0; j < RELAX_ITERATIONS; ++j )
 		{
+			if ( overflowStageCount > 0 )
+			{
+				stage->type = b2_stageRelax;
+				stage->blocks = overflowBlocks;
+				stage->blockCount = overflowBlockCount;
+				stage->colorIndex = B2_OVERFLOW_INDEX;
+				b2AtomicStoreInt( &stage->completionCount, 0 );
+				stage += 1;
+			}
+
 			for ( int i = 0; i < activeColorCount; ++i )
 			{
 				stage->type = b2_stageRelax;
 				stage->blocks = graphColorBlocks[i];
-				stage->blockCount = colorJointBlockCounts[i] + colorContactBlockCounts[i];
+				stage->blockCount = colorJointBlockCounts[i] + colorSIMDJointBlockCounts[i] + colorContactBlockCounts[i];
 				stage->colorIndex = activeColorIndices[i];
 				b2AtomicStoreInt( &stage->completionCount, 0 );
 				stage += 1;
@@ -1695,11 +2248,21 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 		// Restitution
 		// Note: joint blocks mixed in, could have joint limit restitution
+		if ( overflowStageCount > 0 )
+		{
+			stage->type = b2_stageRestitution;
+			stage->blocks = overflowBlocks;
+			stage->blockCount = overflowBlockCount;
+			stage->colorIndex = B2_OVERFLOW_INDEX;
+			b2AtomicStoreInt( &stage->completionCount, 0 );
+			stage += 1;
+		}
+
 		for ( int i = 0; i < activeColorCount; ++i )
 		{
 			stage->type = b2_stageRestitution;
 			stage->blocks = graphColorBlocks[i];
-			stage->blockCount = colorJointBlockCounts[i] + colorContactBlockCounts[i];
+			stage->blockCount = colorJointBlockCounts[i] + colorSIMDJointBlockCounts[i] + colorContactBlockCounts[i];
 			stage->colorIndex = activeColorIndices[i];
 			b2AtomicStoreInt( &stage->completionCount, 0 );
 			stage += 1;
@@ -1707,8 +2270,8 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 		// Store impulses
 		stage->type = b2_stageStoreImpulses;
-		stage->blocks = contactBlocks;
-		stage->blockCount = contactBlockCount;
+		stage->blocks = storeBlocks;
+		stage->blockCount = storeBlockCount;
 		stage->colorIndex = -1;
 		b2AtomicStoreInt( &stage->completionCount, 0 );
 		stage += 1;
@@ -1720,6 +2283,8 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 		stepContext->graph = graph;
 		stepContext->joints = joints;
+		stepContext->simdJoints = simdJoints;
+		stepContext->simdJointConstraints = simdJointConstraints;
 		stepContext->contacts = contacts;
 		stepContext->simdContactConstraints = simdContactConstraints;
 		stepContext->activeColorCount = activeColorCount;
@@ -1727,6 +2292,8 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		stepContext->stageCount = stageCount;
 		stepContext->stages = stages;
 		b2AtomicStoreU32( &stepContext->atomicSyncBits, 0 );
+		b2AtomicStoreInt( &stepContext->sleepingWorkerCount, 0 );
+		b2AtomicStoreInt( &stepContext->mainSleeping, 0 );
 
 		world->profile.prepareStages = b2GetMillisecondsAndReset( &prepareTicks );
 		b2TracyCZoneEnd( prepare_stages );
@@ -1743,6 +2310,8 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 
 			workerContext[i].context = stepContext;
 			workerContext[i].workerIndex = i;
+			memset( workerContext[i].spinTime, 0, sizeof( workerContext[i].spinTime ) );
+			memset( workerContext[i].sleepTime, 0, sizeof( workerContext[i].sleepTime ) );
 			workerContext[i].userTask = world->enqueueTaskFcn( b2SolverTask, 1, 1, workerContext + i, world->userTaskContext );
 			world->taskCount += 1;
 			world->activeTaskCount += workerContext[i].userTask == NULL ? 0 : 1;
@@ -1766,6 +2335,15 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 			}
 		}
 
+		for ( int i = 0; i < workerCount; ++i )
+		{
+			for ( int j = 0; j < b2_solverStageCount; ++j )
+			{
+				world->profile.stageSpin[j] += workerContext[i].spinTime[j];
+				world->profile.stageSleep[j] += workerContext[i].sleepTime[j];
+			}
+		}
+
 		world->profile.solveConstraints = b2GetMillisecondsAndReset( &constraintTicks );
 		b2TracyCZoneEnd( solve_constraints );
 
@@ -1793,13 +2371,21 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 			world->finishTaskFcn( finalizeBodiesTask, world->userTaskContext );
 		}
 
+		b2FreeArenaItem( &world->arena, overflowBlocks );
 		b2FreeArenaItem( &world->arena, graphBlocks );
+		b2FreeArenaItem( &world->arena, storeBlocks );
 		b2FreeArenaItem( &world->arena, jointBlocks );
 		b2FreeArenaItem( &world->arena, contactBlocks );
 		b2FreeArenaItem( &world->arena, bodyBlocks );
 		b2FreeArenaItem( &world->arena, stages );
+		b2FreeArenaItem( &world->arena, stepContext->overflowContactStarts );
+		b2FreeArenaItem( &world->arena, stepContext->overflowJointStarts );
+		b2FreeArenaItem( &world->arena, stepContext->overflowContacts );
+		b2FreeArenaItem( &world->arena, stepContext->overflowJoints );
 		b2FreeArenaItem( &world->arena, overflowContactConstraints );
+		b2FreeArenaItem( &world->arena, simdJointConstraints );
 		b2FreeArenaItem( &world->arena, simdContactConstraints );
+		b2FreeArenaItem( &world->arena, simdJoints );
 		b2FreeArenaItem( &world->arena, joints );
 		b2FreeArenaItem( &world->arena, contacts );
 
@@ -1929,15 +2515,7 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 		b2TracyCZoneNC( refit_bvh, "Refit BVH", b2_colorFireBrick, true );
 		uint64_t refitTicks = b2GetTicks();
 
-		// Finish the user tree task that was queued earlier in the time step. This must be complete before touching the
-		// broad-phase.
-		if ( world->userTreeTask != NULL )
-		{
-			world->finishTaskFcn( world->userTreeTask, world->userTaskContext );
-			world->userTreeTask = NULL;
-			world->activeTaskCount -= 1;
-		}
-
+		// The trees were rebuilt during the narrow phase
 		b2ValidateNoEnlarged( &world->broadPhase );
 
 		// Gather bits for all sim bodies that have enlarged AABBs
@@ -2083,7 +2661,7 @@ void b2Solve( b2World* world, b2StepContext* stepContext )
 				B2_ASSERT( B2_PROXY_TYPE( proxyKey ) == b2_dynamicBody );
 
 				// all fast bullet shapes should already be in the move buffer
-				B2_ASSERT( b2ContainsKey( &broadPhase->moveSet, proxyKey + 1 ) );
+				B2_ASSERT( b2ContainsKey32( &broadPhase->moveSet, (uint32_t)proxyKey ) );
 
 				b2DynamicTree_EnlargeProxy( dynamicTree, proxyId, shape->fatAABB );
 
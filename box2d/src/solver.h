@@ -6,6 +6,7 @@
 #include "core.h"
 
 #include "box2d/math_functions.h"
+#include "box2d/types.h"
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -23,26 +24,16 @@ typedef struct b2Softness
 	float impulseScale;
 } b2Softness;
 
-typedef enum b2SolverStageType
-{
-	b2_stagePrepareJoints,
-	b2_stagePrepareContacts,
-	b2_stageIntegrateVelocities,
-	b2_stageWarmStart,
-	b2_stageSolve,
-	b2_stageIntegratePositions,
-	b2_stageRelax,
-	b2_stageRestitution,
-	b2_stageStoreImpulses
-} b2SolverStageType;
-
 typedef enum b2SolverBlockType
 {
 	b2_bodyBlock,
 	b2_jointBlock,
 	b2_contactBlock,
 	b2_graphJointBlock,
-	b2_graphContactBlock
+	b2_graphContactBlock,
+	b2_jointSIMDBlock,
+	b2_graphJointSIMDBlock,
+	b2_overflowBlock
 } b2SolverBlockType;
 
 // Each block of work has a sync index that gets incremented when a worker claims the block. This ensures only a single worker
@@ -94,6 +85,7 @@ typedef struct b2StepContext
 
 	struct b2World* world;
 	struct b2ConstraintGraph* graph;
+	const struct b2SIMDKernels* simd;
 
 	// shortcut to body states from awake set
 	b2BodyState* states;
@@ -110,8 +102,13 @@ typedef struct b2StepContext
 	b2AtomicInt bulletBodyCount;
 
 	// joint pointers for simplified parallel-for access.
+	// these are the graph color joints that are solved one at a time
 	b2JointSim** joints;
 
+	// graph color joints solved in SIMD lanes, with NULL gaps for SIMD remainders
+	b2JointSim** simdJoints;
+	struct b2JointConstraintSIMD* simdJointConstraints;
+
 	// contact pointers for simplified parallel-for access.
 	// - parallel-for collide with no gaps
 	// - parallel-for prepare and store contacts with NULL gaps for SIMD remainders
@@ -120,12 +117,23 @@ typedef struct b2StepContext
 	b2ContactSim** contacts;
 
 	struct b2ContactConstraintSIMD* simdContactConstraints;
+
+	// The overflow constraints are split into sets that share no awake body. These permutations
+	// keep each set contiguous and an overflow block covers whole sets, so blocks can run in parallel.
+	// Overflow block i covers joints [overflowJointStarts[i], overflowJointStarts[i + 1]) and likewise for contacts.
+	int* overflowJoints;
+	int* overflowContacts;
+	int* overflowJointStarts;
+	int* overflowContactStarts;
+	int overflowBlockCount;
+
 	int activeColorCount;
 	int workerCount;
 
 	b2SolverStage* stages;
 	int stageCount;
 	bool enableWarmStarting;
+	b2SolverWaitType waitType;
 
 	// todo padding to prevent false sharing
 	char dummy1[64];
@@ -133,6 +141,11 @@ typedef struct b2StepContext
 	// sync index (16-bits) | stage type (16-bits)
 	b2AtomicU32 atomicSyncBits;
 
+	// Workers sleeping on the sync bits and whether the main thread sleeps on a stage completion count.
+	// These let the signaling side skip the wake call when nobody sleeps.
+	b2AtomicInt sleepingWorkerCount;
+	b2AtomicInt mainSleeping;
+
 	char dummy2[64];
 
 } b2StepContext;
@@ -181,4 +194,9 @@ static inline b2Softness b2MakeSoft( float hertz, float zeta, float h )
 	};
 }
 
+// Scalar body integration, also used for the remainder of the wide versions in contact_solver.c
+void b2IntegrateVelocities( b2BodySim* sims, b2BodyState* states, int count, b2Vec2 gravity, float h, float maxLinearSpeed,
+							float maxAngularSpeed );
+void b2IntegratePositions( b2BodyState* states, int count, float h );
+
 void b2Solve( b2World* world, b2StepContext* stepContext );
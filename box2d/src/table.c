@@ -10,47 +10,24 @@
 #include <stdbool.h>
 #include <string.h>
 
+#if defined( B2_SIMD_AVX512 ) || defined( B2_SIMD_AVX2 ) || defined( B2_SIMD_SSE2 )
+#include <emmintrin.h>
+#elif defined( B2_SIMD_NEON )
+#include <arm_neon.h>
+#endif
+
 #if B2_SNOOP_TABLE_COUNTERS
 b2AtomicInt b2_findCount;
 b2AtomicInt b2_probeCount;
+#define B2_SNOOP_FIND() b2AtomicFetchAddInt( &b2_findCount, 1 )
+#define B2_SNOOP_PROBE() b2AtomicFetchAddInt( &b2_probeCount, 1 )
+#else
+#define B2_SNOOP_FIND()
+#define B2_SNOOP_PROBE()
 #endif
 
-// todo compare with https://github.com/skeeto/scratch/blob/master/set32/set32.h
-
-b2HashSet b2CreateSet( int capacity )
-{
-	b2HashSet set = { 0 };
-
-	// Capacity must be a power of 2
-	if ( capacity > 16 )
-	{
-		set.capacity = b2RoundUpPowerOf2( capacity );
-	}
-	else
-	{
-		set.capacity = 16;
-	}
-
-	set.count = 0;
-	set.items = b2Alloc( capacity * sizeof( b2SetItem ) );
-	memset( set.items, 0, capacity * sizeof( b2SetItem ) );
-
-	return set;
-}
-
-void b2DestroySet( b2HashSet* set )
-{
-	b2Free( set->items, set->capacity * sizeof( b2SetItem ) );
-	set->items = NULL;
-	set->count = 0;
-	set->capacity = 0;
-}
-
-void b2ClearSet( b2HashSet* set )
-{
-	set->count = 0;
-	memset( set->items, 0, set->capacity * sizeof( b2SetItem ) );
-}
+// Control byte of an empty slot. Occupied slots hold a 7 bit tag from the hash.
+#define B2_SET_EMPTY 0x80
 
 // I need a good hash because the keys are built from pairs of increasing integers.
 // A simple hash like hash = (integer1 XOR integer2) has many collisions.
@@ -58,7 +35,7 @@ void b2ClearSet( b2HashSet* set )
 // https://preshing.com/20130107/this-hash-set-is-faster-than-a-judy-array/
 // todo try: https://www.jandrewrogers.com/2019/02/12/fast-perfect-hashing/
 // todo try: https://probablydance.com/2018/06/16/fibonacci-hashing-the-optimization-that-the-world-forgot-or-a-better-alternative-to-integer-modulo/
-static uint32_t b2KeyHash( uint64_t key )
+static inline uint32_t b2KeyHash( uint64_t key )
 {
 	// Murmur hash
 	uint64_t h = key;
@@ -71,168 +48,296 @@ static uint32_t b2KeyHash( uint64_t key )
 	return (uint32_t)h;
 }
 
-static int b2FindSlot( const b2HashSet* set, uint64_t key, uint32_t hash )
+static inline uint32_t b2KeyHash32( uint32_t key )
 {
-#if B2_SNOOP_TABLE_COUNTERS 
-		b2AtomicFetchAddInt( &b2_findCount, 1 );
-#endif
-
-	uint32_t capacity = set->capacity;
-	int index = hash & ( capacity - 1 );
-	const b2SetItem* items = set->items;
-	while ( items[index].hash != 0 && items[index].key != key )
-	{
-#if B2_SNOOP_TABLE_COUNTERS
-		b2AtomicFetchAddInt( &b2_probeCount, 1 );
-#endif
-		index = ( index + 1 ) & ( capacity - 1 );
-	}
+	// Murmur3 finalizer
+	uint32_t h = key;
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+
+	return h;
+}
 
-	return index;
+// The low bits of the hash pick the slot and the high bits make the tag
+static inline uint8_t b2HashTag( uint32_t hash )
+{
+	return (uint8_t)( hash >> 25 );
 }
 
-static void b2AddKeyHaveCapacity( b2HashSet* set, uint64_t key, uint32_t hash )
+// Grow at 3/4 load
+static inline bool b2ShouldGrow( uint32_t count, uint32_t capacity )
 {
-	int index = b2FindSlot( set, key, hash );
-	b2SetItem* items = set->items;
-	B2_ASSERT( items[index].hash == 0 );
+	return 4 * (uint64_t)count > 3 * (uint64_t)capacity;
+}
 
-	items[index].key = key;
-	items[index].hash = hash;
-	set->count += 1;
+// Shrink below 1/8 load, which leaves the smaller set below 1/4 load
+static inline bool b2ShouldShrink( uint32_t count, uint32_t capacity )
+{
+	return 8 * (uint64_t)count < capacity;
 }
 
-static void b2GrowTable( b2HashSet* set )
+// Writes a control byte and its mirror past the end of the array
+static inline void b2SetControl( uint8_t* controls, uint32_t capacity, uint32_t index, uint8_t control )
 {
-	uint32_t oldCount = set->count;
-	B2_UNUSED( oldCount );
+	controls[index] = control;
+	if ( index < B2_SET_GROUP_SIZE - 1 )
+	{
+		controls[capacity + index] = control;
+	}
+}
 
-	uint32_t oldCapacity = set->capacity;
-	b2SetItem* oldItems = set->items;
+// Group matching gives a bit mask over the group. The slot of a set bit is its index shifted down by
+// B2_GROUP_MASK_SHIFT.
+#if defined( B2_SIMD_AVX512 ) || defined( B2_SIMD_AVX2 ) || defined( B2_SIMD_SSE2 )
 
-	set->count = 0;
-	// Capacity must be a power of 2
-	set->capacity = 2 * oldCapacity;
-	set->items = b2Alloc( set->capacity * sizeof( b2SetItem ) );
-	memset( set->items, 0, set->capacity * sizeof( b2SetItem ) );
+typedef uint32_t b2GroupMask;
+#define B2_GROUP_MASK_SHIFT 0
 
-	// Transfer items into new array
-	for ( uint32_t i = 0; i < oldCapacity; ++i )
-	{
-		b2SetItem* item = oldItems + i;
-		if ( item->hash == 0 )
-		{
-			// this item was empty
-			continue;
-		}
+static inline b2GroupMask b2MatchGroup( const uint8_t* group, uint8_t tag )
+{
+	__m128i controls = _mm_loadu_si128( (const __m128i*)group );
+	return (uint32_t)_mm_movemask_epi8( _mm_cmpeq_epi8( controls, _mm_set1_epi8( (char)tag ) ) );
+}
 
-		b2AddKeyHaveCapacity( set, item->key, item->hash );
-	}
+// Only the empty control byte has the high bit set
+static inline b2GroupMask b2MatchEmpty( const uint8_t* group )
+{
+	return (uint32_t)_mm_movemask_epi8( _mm_loadu_si128( (const __m128i*)group ) );
+}
 
-	B2_ASSERT( set->count == oldCount );
+#elif defined( B2_SIMD_NEON )
 
-	b2Free( oldItems, oldCapacity * sizeof( b2SetItem ) );
-}
+// NEON has no movemask. Narrowing the comparison gives a nibble per slot, keep one bit of each.
+typedef uint64_t b2GroupMask;
+#define B2_GROUP_MASK_SHIFT 2
 
-bool b2ContainsKey( const b2HashSet* set, uint64_t key )
+static inline b2GroupMask b2NarrowMask( uint8x16_t match )
 {
-	// key of zero is a sentinel
-	B2_ASSERT( key != 0 );
-	uint32_t hash = b2KeyHash( key );
-	int index = b2FindSlot( set, key, hash );
-	return set->items[index].key == key;
+	uint8x8_t nibbles = vshrn_n_u16( vreinterpretq_u16_u8( match ), 4 );
+	return vget_lane_u64( vreinterpret_u64_u8( nibbles ), 0 ) & 0x8888888888888888ull;
 }
 
-int b2GetHashSetBytes( b2HashSet* set )
+static inline b2GroupMask b2MatchGroup( const uint8_t* group, uint8_t tag )
 {
-	return set->capacity * (int)sizeof( b2SetItem );
+	return b2NarrowMask( vceqq_u8( vld1q_u8( group ), vdupq_n_u8( tag ) ) );
 }
 
-bool b2AddKey( b2HashSet* set, uint64_t key )
+static inline b2GroupMask b2MatchEmpty( const uint8_t* group )
 {
-	// key of zero is a sentinel
-	B2_ASSERT( key != 0 );
+	return b2NarrowMask( vceqq_u8( vld1q_u8( group ), vdupq_n_u8( B2_SET_EMPTY ) ) );
+}
 
-	uint32_t hash = b2KeyHash( key );
-	B2_ASSERT( hash != 0 );
+#else
 
-	int index = b2FindSlot( set, key, hash );
-	if ( set->items[index].hash != 0 )
-	{
-		// Already in set
-		B2_ASSERT( set->items[index].hash == hash && set->items[index].key == key );
-		return true;
-	}
+typedef uint32_t b2GroupMask;
+#define B2_GROUP_MASK_SHIFT 0
 
-	if ( 2 * set->count >= set->capacity )
+static inline b2GroupMask b2MatchGroup( const uint8_t* group, uint8_t tag )
+{
+	b2GroupMask mask = 0;
+	for ( int i = 0; i < B2_SET_GROUP_SIZE; ++i )
 	{
-		b2GrowTable( set );
+		mask |= (b2GroupMask)( group[i] == tag ) << i;
 	}
-
-	b2AddKeyHaveCapacity( set, key, hash );
-	return false;
+	return mask;
 }
 
-// See https://en.wikipedia.org/wiki/Open_addressing
-bool b2RemoveKey( b2HashSet* set, uint64_t key )
+static inline b2GroupMask b2MatchEmpty( const uint8_t* group )
 {
-	uint32_t hash = b2KeyHash( key );
-	int i = b2FindSlot( set, key, hash );
-	b2SetItem* items = set->items;
-	if ( items[i].hash == 0 )
-	{
-		// Not in set
-		return false;
-	}
-
-	// Mark item i as unoccupied
-	items[i].key = 0;
-	items[i].hash = 0;
+	return b2MatchGroup( group, B2_SET_EMPTY );
+}
 
-	B2_ASSERT( set->count > 0 );
-	set->count -= 1;
+#endif
 
-	// Attempt to fill item i
-	int j = i;
-	uint32_t capacity = set->capacity;
+// First empty slot of the probe sequence for a hash
+static inline int b2FindEmpty( const uint8_t* controls, uint32_t capacity, uint32_t hash )
+{
+	uint32_t mask = capacity - 1;
+	uint32_t index = hash & mask;
 	for ( ;; )
 	{
-		j = ( j + 1 ) & ( capacity - 1 );
-		if ( items[j].hash == 0 )
+		b2GroupMask empties = b2MatchEmpty( controls + index );
+		if ( empties != 0 )
 		{
-			break;
+			return (int)( ( index + ( b2CTZ64( empties ) >> B2_GROUP_MASK_SHIFT ) ) & mask );
 		}
 
-		// k is the first item for the hash of j
-		int k = items[j].hash & ( capacity - 1 );
-
-		// determine if k lies cyclically in (i,j]
-		// i <= j: | i..k..j |
-		// i > j: |.k..j  i....| or |....j     i..k.|
-		if ( i <= j )
-		{
-			if ( i < k && k <= j )
-			{
-				continue;
-			}
-		}
-		else
-		{
-			if ( i < k || k <= j )
-			{
-				continue;
-			}
-		}
-
-		// Move j into i
-		items[i] = items[j];
-
-		// Mark item j as unoccupied
-		items[j].key = 0;
-		items[j].hash = 0;
+		index = ( index + B2_SET_GROUP_SIZE ) & mask;
+	}
+}
 
-		i = j;
+// The set functions for one key type, in the style of B2_ARRAY_SOURCE
+#define B2_HASH_SET_SOURCE( SET, KEY, SUFFIX, HASH )                                                                        \
+	static int b2SetBytes##SUFFIX( uint32_t capacity )                                                                      \
+	{                                                                                                                       \
+		return (int)( capacity * sizeof( KEY ) + capacity + B2_SET_GROUP_SIZE - 1 );                                        \
+	}                                                                                                                       \
+	/* Allocates empty storage. Keys come first so they stay aligned. */                                                    \
+	static void b2AllocateSet##SUFFIX( SET* set, uint32_t capacity )                                                        \
+	{                                                                                                                       \
+		set->keys = b2Alloc( b2SetBytes##SUFFIX( capacity ) );                                                              \
+		set->controls = (uint8_t*)( set->keys + capacity );                                                                 \
+		set->capacity = capacity;                                                                                           \
+		set->count = 0;                                                                                                     \
+		memset( set->controls, B2_SET_EMPTY, capacity + B2_SET_GROUP_SIZE - 1 );                                            \
+	}                                                                                                                       \
+	SET b2CreateSet##SUFFIX( int capacity )                                                                                 \
+	{                                                                                                                       \
+		SET set = { 0 };                                                                                                    \
+		/* Capacity must be a power of 2 */                                                                                 \
+		uint32_t setCapacity = capacity > 16 ? (uint32_t)b2RoundUpPowerOf2( capacity ) : 16;                                \
+		b2AllocateSet##SUFFIX( &set, setCapacity );                                                                         \
+		set.minCapacity = setCapacity;                                                                                      \
+		return set;                                                                                                         \
+	}                                                                                                                       \
+	void b2DestroySet##SUFFIX( SET* set )                                                                                   \
+	{                                                                                                                       \
+		if ( set->keys != NULL )                                                                                            \
+		{                                                                                                                   \
+			b2Free( set->keys, b2SetBytes##SUFFIX( set->capacity ) );                                                       \
+		}                                                                                                                   \
+		set->keys = NULL;                                                                                                   \
+		set->controls = NULL;                                                                                               \
+		set->count = 0;                                                                                                     \
+		set->capacity = 0;                                                                                                  \
+	}                                                                                                                       \
+	int b2GetHashSet##SUFFIX##Bytes( SET* set )                                                                             \
+	{                                                                                                                       \
+		return b2SetBytes##SUFFIX( set->capacity );                                                                         \
+	}                                                                                                                       \
+	/* Returns the slot holding the key or B2_NULL_INDEX. Also provides the first empty slot of the probe. */               \
+	static int b2FindKey##SUFFIX( const SET* set, KEY key, uint32_t hash, int* emptySlot )                                  \
+	{                                                                                                                       \
+		B2_SNOOP_FIND();                                                                                                    \
+		uint32_t mask = set->capacity - 1;                                                                                  \
+		uint8_t tag = b2HashTag( hash );                                                                                    \
+		uint32_t index = hash & mask;                                                                                       \
+		for ( ;; )                                                                                                          \
+		{                                                                                                                   \
+			const uint8_t* group = set->controls + index;                                                                   \
+			b2GroupMask matches = b2MatchGroup( group, tag );                                                               \
+			while ( matches != 0 )                                                                                          \
+			{                                                                                                               \
+				uint32_t slot = ( index + ( b2CTZ64( matches ) >> B2_GROUP_MASK_SHIFT ) ) & mask;                           \
+				if ( set->keys[slot] == key )                                                                               \
+				{                                                                                                           \
+					return (int)slot;                                                                                       \
+				}                                                                                                           \
+				matches &= matches - 1;                                                                                     \
+			}                                                                                                               \
+			/* The probe sequence ends at the first empty slot */                                                           \
+			b2GroupMask empties = b2MatchEmpty( group );                                                                    \
+			if ( empties != 0 )                                                                                             \
+			{                                                                                                               \
+				*emptySlot = (int)( ( index + ( b2CTZ64( empties ) >> B2_GROUP_MASK_SHIFT ) ) & mask );                     \
+				return B2_NULL_INDEX;                                                                                       \
+			}                                                                                                               \
+			B2_SNOOP_PROBE();                                                                                               \
+			index = ( index + B2_SET_GROUP_SIZE ) & mask;                                                                   \
+		}                                                                                                                   \
+	}                                                                                                                       \
+	static void b2InsertKey##SUFFIX( SET* set, KEY key, uint32_t hash, int slot )                                           \
+	{                                                                                                                       \
+		set->keys[slot] = key;                                                                                              \
+		b2SetControl( set->controls, set->capacity, slot, b2HashTag( hash ) );                                              \
+		set->count += 1;                                                                                                    \
+	}                                                                                                                       \
+	static void b2ResizeSet##SUFFIX( SET* set, uint32_t newCapacity )                                                       \
+	{                                                                                                                       \
+		SET oldSet = *set;                                                                                                  \
+		b2AllocateSet##SUFFIX( set, newCapacity );                                                                          \
+		/* Transfer items into the new storage */                                                                           \
+		for ( uint32_t i = 0; i < oldSet.capacity; ++i )                                                                    \
+		{                                                                                                                   \
+			if ( oldSet.controls[i] == B2_SET_EMPTY )                                                                       \
+			{                                                                                                               \
+				continue;                                                                                                   \
+			}                                                                                                               \
+			/* The keys are unique, so only an empty slot is needed */                                                      \
+			KEY key = oldSet.keys[i];                                                                                       \
+			uint32_t hash = HASH( key );                                                                                    \
+			b2InsertKey##SUFFIX( set, key, hash, b2FindEmpty( set->controls, set->capacity, hash ) );                       \
+		}                                                                                                                   \
+		B2_ASSERT( set->count == oldSet.count );                                                                            \
+		b2Free( oldSet.keys, b2SetBytes##SUFFIX( oldSet.capacity ) );                                                       \
+	}                                                                                                                       \
+	void b2ClearSet##SUFFIX( SET* set )                                                                                     \
+	{                                                                                                                       \
+		/* Drop storage that is mostly unused, for example after the first step moved every proxy */                        \
+		if ( set->capacity > set->minCapacity && b2ShouldShrink( set->count, set->capacity ) )                              \
+		{                                                                                                                   \
+			uint32_t capacity = set->capacity;                                                                              \
+			b2Free( set->keys, b2SetBytes##SUFFIX( capacity ) );                                                            \
+			b2AllocateSet##SUFFIX( set, capacity >> 1 );                                                                    \
+			return;                                                                                                         \
+		}                                                                                                                   \
+		set->count = 0;                                                                                                     \
+		memset( set->controls, B2_SET_EMPTY, set->capacity + B2_SET_GROUP_SIZE - 1 );                                       \
+	}                                                                                                                       \
+	bool b2ContainsKey##SUFFIX( const SET* set, KEY key )                                                                   \
+	{                                                                                                                       \
+		int emptySlot;                                                                                                      \
+		return b2FindKey##SUFFIX( set, key, HASH( key ), &emptySlot ) != B2_NULL_INDEX;                                     \
+	}                                                                                                                       \
+	bool b2AddKey##SUFFIX( SET* set, KEY key )                                                                              \
+	{                                                                                                                       \
+		uint32_t hash = HASH( key );                                                                                        \
+		int emptySlot = B2_NULL_INDEX;                                                                                      \
+		if ( b2FindKey##SUFFIX( set, key, hash, &emptySlot ) != B2_NULL_INDEX )                                             \
+		{                                                                                                                   \
+			/* Already in set */                                                                                            \
+			return true;                                                                                                    \
+		}                                                                                                                   \
+		if ( b2ShouldGrow( set->count + 1, set->capacity ) )                                                                \
+		{                                                                                                                   \
+			b2ResizeSet##SUFFIX( set, 2 * set->capacity );                                                                  \
+			b2FindKey##SUFFIX( set, key, hash, &emptySlot );                                                                \
+		}                                                                                                                   \
+		b2InsertKey##SUFFIX( set, key, hash, emptySlot );                                                                   \
+		return false;                                                                                                       \
+	}                                                                                                                       \
+	/* Backward shift deletion, see https://en.wikipedia.org/wiki/Open_addressing */                                        \
+	bool b2RemoveKey##SUFFIX( SET* set, KEY key )                                                                           \
+	{                                                                                                                       \
+		int emptySlot;                                                                                                      \
+		int found = b2FindKey##SUFFIX( set, key, HASH( key ), &emptySlot );                                                 \
+		if ( found == B2_NULL_INDEX )                                                                                       \
+		{                                                                                                                   \
+			/* Not in set */                                                                                                \
+			return false;                                                                                                   \
+		}                                                                                                                   \
+		B2_ASSERT( set->count > 0 );                                                                                        \
+		set->count -= 1;                                                                                                    \
+		uint32_t mask = set->capacity - 1;                                                                                  \
+		uint32_t i = (uint32_t)found;                                                                                       \
+		uint32_t j = i;                                                                                                     \
+		for ( ;; )                                                                                                          \
+		{                                                                                                                   \
+			j = ( j + 1 ) & mask;                                                                                           \
+			if ( set->controls[j] == B2_SET_EMPTY )                                                                         \
+			{                                                                                                               \
+				break;                                                                                                      \
+			}                                                                                                               \
+			/* The item at j can fill the hole at i unless its home slot lies cyclically in (i,j] */                        \
+			uint32_t home = HASH( set->keys[j] ) & mask;                                                                    \
+			if ( ( ( j - home ) & mask ) < ( ( j - i ) & mask ) )                                                           \
+			{                                                                                                               \
+				continue;                                                                                                   \
+			}                                                                                                               \
+			set->keys[i] = set->keys[j];                                                                                    \
+			b2SetControl( set->controls, set->capacity, i, set->controls[j] );                                              \
+			i = j;                                                                                                          \
+		}                                                                                                                   \
+		b2SetControl( set->controls, set->capacity, i, B2_SET_EMPTY );                                                      \
+		if ( set->capacity > set->minCapacity && b2ShouldShrink( set->count, set->capacity ) )                              \
+		{                                                                                                                   \
+			b2ResizeSet##SUFFIX( set, set->capacity >> 1 );                                                                 \
+		}                                                                                                                   \
+		return true;                                                                                                        \
 	}
 
-	return true;
-}
+B2_HASH_SET_SOURCE( b2HashSet, uint64_t, , b2KeyHash )
+B2_HASH_SET_SOURCE( b2HashSet32, uint32_t, 32, b2KeyHash32 )
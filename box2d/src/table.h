@@ -8,22 +8,38 @@
 
 #define B2_SHAPE_PAIR_KEY( K1, K2 ) K1 < K2 ? (uint64_t)K1 << 32 | (uint64_t)K2 : (uint64_t)K2 << 32 | (uint64_t)K1
 
-typedef struct b2SetItem
-{
-	uint64_t key;
-	uint32_t hash;
-} b2SetItem;
-
+// Probing scans this many control bytes at once
+#define B2_SET_GROUP_SIZE 16
+
+// Open addressing hash set with linear probing. Each slot has a control byte that is either empty or
+// holds 7 bits of the key hash, so a probe compares a whole group of slots before touching any key.
+// Removal shifts the following items back instead of leaving tombstones. The set grows at 3/4 load and
+// shrinks again when it drops below 1/8 load, but never below the capacity it was created with.
+// The control array has B2_SET_GROUP_SIZE - 1 extra bytes that mirror the first slots, so a group can
+// be loaded at any slot without wrapping.
 typedef struct b2HashSet
 {
-	b2SetItem* items;
+	uint64_t* keys;
+	uint8_t* controls;
 	uint32_t capacity;
 	uint32_t count;
+	uint32_t minCapacity;
 } b2HashSet;
 
+// The same set for 32-bit keys, such as proxy keys
+typedef struct b2HashSet32
+{
+	uint32_t* keys;
+	uint8_t* controls;
+	uint32_t capacity;
+	uint32_t count;
+	uint32_t minCapacity;
+} b2HashSet32;
+
 b2HashSet b2CreateSet( int capacity );
 void b2DestroySet( b2HashSet* set );
 
+// Removes all keys. Also releases memory if the set was mostly empty.
 void b2ClearSet( b2HashSet* set );
 
 // Returns true if key was already in set
@@ -35,3 +51,11 @@ bool b2RemoveKey( b2HashSet* set, uint64_t key );
 bool b2ContainsKey( const b2HashSet* set, uint64_t key );
 
 int b2GetHashSetBytes( b2HashSet* set );
+
+b2HashSet32 b2CreateSet32( int capacity );
+void b2DestroySet32( b2HashSet32* set );
+void b2ClearSet32( b2HashSet32* set );
+bool b2AddKey32( b2HashSet32* set, uint32_t key );
+bool b2RemoveKey32( b2HashSet32* set, uint32_t key );
+bool b2ContainsKey32( const b2HashSet32* set, uint32_t key );
+int b2GetHashSet32Bytes( b2HashSet32* set );
@@ -2,10 +2,14 @@
 // SPDX-License-Identifier: MIT
 
 #include "aabb.h"
+#include "manifold.h"
 #include "test_macros.h"
 
+#include "box2d/collision.h"
 #include "box2d/math_functions.h"
 
+#include <string.h>
+
 static int AABBTest( void )
 {
 	b2AABB a;
@@ -31,9 +35,428 @@ static int AABBTest( void )
 	return 0;
 }
 
+#define WIDE_PROXY_COUNT 500
+
+typedef struct QueryRecord
+{
+	int proxyIds[WIDE_PROXY_COUNT];
+	int count;
+} QueryRecord;
+
+static bool RecordQueryCallback( int proxyId, uint64_t userData, void* context )
+{
+	(void)userData;
+	QueryRecord* record = context;
+	record->proxyIds[record->count++] = proxyId;
+	return true;
+}
+
+typedef struct RayRecord
+{
+	const b2DynamicTree* tree;
+	float fraction;
+	int proxyId;
+} RayRecord;
+
+static float RecordRayCallback( const b2RayCastInput* input, int proxyId, uint64_t userData, void* context )
+{
+	(void)userData;
+	RayRecord* record = context;
+	b2AABB box = b2DynamicTree_GetAABB( record->tree, proxyId );
+	b2CastOutput output = b2AABB_RayCast( box, input->origin, b2MulAdd( input->origin, input->maxFraction, input->translation ) );
+	if ( output.hit == false )
+	{
+		return -1.0f;
+	}
+
+	float fraction = output.fraction * input->maxFraction;
+	record->fraction = fraction;
+	record->proxyId = proxyId;
+	return fraction;
+}
+
+static bool RecordQueryBatchCallback( int proxyId, uint64_t userData, int baseIndex, uint64_t queryMask, void* context )
+{
+	(void)userData;
+	QueryRecord* records = context;
+	for ( int i = 0; i < 64; ++i )
+	{
+		if ( queryMask & ( (uint64_t)1 << i ) )
+		{
+			QueryRecord* record = records + baseIndex + i;
+			record->proxyIds[record->count++] = proxyId;
+		}
+	}
+	return true;
+}
+
+static float RecordRayBatchCallback( const b2RayCastInput* input, int rayIndex, int proxyId, uint64_t userData, void* context )
+{
+	RayRecord* records = context;
+	return RecordRayCallback( input, proxyId, userData, records + rayIndex );
+}
+
+static int QueryTree( const b2DynamicTree* tree, b2AABB box, uint64_t maskBits, QueryRecord* record )
+{
+	record->count = 0;
+	b2DynamicTree_Query( tree, box, maskBits, RecordQueryCallback, record );
+	return record->count;
+}
+
+static b2AABB MakeTestBox( b2Vec2 offset, float scale, float lowerX, float lowerY, float upperX, float upperY )
+{
+	b2AABB box = { { offset.x + scale * lowerX, offset.y + scale * lowerY },
+				   { offset.x + scale * upperX, offset.y + scale * upperY } };
+	return box;
+}
+
+// The wide nodes must report the same proxies in the same order as the binary tree. The tree is moved
+// and scaled to check the bounds far from the origin.
+static int CompareWideTree( b2Vec2 offset, float scale )
+{
+	b2DynamicTree tree = b2DynamicTree_Create();
+
+	uint32_t seed = 12345;
+	for ( int i = 0; i < WIDE_PROXY_COUNT; ++i )
+	{
+		seed = 1664525u * seed + 1013904223u;
+		float x = (float)( seed >> 16 & 0xFF );
+		seed = 1664525u * seed + 1013904223u;
+		float y = (float)( seed >> 16 & 0xFF );
+		float h = 0.25f + 0.5f * (float)( i % 4 );
+		b2AABB box = MakeTestBox( offset, scale, x - h, y - h, x + h, y + h );
+		b2DynamicTree_CreateProxy( &tree, box, 1ull << ( i % 3 ), (uint64_t)i );
+	}
+
+	b2DynamicTree_Rebuild( &tree, true );
+	ENSURE( tree.wideValid == false );
+
+	static QueryRecord binary, wide;
+	b2AABB queries[] = {
+		MakeTestBox( offset, scale, 0.0f, 0.0f, 256.0f, 256.0f ),
+		MakeTestBox( offset, scale, 10.0f, 20.0f, 60.0f, 40.0f ),
+		MakeTestBox( offset, scale, 100.0f, 100.0f, 101.0f, 101.0f ),
+		MakeTestBox( offset, scale, 300.0f, 300.0f, 400.0f, 400.0f ),
+	};
+	uint64_t masks[] = { B2_DEFAULT_MASK_BITS, 1, 6 };
+
+	b2RayCastInput rays[] = {
+		{ b2MulAdd( offset, scale, ( b2Vec2 ){ -10.0f, -10.0f } ), b2MulSV( scale, ( b2Vec2 ){ 280.0f, 270.0f } ), 1.0f },
+		{ b2MulAdd( offset, scale, ( b2Vec2 ){ 128.0f, -5.0f } ), b2MulSV( scale, ( b2Vec2 ){ 0.0f, 300.0f } ), 1.0f },
+		{ b2MulAdd( offset, scale, ( b2Vec2 ){ 250.0f, 30.0f } ), b2MulSV( scale, ( b2Vec2 ){ -260.0f, 100.0f } ), 0.5f },
+	};
+
+	RayRecord binaryRays[3][3];
+	for ( int k = 0; k < 3; ++k )
+	{
+		for ( int m = 0; m < 3; ++m )
+		{
+			binaryRays[k][m] = ( RayRecord ){ &tree, 1.0f, -1 };
+			b2DynamicTree_RayCast( &tree, rays + k, masks[m], RecordRayCallback, &binaryRays[k][m] );
+		}
+	}
+
+	b2DynamicTree_EnableWideNodes( &tree, true );
+	ENSURE( tree.wideValid == true );
+	ENSURE( 0 < tree.wideNodeCount && tree.wideNodeCount < WIDE_PROXY_COUNT );
+	ENSURE( tree.wideNodes != NULL );
+
+	for ( int q = 0; q < 4; ++q )
+	{
+		for ( int m = 0; m < 3; ++m )
+		{
+			b2DynamicTree_EnableWideNodes( &tree, false );
+			QueryTree( &tree, queries[q], masks[m], &binary );
+			b2DynamicTree_EnableWideNodes( &tree, true );
+			QueryTree( &tree, queries[q], masks[m], &wide );
+
+			ENSURE( binary.count == wide.count );
+			for ( int i = 0; i < binary.count; ++i )
+			{
+				ENSURE( binary.proxyIds[i] == wide.proxyIds[i] );
+			}
+		}
+	}
+
+	for ( int k = 0; k < 3; ++k )
+	{
+		for ( int m = 0; m < 3; ++m )
+		{
+			RayRecord record = { &tree, 1.0f, -1 };
+			b2DynamicTree_RayCast( &tree, rays + k, masks[m], RecordRayCallback, &record );
+			ENSURE( record.proxyId == binaryRays[k][m].proxyId );
+			ENSURE( record.fraction == binaryRays[k][m].fraction );
+		}
+	}
+
+	// The batches walk the wide nodes too
+	for ( int m = 0; m < 3; ++m )
+	{
+		static QueryRecord batch[4];
+		memset( batch, 0, sizeof( batch ) );
+		b2DynamicTree_QueryBatch( &tree, queries, 4, masks[m], RecordQueryBatchCallback, batch );
+
+		for ( int q = 0; q < 4; ++q )
+		{
+			QueryTree( &tree, queries[q], masks[m], &wide );
+			ENSURE( batch[q].count == wide.count );
+			for ( int i = 0; i < wide.count; ++i )
+			{
+				ENSURE( batch[q].proxyIds[i] == wide.proxyIds[i] );
+			}
+		}
+
+		RayRecord rayBatch[3];
+		for ( int k = 0; k < 3; ++k )
+		{
+			rayBatch[k] = ( RayRecord ){ &tree, 1.0f, -1 };
+		}
+
+		// The rays of a batch are clipped in another order, so the fractions may round differently
+		b2DynamicTree_RayCastBatch( &tree, rays, 3, masks[m], RecordRayBatchCallback, rayBatch );
+		for ( int k = 0; k < 3; ++k )
+		{
+			ENSURE( rayBatch[k].proxyId == binaryRays[k][m].proxyId );
+			ENSURE_SMALL( rayBatch[k].fraction - binaryRays[k][m].fraction, 1.0e-4f );
+		}
+	}
+
+	// Any change to the tree drops the wide nodes until the next rebuild
+	b2DynamicTree_MoveProxy( &tree, 0, MakeTestBox( offset, scale, 0.0f, 0.0f, 1.0f, 1.0f ) );
+	ENSURE( tree.wideValid == false );
+	b2DynamicTree_Rebuild( &tree, true );
+	ENSURE( tree.wideValid == true );
+
+	b2DynamicTree_Destroy( &tree );
+
+	return 0;
+}
+
+static int WideTreeTest( void )
+{
+	ENSURE( CompareWideTree( b2Vec2_zero, 1.0f ) == 0 );
+	ENSURE( CompareWideTree( ( b2Vec2 ){ 5000.0f, -3000.0f }, 0.01f ) == 0 );
+
+	return 0;
+}
+
+#define REBUILD_PROXY_COUNT 5000
+
+// Runs the items one at a time in reverse order to stand in for workers finishing out of order
+static void* ReverseEnqueueTask( b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext )
+{
+	(void)minRange;
+	int* taskCount = userContext;
+	*taskCount += 1;
+
+	for ( int i = itemCount - 1; i >= 0; --i )
+	{
+		task( i, i + 1, 0, taskContext );
+	}
+	return NULL;
+}
+
+static void FinishTask( void* userTask, void* userContext )
+{
+	(void)userTask;
+	(void)userContext;
+}
+
+// Same root, shape and traversal order
+static bool SameTree( const b2DynamicTree* a, const b2DynamicTree* b )
+{
+	if ( a->root != b->root || b2DynamicTree_GetHeight( a ) != b2DynamicTree_GetHeight( b ) ||
+		 b2DynamicTree_GetAreaRatio( a ) != b2DynamicTree_GetAreaRatio( b ) )
+	{
+		return false;
+	}
+
+	static QueryRecord recordA, recordB;
+	for ( int i = 0; i < 16; ++i )
+	{
+		for ( int j = 0; j < 16; ++j )
+		{
+			b2AABB box = { { 64.0f * i, 64.0f * j }, { 64.0f * i + 40.0f, 64.0f * j + 40.0f } };
+			uint64_t maskBits = ( i + j ) % 2 == 0 ? B2_DEFAULT_MASK_BITS : 6;
+			QueryTree( a, box, maskBits, &recordA );
+			QueryTree( b, box, maskBits, &recordB );
+			if ( recordA.count != recordB.count ||
+				 memcmp( recordA.proxyIds, recordB.proxyIds, recordA.count * sizeof( int ) ) != 0 )
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// The task rebuild must produce the same nodes as the serial rebuild, for full and partial rebuilds
+static int TaskRebuildTest( void )
+{
+	b2DynamicTree serialTree = b2DynamicTree_Create();
+	b2DynamicTree taskTree = b2DynamicTree_Create();
+
+	static int proxyIds[REBUILD_PROXY_COUNT];
+	uint32_t seed = 6789;
+	for ( int i = 0; i < REBUILD_PROXY_COUNT; ++i )
+	{
+		seed = 1664525u * seed + 1013904223u;
+		float x = (float)( seed >> 16 & 0x3FF );
+		seed = 1664525u * seed + 1013904223u;
+		float y = (float)( seed >> 16 & 0x3FF );
+		b2AABB box = { { x - 0.5f, y - 0.5f }, { x + 0.5f, y + 0.5f } };
+		proxyIds[i] = b2DynamicTree_CreateProxy( &serialTree, box, 1ull << ( i % 5 ), (uint64_t)i );
+		int taskProxyId = b2DynamicTree_CreateProxy( &taskTree, box, 1ull << ( i % 5 ), (uint64_t)i );
+		ENSURE( taskProxyId == proxyIds[i] );
+	}
+
+	int taskCount = 0;
+	int serialLeafCount = b2DynamicTree_Rebuild( &serialTree, true );
+	int taskLeafCount = b2DynamicTree_RebuildWithTasks( &taskTree, true, ReverseEnqueueTask, FinishTask, &taskCount );
+	ENSURE( serialLeafCount == REBUILD_PROXY_COUNT );
+	ENSURE( taskLeafCount == serialLeafCount );
+	ENSURE( taskCount == 1 );
+	ENSURE( SameTree( &serialTree, &taskTree ) );
+
+	// Enlarge a third of the proxies so the partial rebuild keeps some internal nodes as leaves
+	for ( int i = 0; i < REBUILD_PROXY_COUNT; i += 3 )
+	{
+		b2AABB box = b2DynamicTree_GetAABB( &serialTree, proxyIds[i] );
+		box.upperBound.x += 3.0f;
+		b2DynamicTree_EnlargeProxy( &serialTree, proxyIds[i], box );
+		b2DynamicTree_EnlargeProxy( &taskTree, proxyIds[i], box );
+	}
+
+	taskCount = 0;
+	serialLeafCount = b2DynamicTree_Rebuild( &serialTree, false );
+	taskLeafCount = b2DynamicTree_RebuildWithTasks( &taskTree, false, ReverseEnqueueTask, FinishTask, &taskCount );
+	ENSURE( taskLeafCount == serialLeafCount );
+	ENSURE( taskCount == 1 );
+	ENSURE( SameTree( &serialTree, &taskTree ) );
+
+	b2DynamicTree_Destroy( &serialTree );
+	b2DynamicTree_Destroy( &taskTree );
+
+	return 0;
+}
+
+#define MANIFOLD_PAIR_COUNT 20000
+
+static float RandomTestFloat( uint32_t* seed, float lower, float upper )
+{
+	*seed = 1664525u * *seed + 1013904223u;
+	float unit = (float)( *seed >> 8 ) / (float)( 1 << 24 );
+	return lower + ( upper - lower ) * unit;
+}
+
+static b2Polygon MakeTestPolygon( uint32_t* seed )
+{
+	*seed = 1664525u * *seed + 1013904223u;
+	int kind = (int)( *seed >> 16 & 3 );
+
+	if ( kind == 0 )
+	{
+		return b2MakeBox( RandomTestFloat( seed, 0.1f, 2.0f ), RandomTestFloat( seed, 0.1f, 2.0f ) );
+	}
+
+	if ( kind == 1 )
+	{
+		b2Vec2 center = { RandomTestFloat( seed, -1.0f, 1.0f ), RandomTestFloat( seed, -1.0f, 1.0f ) };
+		b2Rot rotation = b2MakeRot( RandomTestFloat( seed, -B2_PI, B2_PI ) );
+		return b2MakeOffsetRoundedBox( RandomTestFloat( seed, 0.1f, 2.0f ), RandomTestFloat( seed, 0.1f, 2.0f ), center,
+									   rotation, RandomTestFloat( seed, 0.0f, 0.2f ) );
+	}
+
+	// Random hull with up to B2_MAX_POLYGON_VERTICES points
+	b2Vec2 points[B2_MAX_POLYGON_VERTICES];
+	*seed = 1664525u * *seed + 1013904223u;
+	int count = 3 + (int)( *seed >> 16 ) % ( B2_MAX_POLYGON_VERTICES - 2 );
+	for ( int i = 0; i < count; ++i )
+	{
+		float angle = 2.0f * B2_PI * ( (float)i + RandomTestFloat( seed, 0.0f, 0.5f ) ) / (float)count;
+		float radius = RandomTestFloat( seed, 0.5f, 2.0f );
+		b2CosSin cs = b2ComputeCosSin( angle );
+		points[i] = (b2Vec2){ radius * cs.cosine, radius * cs.sine };
+	}
+
+	b2Hull hull = b2ComputeHull( points, count );
+	if ( hull.count == 0 )
+	{
+		return b2MakeSquare( 1.0f );
+	}
+
+	float radius = kind == 3 ? RandomTestFloat( seed, 0.0f, 0.2f ) : 0.0f;
+	return b2MakePolygon( &hull, radius );
+}
+
+static bool SameBits( const void* a, const void* b, size_t size )
+{
+	return memcmp( a, b, size ) == 0;
+}
+
+static bool SameManifold( const b2Manifold* a, const b2Manifold* b )
+{
+	if ( a->pointCount != b->pointCount || SameBits( &a->normal, &b->normal, sizeof( b2Vec2 ) ) == false )
+	{
+		return false;
+	}
+
+	for ( int i = 0; i < a->pointCount; ++i )
+	{
+		const b2ManifoldPoint* pa = a->points + i;
+		const b2ManifoldPoint* pb = b->points + i;
+		if ( SameBits( &pa->point, &pb->point, sizeof( b2Vec2 ) ) == false ||
+			 SameBits( &pa->anchorA, &pb->anchorA, sizeof( b2Vec2 ) ) == false ||
+			 SameBits( &pa->anchorB, &pb->anchorB, sizeof( b2Vec2 ) ) == false ||
+			 SameBits( &pa->separation, &pb->separation, sizeof( float ) ) == false || pa->id != pb->id )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// The SIMD separating axis search must give the same manifold bits as the scalar search
+static int PolygonManifoldTest( void )
+{
+	uint32_t seed = 4321;
+	int touchingCount = 0;
+
+	for ( int i = 0; i < MANIFOLD_PAIR_COUNT; ++i )
+	{
+		b2Polygon polygonA = MakeTestPolygon( &seed );
+		b2Polygon polygonB = MakeTestPolygon( &seed );
+
+		b2Transform xfA = { { RandomTestFloat( &seed, -100.0f, 100.0f ), RandomTestFloat( &seed, -100.0f, 100.0f ) },
+							b2MakeRot( RandomTestFloat( &seed, -B2_PI, B2_PI ) ) };
+		b2Vec2 offset = { RandomTestFloat( &seed, -3.0f, 3.0f ), RandomTestFloat( &seed, -3.0f, 3.0f ) };
+
+		// Every so often use an axis aligned pair so separations and dot products tie
+		b2Rot rotationB = ( i & 7 ) == 0 ? xfA.q : b2MakeRot( RandomTestFloat( &seed, -B2_PI, B2_PI ) );
+		b2Transform xfB = { b2Add( xfA.p, offset ), rotationB };
+
+		b2Manifold manifold = b2CollidePolygons( &polygonA, xfA, &polygonB, xfB );
+		b2Manifold reference = b2CollidePolygonsScalar( &polygonA, xfA, &polygonB, xfB );
+		ENSURE( SameManifold( &manifold, &reference ) );
+
+		touchingCount += manifold.pointCount > 0 ? 1 : 0;
+	}
+
+	// Make sure the pairs cover both touching and separated polygons
+	ENSURE( touchingCount > MANIFOLD_PAIR_COUNT / 10 );
+	ENSURE( touchingCount < MANIFOLD_PAIR_COUNT - MANIFOLD_PAIR_COUNT / 10 );
+
+	return 0;
+}
+
 int CollisionTest( void )
 {
 	RUN_SUBTEST( AABBTest );
+	RUN_SUBTEST( WideTreeTest );
+	RUN_SUBTEST( TaskRebuildTest );
+	RUN_SUBTEST( PolygonManifoldTest );
 
 	return 0;
 }
@@ -79,7 +79,7 @@ static void FinishTask( void* userTask, void* userContext )
 	enkiWaitForTaskSet( scheduler, task );
 }
 
-static int SingleMultithreadingTest( int workerCount )
+static int SingleMultithreadingTest( int workerCount, b2SolverWaitType waitType )
 {
 	scheduler = enkiNewTaskScheduler();
 	struct enkiTaskSchedulerConfig config = enkiGetTaskSchedulerConfig( scheduler );
@@ -95,8 +95,10 @@ static int SingleMultithreadingTest( int workerCount )
 	worldDef.enqueueTask = EnqueueTask;
 	worldDef.finishTask = FinishTask;
 	worldDef.workerCount = workerCount;
+	worldDef.solverWaitType = waitType;
 
 	b2WorldId worldId = b2CreateWorld( &worldDef );
+	ENSURE( b2World_GetSolverWaitType( worldId ) == waitType );
 
 	FallingHingeData data = CreateFallingHinges( worldId );
 
@@ -129,12 +131,15 @@ static int SingleMultithreadingTest( int workerCount )
 	return 0;
 }
 
-// Test multithreaded determinism.
+// Test multithreaded determinism. The solver wait type must not change the results.
 static int MultithreadingTest( void )
 {
 	for ( int workerCount = 1; workerCount < 6; ++workerCount )
 	{
-		int result = SingleMultithreadingTest( workerCount );
+		int result = SingleMultithreadingTest( workerCount, b2_spinSolverWait );
+		ENSURE( result == 0 );
+
+		result = SingleMultithreadingTest( workerCount, b2_hybridSolverWait );
 		ENSURE( result == 0 );
 	}
 
@@ -171,10 +176,206 @@ static int CrossPlatformTest( void )
 	return 0;
 }
 
+// Several separate piles that each overflow the graph coloring, plus a hub with too many joints.
+// Returns a hash of the body transforms.
+static uint32_t SimulateOverflowPiles( int workerCount, int* overflowContactCount, int* overflowJointCount )
+{
+	scheduler = enkiNewTaskScheduler();
+	struct enkiTaskSchedulerConfig config = enkiGetTaskSchedulerConfig( scheduler );
+	config.numTaskThreadsToCreate = workerCount - 1;
+	enkiInitTaskSchedulerWithConfig( scheduler, config );
+
+	for ( int i = 0; i < e_maxTasks; ++i )
+	{
+		tasks[i] = enkiCreateTaskSet( scheduler, ExecuteRangeTask );
+	}
+
+	b2WorldDef worldDef = b2DefaultWorldDef();
+	worldDef.enqueueTask = EnqueueTask;
+	worldDef.finishTask = FinishTask;
+	worldDef.workerCount = workerCount;
+
+	b2WorldId worldId = b2CreateWorld( &worldDef );
+
+	enum
+	{
+		e_pileCount = 6,
+		e_circleCount = 32,
+		e_spokeCount = 30,
+		e_bodyCapacity = e_pileCount * ( 1 + e_circleCount ) + 1 + e_spokeCount,
+	};
+
+	b2BodyId bodyIds[e_bodyCapacity];
+	int bodyCount = 0;
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+
+	b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+	b2Segment segment = { { -400.0f, 0.0f }, { 400.0f, 0.0f } };
+	b2CreateSegmentShape( groundId, &shapeDef, &segment );
+
+	bodyDef.type = b2_dynamicBody;
+	b2Polygon plank = b2MakeBox( 20.0f, 0.5f );
+	b2Circle circle = { { 0.0f, 0.0f }, 0.5f };
+
+	for ( int i = 0; i < e_pileCount; ++i )
+	{
+		float x = -300.0f + 60.0f * i;
+
+		bodyDef.position = (b2Vec2){ x, 0.6f };
+		bodyIds[bodyCount++] = b2CreateBody( worldId, &bodyDef );
+		b2CreatePolygonShape( bodyIds[bodyCount - 1], &shapeDef, &plank );
+
+		for ( int j = 0; j < e_circleCount; ++j )
+		{
+			bodyDef.position = (b2Vec2){ x - 18.6f + 1.2f * j, 1.7f + 0.1f * ( j % 3 ) };
+			bodyIds[bodyCount++] = b2CreateBody( worldId, &bodyDef );
+			b2CreateCircleShape( bodyIds[bodyCount - 1], &shapeDef, &circle );
+		}
+	}
+
+	bodyDef.position = (b2Vec2){ 200.0f, 20.0f };
+	b2BodyId hubId = b2CreateBody( worldId, &bodyDef );
+	bodyIds[bodyCount++] = hubId;
+	b2Circle hubCircle = { { 0.0f, 0.0f }, 4.0f };
+	b2CreateCircleShape( hubId, &shapeDef, &hubCircle );
+
+	b2RevoluteJointDef jointDef = b2DefaultRevoluteJointDef();
+	jointDef.base.bodyIdA = hubId;
+	for ( int i = 0; i < e_spokeCount; ++i )
+	{
+		float angle = 2.0f * B2_PI * i / e_spokeCount;
+		b2Vec2 offset = b2RotateVector( b2MakeRot( angle ), (b2Vec2){ 5.0f, 0.0f } );
+		bodyDef.position = b2Add( (b2Vec2){ 200.0f, 20.0f }, offset );
+		bodyIds[bodyCount++] = b2CreateBody( worldId, &bodyDef );
+		b2CreateCircleShape( bodyIds[bodyCount - 1], &shapeDef, &circle );
+
+		jointDef.base.bodyIdB = bodyIds[bodyCount - 1];
+		jointDef.base.localFrameA.p = offset;
+		b2CreateRevoluteJoint( worldId, &jointDef );
+	}
+
+	*overflowContactCount = 0;
+	*overflowJointCount = 0;
+
+	for ( int i = 0; i < 90; ++i )
+	{
+		b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+		b2Counters counters = b2World_GetCounters( worldId );
+		*overflowContactCount = b2MaxInt( *overflowContactCount, counters.overflowContactCount );
+		*overflowJointCount = b2MaxInt( *overflowJointCount, counters.overflowJointCount );
+	}
+
+	uint32_t hash = B2_HASH_INIT;
+	for ( int i = 0; i < bodyCount; ++i )
+	{
+		b2Transform xf = b2Body_GetTransform( bodyIds[i] );
+		hash = b2Hash( hash, (uint8_t*)&xf, sizeof( b2Transform ) );
+	}
+
+	b2DestroyWorld( worldId );
+
+	for ( int i = 0; i < e_maxTasks; ++i )
+	{
+		enkiDeleteTaskSet( scheduler, tasks[i] );
+	}
+
+	enkiDeleteTaskScheduler( scheduler );
+
+	return hash;
+}
+
+// Overflow constraints are split into independent sets that are solved in parallel. This must match the serial solve.
+static int OverflowMultithreadingTest( void )
+{
+	int overflowContactCount, overflowJointCount;
+	uint32_t expectedHash = SimulateOverflowPiles( 1, &overflowContactCount, &overflowJointCount );
+	ENSURE( overflowContactCount > 0 );
+	ENSURE( overflowJointCount > 0 );
+
+	for ( int workerCount = 2; workerCount < 6; ++workerCount )
+	{
+		uint32_t hash = SimulateOverflowPiles( workerCount, &overflowContactCount, &overflowJointCount );
+		ENSURE( hash == expectedHash );
+	}
+
+	return 0;
+}
+
+// Test that every SIMD backend gives the same results, including when switching between steps.
+static int SIMDBackendTest( void )
+{
+	b2SIMDBackend backends[b2_simdBackendCount];
+	int backendCount = 0;
+
+	for ( int i = 0; i < b2_simdBackendCount; ++i )
+	{
+		b2SIMDBackend backend = (b2SIMDBackend)i;
+		if ( b2IsSIMDBackendSupported( backend ) )
+		{
+			backends[backendCount] = backend;
+			backendCount += 1;
+		}
+	}
+
+	// Neon and x86 are never both available
+	ENSURE( 0 < backendCount && backendCount < b2_simdBackendCount );
+
+	// The last pass cycles through all backends
+	for ( int pass = 0; pass <= backendCount; ++pass )
+	{
+		b2WorldDef worldDef = b2DefaultWorldDef();
+		b2WorldId worldId = b2CreateWorld( &worldDef );
+
+		for ( int i = 0; i < b2_simdBackendCount; ++i )
+		{
+			b2SIMDBackend backend = (b2SIMDBackend)i;
+			if ( b2IsSIMDBackendSupported( backend ) == false )
+			{
+				b2SIMDBackend current = b2World_GetSIMDBackend( worldId );
+				ENSURE( b2World_SetSIMDBackend( worldId, backend ) == false );
+				ENSURE( b2World_GetSIMDBackend( worldId ) == current );
+			}
+		}
+
+		FallingHingeData data = CreateFallingHinges( worldId );
+
+		float timeStep = 1.0f / 60.0f;
+
+		bool done = false;
+		int stepIndex = 0;
+		while ( done == false )
+		{
+			b2SIMDBackend backend = pass < backendCount ? backends[pass] : backends[stepIndex % backendCount];
+			ENSURE( b2World_SetSIMDBackend( worldId, backend ) );
+			ENSURE( b2World_GetSIMDBackend( worldId ) == backend );
+
+			int subStepCount = 4;
+			b2World_Step( worldId, timeStep, subStepCount );
+			stepIndex += 1;
+
+			done = UpdateFallingHinges( worldId, &data );
+		}
+
+		ENSURE( data.sleepStep == EXPECTED_SLEEP_STEP );
+		ENSURE( data.hash == EXPECTED_HASH );
+
+		DestroyFallingHinges( &data );
+
+		b2DestroyWorld( worldId );
+	}
+
+	return 0;
+}
+
 int DeterminismTest( void )
 {
 	RUN_SUBTEST( MultithreadingTest );
 	RUN_SUBTEST( CrossPlatformTest );
+	RUN_SUBTEST( SIMDBackendTest );
+	RUN_SUBTEST( OverflowMultithreadingTest );
 
 	return 0;
 }
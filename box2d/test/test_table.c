@@ -107,8 +107,72 @@ int TableTest( void )
 
 		ENSURE( set.count == 0 );
 
+		// Removing shrinks the set back to its initial capacity
+		ENSURE( set.capacity == 16 );
+
 		b2DestroySet( &set );
 	}
 
+	// 32-bit keys, including zero, added and removed in an interleaved order
+	{
+		enum
+		{
+			e_keyCount = 4096
+		};
+
+		bool inSet[e_keyCount] = { 0 };
+		uint32_t count = 0;
+		b2HashSet32 set = b2CreateSet32( 16 );
+
+		uint32_t seed = 12345;
+		for ( int i = 0; i < 16 * e_keyCount; ++i )
+		{
+			seed = 1664525 * seed + 1013904223;
+			uint32_t key = ( seed >> 8 ) % e_keyCount;
+
+			// Mostly adds in the first half, mostly removes in the second half
+			bool add = ( ( seed >> 4 ) & 3 ) != 0;
+			if ( i >= 8 * e_keyCount )
+			{
+				add = !add;
+			}
+
+			if ( add )
+			{
+				ENSURE( b2AddKey32( &set, key ) == inSet[key] );
+				count += inSet[key] ? 0 : 1;
+				inSet[key] = true;
+			}
+			else
+			{
+				ENSURE( b2RemoveKey32( &set, key ) == inSet[key] );
+				count -= inSet[key] ? 1 : 0;
+				inSet[key] = false;
+			}
+		}
+
+		ENSURE( set.count == count );
+		for ( uint32_t key = 0; key < e_keyCount; ++key )
+		{
+			ENSURE( b2ContainsKey32( &set, key ) == inSet[key] );
+		}
+
+		// Clearing a mostly empty set releases memory
+		for ( uint32_t key = 0; key < e_keyCount; ++key )
+		{
+			b2AddKey32( &set, key );
+		}
+
+		uint32_t capacity = set.capacity;
+		b2ClearSet32( &set );
+		ENSURE( set.count == 0 && set.capacity == capacity );
+		b2AddKey32( &set, 7 );
+		b2ClearSet32( &set );
+		ENSURE( set.capacity == capacity / 2 );
+		ENSURE( b2ContainsKey32( &set, 7 ) == false );
+
+		b2DestroySet32( &set );
+	}
+
 	return 0;
 }
@@ -1,7 +1,9 @@
 // SPDX-FileCopyrightText: 2023 Erin Catto
 // SPDX-License-Identifier: MIT
 
+#include "body.h"
 #include "constants.h"
+#include "contact_solver.h"
 #include "core.h"
 #include "test_macros.h"
 
@@ -9,7 +11,9 @@
 #include "box2d/collision.h"
 #include "box2d/math_functions.h"
 
+#include <float.h>
 #include <stdio.h>
+#include <string.h>
 
 // This is a simple example of building and running a simulation
 // using Box2D. Here we create a large ground box and a small dynamic
@@ -394,6 +398,691 @@ static int TestSensor( void )
 	return 0;
 }
 
+#define SNAPSHOT_BODY_COUNT 20
+static int SnapshotRoundTrip( b2BroadPhaseType broadPhaseType )
+{
+	b2WorldDef worldDef = b2DefaultWorldDef();
+	worldDef.broadPhaseType = broadPhaseType;
+	b2WorldId worldId = b2CreateWorld( &worldDef );
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+	b2Vec2 points[4] = { { 20.0f, 0.0f }, { 20.0f, 10.0f }, { -20.0f, 10.0f }, { -20.0f, 0.0f } };
+	b2ChainDef chainDef = b2DefaultChainDef();
+	chainDef.points = points;
+	chainDef.count = 4;
+	chainDef.isLoop = true;
+	b2CreateChain( groundId, &chainDef );
+
+	b2BodyId bodyIds[SNAPSHOT_BODY_COUNT];
+	b2Polygon square = b2MakeSquare( 0.5f );
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	bodyDef.type = b2_dynamicBody;
+	for ( int i = 0; i < SNAPSHOT_BODY_COUNT; ++i )
+	{
+		bodyDef.position = (b2Vec2){ -5.0f + 0.5f * ( i % 10 ), 1.0f + 1.1f * i };
+		bodyIds[i] = b2CreateBody( worldId, &bodyDef );
+		b2CreatePolygonShape( bodyIds[i], &shapeDef, &square );
+	}
+
+	b2RevoluteJointDef jointDef = b2DefaultRevoluteJointDef();
+	jointDef.base.bodyIdA = bodyIds[0];
+	jointDef.base.bodyIdB = bodyIds[1];
+	b2CreateRevoluteJoint( worldId, &jointDef );
+
+	for ( int i = 0; i < 30; ++i )
+	{
+		b2World_Step( worldId, 1.0f / 60.0f, 4 );
+	}
+
+	int size = b2World_GetSnapshotSize( worldId );
+	ENSURE( size > 0 );
+	void* buffer = b2Alloc( size );
+	ENSURE( b2World_SaveSnapshot( worldId, buffer, size - 1 ) == 0 );
+	ENSURE( b2World_SaveSnapshot( worldId, buffer, size ) == size );
+
+	for ( int i = 0; i < 60; ++i )
+	{
+		b2World_Step( worldId, 1.0f / 60.0f, 4 );
+	}
+
+	b2Transform expected[SNAPSHOT_BODY_COUNT];
+	for ( int i = 0; i < SNAPSHOT_BODY_COUNT; ++i )
+	{
+		expected[i] = b2Body_GetTransform( bodyIds[i] );
+	}
+
+	// Change the world structure before restoring
+	b2DestroyBody( bodyIds[5] );
+	b2DestroyBody( bodyIds[0] );
+	for ( int i = 0; i < 5; ++i )
+	{
+		b2BodyId extraId = b2CreateBody( worldId, &bodyDef );
+		b2CreatePolygonShape( extraId, &shapeDef, &square );
+	}
+	b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+	// Bad data is rejected
+	ENSURE( b2World_RestoreSnapshot( worldId, buffer, size - 8 ) == false );
+
+	ENSURE( b2World_RestoreSnapshot( worldId, buffer, size ) );
+	ENSURE( b2Body_IsValid( bodyIds[0] ) );
+	ENSURE( b2Body_IsValid( bodyIds[5] ) );
+
+	b2Counters counters = b2World_GetCounters( worldId );
+	ENSURE( counters.bodyCount == SNAPSHOT_BODY_COUNT + 1 );
+	ENSURE( counters.jointCount == 1 );
+
+	for ( int i = 0; i < 60; ++i )
+	{
+		b2World_Step( worldId, 1.0f / 60.0f, 4 );
+	}
+
+	for ( int i = 0; i < SNAPSHOT_BODY_COUNT; ++i )
+	{
+		b2Transform xf = b2Body_GetTransform( bodyIds[i] );
+		ENSURE( xf.p.x == expected[i].p.x && xf.p.y == expected[i].p.y );
+		ENSURE( xf.q.c == expected[i].q.c && xf.q.s == expected[i].q.s );
+	}
+
+	b2Free( buffer, size );
+	b2DestroyWorld( worldId );
+
+	return 0;
+}
+
+static int TestWorldSnapshot( void )
+{
+	ENSURE( SnapshotRoundTrip( b2_treeBroadPhase ) == 0 );
+	ENSURE( SnapshotRoundTrip( b2_sortAndSweepBroadPhase ) == 0 );
+	ENSURE( SnapshotRoundTrip( b2_gridBroadPhase ) == 0 );
+	return 0;
+}
+
+#define BROAD_PHASE_ROW_COUNT 8
+#define BROAD_PHASE_COLUMN_COUNT 20
+#define BROAD_PHASE_BODY_COUNT ( BROAD_PHASE_ROW_COUNT * BROAD_PHASE_COLUMN_COUNT + 2 )
+
+// Rows of circles that slide past each other with gaps smaller than the AABB margin. The fat boxes
+// overlap, so pairs form and break every step, but the circles never touch and the motion does not
+// depend on the contact order. One row has larger circles and two very long boxes slide past each
+// other far above, so the grid uses several levels and its fallback for oversized proxies.
+static void CreateBroadPhaseScene( b2WorldId worldId, b2BodyId* bodyIds )
+{
+	float gap = 0.08f;
+	b2Circle circle = { { 0.0f, 0.0f }, 0.5f };
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+	for ( int i = 0; i < BROAD_PHASE_COLUMN_COUNT; ++i )
+	{
+		circle.center = (b2Vec2){ ( 1.0f + gap ) * i, -1.0f - gap };
+		b2CreateCircleShape( groundId, &shapeDef, &circle );
+	}
+
+	circle.center = b2Vec2_zero;
+	float y = 0.0f;
+	float previousRadius = 0.5f;
+	for ( int j = 0; j < BROAD_PHASE_ROW_COUNT; ++j )
+	{
+		circle.radius = j == 3 ? 1.5f : 0.5f;
+		y += j == 0 ? 0.0f : previousRadius + circle.radius + gap;
+		previousRadius = circle.radius;
+
+		// The top row is kinematic
+		bodyDef.type = j == BROAD_PHASE_ROW_COUNT - 1 ? b2_kinematicBody : b2_dynamicBody;
+		bodyDef.linearVelocity = (b2Vec2){ 0.5f * ( j - BROAD_PHASE_ROW_COUNT / 2 ), 0.0f };
+		for ( int i = 0; i < BROAD_PHASE_COLUMN_COUNT; ++i )
+		{
+			bodyDef.position = (b2Vec2){ ( 2.0f * circle.radius + gap ) * i, y };
+			b2BodyId bodyId = b2CreateBody( worldId, &bodyDef );
+			b2CreateCircleShape( bodyId, &shapeDef, &circle );
+			bodyIds[j * BROAD_PHASE_COLUMN_COUNT + i] = bodyId;
+		}
+	}
+
+	bodyDef.type = b2_dynamicBody;
+	b2Polygon box = b2MakeBox( 40000.0f, 0.5f );
+	for ( int i = 0; i < 2; ++i )
+	{
+		bodyDef.position = (b2Vec2){ 0.0f, 1000.0f + ( 1.0f + gap ) * i };
+		bodyDef.linearVelocity = (b2Vec2){ 2.0f * i, 0.0f };
+		b2BodyId bodyId = b2CreateBody( worldId, &bodyDef );
+		b2CreatePolygonShape( bodyId, &shapeDef, &box );
+		bodyIds[BROAD_PHASE_ROW_COUNT * BROAD_PHASE_COLUMN_COUNT + i] = bodyId;
+	}
+}
+
+// Sort and sweep, the grid and refit trees must find the same pairs as the tree queries
+static int TestBroadPhaseTypes( void )
+{
+	b2BroadPhaseType types[4] = { b2_treeBroadPhase, b2_sortAndSweepBroadPhase, b2_gridBroadPhase, b2_treeBroadPhase };
+	b2WorldId worldIds[4];
+	b2BodyId bodyIds[4][BROAD_PHASE_BODY_COUNT];
+	for ( int k = 0; k < 4; ++k )
+	{
+		b2WorldDef worldDef = b2DefaultWorldDef();
+		worldDef.gravity = b2Vec2_zero;
+		worldDef.enableSleep = false;
+		worldDef.broadPhaseType = types[k];
+		worldDef.treeRefitRatio = k == 3 ? 1.2f : 0.0f;
+		worldIds[k] = b2CreateWorld( &worldDef );
+		CreateBroadPhaseScene( worldIds[k], bodyIds[k] );
+	}
+
+	int maxContactCount = 0;
+	for ( int step = 0; step < 120; ++step )
+	{
+		// Removed proxies leave holes in the sorted set and reorder the grid entries
+		if ( step == 40 || step == 80 )
+		{
+			for ( int k = 0; k < 4; ++k )
+			{
+				b2DestroyBody( bodyIds[k][step] );
+				b2DestroyBody( bodyIds[k][step + 33] );
+			}
+		}
+
+		for ( int k = 0; k < 4; ++k )
+		{
+			b2World_Step( worldIds[k], 1.0f / 60.0f, 4 );
+		}
+
+		int treeContactCount = b2World_GetCounters( worldIds[0] ).contactCount;
+		ENSURE( b2World_GetCounters( worldIds[1] ).contactCount == treeContactCount );
+		ENSURE( b2World_GetCounters( worldIds[2] ).contactCount == treeContactCount );
+		ENSURE( b2World_GetCounters( worldIds[3] ).contactCount == treeContactCount );
+		maxContactCount = b2MaxInt( maxContactCount, treeContactCount );
+	}
+
+	ENSURE( maxContactCount > 0 );
+
+	for ( int i = 0; i < BROAD_PHASE_BODY_COUNT; ++i )
+	{
+		if ( b2Body_IsValid( bodyIds[0][i] ) == false )
+		{
+			continue;
+		}
+
+		b2Vec2 p = b2Body_GetPosition( bodyIds[0][i] );
+		for ( int k = 1; k < 4; ++k )
+		{
+			b2Vec2 q = b2Body_GetPosition( bodyIds[k][i] );
+			ENSURE( p.x == q.x && p.y == q.y );
+		}
+	}
+
+	for ( int k = 0; k < 4; ++k )
+	{
+		b2DestroyWorld( worldIds[k] );
+	}
+
+	return 0;
+}
+
+#define BATCH_QUERY_COUNT 150
+
+static bool CountOverlap( b2ShapeId shapeId, void* context )
+{
+	(void)shapeId;
+	int* count = context;
+	*count += 1;
+	return true;
+}
+
+// Batched queries must find the same shapes as the single queries
+static int TestBatchQueries( void )
+{
+	b2WorldDef worldDef = b2DefaultWorldDef();
+	b2WorldId worldId = b2CreateWorld( &worldDef );
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	b2Polygon box = b2MakeBox( 0.4f, 0.3f );
+	b2Circle circle = { { 0.0f, 0.0f }, 0.35f };
+
+	// Static, kinematic and dynamic shapes so every tree is walked
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2BodyType types[3] = { b2_staticBody, b2_kinematicBody, b2_dynamicBody };
+	for ( int i = 0; i < 20; ++i )
+	{
+		for ( int j = 0; j < 20; ++j )
+		{
+			bodyDef.type = types[( i + j ) % 3];
+			bodyDef.position = (b2Vec2){ 1.7f * i + 0.1f * j, 1.3f * j };
+			b2BodyId bodyId = b2CreateBody( worldId, &bodyDef );
+			if ( ( i * j ) % 2 == 0 )
+			{
+				b2CreatePolygonShape( bodyId, &shapeDef, &box );
+			}
+			else
+			{
+				b2CreateCircleShape( bodyId, &shapeDef, &circle );
+			}
+		}
+	}
+
+	b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+	b2Vec2 origins[BATCH_QUERY_COUNT];
+	b2Vec2 translations[BATCH_QUERY_COUNT];
+	b2AABB boxes[BATCH_QUERY_COUNT];
+	uint32_t seed = 42;
+	for ( int i = 0; i < BATCH_QUERY_COUNT; ++i )
+	{
+		seed = 1664525u * seed + 1013904223u;
+		float x = 34.0f * (float)( seed >> 8 ) / (float)( 1 << 24 );
+		seed = 1664525u * seed + 1013904223u;
+		float y = 26.0f * (float)( seed >> 8 ) / (float)( 1 << 24 );
+		origins[i] = (b2Vec2){ -2.0f, y };
+		translations[i] = (b2Vec2){ x + 2.0f, 26.0f - 2.0f * y };
+		boxes[i] = (b2AABB){ { x - 1.0f, y - 1.0f }, { x + 0.5f * ( i % 5 ), y + 0.5f * ( i % 3 ) } };
+	}
+
+	b2QueryFilter filter = b2DefaultQueryFilter();
+
+	for ( int pass = 0; pass < 4; ++pass )
+	{
+		// The second half walks the wide nodes of the rebuilt static tree
+		if ( pass == 2 )
+		{
+			b2World_RebuildStaticTree( worldId );
+		}
+
+		bool useTasks = pass % 2 == 1;
+
+		static b2RayResult results[BATCH_QUERY_COUNT];
+		b2TreeStats stats =
+			b2World_CastRayBatch( worldId, origins, translations, BATCH_QUERY_COUNT, filter, results, useTasks );
+		ENSURE( stats.nodeVisits > 0 );
+
+		int hitCount = 0;
+		for ( int i = 0; i < BATCH_QUERY_COUNT; ++i )
+		{
+			b2RayResult single = b2World_CastRayClosest( worldId, origins[i], translations[i], filter );
+			ENSURE( results[i].hit == single.hit );
+			if ( single.hit )
+			{
+				ENSURE( B2_ID_EQUALS( results[i].shapeId, single.shapeId ) );
+				ENSURE( results[i].fraction == single.fraction );
+				hitCount += 1;
+			}
+		}
+		ENSURE( hitCount > 0 );
+
+		static b2OverlapBatchResult overlaps[20 * BATCH_QUERY_COUNT];
+		int overlapCount =
+			b2World_OverlapAABBBatch( worldId, boxes, BATCH_QUERY_COUNT, filter, overlaps, 20 * BATCH_QUERY_COUNT, useTasks );
+		ENSURE( 0 < overlapCount && overlapCount <= 20 * BATCH_QUERY_COUNT );
+
+		int batchCounts[BATCH_QUERY_COUNT] = { 0 };
+		for ( int i = 0; i < overlapCount; ++i )
+		{
+			ENSURE( 0 <= overlaps[i].queryIndex && overlaps[i].queryIndex < BATCH_QUERY_COUNT );
+			ENSURE( b2Shape_IsValid( overlaps[i].shapeId ) );
+			batchCounts[overlaps[i].queryIndex] += 1;
+		}
+
+		for ( int i = 0; i < BATCH_QUERY_COUNT; ++i )
+		{
+			int singleCount = 0;
+			b2World_OverlapAABB( worldId, boxes[i], filter, CountOverlap, &singleCount );
+			ENSURE( batchCounts[i] == singleCount );
+		}
+
+		// A small result buffer still reports the full count
+		ENSURE( b2World_OverlapAABBBatch( worldId, boxes, BATCH_QUERY_COUNT, filter, overlaps, 3, useTasks ) ==
+				overlapCount );
+	}
+
+	b2DestroyWorld( worldId );
+
+	return 0;
+}
+
+#define REUSE_STACK_COUNT 5
+
+// A stack of boxes riding on a moving kinematic platform. The boxes settle and then only move
+// together with the platform, so most manifolds are reused.
+static int RunReuseStack( float tolerance, b2Vec2* topPosition, int* reuseCount )
+{
+	b2WorldDef worldDef = b2DefaultWorldDef();
+	worldDef.enableSleep = false;
+	worldDef.manifoldReuseTolerance = tolerance;
+	b2WorldId worldId = b2CreateWorld( &worldDef );
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.type = b2_kinematicBody;
+	b2BodyId platformId = b2CreateBody( worldId, &bodyDef );
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.material.friction = 1.0f;
+	b2Polygon platform = b2MakeBox( 10.0f, 0.5f );
+	b2CreatePolygonShape( platformId, &shapeDef, &platform );
+
+	bodyDef.type = b2_dynamicBody;
+	b2Polygon box = b2MakeBox( 0.5f, 0.5f );
+	b2BodyId topId = b2_nullBodyId;
+	for ( int i = 0; i < REUSE_STACK_COUNT; ++i )
+	{
+		bodyDef.position = (b2Vec2){ 0.0f, 1.0f + 1.0f * i };
+		topId = b2CreateBody( worldId, &bodyDef );
+		b2CreatePolygonShape( topId, &shapeDef, &box );
+	}
+
+	*reuseCount = 0;
+	for ( int i = 0; i < 240; ++i )
+	{
+		if ( i == 120 )
+		{
+			b2Body_SetLinearVelocity( platformId, (b2Vec2){ 0.5f, 0.0f } );
+		}
+
+		b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+		b2Counters counters = b2World_GetCounters( worldId );
+		ENSURE( 0 <= counters.manifoldReuseCount && counters.manifoldReuseCount <= REUSE_STACK_COUNT );
+		*reuseCount += counters.manifoldReuseCount;
+	}
+
+	*topPosition = b2Body_GetPosition( topId );
+	b2DestroyWorld( worldId );
+	return 0;
+}
+
+static int TestManifoldReuse( void )
+{
+	b2Vec2 computed, reused;
+	int computedCount, reusedCount;
+	ENSURE( RunReuseStack( 0.0f, &computed, &computedCount ) == 0 );
+	ENSURE( RunReuseStack( 0.1f * B2_LINEAR_SLOP, &reused, &reusedCount ) == 0 );
+
+	ENSURE( computedCount == 0 );
+	ENSURE( reusedCount > 240 * REUSE_STACK_COUNT / 2 );
+
+	// The stack moved with the platform and stayed upright
+	ENSURE( computed.x > 0.9f && computed.y > 4.9f );
+	ENSURE( b2Distance( computed, reused ) < B2_LINEAR_SLOP );
+	return 0;
+}
+
+#define INTEGRATE_BODY_COUNT 37
+
+static float RandomIntegrateFloat( uint32_t* seed, float lower, float upper )
+{
+	*seed = 1664525u * *seed + 1013904223u;
+	float unit = (float)( *seed >> 8 ) / (float)( 1 << 24 );
+	return lower + ( upper - lower ) * unit;
+}
+
+// The wide integration kernels must give the same bits as the scalar loops, including the speed clamps
+static int TestWideIntegration( void )
+{
+	int simBytes = INTEGRATE_BODY_COUNT * sizeof( b2BodySim );
+	int stateBytes = INTEGRATE_BODY_COUNT * sizeof( b2BodyState );
+	b2BodySim* sims = b2Alloc( simBytes );
+	b2BodySim* wideSims = b2Alloc( simBytes );
+	b2BodyState* states = b2Alloc( stateBytes );
+	b2BodyState* wideStates = b2Alloc( stateBytes );
+
+	b2Vec2 gravity = { 0.0f, -10.0f };
+	float h = 1.0f / 240.0f;
+	float maxLinearSpeed = 40.0f;
+	float maxAngularSpeed = B2_MAX_ROTATION * 60.0f;
+
+	uint32_t seed = 7;
+	int linearCapCount = 0, angularCapCount = 0;
+
+	for ( int round = 0; round < 20; ++round )
+	{
+		memset( sims, 0, simBytes );
+		for ( int i = 0; i < INTEGRATE_BODY_COUNT; ++i )
+		{
+			b2BodySim* sim = sims + i;
+			sim->force.x = RandomIntegrateFloat( &seed, -500.0f, 500.0f );
+			sim->force.y = RandomIntegrateFloat( &seed, -500.0f, 500.0f );
+			sim->torque = RandomIntegrateFloat( &seed, -200.0f, 200.0f );
+
+			// Some kinematic bodies, which ignore gravity
+			sim->invMass = ( i % 5 ) == 0 ? 0.0f : RandomIntegrateFloat( &seed, 0.1f, 2.0f );
+			sim->invInertia = RandomIntegrateFloat( &seed, 0.0f, 4.0f );
+			sim->linearDamping = RandomIntegrateFloat( &seed, 0.0f, 2.0f );
+			sim->angularDamping = RandomIntegrateFloat( &seed, 0.0f, 2.0f );
+			sim->gravityScale = RandomIntegrateFloat( &seed, -1.0f, 2.0f );
+			sim->allowFastRotation = ( i % 3 ) == 0;
+
+			b2BodyState* state = states + i;
+			state->linearVelocity.x = RandomIntegrateFloat( &seed, -50.0f, 50.0f );
+			state->linearVelocity.y = RandomIntegrateFloat( &seed, -50.0f, 50.0f );
+			state->angularVelocity = RandomIntegrateFloat( &seed, -80.0f, 80.0f );
+			state->flags = (int)seed;
+			state->deltaPosition.x = RandomIntegrateFloat( &seed, -1.0f, 1.0f );
+			state->deltaPosition.y = RandomIntegrateFloat( &seed, -1.0f, 1.0f );
+			state->deltaRotation = b2MakeRot( RandomIntegrateFloat( &seed, -B2_PI, B2_PI ) );
+
+			linearCapCount += b2Length( state->linearVelocity ) > maxLinearSpeed ? 1 : 0;
+			angularCapCount += b2AbsFloat( state->angularVelocity ) > maxAngularSpeed && sim->allowFastRotation == false ? 1 : 0;
+		}
+
+		// Every count covers a different remainder for the scalar tail
+		int count = INTEGRATE_BODY_COUNT - round;
+
+		memcpy( wideSims, sims, simBytes );
+		memcpy( wideStates, states, stateBytes );
+
+		b2IntegrateVelocities( sims, states, count, gravity, h, maxLinearSpeed, maxAngularSpeed );
+		b2IntegrateVelocitiesWide( wideSims, wideStates, count, gravity, h, maxLinearSpeed, maxAngularSpeed );
+		ENSURE( memcmp( states, wideStates, stateBytes ) == 0 );
+		ENSURE( memcmp( sims, wideSims, simBytes ) == 0 );
+
+		b2IntegratePositions( states, count, h );
+		b2IntegratePositionsWide( wideStates, count, h );
+		ENSURE( memcmp( states, wideStates, stateBytes ) == 0 );
+	}
+
+	// Make sure both clamps were exercised
+	ENSURE( linearCapCount > 0 && angularCapCount > 0 );
+
+	b2Free( sims, simBytes );
+	b2Free( wideSims, simBytes );
+	b2Free( states, stateBytes );
+	b2Free( wideStates, stateBytes );
+	return 0;
+}
+
+#define JOINT_CHAIN_COUNT 6
+#define JOINT_LINK_COUNT 10
+#define JOINT_BODY_COUNT ( JOINT_CHAIN_COUNT * JOINT_LINK_COUNT )
+
+static void SetChainJointBase( b2JointDef* base, b2BodyId bodyIdA, b2BodyId bodyIdB, b2Vec2 pivot, float threshold )
+{
+	base->bodyIdA = bodyIdA;
+	base->bodyIdB = bodyIdB;
+	base->localFrameA = (b2Transform){ b2Body_GetLocalPoint( bodyIdA, pivot ), b2Rot_identity };
+	base->localFrameB = (b2Transform){ b2Body_GetLocalPoint( bodyIdB, pivot ), b2Rot_identity };
+	base->forceThreshold = threshold;
+	base->torqueThreshold = threshold;
+}
+
+// Chains of revolute and weld joints with every option in use. A force threshold keeps all joints on the scalar path.
+static int RunJointChains( float threshold, b2Transform* transforms, b2Vec2* velocities, float* angularVelocities,
+						   b2Vec2* forces, float* torques )
+{
+	b2WorldDef worldDef = b2DefaultWorldDef();
+	worldDef.enableSleep = false;
+	b2WorldId worldId = b2CreateWorld( &worldDef );
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	b2Polygon box = b2MakeBox( 0.5f, 0.125f );
+
+	b2BodyId bodyIds[JOINT_BODY_COUNT];
+	b2JointId jointIds[JOINT_BODY_COUNT];
+
+	bodyDef.type = b2_dynamicBody;
+	for ( int k = 0; k < JOINT_CHAIN_COUNT; ++k )
+	{
+		b2BodyId prevId = groundId;
+		for ( int i = 0; i < JOINT_LINK_COUNT; ++i )
+		{
+			int index = JOINT_LINK_COUNT * k + i;
+			bodyDef.position = (b2Vec2){ 0.5f + i, 20.0f - 2.0f * k };
+
+			// A fixed rotation link on the ground disables the angular parts
+			bodyDef.fixedRotation = k == 1 && i == 0;
+			bodyIds[index] = b2CreateBody( worldId, &bodyDef );
+			b2CreatePolygonShape( bodyIds[index], &shapeDef, &box );
+
+			b2Vec2 pivot = { (float)i, 20.0f - 2.0f * k };
+
+			if ( ( i + k ) % 3 == 2 )
+			{
+				b2WeldJointDef jointDef = b2DefaultWeldJointDef();
+				SetChainJointBase( &jointDef.base, prevId, bodyIds[index], pivot, threshold );
+				jointDef.linearHertz = k % 2 == 0 ? 5.0f : 0.0f;
+				jointDef.angularHertz = i % 2 == 0 ? 3.0f : 0.0f;
+				jointDef.linearDampingRatio = 0.5f;
+				jointDef.angularDampingRatio = 0.5f;
+				jointIds[index] = b2CreateWeldJoint( worldId, &jointDef );
+			}
+			else
+			{
+				b2RevoluteJointDef jointDef = b2DefaultRevoluteJointDef();
+				SetChainJointBase( &jointDef.base, prevId, bodyIds[index], pivot, threshold );
+				jointDef.enableSpring = i % 2 == 0;
+				jointDef.hertz = 2.0f;
+				jointDef.dampingRatio = 0.3f;
+				jointDef.targetAngle = 0.25f * i;
+				jointDef.enableLimit = i % 3 == 0;
+				jointDef.lowerAngle = -0.3f;
+				jointDef.upperAngle = 0.4f;
+				jointDef.enableMotor = i % 4 == 1;
+				jointDef.maxMotorTorque = 20.0f;
+				jointDef.motorSpeed = k % 2 == 0 ? 1.0f : -2.0f;
+				jointIds[index] = b2CreateRevoluteJoint( worldId, &jointDef );
+
+				// The definition clamps the target angle but the setter does not, so this needs the full unwind
+				if ( k == 4 )
+				{
+					b2RevoluteJoint_SetTargetAngle( jointIds[index], 10.0f );
+				}
+			}
+
+			prevId = bodyIds[index];
+		}
+	}
+
+	for ( int i = 0; i < 120; ++i )
+	{
+		b2World_Step( worldId, 1.0f / 60.0f, 4 );
+	}
+
+	for ( int i = 0; i < JOINT_BODY_COUNT; ++i )
+	{
+		transforms[i] = b2Body_GetTransform( bodyIds[i] );
+		velocities[i] = b2Body_GetLinearVelocity( bodyIds[i] );
+		angularVelocities[i] = b2Body_GetAngularVelocity( bodyIds[i] );
+		forces[i] = b2Joint_GetConstraintForce( jointIds[i] );
+		torques[i] = b2Joint_GetConstraintTorque( jointIds[i] );
+	}
+
+	ENSURE( b2World_GetJointEvents( worldId ).count == 0 );
+
+	b2DestroyWorld( worldId );
+	return 0;
+}
+
+// Revolute and weld joints solved in SIMD lanes must give the same bits as the scalar joint solver
+static int TestWideJoints( void )
+{
+	b2Transform transforms[2][JOINT_BODY_COUNT];
+	b2Vec2 velocities[2][JOINT_BODY_COUNT];
+	float angularVelocities[2][JOINT_BODY_COUNT];
+	b2Vec2 forces[2][JOINT_BODY_COUNT];
+	float torques[2][JOINT_BODY_COUNT];
+
+	ENSURE( RunJointChains( FLT_MAX, transforms[0], velocities[0], angularVelocities[0], forces[0], torques[0] ) == 0 );
+	ENSURE( RunJointChains( 1.0e30f, transforms[1], velocities[1], angularVelocities[1], forces[1], torques[1] ) == 0 );
+
+	ENSURE( memcmp( transforms[0], transforms[1], sizeof( transforms[0] ) ) == 0 );
+	ENSURE( memcmp( velocities[0], velocities[1], sizeof( velocities[0] ) ) == 0 );
+	ENSURE( memcmp( angularVelocities[0], angularVelocities[1], sizeof( angularVelocities[0] ) ) == 0 );
+	ENSURE( memcmp( forces[0], forces[1], sizeof( forces[0] ) ) == 0 );
+	ENSURE( memcmp( torques[0], torques[1], sizeof( torques[0] ) ) == 0 );
+
+	// The chains fell and swung
+	ENSURE( transforms[0][JOINT_BODY_COUNT - 1].p.y < 10.0f );
+	return 0;
+}
+
+// A wide plank holding more small bodies than there are graph colors. The extra contacts go to the
+// overflow set. Removing some bodies frees colors and the remaining overflow contacts move into them.
+static int TestOverflowRecolor( void )
+{
+	b2WorldDef worldDef = b2DefaultWorldDef();
+	worldDef.gravity = b2Vec2_zero;
+	b2WorldId worldId = b2CreateWorld( &worldDef );
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.type = b2_dynamicBody;
+	b2BodyId plankId = b2CreateBody( worldId, &bodyDef );
+	b2Polygon plank = b2MakeBox( 40.0f, 0.5f );
+	b2CreatePolygonShape( plankId, &shapeDef, &plank );
+
+	enum
+	{
+		e_count = 32
+	};
+
+	b2BodyId bodyIds[e_count];
+	b2Circle circle = { { 0.0f, 0.0f }, 0.5f };
+	for ( int i = 0; i < e_count; ++i )
+	{
+		bodyDef.position = (b2Vec2){ -35.0f + 2.0f * i, 1.0f };
+		bodyIds[i] = b2CreateBody( worldId, &bodyDef );
+		b2CreateCircleShape( bodyIds[i], &shapeDef, &circle );
+	}
+
+	b2World_Step( worldId, 1.0f / 60.0f, 4 );
+	b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+	b2Counters counters = b2World_GetCounters( worldId );
+	ENSURE( counters.overflowContactCount > 0 );
+	ENSURE( counters.overflowJointCount == 0 );
+
+	int colorCount = sizeof( counters.colorCounts ) / sizeof( counters.colorCounts[0] );
+	int totalCount = 0;
+	for ( int i = 0; i < colorCount; ++i )
+	{
+		totalCount += counters.colorCounts[i];
+	}
+	ENSURE( totalCount == e_count );
+	ENSURE( counters.colorCounts[colorCount - 1] == counters.overflowContactCount );
+
+	for ( int i = 0; i < e_count / 2; ++i )
+	{
+		b2DestroyBody( bodyIds[i] );
+	}
+
+	b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+	counters = b2World_GetCounters( worldId );
+	ENSURE( counters.recolorCount > 0 );
+	ENSURE( counters.overflowContactCount == 0 );
+
+	b2World_Step( worldId, 1.0f / 60.0f, 4 );
+
+	counters = b2World_GetCounters( worldId );
+	ENSURE( counters.recolorCount == 0 );
+
+	b2DestroyWorld( worldId );
+
+	return 0;
+}
+
 int WorldTest( void )
 {
 	RUN_SUBTEST( HelloWorld );
@@ -403,6 +1092,13 @@ int WorldTest( void )
 	RUN_SUBTEST( TestWorldRecycle );
 	RUN_SUBTEST( TestWorldCoverage );
 	RUN_SUBTEST( TestSensor );
+	RUN_SUBTEST( TestWorldSnapshot );
+	RUN_SUBTEST( TestBroadPhaseTypes );
+	RUN_SUBTEST( TestBatchQueries );
+	RUN_SUBTEST( TestManifoldReuse );
+	RUN_SUBTEST( TestWideIntegration );
+	RUN_SUBTEST( TestWideJoints );
+	RUN_SUBTEST( TestOverflowRecolor );
 
 	return 0;
 }